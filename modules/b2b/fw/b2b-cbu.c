@@ -3,7 +3,7 @@
  *
  *  created : 2019
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 06-Oct-2023
+ *  version : 18-Oct-2026
  *
  *  firmware implementing the CBU (Central Bunch-To-Bucket Unit)
  *  NB: units of variables are [ns] unless explicitely mentioned as suffix
@@ -58,6 +58,7 @@
 #include <common-defs.h>                                                // common defs
 #include <common-fwlib.h>                                               // fw lib
 #include <b2b.h>                                                        // defs for b2b
+#include <b2b-phasematch.h>                                             // phase match
 #include <b2bcbu_shared_mmap.h>                                         // autogenerated upon building firmware
 
 // stuff required for environment
@@ -603,7 +604,7 @@ void rfFineTune(uint64_t tH1Ext_as, uint64_t tH1Inj_as, uint64_t *tMatch_as, uin
 } // rfFineTune
 
 
-// true b2b: calculate time for phase match
+// true b2b: calculate time for phase match; returns B2B_STATUS_PHASEFAILED with a valid (fine tuned) tPhaseMatch if multi-beat tuning failed
 uint32_t calcPhaseMatch(uint64_t tMin, uint64_t *tPhaseMatch, uint64_t *TBeat_as)  // calculates when extraction and injection machines are synchronized
 {
   uint64_t TSlow_as;                                // period of 'slow' RF signal               [as] // sic! atoseconds
@@ -631,15 +632,12 @@ uint32_t calcPhaseMatch(uint64_t tMin, uint64_t *tPhaseMatch, uint64_t *TBeat_as
 #define LIMITMULTIBEAT  360                         // do multibeat-tuning, if number of h=1 periods within beating is below this number
 
   uint64_t nH1BeatExt;                              // number of h=1 periods within beating period extraction
-  int      i;
-  int      nProbes;                                 // number of probes to be used
-  int      maxProbes;                               // max number of probes
-  uint64_t tTimeout;                                // deadline, when this routine must finish
-  int64_t  dt_as, dtTmp_as;                         // achieved precision, temporary variable
-  uint64_t tMatch0_as, tMatchTmp_as;                // temporary variables
-  uint64_t TBeat;                                   // beat period (see 'trick' below)          [ns]
-  uint64_t iMatch;                                  // trick: iteration of good match allows continuation of fine tuning
+  int64_t  dt_as;                                   // achieved precision                       [as]
+  uint64_t tMatchTmp_as;                            // temporary variable
+  uint64_t tFirst_as;                               // begin of window for kicker trigger       [as]
+  uint64_t tLast_as;                                // end of window for kicker trigger         [as]
   uint32_t tmp32;
+  uint32_t status = COMMON_STATUS_OK;
 
   // define temporary epoch
   tNow    = getSysTime();
@@ -735,42 +733,27 @@ uint32_t calcPhaseMatch(uint64_t tMin, uint64_t *tPhaseMatch, uint64_t *TBeat_as
  
   //pp_printf("TH1Inj %llu, nPeriod %llu, nGInj %u, flagExtSlow %d\n", TH1Inj, nPeriod, nGInj, flagExtSlow);
   
-  // enable fine tuning?
-  if (fFineTune) nProbes = 1;
-  else           nProbes = 0;
-  
   // multi-beat tuning
-  dt_as       = 999999999999;
-  tMatch0_as  = tMatch_as;
   nH1BeatExt = *TBeat_as / TRfExt_as;
-  maxProbes  = 0;
   // multi-beat tuning is applied if one of the following conditions is fullfilled
   // a. very short beating period
   // b. geometric harmonic number of injection > 1 (CR -> HESR, 'brute force')
   // c. if the multi-beat flag is set
+  // instead of probing beat by beat, the best matching h=1 edge of extraction within the allowed window is
+  // calculated directly; this takes a bounded number of steps and needs no timeout
   if ((nH1BeatExt < LIMITMULTIBEAT) || (nGInj > 1) || fMBTune) {
-    tTimeout  = tMin - (COMMON_AHEADT); // time, when we must finish     
-    maxProbes = (one_ns_as * (B2B_KICKOFFSETMAX - B2B_KICKOFFSETMIN)) / *TBeat_as;
-    if (maxProbes > nProbes) nProbes = maxProbes;
-    TBeat     = *TBeat_as / one_ns_as;
-    iMatch    = 0;
-  } // if nH1BeatExt
-  //pp_printf("cbu, nProbes %d\n", nProbes);
-  for (i=0; i < nProbes; i++) {
-    // advance to next possible beat time (unless in first iteration)
-    tMatchTmp_as = tMatch0_as + (uint64_t)i * *TBeat_as;
-
-    // fine tune (and align to extraction ring) and check for improved value
-    rfFineTune(tH1Ext_as, tH1Inj_as, &tMatchTmp_as, &dtTmp_as);
-    if (llabs(dtTmp_as) < llabs(dt_as)) {
+    tFirst_as = (tMin - epoch) * one_ns_as;
+    tLast_as  = (tMin - epoch + (B2B_KICKOFFSETMAX - B2B_KICKOFFSETMIN)) * one_ns_as - (one_ns_as >> 1); // stay within window after rounding to ns
+    if (phmatch_bestMatch(tH1Ext_as, TH1Ext_as, tH1Inj_as, TH1Inj_as, tFirst_as, tLast_as, &tMatchTmp_as, &dt_as) == COMMON_STATUS_OK)
       tMatch_as = tMatchTmp_as;
-      dt_as     = dtTmp_as;
-      iMatch   = i;
-    } // if dtTmp_as
-    if (getSysTime() > (tTimeout + iMatch * TBeat)) break;
-  } // for i
-
-  //pp_printf("b2b: n probes (=max) %d, used %d\n", nProbes, i);
+    else {
+      // search failed: fall back to fine tuning of the first match found above and report this
+      rfFineTune(tH1Ext_as, tH1Inj_as, &tMatch_as, (uint64_t *)&dt_as);
+      status = B2B_STATUS_PHASEFAILED;
+    } // else phmatch_bestMatch
+  } // if nH1BeatExt
+  // fine tune (and align to extraction ring)
+  else if (fFineTune) rfFineTune(tH1Ext_as, tH1Inj_as, &tMatch_as, (uint64_t *)&dt_as);
 
   // convert back to TAI
   tMatch       = tMatch_as / one_ns_as;
@@ -786,7 +769,7 @@ uint32_t calcPhaseMatch(uint64_t tMin, uint64_t *tPhaseMatch, uint64_t *TBeat_as
     return COMMON_STATUS_OUTOFRANGE;
   } // if tmp32
 
-  return COMMON_STATUS_OK;    
+  return status;
 } // calcPhaseMatch
 
 
@@ -1192,7 +1175,7 @@ uint32_t doActionOperation(uint32_t actStatus)                // actual status o
     //tmp32 = (getSysTime() - tCBS); pp_printf("pre phase match %u\n", tmp32);
     if (errorFlags) {tTrig =  tWantExt;/*pp_printf("b2b: error flags\n");*/}  // plan B
     else if ((status = calcPhaseMatch(tWantExt, &tTrig, &TBeat_as)) != COMMON_STATUS_OK) {
-      tTrig       = tWantExt;                                                 // plan B
+      if (status != B2B_STATUS_PHASEFAILED) tTrig = tWantExt;                // plan B; else keep fine tuned fallback
       errorFlags |= B2B_ERRFLAG_CBU;
       //pp_printf("b2b: error match algorithm, TBeat %lu\n", (uint32_t)(TBeat_as / 1000000000));
     } // if NOT STATUS_OK
@@ -0,0 +1,313 @@
+/********************************************************************************************
+ *  b2b-phasefit.c
+ *
+ *  created : 2026
+ *  author  : Dietrich Beck, GSI-Darmstadt
+ *  version : 18-Oct-2026
+ *
+ *  routines for fitting the h=1 phase from a series of timestamps
+ *
+ *  - used by the firmware b2b-pm and by host tools (b2b-sim, b2b-phasefit-bench)
+ *  - keep this portable: integer arithmetic only, no firmware libs
+ *  units of time are
+ *  in case of no suffix         : ns
+ *  in case of suffix such as _as: as
+ *  in case of suffix _t         : b2bt type
+ *
+ * -------------------------------------------------------------------------------------------
+ * License Agreement for this software:
+ *
+ * Copyright (C) 2018  Dietrich Beck
+ * GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ * Planckstrasse 1
+ * D-64291 Darmstadt
+ * Germany
+ *
+ * Contact: d.beck@gsi.de
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * For all questions and ideas contact: d.beck@gsi.de
+ * Last update: 15-April-2019
+ ********************************************************************************************/
+#include <stdint.h>
+
+#include <common-defs.h>                                                // common defs
+#include <common-fwlib.h>                                               // b2bt_t
+#include <b2b.h>                                                        // specific defs for b2b
+#include <b2b-phasefit.h>                                               // this module
+
+
+// adjusts ns such, that ps part remains small; same as fwlib_cleanB2bt, but available for host tools
+static b2bt_t cleanB2bt(b2bt_t t_ps)
+{
+  while (t_ps.ps < -500) {t_ps.ns -= 1; t_ps.ps += 1000;}
+  while (t_ps.ps >= 500) {t_ps.ns += 1; t_ps.ps -= 1000;}
+
+  return t_ps;
+} // cleanB2bt
+
+
+// mark phase as invalid
+static void invalidPhase(b2bt_t *phase_t)
+{
+  (*phase_t).ns  = 0x7fffffffffffffff;
+  (*phase_t).ps  = 0x7fffffff;
+  (*phase_t).dps = 0x7fffffff;
+} // invalidPhase
+
+
+// sort timestamps as they might be unordered
+// for 11/31/51/61/101 timestamps, this is below 10,16,27,31,51 us
+void phfit_insertionSort(uint64_t *stamps, int n)
+{
+  int      i, j;
+  uint64_t tmp;
+
+  for (i=1; i<n; i++) {
+    tmp = stamps[i];
+    j   = i;
+    while ((--j >= 0) && (stamps[j] > tmp)) stamps[j+1] = stamps[j];
+    stamps[j+1] = tmp;
+  } // for i
+} // phfit_insertionSort
+
+
+// quickselect (Hoare) with middle element as pivot; timestamps are usually almost sorted, thus
+// the middle element is a good guess for the median and the worst case is not hit
+uint64_t phfit_select(uint64_t *stamps, int n, int k)
+{
+  int      left, right, i, j;
+  uint64_t pivot;
+  uint64_t tmp;
+
+  left  = 0;
+  right = n - 1;
+  while (left < right) {
+    pivot = stamps[left + ((right - left) >> 1)];
+    i     = left;
+    j     = right;
+    while (i <= j) {
+      while (stamps[i] < pivot) i++;
+      while (stamps[j] > pivot) j--;
+      if (i <= j) {
+        tmp = stamps[i]; stamps[i] = stamps[j]; stamps[j] = tmp;
+        i++;
+        j--;
+      } // if i <= j
+    } // while i <= j
+    if      (k <= j) right = j;
+    else if (k >= i) left  = i;
+    else             break;
+  } // while left < right
+
+  return stamps[k];
+} // phfit_select
+
+
+// perform fit of phase with sub-ns
+int32_t phfit_phaseFitAverage(uint64_t *stamps, uint32_t nSamples, uint64_t TH1_as, int method, b2bt_t *phase_t, uint32_t *window_as)
+{
+  int64_t  one_ns_as   = 1000000000;        // conversion ns to as
+  int64_t  max_diff_as = TH1_as >> 2;       // maximum difference shall be a quarter of the rf-period
+
+  int      i;
+  uint64_t tFirst_ns;                       // first timestamp [ns]
+  uint64_t diff_stamp_as;                   // difference between actual and first timestamp [as]
+  int64_t  sum_rfperiods_as;                // sum of all rf-periods [as]
+  int64_t  deviation_as;                    // deviation between measured and projected timestamp [as]
+  int64_t  abs_deviation_as;                // absolute value of deviation [as]
+  int64_t  sum_deviation_as;                // sum of all deviations [as]
+  int64_t  ave_deviation_as;                // average of all deviations [as]
+  int64_t  max_deviation_as;                // maximum of all deviations [as]
+  int64_t  min_deviation_as;                // minimum of all deviations [as]
+  int64_t  subnsfit_dev_as;                 // sub-ns-fit deviation [as]
+  uint32_t window;                          // window given by max and min deviation [as]
+  b2bt_t   ts_t;                            // timestamp [ps]
+  int      nGood;                           // number of good timestamps
+
+  // The idea is similar to the native sub-ns fit. As the main difference, the fractional part is
+  // not calculated by the _two_ extremes only, but by using the average of _all_ samples.
+  // The algorithm is as follows
+  // - always start from the 1st 'good' timestamp (which is the stamps[1], stamps[0] might be bad)
+  // - for stamps[i], add (i-1)*rf-period to the first timestamp and calc the difference to stamps[i]
+  // - average all the differences -> one obtains the mean value of all differences
+  // - use the mean values as fractional part and add this to the value of stamps[1]
+  // Be aware: timestamps are sorted, but maybe incomplete. The algorithm stops at the first missing timestamp.
+
+  if (TH1_as==0)    return B2B_STATUS_PHASEFAILED; // rf period must be known
+  if (nSamples < 3) return B2B_STATUS_PHASEFAILED; // need at least three measurements
+
+  // init stuff
+  tFirst_ns = stamps[1];              // don't use 1st timestamp stamps[0]: start with 2nd timestamp stamps[1]
+  sum_deviation_as = 0;
+  sum_rfperiods_as = 0;
+  nGood            = 0;
+  max_deviation_as = 0;
+  min_deviation_as = 0;
+
+  // calc sum deviation of all timestamps
+  for (i=1; i<nSamples; i++) {        // include 1st timestamp too (important for little statistics)
+    // this multiplication is expensive
+    diff_stamp_as = (stamps[i] - tFirst_ns) * one_ns_as;
+
+    // we use ther number of iterations as the number of rf-periods; thus, the algorithm will
+    // stop at the first missing timestamp
+    deviation_as  = diff_stamp_as - sum_rfperiods_as;
+
+    if (deviation_as < 0) abs_deviation_as = -deviation_as;
+    else                  abs_deviation_as =  deviation_as;
+    // do a simple consistency check - don't accept differences larger than max_diff
+    if (abs_deviation_as < max_diff_as) {
+      sum_deviation_as += deviation_as;
+      nGood++;
+      // simple statistics
+      if (deviation_as > max_deviation_as) max_deviation_as = deviation_as;
+      if (deviation_as < min_deviation_as) min_deviation_as = deviation_as;
+    } // if abs_deviation in range
+
+    // increment rf period for next iteration
+    sum_rfperiods_as += TH1_as;
+  } // for i
+
+  // if result invalid, return with error
+  if (nGood < 1) {
+    invalidPhase(phase_t);
+    return B2B_STATUS_PHASEFAILED;
+  } // if nGood < 1
+
+  // calculate average and max-min window
+  ave_deviation_as = sum_deviation_as / nGood;
+  subnsfit_dev_as  = (max_deviation_as + min_deviation_as) >> 1;
+  window           = (uint32_t)(max_deviation_as - min_deviation_as);
+  // calculate a phase value and convert to ps
+  ts_t.ns          = tFirst_ns;
+  if (method == PHFIT_SUBNS) ts_t.ps = subnsfit_dev_as  / 1000000;  // sub-ns fit
+  else                       ts_t.ps = ave_deviation_as / 1000000;  // average fit
+  ts_t.dps         = window >> 20;                   // cheap division by 1000000
+  *phase_t         = cleanB2bt(ts_t);
+  if (window_as) *window_as = window;
+
+  return COMMON_STATUS_OK;
+} // phfit_phaseFitAverage
+
+
+// perform fit of phase with sub-ns on unsorted timestamps
+// - the median timestamp serves as reference, it is found by selection in O(n) instead of sorting
+// - for each timestamp, the deviation from the closest multiple of the rf-period is calculated
+// - the fitted phase refers to the median timestamp and not to the 2nd earliest one; the difference
+//   to phfit_phaseFitAverage is a multiple of the rf-period
+// this costs one 64 bit division per timestamp; this is cheap on the host but not on the lm32
+int32_t phfit_phaseFitMedian(uint64_t *stamps, uint32_t nSamples, uint64_t TH1_as, int method, b2bt_t *phase_t, uint32_t *window_as)
+{
+  int64_t  one_ns_as   = 1000000000;        // conversion ns to as
+  int64_t  max_diff_as = TH1_as >> 2;       // maximum difference shall be a quarter of the rf-period
+  int64_t  half_as     = TH1_as >> 1;       // half rf-period
+
+  int      i;
+  uint64_t tRef_ns;                         // reference timestamp [ns]
+  int64_t  diff_stamp_as;                   // difference between actual and reference timestamp [as]
+  int64_t  nPeriods;                        // number of rf-periods between actual and reference timestamp
+  int64_t  deviation_as;                    // deviation between measured and projected timestamp [as]
+  int64_t  abs_deviation_as;                // absolute value of deviation [as]
+  int64_t  sum_deviation_as;                // sum of all deviations [as]
+  int64_t  max_deviation_as;                // maximum of all deviations [as]
+  int64_t  min_deviation_as;                // minimum of all deviations [as]
+  uint32_t window;                          // window given by max and min deviation [as]
+  b2bt_t   ts_t;                            // timestamp [ps]
+  int      nGood;                           // number of good timestamps
+
+  if (TH1_as==0)    return B2B_STATUS_PHASEFAILED; // rf period must be known
+  if (nSamples < 3) return B2B_STATUS_PHASEFAILED; // need at least three measurements
+
+  tRef_ns          = phfit_select(stamps, nSamples, nSamples >> 1);
+  sum_deviation_as = 0;
+  nGood            = 0;
+  max_deviation_as = 0;
+  min_deviation_as = 0;
+
+  for (i=0; i<nSamples; i++) {
+    diff_stamp_as = (int64_t)(stamps[i] - tRef_ns) * one_ns_as;
+    if (diff_stamp_as < 0) nPeriods = (diff_stamp_as - half_as) / (int64_t)TH1_as;
+    else                   nPeriods = (diff_stamp_as + half_as) / (int64_t)TH1_as;
+    deviation_as  = diff_stamp_as - nPeriods * (int64_t)TH1_as;
+
+    if (deviation_as < 0) abs_deviation_as = -deviation_as;
+    else                  abs_deviation_as =  deviation_as;
+    // same consistency check as phfit_phaseFitAverage
+    if (abs_deviation_as < max_diff_as) {
+      sum_deviation_as += deviation_as;
+      nGood++;
+      if (deviation_as > max_deviation_as) max_deviation_as = deviation_as;
+      if (deviation_as < min_deviation_as) min_deviation_as = deviation_as;
+    } // if abs_deviation in range
+  } // for i
+
+  if (nGood < 1) {
+    invalidPhase(phase_t);
+    return B2B_STATUS_PHASEFAILED;
+  } // if nGood < 1
+
+  window           = (uint32_t)(max_deviation_as - min_deviation_as);
+  ts_t.ns          = tRef_ns;
+  if (method == PHFIT_SUBNS) ts_t.ps = ((max_deviation_as + min_deviation_as) >> 1) / 1000000;
+  else                       ts_t.ps = (sum_deviation_as / nGood)                 / 1000000;
+  ts_t.dps         = window >> 20;
+  *phase_t         = cleanB2bt(ts_t);
+  if (window_as) *window_as = window;
+
+  return COMMON_STATUS_OK;
+} // phfit_phaseFitMedian
+
+
+// 'fit' phase value
+// this takes about 38/54/72/115us per 11/31/51/101 samples
+uint32_t phfit_phaseFit(uint64_t *stamps, uint32_t nSamples, uint64_t period_as, int method, b2bt_t *phase_t)
+{
+  int      usedIdx;         // index of used timestamp
+  int32_t  diff;            // difference of two neighboring timestamps [ns]
+  int32_t  delta;           // difference from expected period [ns]
+  int32_t  dt;              // helper variable
+  int32_t  periodNs;        // period [ns]
+  uint32_t maxDelta;        // max deviation of measured period [ns]
+  int32_t  status;
+
+  if (period_as == 0)         return B2B_STATUS_PHASEFAILED;           // this does not make sense
+  if (nSamples   < 3)         return B2B_STATUS_PHASEFAILED;           // have at least three samples
+
+  // select timestamp in the middle (never use the first TS)
+  usedIdx  = nSamples >> 1;                                            // this is safe as we have at least three samples
+
+  // check period
+  periodNs = (int32_t)(period_as/1000000000);                          // convert to ns chk: consider right-shift by 30 bits instead
+  maxDelta = periodNs / 10;                                            // allow 10% deviation chk: consider right-shift by 3 bits instead
+  diff     = (int32_t)(stamps[usedIdx+1] - stamps[usedIdx]);           // time difference of selected timestamps
+  delta    = diff % periodNs;                                          // difference is multiple of period? (missing timestamp possible)!
+  if (delta > (periodNs >> 1)) dt = periodNs - delta;
+  else                         dt = delta;
+  if (dt > maxDelta) return B2B_STATUS_PHASEFAILED;
+
+  // phase fit
+  status = phfit_phaseFitAverage(stamps, nSamples, period_as, method, phase_t, 0);
+
+  // if phase fit failed: plan B
+  if (status != COMMON_STATUS_OK) {
+    (*phase_t).ns  = stamps[usedIdx];                                  // just grab a timestamp in the middle
+    (*phase_t).ps  = 0;
+    (*phase_t).dps = 2000;                                             // conservative estimate of uncertainty
+    status         = COMMON_STATUS_OK;                                 // assume this is ok ...
+  } // if status
+
+  return status;
+} // phfit_phaseFit
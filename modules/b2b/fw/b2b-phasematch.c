@@ -0,0 +1,146 @@
+/********************************************************************************************
+ *  b2b-phasematch.c
+ *
+ *  created : 2026
+ *  author  : Dietrich Beck, GSI-Darmstadt
+ *  version : 18-Oct-2026
+ *
+ *  routines for finding the best phase match of the h=1 signals of two rings
+ *
+ *  - used by the firmware b2b-cbu and by the host tool b2b-phasematch-test
+ *  - keep this portable: integer arithmetic only, no firmware libs
+ *  units of time are
+ *  in case of suffix such as _as: as
+ *
+ * -------------------------------------------------------------------------------------------
+ * License Agreement for this software:
+ *
+ * Copyright (C) 2018  Dietrich Beck
+ * GSI Helmholtzzentrum fuer Schwerionenforschung GmbH
+ * Planckstrasse 1
+ * D-64291 Darmstadt
+ * Germany
+ *
+ * Contact: d.beck@gsi.de
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * For all questions and ideas contact: d.beck@gsi.de
+ * Last update: 15-April-2019
+ ********************************************************************************************/
+#include <stdint.h>
+
+#include <common-defs.h>                                                // common defs
+#include <b2b-phasematch.h>                                             // this module
+
+#define NONE 0xffffffffffffffff                                         // no solution
+
+
+// smallest d in [0, dMax] with L <= (d * a) mod m <= R; requires 0 <= a < m and 0 <= L <= R < m
+// this is the Euclidean algorithm on the pair (m, a); the depth of recursion is O(log(m))
+static uint64_t firstInRange(uint64_t a, uint64_t m, uint64_t L, uint64_t R, uint64_t dMax)
+{
+  uint64_t d;
+  uint64_t y;                                                           // number of wraps of d * a around m
+  uint64_t yMax;
+
+  if (L == 0) return 0;
+  if (a == 0) return NONE;
+
+  // solution without wrap?
+  d = (L + a - 1) / a;
+  if (d * a <= R) {
+    if (d > dMax) return NONE;
+    return d;
+  } // if no wrap
+
+  // now, [L, R] contains no multiple of a; we need y wraps such that L <= d * a - y * m <= R, which is
+  // equivalent to (y * m) mod a in [(-R) mod a, (-L) mod a]; d grows with y, thus the smallest y is wanted
+  yMax = (dMax / m) * a + ((dMax % m) * a) / m + 1;
+  y    = firstInRange(m % a, a, a - R % a, a - L % a, yMax);
+  if (y == NONE) return NONE;
+  d    = (L + y * m + a - 1) / a;
+  if (d > dMax) return NONE;
+
+  return d;
+} // firstInRange
+
+
+// minimum of (c + x * s) mod m for x in [0, n), earliest x if ambiguous; returns value
+// the record values of the sequence decrease in runs with constant step; each run is taken in one go and the
+// value after a run is less than the decrement during the run, thus the number of runs is O(log(m))
+static uint64_t minMod(uint64_t c, uint64_t s, uint64_t m, uint64_t n, uint64_t *x)
+{
+  uint64_t v;                                                           // current record value
+  uint64_t d;                                                           // step to next record
+  uint64_t delta;                                                       // decrement of value per step
+  uint64_t k;                                                           // number of steps in this run
+
+  *x = 0;
+  v  = c;
+  while ((v > 0) && (*x + 1 < n)) {
+    // next record: (v + d * s) mod m < v, that is (d * s) mod m in [m - v, m - 1]
+    d = firstInRange(s, m, m - v, m - 1, n - 1 - *x);
+    if (d == NONE) break;
+    delta = m - (d * s) % m;
+    k     = v / delta;
+    if (k > (n - 1 - *x) / d) k = (n - 1 - *x) / d;
+    *x   += k * d;
+    v    -= k * delta;
+  } // while v
+
+  return v;
+} // minMod
+
+
+uint32_t phmatch_bestMatch(uint64_t tExt_as, uint64_t TExt_as, uint64_t tInj_as, uint64_t TInj_as, uint64_t tFirst_as, uint64_t tLast_as,
+                           uint64_t *tMatch_as, int64_t *dt_as)
+{
+  uint64_t tE_as;                                                       // first edge of extraction within window
+  uint64_t n;                                                           // number of edges of extraction within window
+  uint64_t c;                                                           // offset of first edge to injection, modulo TInj
+  uint64_t s;                                                           // advance per edge, modulo TInj
+  uint64_t xPlus, xMinus;                                               // index of best edge
+  uint64_t vPlus, vMinus;                                               // deviation of best edge
+
+  if ((TExt_as == 0) || (TInj_as == 0)) return COMMON_STATUS_OUTOFRANGE;
+  if (tLast_as < tFirst_as)             return COMMON_STATUS_OUTOFRANGE;
+
+  // first edge of extraction within window
+  if (tExt_as >= tFirst_as) tE_as = tExt_as - ((tExt_as - tFirst_as) / TExt_as) * TExt_as;
+  else                      tE_as = tExt_as + ((tFirst_as - tExt_as + TExt_as - 1) / TExt_as) * TExt_as;
+  if (tE_as > tLast_as)                 return COMMON_STATUS_OUTOFRANGE;
+  n = (tLast_as - tE_as) / TExt_as + 1;
+  if (n > (NONE >> 2) / TInj_as)        return COMMON_STATUS_OUTOFRANGE;   // products below must not overflow
+
+  // deviation of edge x: (c + x * s) mod TInj, extraction later than injection
+  if (tE_as >= tInj_as) c = (tE_as - tInj_as) % TInj_as;
+  else                  c = (TInj_as - (tInj_as - tE_as) % TInj_as) % TInj_as;
+  s = TExt_as % TInj_as;
+
+  // best match with extraction after and before injection
+  vPlus  = minMod(c, s, TInj_as, n, &xPlus);
+  vMinus = minMod((TInj_as - c) % TInj_as, (TInj_as - s) % TInj_as, TInj_as, n, &xMinus);
+
+  if ((vPlus < vMinus) || ((vPlus == vMinus) && (xPlus <= xMinus))) {
+    *tMatch_as = tE_as + xPlus * TExt_as;
+    *dt_as     = (int64_t)vPlus;
+  } // if plus
+  else {
+    *tMatch_as = tE_as + xMinus * TExt_as;
+    *dt_as     = -(int64_t)vMinus;
+  } // else plus
+
+  return COMMON_STATUS_OK;
+} // phmatch_bestMatch
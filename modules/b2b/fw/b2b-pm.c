@@ -3,7 +3,7 @@
  *
  *  created : 2019
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 15-Nov-2023
+ *  version : 18-Oct-2026
  *
  *  firmware required for measuring the h=1 phase for ring machine
  *  
@@ -64,6 +64,7 @@
 #include <common-defs.h>                                                // common defs for firmware
 #include <common-fwlib.h>                                               // common routines for firmware
 #include <b2b.h>                                                        // specific defs for b2b
+#include <b2b-phasefit.h>                                               // phase fit
 #include <b2bpm_shared_mmap.h>                                          // autogenerated upon building firmware
 
 // stuff required for environment
@@ -229,165 +230,6 @@ uint32_t extern_exitActionOperation()
 } // extern_exitActionOperation
 
 
-// sort timestamps as they might be unordered
-// for 11/31/51/61/101 timestamps, this is below 10,16,27,31,51 us
-void insertionSort(uint64_t *stamps, int n) {
-  int      i, j;
-  uint64_t tmp;
-  for (i=1; i<n; i++) {
-    tmp = stamps[i];
-    j   = i;
-    while ((--j >= 0) && (stamps[j] > tmp)) stamps[j+1] = stamps[j];
-    stamps[j+1] = tmp;
-  } // for i
-} // insertionSort
-
-
-// perform fit of phase with sub-ns
-int32_t phaseFitAverage(uint64_t TH1_as, uint32_t nSamples, b2bt_t *phase_t) {
-  int64_t  one_ns_as   = 1000000000;        // conversion ns to as
-  int64_t  max_diff_as = TH1_as >> 2;       // maximum difference shall be a quarter of the rf-period
-  
-  int      i;
-  uint64_t tFirst_ns;                       // first timestamp [ns]
-  //uint64_t nPeriods;                      // number of rf periods
-  uint64_t diff_stamp_as;                   // difference between actual and first timestamp [as]
-  int64_t  sum_rfperiods_as;                // sum of all rf-periods [as] 
-  int64_t  deviation_as;                    // deviation between measured and projected timestamp [as]
-  int64_t  abs_deviation_as;                // absolute value of deviation [as]
-  int64_t  sum_deviation_as;                // sum of all deviations [as]
-  int64_t  ave_deviation_as;                // average of all deviations [as]
-  int64_t  max_deviation_as;                // maximum of all deviations [as]
-  int64_t  min_deviation_as;                // minimum of all deviations [as]
-  int64_t  subnsfit_dev_as;                 // sub-ns-fit deviation [as]
-  uint32_t window_as;                       // window given by max and min deviation
-  b2bt_t   ts_t;                            // timestamp [ps]
-  int      nGood;                           // number of good timestamps
-
-  // The idea is similar to the native sub-ns fit. As the main difference, the fractional part is 
-  // not calculated by the _two_ extremes only, but by using the average of _all_ samples.
-  // The algorithm is as follows
-  // - always start from the 1st 'good' timestamp (which is the tStamp[1], tStamp[0] might be bad)
-  // - for tStamp[i], add (i-1)*rf-period to the first timestamp and calc the difference to tStamp[i]
-  // - average all the differences -> one obtains the mean value of all differences
-  // - use the mean values as fractional part and add this to the value of tStamp[1]
-  // Be aware: timestamps are sorted, but maybe incomplete. The algorithm stops at the first missing timestamp.
-
-  if (TH1_as==0)    return B2B_STATUS_PHASEFAILED; // rf period must be known
-  if (nSamples < 3) return B2B_STATUS_PHASEFAILED; // need at least three measurements
-
-  // init stuff
-  tFirst_ns = tStamp[1];              // don't use 1st timestamp tStamp[0]: start with 2nd timestamp tStamp[1]
-  sum_deviation_as = 0;
-  sum_rfperiods_as = 0;
-  nGood            = 0;
-  max_deviation_as = 0;
-  min_deviation_as = 0;
-
-  // calc sum deviation of all timestamps
-  for (i=1; i<nSamples; i++) {        // include 1st timestamp too (important for little statistics)
-    // for (i=1; i<27; i++) {  // HACK     // include 1st timestamp too (important for little statistics)
-    
-    // this multiplication is expensive
-    diff_stamp_as = (tStamp[i] - tFirst_ns) * one_ns_as;
-
-    // we use ther number of iterations as the number of rf-periods; thus, the algorithm will
-    // stop at the first missing timestamp
-    deviation_as  = diff_stamp_as - sum_rfperiods_as;
-
-    if (deviation_as < 0) abs_deviation_as = -deviation_as;
-    else                  abs_deviation_as =  deviation_as;
-    // do a simple consistency check - don't accept differences larger than max_diff
-    if (abs_deviation_as < max_diff_as) {
-      sum_deviation_as += deviation_as;
-      nGood++;
-      // simple statistics
-      if (deviation_as > max_deviation_as) max_deviation_as = deviation_as;
-      if (deviation_as < min_deviation_as) min_deviation_as = deviation_as;
-    } // if abs_deviation in range
-
-    // increment rf period for next iteration
-    sum_rfperiods_as += TH1_as;
-  } // for i
-
-  // if result invalid, return with error
-  if (nGood < 1) {
-    (*phase_t).ns  = 0x7fffffffffffffff;
-    (*phase_t).ps  = 0x7fffffff;
-    (*phase_t).dps = 0x7fffffff;
-    return B2B_STATUS_PHASEFAILED;
-  } // if nGood < 1
-
-  // calculate average and max-min window
-  ave_deviation_as = sum_deviation_as / nGood;
-  subnsfit_dev_as  = (max_deviation_as + min_deviation_as) >> 1; 
-  window_as        = (uint32_t)(max_deviation_as - min_deviation_as);
-  // calculate a phasmax_deviation_as + me value and convert to ps
-  ts_t.ns          = tFirst_ns;
-  if (B2B_FW_USESUBNSFIT) ts_t.ps = subnsfit_dev_as  / 1000000;  // sub-ns fit
-  else                    ts_t.ps = ave_deviation_as / 1000000;  // average fit
-  ts_t.dps         = window_as >> 20;                // cheap division by 1000000
-  *phase_t         = fwlib_cleanB2bt(ts_t);
-
-  //pp_printf("nSamples %d, nGood %d, correction [ps] %d, dt [ps] %d\n", nSamples, nGood, ts_t.ps, ts_t.dps);
-  return COMMON_STATUS_OK;
-} //phaseFitSubNs
-
-
-// 'fit' phase value
-// this takes about 38/54/72/115us per 11/31/51/101 samples
-uint32_t phaseFit(uint64_t period_as, uint32_t nSamples, b2bt_t *phase_t)
-{
-  int      i;
-  int      usedIdx;         // index of used timestamp
-  int32_t  diff;            // difference of two neighboring timestamps [ns]
-  int32_t  delta;           // difference from expected period [ns]
-  int32_t  dt;              // helper variable
-  int32_t  periodNs;        // period [ns]
-  uint32_t maxDelta;        // max deviation of measured period [ns]
-  
-  uint64_t phaseTmp;        // intermediate value;
-  uint64_t tmp;             // helper variable
-
-  int64_t  dummy;           // value ignored
-  int32_t  status;
-
-  if (period_as == 0)         return B2B_STATUS_PHASEFAILED;           // this does not make sense
-  if (nSamples   < 3)         return B2B_STATUS_PHASEFAILED;           // have at least three samples
-
-  // select timestamp in the middle (never use the first TS)
-  usedIdx  = nSamples >> 1;                                            // this is safe as we have at least three samples
-
-  // check period
-  periodNs = (int32_t)(period_as/1000000000);                          // convert to ns chk: consider right-shift by 30 bits instead
-  maxDelta = periodNs / 10;                                            // allow 10% deviation chk: consider right-shift by 3 bits instead
-  diff     = (int32_t)(tStamp[usedIdx+1] - tStamp[usedIdx]);           // time difference of selected timestamps
-  delta    = diff % periodNs;                                          // difference is multiple of period? (missing timestamp possible)!
-  if (delta > (periodNs >> 1)) dt = periodNs - delta;
-  else                         dt = delta;
-  if (dt > maxDelta) {
-    //pp_printf("ohps,  delta %d, usedIDX %d\n", delta, usedIdx);
-    return B2B_STATUS_PHASEFAILED;
-  } // if dt
-
-  // phase fit
-  status = phaseFitAverage(period_as, nSamples, phase_t);
-  
-  //status = phaseFitSubNs(period_as, nSamples, phase_ns, phase_125ps, &dummy, confidence_as);
-  //dummy  = dummy/1000000;
-
-  // if phase fit failed: plan B
-  if (status != COMMON_STATUS_OK) {
-    (*phase_t).ns  = tStamp[usedIdx];                                  // just grab a timestamp in the middle
-    (*phase_t).ps  = 0;
-    (*phase_t).dps = 2000;                                             // conservative estimate of uncertainty
-    status         = COMMON_STATUS_OK;                                 // assume this is ok ...
-  } // if status
-
-  return status;
-} //phaseFit
-
-
 // aquires a series of timestamps from an IO; returns '0' on success
 // takes about 
 // - 4.0 us per timestamp
@@ -523,8 +365,8 @@ uint32_t doActionOperation(uint64_t *tAct,                    // actual time
       nInput = 0;
       acquireTimestamps(tStamp, nSamples, &nInput, TMeas_us, 2, B2B_ECADO_TLUINPUT3);
 
-      if (nInput > 2) insertionSort(tStamp, nInput);                  
-      if (phaseFit(TH1_as, nInput, &tH1_t) != COMMON_STATUS_OK) {
+      if (nInput > 2) phfit_insertionSort(tStamp, nInput);                  
+      if (phfit_phaseFit(tStamp, nInput, TH1_as, B2B_FW_USESUBNSFIT, &tH1_t) != COMMON_STATUS_OK) {
         if (sendEvtNo ==  B2B_ECADO_B2B_PREXT) flagPMError = B2B_ERRFLAG_PMEXT;
         else                                   flagPMError = B2B_ERRFLAG_PMINJ;
         if (nInput < 3) status = B2B_STATUS_NORF;
@@ -569,8 +411,8 @@ uint32_t doActionOperation(uint64_t *tAct,                    // actual time
 
         // find closest timestamp
         if (nInput > 2) {
-          insertionSort(tStamp, nInput);                              // need at least two timestamps
-          if (phaseFit(TH1_as, nInput, &tH1Match_t) == COMMON_STATUS_OK) {
+          phfit_insertionSort(tStamp, nInput);                              // need at least two timestamps
+          if (phfit_phaseFit(tStamp, nInput, TH1_as, B2B_FW_USESUBNSFIT, &tH1Match_t) == COMMON_STATUS_OK) {
             dtMatch_as  = (reqDeadline - tH1Match_t.ns);              // ns
             //pp_printf("match ns %4d, ps %4d, ", (int32_t)dtMatch_as, (int32_t)tH1Match_t.ps);
             dtMatch_as  = dtMatch_as * 1000 - tH1Match_t.ps;          // ps
@@ -615,8 +457,8 @@ uint32_t doActionOperation(uint64_t *tAct,                    // actual time
       //pp_printf("nInput %d \n", nInput);
       // find closest timestamp
       if (nInput > 2) {
-        insertionSort(tStamp, nInput);                                // need at least two timestamps
-        if (phaseFit(TH1_as, nInput, &tH1Phase_t) == COMMON_STATUS_OK) {
+        phfit_insertionSort(tStamp, nInput);                                // need at least two timestamps
+        if (phfit_phaseFit(tStamp, nInput, TH1_as, B2B_FW_USESUBNSFIT, &tH1Phase_t) == COMMON_STATUS_OK) {
           dtPhase_as   = (tH1Phase_t.ns - tH1_t.ns) * 1000000000;     // difference [as]
           dtPhase_as  += (tH1Phase_t.ps - tH1_t.ps) * 1000000;
           remainder   =  dtPhase_as % TH1_as;                         // remainder [as]
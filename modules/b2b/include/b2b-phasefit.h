@@ -0,0 +1,50 @@
+#ifndef _B2B_PHASEFIT_
+#define _B2B_PHASEFIT_
+
+// phase fit routines for h=1 timestamps, shared by firmware (lm32) and host tools;
+// this code must remain portable: no firmware libs, no libc beyond integer arithmetic
+
+#include <stdint.h>
+#include <common-fwlib.h>                   // b2bt_t
+
+#define PHFIT_SUBNS                 1       // fit method 'sub-ns fit': center of min/max window
+#define PHFIT_AVERAGE               0       // fit method 'average fit': mean of all deviations
+
+// sort timestamps as they might be unordered
+void phfit_insertionSort(uint64_t *stamps,  // array of timestamps [ns]
+                         int      n         // number of timestamps
+                         );
+
+// select the k-th smallest timestamp, array is partially reordered; average O(n); returns timestamp [ns]
+uint64_t phfit_select(uint64_t *stamps,     // array of timestamps [ns]
+                      int      n,           // number of timestamps
+                      int      k            // rank 0..n-1
+                      );
+
+// fit phase from sorted timestamps, the fit stops being meaningful at the first missing timestamp; returns error status
+int32_t phfit_phaseFitAverage(uint64_t *stamps,  // array of sorted timestamps [ns]
+                              uint32_t nSamples, // number of timestamps
+                              uint64_t TH1_as,   // h=1 period [as]
+                              int      method,   // PHFIT_SUBNS or PHFIT_AVERAGE
+                              b2bt_t   *phase_t, // fitted phase [ps]
+                              uint32_t *window_as// window of deviations [as]; may be NULL
+                              );
+
+// fit phase from unsorted timestamps, using the median timestamp as reference; tolerates missing timestamps; returns error status
+int32_t phfit_phaseFitMedian(uint64_t *stamps,  // array of timestamps [ns], partially reordered
+                             uint32_t nSamples, // number of timestamps
+                             uint64_t TH1_as,   // h=1 period [as]
+                             int      method,   // PHFIT_SUBNS or PHFIT_AVERAGE
+                             b2bt_t   *phase_t, // fitted phase [ps]
+                             uint32_t *window_as// window of deviations [as]; may be NULL
+                             );
+
+// check period and fit phase from sorted timestamps; falls back to the middle timestamp if the fit fails; returns error status
+uint32_t phfit_phaseFit(uint64_t *stamps,   // array of sorted timestamps [ns]
+                        uint32_t nSamples,  // number of timestamps
+                        uint64_t period_as, // h=1 period [as]
+                        int      method,    // PHFIT_SUBNS or PHFIT_AVERAGE
+                        b2bt_t   *phase_t   // fitted phase [ps]
+                        );
+
+#endif
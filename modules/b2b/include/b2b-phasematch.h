@@ -0,0 +1,24 @@
+#ifndef _B2B_PHASEMATCH_
+#define _B2B_PHASEMATCH_
+
+// phase matching of the h=1 signals of two rings, shared by firmware (lm32) and host tools;
+// this code must remain portable: no firmware libs, 64 bit integer arithmetic only
+
+#include <stdint.h>
+
+// find the h=1 edge of extraction with the best match to any h=1 edge of injection within a time window; returns error status
+// - all times are relative to a common epoch [as]
+// - the search takes O(log^2(TInj_as)) steps, independent of the length of the window
+// - of several equally good edges, the earliest is returned
+// - the window must not exceed 2^62 / TInj_as periods of extraction
+uint32_t phmatch_bestMatch(uint64_t tExt_as,     // h=1 edge of extraction [as]
+                           uint64_t TExt_as,     // h=1 period of extraction [as]
+                           uint64_t tInj_as,     // h=1 edge of injection [as]
+                           uint64_t TInj_as,     // h=1 period of injection [as]
+                           uint64_t tFirst_as,   // begin of window [as]
+                           uint64_t tLast_as,    // end of window [as]
+                           uint64_t *tMatch_as,  // best matching h=1 edge of extraction [as]
+                           int64_t  *dt_as       // deviation from closest h=1 edge of injection, extraction - injection [as]
+                           );
+
+#endif
@@ -3,7 +3,7 @@
  *
  *  created : 2020
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 20-Nov-2023
+ *  version : 18-Oct-2026
  *
  * library for b2b
  *
@@ -219,6 +219,30 @@ extern "C" {
     double   inj_monRemMax;
   } diagstat_t;
 
+  // quantities with streaming quantiles and histograms; rf frequencies are tracked as difference to the set value [Hz], all others [ns]
+  enum diagQuantity{quantExtDdsOff, quantInjDdsOff, quantPhaseOff, quantExtRfOff, quantInjRfOff, quantExtRfNue, quantInjRfNue,
+                    quantCbsFinOff, quantCbsPrrOff, quantCbsPreOff, quantCbsPriOff, quantCbsKteOff, quantCbsKtiOff, quantExtMonRem, quantInjMonRem, quantN};
+  typedef enum diagQuantity quant_t;
+
+  // histogram bins are logarithmic in |value|: B2B_HISTBINDEC bins per decade starting at 10^B2B_HISTMINEXP, separately for negative and positive
+  // values; bin B2B_HISTNBIN/2 holds |value| < 10^B2B_HISTMINEXP, the outermost bins hold all values beyond the last decade
+#define B2B_HISTMINEXP   -3                            // lowest decade
+#define B2B_HISTNDEC      9                            // number of decades
+#define B2B_HISTBINDEC    4                            // bins per decade
+#define B2B_HISTNBIN     (2 * B2B_HISTNDEC * B2B_HISTBINDEC + 1)
+
+  // data type for streaming quantiles (P-square estimates); index is quant_t
+  typedef struct {
+    double   p50[quantN];                              // median
+    double   p99[quantN];                              // 99% quantile
+    double   p999[quantN];                             // 99.9% quantile
+  } diagquant_t;
+
+  // data type for histograms; index is quant_t
+  typedef struct {
+    uint32_t bin[quantN][B2B_HISTNBIN];                // number of values per bin
+  } diaghist_t;
+
   typedef struct {
     double   nueSet;                                   // DDS set value; just a crosscheck [Hz]
     double   nueGet;                                   // DDS measured value [Hz]
@@ -240,7 +264,99 @@ extern "C" {
     double   ppsMin;                                   // min value
     double   ppsMax;                                   // max value
   } jitterChk_t;
-    
+
+  // jitter check: overlapping Allan deviation and time deviation of the PPS phase at tau = 2^i s, i = 0 .. B2B_JITTER_NTAU-1
+#define B2B_JITTER_NTAU     12                         // number of tau values
+
+  typedef struct {
+    double   tau[B2B_JITTER_NTAU];                     // averaging time [s]
+    double   adev[B2B_JITTER_NTAU];                    // overlapping Allan deviation
+    double   tdev[B2B_JITTER_NTAU];                    // time deviation [ns]
+    uint32_t nAdev[B2B_JITTER_NTAU];                   // number of terms of Allan deviation
+    uint32_t nTdev[B2B_JITTER_NTAU];                   // number of terms of time deviation
+    double   ppsMin;                                   // min value [ns]
+    uint64_t ppsMinTime;                               // deadline of min value [ns, TAI]
+    double   ppsMax;                                   // max value [ns]
+    uint64_t ppsMaxTime;                               // deadline of max value [ns, TAI]
+    uint32_t nGap;                                     // number of missing PPS; each gap restarts the deviations
+    uint32_t reserved;
+  } jitterDev_t;
+
+  // jitter check: histograms of the PPS phase, binning as B2B_HISTNBIN
+  typedef struct {
+    uint32_t dev[B2B_HISTNBIN];                        // deviation from mean value [ns]
+    uint32_t diff[B2B_HISTNBIN];                       // difference to previous PPS [ns]
+  } jitterHist_t;
+
+  // binary archive of b2b-archiver: a file header followed by fixed size records, one record per transfer
+#define B2B_ARCHIVE_MAGIC    0x62326261                // 'b2ba'
+#define B2B_ARCHIVE_VERSION  0x1                       // increment on changes of archval_t, setval_t or getval_t
+#define B2B_ARCHIVE_PNAMELEN 64                        // max length of pattern name, including terminating zero
+#define B2B_ARCHIVE_CSVLEN   4096                      // max length of a CSV line
+
+  typedef struct {
+    uint32_t magic;                                    // B2B_ARCHIVE_MAGIC
+    uint32_t version;                                  // B2B_ARCHIVE_VERSION
+    uint32_t recSize;                                  // size of one record [bytes]
+    uint32_t reserved;
+  } archhdr_t;
+
+  typedef struct {
+    uint64_t  utcSecs;                                 // time of CBS in UTC [s]
+    uint32_t  utcMsecs;                                // time of CBS in UTC, ms part
+    uint32_t  sid;                                     // SID
+    char      pName[B2B_ARCHIVE_PNAMELEN];             // pattern name
+    setval_t  setval;                                  // set values
+    getval_t  getval;                                  // get values
+    double    ext_kickLen;                             // extraction: length of kicker signal [ns]
+    double    ext_kickCompLvl;                         // extraction: comparator level of kicker signal
+    uint32_t  flagNueValid;                            // 1: rf frequency values are valid; 0: no link to analyzer
+    uint32_t  reserved;
+    double    ext_rfNueAct;                            // extraction: rf frequency [Hz]
+    double    ext_rfNueActErr;                         // extraction: uncertainty of rf frequency [Hz]
+    double    inj_rfNueAct;                            // injection : ...
+    double    inj_rfNueActErr;
+  } archval_t;
+
+  // recorded timing messages for offline replay through the ECA conditions of a host tool: a file header followed by
+  // fixed size records, one record per timing message as received from the network (actions due to offsets are not recorded)
+#define B2B_REPLAY_MAGIC     0x62326272                // 'b2br'
+#define B2B_REPLAY_VERSION   0x1                       // increment on changes of ecamsg_t
+#define B2B_REPLAY_NPENDING  256                       // max number of actions waiting for their deadline
+
+  typedef struct {
+    uint32_t magic;                                    // B2B_REPLAY_MAGIC
+    uint32_t version;                                  // B2B_REPLAY_VERSION
+    uint32_t recSize;                                  // size of one record [bytes]
+    uint32_t reserved;
+  } ecahdr_t;
+
+  typedef struct {
+    uint64_t evtId;                                    // event ID
+    uint64_t param;                                    // parameter field
+    uint64_t deadline;                                 // deadline [ns, TAI]
+    uint64_t executed;                                 // time of execution [ns, TAI]; 0: unknown
+    uint32_t flags;                                    // bit 0: late, 1: early, 2: conflict, 3: delayed
+    uint32_t tef;                                      // TEF field
+  } ecamsg_t;
+
+  // ECA condition; an action is created for each timing message with (evtId & mask) == (id & mask)
+  typedef struct {
+    uint64_t id;                                       // event ID
+    uint64_t mask;                                     // mask
+    uint64_t offset;                                   // offset of the action to the deadline [ns]
+    uint32_t tag;                                      // tag of action
+    uint32_t reserved;
+  } ecacond_t;
+
+  // state of a replay or recording; opaque
+  typedef struct b2b_replay_s b2b_replay_t;
+
+  // handler of an action during replay
+  typedef void (*b2b_replay_handler_t)(uint32_t tag,           // tag of action
+                                       const ecamsg_t *action  // action; deadline includes the offset of the condition
+                                       );
+
   // ---------------------------------
   // helper routines
   // ---------------------------------
@@ -248,6 +364,10 @@ extern "C" {
   // get host system time [ns]
   uint64_t b2b_getSysTime();
 
+  // returns the bin of a value in a logarithmic histogram, see B2B_HISTNBIN
+  int b2b_hist_bin(double val                                  // value
+                   );
+
   // convert status code to status text
   const char* b2b_status_text(uint32_t code                    // status code
                               );
@@ -277,11 +397,74 @@ extern "C" {
                  );
 
   // returns the maximum systematic deviation of the sub-ns fit [ps]
+  // closed form with a few integer divisions, no iteration; the result jumps with the sub-ns fraction
+  // of TH1 at fs resolution, thus it must not be replaced by an interpolated table
   uint32_t b2b_calc_max_sysdev_ps(uint64_t TH1_as,             // h=1 period [as]
                                   uint32_t nSamples,           // number of timestamp samples
                                   uint32_t printFlag           // 0: don't print info; >1 print info
                                   );
-  
+
+  // header line of archived data in CSV format
+  const char* b2b_archive_csvHeader();
+
+  // convert an archive record to one line in CSV format (without newline), returns length of line
+  int b2b_archive_csvLine(char      *line,                     // buffer of at least B2B_ARCHIVE_CSVLEN bytes
+                          archval_t *rec                       // archive record
+                          );
+
+  // open a file of recorded timing messages for replay, returns error code
+  uint32_t b2b_replay_open(b2b_replay_t    **replay,           // state of replay
+                           const char      *filename,          // name of file
+                           const ecacond_t *cond,              // conditions; must remain valid until the replay is closed
+                           uint32_t        nCond               // number of conditions
+                           );
+
+  // get the next action in order of deadlines, returns error code; B2BLIB_STATUS_TIMEDOUT: no more actions
+  uint32_t b2b_replay_next(b2b_replay_t *replay,               // state of replay
+                           uint32_t     *tag,                  // tag of action
+                           ecamsg_t     *action                // action
+                           );
+
+  // replay all actions of a file at maximum speed and print throughput and latency of the handler, returns error code
+  uint32_t b2b_replay_run(const char           *filename,      // name of file
+                          const ecacond_t      *cond,          // conditions
+                          uint32_t             nCond,          // number of conditions
+                          b2b_replay_handler_t handler         // handler, called for each action
+                          );
+
+  // create a file for recording timing messages, returns error code
+  uint32_t b2b_record_open(b2b_replay_t **record,              // state of recording
+                           const char   *filename              // name of file
+                           );
+
+  // record one timing message, returns error code
+  uint32_t b2b_record_write(b2b_replay_t   *record,            // state of recording
+                            const ecamsg_t *msg                // timing message
+                            );
+
+  // close replay or recording
+  void b2b_replay_close(b2b_replay_t *replay                   // state of replay or recording
+                        );
+
+  // text screen with delta rendering: a frame is built line by line, and only lines that differ from what is on the
+  // terminal are written, addressed by cursor position; as the terminal is shared, there is only one screen per process
+#define B2B_SCREEN_NLINE    64                         // max number of lines
+#define B2B_SCREEN_WIDTH    1024                       // max length of a line, including escape sequences
+
+  // forget what is on the terminal; the next frame is written completely; use after clearing the terminal or printing to it directly
+  void b2b_screen_invalidate();
+
+  // set one line of the next frame; lines not set for a frame are erased
+  void b2b_screen_line(uint32_t   line,                        // line number, 1 .. B2B_SCREEN_NLINE
+                       const char *text                        // text of line, without newline
+                       );
+
+  // write the changed lines of the frame to stdout and start a new frame, returns error code
+  uint32_t b2b_screen_flush(uint32_t *nLine,                   // number of lines written
+                            uint32_t *nByte,                   // number of bytes written
+                            int      flagPrint                 // 0: don't write (for benchmarks), just count
+                            );
+
   // ---------------------------------
   // communication with lm32 firmware
   // ---------------------------------
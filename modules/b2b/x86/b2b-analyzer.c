@@ -3,7 +3,7 @@
  *
  *  created : 2021
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 18-Oct-2023
+ *  version : 18-Oct-2026
  *
  * analyzes and publishes get values
  * 
@@ -36,7 +36,7 @@
  * For all questions and ideas contact: d.beck@gsi.de
  * Last update: 15-April-2019
  *********************************************************************************************/
-#define B2B_ANALYZER_VERSION 0x000702
+#define B2B_ANALYZER_VERSION 0x000800
 
 // standard includes 
 #include <unistd.h> // getopt
@@ -79,6 +79,8 @@ setval_t   dicSetval[B2B_NSID];
 getval_t   dicGetval[B2B_NSID];
 diagval_t  disDiagval[B2B_NSID];
 diagstat_t disDiagstat[B2B_NSID];
+diagquant_t disDiagquant[B2B_NSID];
+diaghist_t disDiaghist[B2B_NSID];
 
 
 uint32_t   disVersionId      = 0;
@@ -90,10 +92,33 @@ uint32_t   dicSetvalId[B2B_NSID];
 uint32_t   dicGetvalId[B2B_NSID];
 uint32_t   disDiagvalId[B2B_NSID];
 uint32_t   disDiagstatId[B2B_NSID];
+uint32_t   disDiagquantId[B2B_NSID];
+uint32_t   disDiaghistId[B2B_NSID];
 uint32_t   disClearDiagId;
 
 int        flagSetValid[B2B_NSID];
 int        flagGetValid[B2B_NSID];
+int        flagOffline;                     // analyzer is fed from an archive file, no DIM
+
+// streaming quantile, P-square algorithm; see R. Jain, I. Chlamtac, Comm. ACM 28 (1985) 1076
+typedef struct {
+  double    p;                              // quantile
+  uint32_t  n;                              // number of values
+  double    q[5];                           // marker heights
+  double    pos[5];                         // actual marker positions
+  double    des[5];                         // desired marker positions
+} p2quant_t;
+
+// streaming statistics of a quantity
+typedef struct {
+  p2quant_t p50;
+  p2quant_t p99;
+  p2quant_t p999;
+} quantStat_t;
+
+quantStat_t quantStat[B2B_NSID][quantN];
+const char  *quantName[quantN] = {"ext_ddsOff", "inj_ddsOff", "phaseOff", "ext_rfOff", "inj_rfOff", "ext_rfNueDiff", "inj_rfNueDiff",
+                                  "cbs_finOff", "cbs_prrOff", "cbs_preOff", "cbs_priOff", "cbs_kteOff", "cbs_ktiOff", "ext_monRem", "inj_monRem"};
 
 // extraction DDS match
 uint32_t  ext_ddsOffN[B2B_NSID];
@@ -202,15 +227,116 @@ static void help(void) {
   fprintf(stderr, "\n");
   fprintf(stderr, "  -h                  display this help and exit\n");
   fprintf(stderr, "  -e                  display version\n");
+  fprintf(stderr, "  -f<file>            offline: analyze records of a b2b-archiver file instead of DIM services, print statistics\n");
   fprintf(stderr, "\n");
   fprintf(stderr, "Use this tool to analyze and display get values of the B2B system\n");
   fprintf(stderr, "Example1: '%s pro_sis18'\n", program);
+  fprintf(stderr, "Example2: '%s -f test_b2b_pro_sis18.b2ba'\n", program);
   fprintf(stderr, "\n");
   fprintf(stderr, "Report software bugs to <d.beck@gsi.de>\n");
   fprintf(stderr, "Version %s. Licensed under the LGPL v3.\n", b2b_version_text(B2B_ANALYZER_VERSION));
 } //help
 
 
+// clears a streaming quantile
+void p2Clear(p2quant_t *s, double p)
+{
+  memset(s, 0, sizeof(p2quant_t));
+  s->p = p;
+} // p2Clear
+
+
+// adds a value to a streaming quantile; O(1)
+void p2Add(p2quant_t *s, double val)
+{
+  double dDes[5];
+  double d, qNew;
+  double tmp;
+  int    i, j, k, ds;
+
+  // first five values: keep them sorted
+  if (s->n < 5) {
+    for (i = s->n; (i > 0) && (s->q[i-1] > val); i--) s->q[i] = s->q[i-1];
+    s->q[i] = val;
+    s->n++;
+    if (s->n == 5) {
+      for (j=0; j<5; j++) s->pos[j] = j + 1;
+      s->des[0] = 1; s->des[1] = 1 + 2 * s->p; s->des[2] = 1 + 4 * s->p; s->des[3] = 3 + 2 * s->p; s->des[4] = 5;
+    } // if n
+    return;
+  } // if n < 5
+
+  // cell of new value
+  if      (val < s->q[0])  {s->q[0] = val; k = 0;}
+  else if (val >= s->q[4]) {s->q[4] = val; k = 3;}
+  else for (k=0; k<3; k++) if (val < s->q[k+1]) break;
+
+  dDes[0] = 0; dDes[1] = s->p / 2; dDes[2] = s->p; dDes[3] = (1 + s->p) / 2; dDes[4] = 1;
+  for (i=k+1; i<5; i++) s->pos[i]++;
+  for (i=0; i<5; i++)   s->des[i] += dDes[i];
+  s->n++;
+
+  // adjust inner markers
+  for (i=1; i<4; i++) {
+    d = s->des[i] - s->pos[i];
+    if (((d >= 1) && (s->pos[i+1] - s->pos[i] > 1)) || ((d <= -1) && (s->pos[i-1] - s->pos[i] < -1))) {
+      ds   = (d > 0) ? 1 : -1;
+      // parabolic prediction
+      tmp  = (s->pos[i] - s->pos[i-1] + ds) * (s->q[i+1] - s->q[i]) / (s->pos[i+1] - s->pos[i]);
+      tmp += (s->pos[i+1] - s->pos[i] - ds) * (s->q[i] - s->q[i-1]) / (s->pos[i] - s->pos[i-1]);
+      qNew = s->q[i] + ds * tmp / (s->pos[i+1] - s->pos[i-1]);
+      // linear prediction, if parabolic prediction is out of order
+      if ((qNew <= s->q[i-1]) || (qNew >= s->q[i+1])) qNew = s->q[i] + ds * (s->q[i+ds] - s->q[i]) / (s->pos[i+ds] - s->pos[i]);
+      s->q[i]    = qNew;
+      s->pos[i] += ds;
+    } // if d
+  } // for i
+} // p2Add
+
+
+// returns the estimate of a streaming quantile
+double p2Get(p2quant_t *s)
+{
+  if (s->n == 0) return NAN;
+  if (s->n < 5)  return s->q[(int)(s->p * (s->n - 1) + 0.5)];
+  return s->q[2];
+} // p2Get
+
+
+// clears streaming quantiles and histograms
+void clearQuant(uint32_t sid)
+{
+  int i;
+
+  for (i=0; i<quantN; i++) {
+    p2Clear(&(quantStat[sid][i].p50),  0.5);
+    p2Clear(&(quantStat[sid][i].p99),  0.99);
+    p2Clear(&(quantStat[sid][i].p999), 0.999);
+    disDiagquant[sid].p50[i]  = NAN;
+    disDiagquant[sid].p99[i]  = NAN;
+    disDiagquant[sid].p999[i] = NAN;
+  } // for i
+  memset(&(disDiaghist[sid]), 0, sizeof(diaghist_t));
+} // clearQuant
+
+
+// adds a value to streaming quantiles and histogram
+void addQuant(uint32_t sid, quant_t quant, double val)
+{
+  quantStat_t *stat = &(quantStat[sid][quant]);
+
+  if (isnan(val)) return;
+
+  p2Add(&(stat->p50),  val);
+  p2Add(&(stat->p99),  val);
+  p2Add(&(stat->p999), val);
+  disDiagquant[sid].p50[quant]  = p2Get(&(stat->p50));
+  disDiagquant[sid].p99[quant]  = p2Get(&(stat->p99));
+  disDiagquant[sid].p999[quant] = p2Get(&(stat->p999));
+  disDiaghist[sid].bin[quant][b2b_hist_bin(val)]++;
+} // addQuant
+
+
 // clears diag data
 void clearStats(uint32_t sid)
 {
@@ -301,6 +427,8 @@ void clearStats(uint32_t sid)
   inj_monRemMin[sid]       = FLTMAX;
   inj_monRemAveOld[sid]    = 0;   
   inj_monRemStreamOld[sid] = 0;
+
+  clearQuant(sid);
 } // clearDiagData
 
 
@@ -418,10 +546,9 @@ void cmdClearDiag(long *tag, uint32_t *address, int *size)
 } // cmdClearDiag
 
 
-// receive set values
-void recGetvalue(long *tag, diagval_t *address, int *size)
+// analyze get values of a transfer
+void analyzeGetvalue(uint32_t sid)
 {
-  uint32_t  sid;
   uint32_t  mode;
   double    cor;
   double    act;
@@ -434,11 +561,6 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
   double    tmp;
   uint64_t  tmp64;
 
-  sid = *tag;
-  if ((sid < 0) || (sid >= B2B_NSID)) return;
-  if (!flagSetValid[sid])             return;
-  flagGetValid[sid] = (*size != sizeof(uint32_t));
-
   mode = dicSetval[sid].mode;
 
   disDiagstat[sid].cbs_preOffAct  = NAN;
@@ -475,6 +597,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       //printf("ave %7.3f, sdev %7.3f\n", aveNew, sdev);
       cbs_preOffAveOld[sid]          = aveNew;
       cbs_preOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantCbsPreOff, act);
       if (act < cbs_preOffMin[sid]) cbs_preOffMin[sid] = act;
       if (act > cbs_preOffMax[sid]) cbs_preOffMax[sid] = act;
 
@@ -497,6 +620,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, ext_rfOffAveOld[sid], &streamNew, ext_rfOffStreamOld[sid], act, n , &dummy, &sdev);
       ext_rfOffAveOld[sid]           = aveNew;
       ext_rfOffStreamOld[sid]        = streamNew;
+      addQuant(sid, quantExtRfOff, act);
       if (act < ext_rfOffMin[sid]) ext_rfOffMin[sid] = act;
       if (act > ext_rfOffMax[sid]) ext_rfOffMax[sid] = act;
       
@@ -520,6 +644,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, ext_rfNueAveOld[sid], &streamNew, ext_rfNueStreamOld[sid], act, n ,&dummy , &sdev);
       ext_rfNueAveOld[sid]           = aveNew;
       ext_rfNueStreamOld[sid]        = streamNew;
+      addQuant(sid, quantExtRfNue, act - tmp);
       
       // copy
       disDiagval[sid].ext_rfNueAct   = act;
@@ -544,6 +669,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, cbs_finOffAveOld[sid], &streamNew, cbs_finOffStreamOld[sid], act, n , &dummy, &sdev);
       cbs_finOffAveOld[sid]          = aveNew;
       cbs_finOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantCbsFinOff, act);
       if (act < cbs_finOffMin[sid]) cbs_finOffMin[sid] = act;
       if (act > cbs_finOffMax[sid]) cbs_finOffMax[sid] = act;
       
@@ -566,6 +692,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, cbs_prrOffAveOld[sid], &streamNew, cbs_prrOffStreamOld[sid], act, n , &dummy, &sdev);
       cbs_prrOffAveOld[sid]          = aveNew;
       cbs_prrOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantCbsPrrOff, act);
       if (act < cbs_prrOffMin[sid]) cbs_prrOffMin[sid] = act;
       if (act > cbs_prrOffMax[sid]) cbs_prrOffMax[sid] = act;
 
@@ -587,6 +714,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, cbs_kteOffAveOld[sid], &streamNew, cbs_kteOffStreamOld[sid], act, n , &dummy, &sdev);
       cbs_kteOffAveOld[sid]          = aveNew;
       cbs_kteOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantCbsKteOff, act);
       if (act < cbs_kteOffMin[sid]) cbs_kteOffMin[sid] = act;
       if (act > cbs_kteOffMax[sid]) cbs_kteOffMax[sid] = act;
       
@@ -610,6 +738,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, ext_monRemAveOld[sid], &streamNew, ext_monRemStreamOld[sid], act, n , &dummy, &sdev);
       ext_monRemAveOld[sid]          = aveNew;
       ext_monRemStreamOld[sid]       = streamNew;
+      addQuant(sid, quantExtMonRem, act);
       if (act < ext_monRemMin[sid]) ext_monRemMin[sid] = act;
       if (act > ext_monRemMax[sid]) ext_monRemMax[sid] = act;
       
@@ -638,6 +767,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       //printf("ave %7.3f, sdev %7.3f\n", aveNew, sdev);
       ext_ddsOffAveOld[sid]          = aveNew;
       ext_ddsOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantExtDdsOff, act);
       if (act < ext_ddsOffMin[sid]) ext_ddsOffMin[sid] = act;
       if (act > ext_ddsOffMax[sid]) ext_ddsOffMax[sid] = act;
       
@@ -662,6 +792,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, cbs_ktiOffAveOld[sid], &streamNew, cbs_ktiOffStreamOld[sid], act, n , &dummy, &sdev);
       cbs_ktiOffAveOld[sid]          = aveNew;
       cbs_ktiOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantCbsKtiOff, act);
       if (act < cbs_ktiOffMin[sid]) cbs_ktiOffMin[sid] = act;
       if (act > cbs_ktiOffMax[sid]) cbs_ktiOffMax[sid] = act;
       
@@ -685,6 +816,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, inj_monRemAveOld[sid], &streamNew, inj_monRemStreamOld[sid], act, n , &dummy, &sdev);
       inj_monRemAveOld[sid]          = aveNew;
       inj_monRemStreamOld[sid]       = streamNew;
+      addQuant(sid, quantInjMonRem, act);
       if (act < inj_monRemMin[sid]) inj_monRemMin[sid] = act;
       if (act > inj_monRemMax[sid]) inj_monRemMax[sid] = act;
       
@@ -707,6 +839,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, inj_rfOffAveOld[sid], &streamNew, inj_rfOffStreamOld[sid], act, n , &dummy, &sdev);
       inj_rfOffAveOld[sid]           = aveNew;
       inj_rfOffStreamOld[sid]        = streamNew;
+      addQuant(sid, quantInjRfOff, act);
       if (act < inj_rfOffMin[sid]) inj_rfOffMin[sid] = act;
       if (act > inj_rfOffMax[sid]) inj_rfOffMax[sid] = act;
       
@@ -729,6 +862,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, inj_rfNueAveOld[sid], &streamNew, inj_rfNueStreamOld[sid], act, n ,&dummy , &sdev);
       inj_rfNueAveOld[sid]           = aveNew;
       inj_rfNueStreamOld[sid]        = streamNew;
+      addQuant(sid, quantInjRfNue, act - tmp);
       
       // copy
       disDiagval[sid].inj_rfNueAct   = act;
@@ -749,6 +883,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, cbs_priOffAveOld[sid], &streamNew, cbs_priOffStreamOld[sid], act, n , &dummy, &sdev);
       cbs_priOffAveOld[sid]          = aveNew;
       cbs_priOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantCbsPriOff, act);
       if (act < cbs_priOffMin[sid]) cbs_priOffMin[sid] = act;
       if (act > cbs_priOffMax[sid]) cbs_priOffMax[sid] = act;
       
@@ -778,6 +913,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, inj_ddsOffAveOld[sid], &streamNew, inj_ddsOffStreamOld[sid], act, n , &dummy, &sdev);
       inj_ddsOffAveOld[sid]          = aveNew;
       inj_ddsOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantInjDdsOff, act);
       if (act < inj_ddsOffMin[sid]) inj_ddsOffMin[sid] = act;
       if (act > inj_ddsOffMax[sid]) inj_ddsOffMax[sid] = act;
       
@@ -799,6 +935,7 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
       calcStats(&aveNew, phaseOffAveOld[sid], &streamNew, phaseOffStreamOld[sid], act, n , &dummy, &sdev);
       phaseOffAveOld[sid]          = aveNew;
       phaseOffStreamOld[sid]       = streamNew;
+      addQuant(sid, quantPhaseOff, act);
       if (act < phaseOffMin[sid]) phaseOffMin[sid] = act;
       if (act > phaseOffMax[sid]) phaseOffMax[sid] = act;
       
@@ -812,9 +949,25 @@ void recGetvalue(long *tag, diagval_t *address, int *size)
     } // if isnan
 
   } // if mode B2B_MODE_B2B
-  
+} // analyzeGetvalue
+
+
+// receive get values
+void recGetvalue(long *tag, getval_t *address, int *size)
+{
+  uint32_t  sid;
+
+  sid = *tag;
+  if ((sid < 0) || (sid >= B2B_NSID)) return;
+  if (!flagSetValid[sid])             return;
+  flagGetValid[sid] = (*size != sizeof(uint32_t));
+
+  analyzeGetvalue(sid);
+
   dis_update_service(disDiagvalId[sid]);
   dis_update_service(disDiagstatId[sid]);
+  dis_update_service(disDiagquantId[sid]);
+  dis_update_service(disDiaghistId[sid]);
   dis_update_service(disNTransferId);
 } // recGetvalue
   
@@ -830,6 +983,58 @@ void recSetvalue(long *tag, setval_t *address, int *size)
 } // recSetValue
   
 
+// offline: analyze all records of an archive file and print statistics; returns 0 on success
+int analyzeFile(const char *name)
+{
+  FILE      *in;
+  archhdr_t hdr;
+  archval_t rec;
+  uint32_t  nRec = 0;
+  uint32_t  sid;
+  uint64_t  t0, t1;
+  p2quant_t *stat;
+  int       i;
+
+  if (!(in = fopen(name, "rb"))) {
+    fprintf(stderr, "%s: can't open file %s\n", program, name);
+    return 1;
+  } // if !in
+  if ((fread(&hdr, sizeof(hdr), 1, in) != 1) || (hdr.magic != B2B_ARCHIVE_MAGIC) || (hdr.version != B2B_ARCHIVE_VERSION) || (hdr.recSize != sizeof(archval_t))) {
+    fprintf(stderr, "%s: %s is not a b2b archive file of version %u\n", program, name, B2B_ARCHIVE_VERSION);
+    fclose(in);
+    return 1;
+  } // if fread
+
+  t0 = b2b_getSysTime();
+  while (fread(&rec, sizeof(rec), 1, in) == 1) {
+    sid = rec.sid;
+    if (sid >= B2B_NSID) continue;
+    dicSetval[sid]    = rec.setval;
+    dicGetval[sid]    = rec.getval;
+    flagSetValid[sid] = 1;
+    flagGetValid[sid] = 1;
+    analyzeGetvalue(sid);
+    nRec++;
+  } // while fread
+  t1 = b2b_getSysTime();
+  fclose(in);
+
+  printf("%s: analyzed %u records in %.3f ms, %.3f us per record\n", program, nRec, (double)(t1 - t0) / 1000000.0, nRec ? (double)(t1 - t0) / 1000.0 / (double)nRec : 0.0);
+  printf("sid; quantity; n; min; p50; p99; p99.9; max\n");
+  for (sid=0; sid<B2B_NSID; sid++) {
+    for (i=0; i<quantN; i++) {
+      stat = &(quantStat[sid][i].p50);
+      if (stat->n == 0) continue;
+      // outer markers of P-square are min and max
+      printf("%2u; %-13s; %6u; %13.3f; %13.3f; %13.3f; %13.3f; %13.3f\n", sid, quantName[i], stat->n, stat->q[0],
+             disDiagquant[sid].p50[i], disDiagquant[sid].p99[i], disDiagquant[sid].p999[i], stat->q[(stat->n < 5) ? stat->n - 1 : 4]);
+    } // for i
+  } // for sid
+
+  return 0;
+} // analyzeFile
+
+
 // add all dim services
 void dicSubscribeServices(char *prefix)
 {
@@ -880,6 +1085,12 @@ void disAddServices(char *prefix)
     sprintf(name, "%s-cal_stat_sid%02d", prefix, i);
     disDiagstatId[i] = dis_add_service(name, "D:1;I:1;D:5;I:1;D:5;I:1;D:5;I:1;D:5;I:1;D:5;I:1;D:5;I:1;D:5;I:1;D:4", &(disDiagstat[i]), sizeof(diagstat_t), 0 , 0);
 
+    sprintf(name, "%s-cal_quant_sid%02d", prefix, i);
+    disDiagquantId[i] = dis_add_service(name, "D:45", &(disDiagquant[i]), sizeof(diagquant_t), 0 , 0);
+
+    sprintf(name, "%s-cal_hist_sid%02d", prefix, i);
+    disDiaghistId[i] = dis_add_service(name, "I:1095", &(disDiaghist[i]), sizeof(diaghist_t), 0 , 0);
+
     sprintf(name, "%s-cal_cmd_cleardiag", prefix);
     disClearDiagId   = dis_add_cmnd(name, "I:1", cmdClearDiag, 0);
   } // for i
@@ -892,6 +1103,7 @@ int main(int argc, char** argv) {
 
   int      getVersion;
   int      subscribe;
+  char     *fileName = NULL;                // archive file for offline analysis
 
 
   char     prefix[132];
@@ -903,11 +1115,16 @@ int main(int argc, char** argv) {
   getVersion    = 0;
   subscribe     = 1;
 
-  while ((opt = getopt(argc, argv, "s:eh")) != -1) {
+  while ((opt = getopt(argc, argv, "s:f:eh")) != -1) {
     switch (opt) {
       case 'e':
         getVersion = 1;
         break;
+      case 'f':
+        flagOffline = 1;
+        subscribe   = 0;
+        fileName    = optarg;
+        break;
       case 'h':
         help();
         return 0;
@@ -946,6 +1163,11 @@ int main(int argc, char** argv) {
     
     while (1) sleep(1);
   } // if subscribe
+
+  if (flagOffline) {
+    for (i=0; i<B2B_NSID; i++) clearStats(i);
+    exitCode = analyzeFile(fileName);
+  } // if flagOffline
   
   return exitCode;
 }
@@ -0,0 +1,180 @@
+/*******************************************************************************************
+ *  b2b-archive2csv.c
+ *
+ *  created : 2026
+ *  author  : Dietrich Beck, GSI-Darmstadt
+ *  version : 18-Oct-2026
+ *
+ * converts binary data files of b2b-archiver to CSV
+ *
+ * ------------------------------------------------------------------------------------------
+ * License Agreement for this software:
+ *
+ * Copyright (C) 2013  Dietrich Beck
+ * GSI Helmholtzzentrum für Schwerionenforschung GmbH
+ * Planckstraße 1
+ * D-64291 Darmstadt
+ * Germany
+ *
+ * Contact: d.beck@gsi.de
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * For all questions and ideas contact: d.beck@gsi.de
+ * Last update: 15-April-2019
+ *********************************************************************************************/
+#define B2B_ARCHIVE2CSV_VERSION 0x000800
+
+// standard includes 
+#include <unistd.h> // getopt
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// b2b
+#include <common-lib.h>                    // COMMON
+#include <b2blib.h>                        // API
+#include <b2b.h>                           // FW
+
+#define    NREC        256                 // number of records read at once
+
+const char* program;
+
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION] <FILE> [FILE ...]\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -h                  display this help and exit\n");
+  fprintf(stderr, "  -e                  display version\n");
+  fprintf(stderr, "  -s<sid>             convert only records of <sid>\n");
+  fprintf(stderr, "  -o<file>            write to <file> instead of stdout\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Use this tool to convert data files of b2b-archiver to CSV. Files are converted in the given order,\n");
+  fprintf(stderr, "the CSV header is written once.\n");
+  fprintf(stderr, "Example1: '%s -s3 test_b2b_pro_sis18.b2ba > test_b2b_pro_sis18_sid03.dat'\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report software bugs to <d.beck@gsi.de>\n");
+  fprintf(stderr, "Version %s. Licensed under the LGPL v3.\n", b2b_version_text(B2B_ARCHIVE2CSV_VERSION));
+} //help
+
+
+// convert one archive file; returns 0 on success
+int convertFile(const char *name, FILE *out, int sid)
+{
+  FILE      *in;
+  archhdr_t hdr;
+  archval_t rec[NREC];
+  char      line[B2B_ARCHIVE_CSVLEN];
+  size_t    nRec;
+  size_t    i;
+
+  if (!(in = fopen(name, "rb"))) {
+    fprintf(stderr, "%s: can't open file %s\n", program, name);
+    return 1;
+  } // if !in
+
+  if ((fread(&hdr, sizeof(hdr), 1, in) != 1) || (hdr.magic != B2B_ARCHIVE_MAGIC)) {
+    fprintf(stderr, "%s: %s is not a b2b archive file\n", program, name);
+    fclose(in);
+    return 1;
+  } // if fread
+  if ((hdr.version != B2B_ARCHIVE_VERSION) || (hdr.recSize != sizeof(archval_t))) {
+    fprintf(stderr, "%s: %s has archive version %u, record size %u; expected version %u, record size %u\n", program, name,
+            hdr.version, hdr.recSize, B2B_ARCHIVE_VERSION, (uint32_t)sizeof(archval_t));
+    fclose(in);
+    return 1;
+  } // if version
+
+  while ((nRec = fread(rec, sizeof(archval_t), NREC, in)) > 0) {
+    for (i=0; i<nRec; i++) {
+      if ((sid >= 0) && (rec[i].sid != sid)) continue;
+      b2b_archive_csvLine(line, &(rec[i]));
+      fprintf(out, "%s\n", line);
+    } // for i
+  } // while nRec
+
+  fclose(in);
+  return 0;
+} // convertFile
+
+
+int main(int argc, char** argv) {
+  int opt, error = 0;
+  int exitCode   = 0;
+  char *tmp;
+
+  int      getVersion;
+  int      sid;                             // SID, -1: all
+  FILE     *out;                            // output
+  char     *outName;                        // name of output file
+
+  program       = argv[0];
+  getVersion    = 0;
+  sid           = -1;
+  outName       = NULL;
+
+  while ((opt = getopt(argc, argv, "s:o:eh")) != -1) {
+    switch (opt) {
+      case 'e':
+        getVersion = 1;
+        break;
+      case 'h':
+        help();
+        return 0;
+        error = 1;
+        break;
+      case 's' :
+        sid = strtol(optarg, &tmp, 0);
+        if ((*tmp) || (sid < 0) || (sid >= B2B_NSID)) {
+          fprintf(stderr, "Specify a proper SID, not '%s'!\n", optarg);
+          exit(1);
+        } // if *tmp
+        break;
+      case 'o' :
+        outName = optarg;
+        break;
+      default:
+        fprintf(stderr, "%s: bad getopt result\n", program);
+        return 1;
+    } // switch opt
+  } //  while opt
+
+  if (error) {
+    help();
+    return 1;
+  } // if error
+
+  if (getVersion) printf("%s: version %s\n", program, b2b_version_text(B2B_ARCHIVE2CSV_VERSION));
+
+  if (optind >= argc) {
+    if (!getVersion) fprintf(stderr, "%s: missing non optional argument <file>\n", program);
+    return getVersion ? 0 : 1;
+  } // if optind
+
+  if (outName) {
+    if (!(out = fopen(outName, "w"))) {
+      fprintf(stderr, "%s: can't open file %s\n", program, outName);
+      exit(1);
+    } // if !out
+  } // if outName
+  else out = stdout;
+
+  fprintf(out, "%s\n", b2b_archive_csvHeader());
+  for (; optind < argc; optind++) if (convertFile(argv[optind], out, sid)) exitCode = 1;
+
+  if (outName) fclose(out);
+
+  return exitCode;
+}
@@ -3,9 +3,9 @@
  *
  *  created : 2021
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 19-Jan-2024
+ *  version : 18-Oct-2026
  *
- * archives set and get values to data files
+ * archives set and get values to binary data files; use b2b-archive2csv for conversion to CSV
  *
  * ------------------------------------------------------------------------------------------
  * License Agreement for this software:
@@ -34,7 +34,7 @@
  * For all questions and ideas contact: d.beck@gsi.de
  * Last update: 15-April-2019
  *********************************************************************************************/
-#define B2B_ARCHIVER_VERSION 0x000703
+#define B2B_ARCHIVER_VERSION 0x000800
 
 // standard includes 
 #include <unistd.h> // getopt
@@ -44,6 +44,10 @@
 #include <stdint.h>
 #include <math.h>
 #include <time.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 // dim
 #include <dic.h>
@@ -64,7 +68,6 @@ uint32_t   no_link_32    = 0xdeadbeef;
 uint64_t   no_link_64    = 0xdeadbeefce420651;
 double     no_link_dbl   = NAN;
 char       no_link_str[] = "NO_LINK";
-char       nan_str[]     = "nan";
 
 setval_t   dicSetval[B2B_NSID]; 
 getval_t   dicGetval[B2B_NSID];
@@ -87,7 +90,31 @@ int        flagGetValid[B2B_NSID];          // flag: received get value
 time_t     utc_secs[B2B_NSID];              // time of CBS in UTC
 uint32_t   utc_msecs[B2B_NSID];             // time of CBS in UTC
 
-char       filename[B2B_NSID][DIMMAXSIZE];  // file names
+char       filename[DIMMAXSIZE];            // name of archive file
+int        dataFd = -1;                     // archive file
+uint64_t   fileSize;                        // size of archive file [bytes]
+uint64_t   maxFileSize;                     // archive file is rotated when reaching this size [bytes]; 0: no rotation
+
+// queue from DIM callback (single producer) to writer thread (single consumer); indices are free running
+#define    QUEUELEN    1024                 // max number of pending records, power of 2
+#define    BUFLEN      256                  // max number of records written at once
+#define    NUEDELAY    100000000            // wait for the analyzer to publish frequency values [ns]
+#define    FLUSHDELAY  1000000000           // max time a record stays in the write buffer [ns]
+
+typedef struct {
+  uint64_t   tEnq;                          // time when record was queued [ns]
+  archval_t  rec;                           // record
+} qelem_t;
+
+qelem_t    queue[QUEUELEN];
+uint32_t   queueHead;                       // written by producer only
+uint32_t   queueTail;                       // written by consumer only
+uint32_t   nDropped;                        // number of records dropped due to a full queue
+
+// DIM writes dicDiagval from its own thread; the writer thread only reads this copy taken in the callback
+diagval_t       diagSnap[B2B_NSID];         // copy of frequency values
+int             flagDiagValid[B2B_NSID];    // flag: copy holds valid frequency values
+pthread_mutex_t diagLock = PTHREAD_MUTEX_INITIALIZER;
 
 
 static void help(void) {
@@ -96,9 +123,12 @@ static void help(void) {
   fprintf(stderr, "  -h                  display this help and exit\n");
   fprintf(stderr, "  -e                  display version\n");
   fprintf(stderr, "  -f<fprefix>         sets a prefix for the file names\n");
-  fprintf(stderr, "  -n                  create new files, erases existing files\n");
+  fprintf(stderr, "  -n                  create new file, erases existing file\n");
+  fprintf(stderr, "  -r<size>            rotate file when reaching <size> MiB, default 64, 0: no rotation\n");
   fprintf(stderr, "\n");
-  fprintf(stderr, "Use this tool to archive data of the B2B system\n");
+  fprintf(stderr, "Use this tool to archive data of the B2B system. Data of all SIDs are written as binary records to\n");
+  fprintf(stderr, "<fprefix>_b2b_<PREFIX>.b2ba, rotated files get the UTC of rotation appended to the name.\n");
+  fprintf(stderr, "Use b2b-archive2csv to convert the data to CSV.\n");
   fprintf(stderr, "Example1: '%s pro_sis18 -ftest\n", program);
   fprintf(stderr, "\n");
   fprintf(stderr, "Report software bugs to <d.beck@gsi.de>\n");
@@ -106,123 +136,191 @@ static void help(void) {
 } //help
 
 
-// header String for file
-char * headerString()
-{
-  return "patternName; time_CBS_UTC; sid; mode; ext_T [as]; ext_h; ext_cTrig; inj_T; inj_h; inj_cTrig; cPhase; ext_phase; ext_phaseFract; ext_phaseErr; ext_maxsysErr; ext_dKickMon; ext_kickCompLvl; ext_dkickProb; ext_kickLen; ext_diagPhase; ext_diag_Match; inj_phase; inj_phaseFract; inj_phaseErr; inj_maxsysErr; inj_dKickMon; inj_dKickProb; inj_diagPhase; inj_diagMatch; received PME; PMI; PRE; PRI; KTE; KTI; KDE; KDI; PDE; PDI; error PME; PMI; PRE; PRI; KTE; KTI; KDE; KDI; PDE; PDI; late PME; PMI; PRE; PRI; KTE; KTI; KDE; KDI; PDE; PDI; fin-CBS; prr-CBS; t0E-CBS; t0I-CBS; kte-CBS; kti-CBS; ext_nueGet; ext_dNueGet; inj_nueGet; inj_dNueGet";
-} // headerString
+int archiveOpen(int flags);
 
-// receive get values
-void recGetvalue(long *tag, diagval_t *address, int *size)
+
+// rotate archive file: rename the file, reopen a new one; returns 0 on success
+// if renaming fails, the file is left untouched and closed; the caller decides whether to append or give up
+int archiveRotate()
 {
-#define STRMAXLEN 2048
-  uint32_t  sid;
-  uint32_t  mode;
-  double    cor;
-  double    act;
-  char      tCBS[256];;
+  char   rotName[DIMMAXSIZE + 64];
+  char   tRot[64];
+  time_t now;
+
+  now = time(NULL);
+  strftime(tRot, sizeof(tRot), "%Y%m%d_%H%M%S", gmtime(&now));
+  sprintf(rotName, "%s.%s", filename, tRot);
+  if (dataFd >= 0) close(dataFd);
+  dataFd = -1;
+  if (rename(filename, rotName)) {
+    fprintf(stderr, "%s: can't rename file %s to %s, %s\n", program, filename, rotName, strerror(errno));
+    return 1;
+  } // if rename
 
-  char      strSetval[STRMAXLEN];
-  char      strGetval[STRMAXLEN];
-  char      strNueval[STRMAXLEN];
-  char      *new;
+  return archiveOpen(0);                    // the old file is gone, never truncate here
+} // archiveRotate
 
-  int       i;
 
-  FILE      *dataFile;                       // file for data
+// open archive file and write file header if the file is new; an existing file with a different header is rotated; returns 0 on success
+int archiveOpen(int flags)
+{
+  archhdr_t   hdr;
+  archhdr_t   hdrFile;
+  struct stat fileStat;
+
+  hdr.magic    = B2B_ARCHIVE_MAGIC;
+  hdr.version  = B2B_ARCHIVE_VERSION;
+  hdr.recSize  = sizeof(archval_t);
+  hdr.reserved = 0;
+
+  if ((dataFd = open(filename, O_RDWR | O_CREAT | O_APPEND | flags, 0644)) < 0) return 1;
+  if (fstat(dataFd, &fileStat)) return 1;
+  fileSize = fileStat.st_size;
+
+  if (fileSize == 0) {
+    if (write(dataFd, &hdr, sizeof(hdr)) != sizeof(hdr)) return 1;
+    fileSize = sizeof(hdr);
+  } // if new file
+  else if ((pread(dataFd, &hdrFile, sizeof(hdrFile), 0) != sizeof(hdrFile)) || memcmp(&hdr, &hdrFile, sizeof(hdr))) {
+    fprintf(stderr, "%s: file %s has a different format, rotating it\n", program, filename);
+    return archiveRotate();
+  } // else if header mismatch
+
+  return 0;
+} // archiveOpen
+
+
+// write buffered records to archive file; rotation only happens between records
+void archiveWrite(archval_t *buf, int nRec)
+{
+  ssize_t len;
+  size_t  done = 0;
+  size_t  size = nRec * sizeof(archval_t);
+
+  if (nRec == 0) return;
+  if (maxFileSize && (fileSize + size > maxFileSize) && (fileSize > sizeof(archhdr_t))) {
+    if (archiveRotate()) {
+      // keep appending to the old file, rotation is retried with the next write
+      if ((dataFd < 0) && archiveOpen(0)) fprintf(stderr, "%s: can't open file %s after failed rotation\n", program, filename);
+    } // if archiveRotate
+  } // if maxFileSize
+  if (dataFd < 0) return;
+
+  while (done < size) {
+    len = write(dataFd, (char *)buf + done, size - done);
+    if (len < 0) {
+      if (errno == EINTR) continue;
+      fprintf(stderr, "%s: writing to file %s failed, %s\n", program, filename, strerror(errno));
+      return;
+    } // if len
+    done += len;
+  } // while done
+  fileSize += size;
+} // archiveWrite
+
+
+// writer thread: completes queued records with frequency values and appends them batch-wise to the archive file
+void *writerThread(void *arg)
+{
+  archval_t buf[BUFLEN];                     // write buffer
+  int       nBuf = 0;                        // number of records in write buffer
+  uint64_t  tFirst = 0;                      // time when first record was put into write buffer [ns]
+  uint64_t  now;
+  uint32_t  head;
+  uint32_t  dropped;
+  uint32_t  sid;
+  qelem_t   *elem;
+  diagval_t diag;
+
+  while (1) {
+    now  = b2b_getSysTime();
+    head = __atomic_load_n(&queueHead, __ATOMIC_ACQUIRE);
+
+    if (head == queueTail) {
+      if (nBuf && (now - tFirst > FLUSHDELAY)) {archiveWrite(buf, nBuf); nBuf = 0;}
+      if ((dropped = __atomic_exchange_n(&nDropped, 0, __ATOMIC_RELAXED))) fprintf(stderr, "%s: queue full, dropped %u records\n", program, dropped);
+      usleep(10000);
+      continue;
+    } // if queue empty
+
+    // see comment in routine 'dicSubscribeServices': wait a bit until the analyzer has published the frequency values
+    elem = &(queue[queueTail & (QUEUELEN - 1)]);
+    if (now < elem->tEnq + NUEDELAY) {
+      usleep((elem->tEnq + NUEDELAY - now) / 1000);
+      continue;
+    } // if now
+    sid = elem->rec.sid;
+    // frequency values; chk: in principle we should check the timestammp of the service too?
+    pthread_mutex_lock(&diagLock);
+    elem->rec.flagNueValid = flagDiagValid[sid];
+    diag                   = diagSnap[sid];
+    pthread_mutex_unlock(&diagLock);
+    if (elem->rec.flagNueValid) {
+      elem->rec.ext_rfNueAct    = diag.ext_rfNueAct;
+      elem->rec.ext_rfNueActErr = diag.ext_rfNueActErr;
+      elem->rec.inj_rfNueAct    = diag.inj_rfNueAct;
+      elem->rec.inj_rfNueActErr = diag.inj_rfNueActErr;
+    } // if flagNueValid
+
+    if (nBuf == 0) tFirst = now;
+    buf[nBuf++] = elem->rec;
+    __atomic_store_n(&queueTail, queueTail + 1, __ATOMIC_RELEASE);
+
+    if (nBuf == BUFLEN) {archiveWrite(buf, nBuf); nBuf = 0;}
+  } // while 1
+
+  return NULL;
+} // writerThread
+
+
+// receive get values; all DIM callbacks are executed by the same DIM thread, thus this is the only producer of the queue
+void recGetvalue(long *tag, getval_t *address, int *size)
+{
+  uint32_t  sid;
+  uint32_t  head;
+  qelem_t   *elem;
 
-  // usleep: see comment in routine 'dicSubscribeServices'
-  usleep(100000);  // 100 ms should be safe
-  
   sid = *tag;
   if ((sid < 0) || (sid >= B2B_NSID)) return;
   if (!flagSetValid[sid])             return;
   flagGetValid[sid] = (*size != sizeof(uint32_t));
-  mode = dicSetval[sid].mode;
-  //if (mode <  1) return;                                    // b2b 'off', no need to write data; but maybe it is interesting to see when facility was executed withouot b2b
-
-  strftime(tCBS, 52, "%d-%b-%Y_%H:%M:%S", gmtime(&(utc_secs[sid])));
-
-  // set values
-  new  = strSetval;
-  new += sprintf(new, "%s.%03d; %d; %d", tCBS, utc_msecs[sid], sid, mode);
-  if (dicSetval[sid].ext_T == -1) new += sprintf(new, "; %s"    , nan_str);
-  else new += sprintf(new, "; %lu"   , dicSetval[sid].ext_T);
-  if (dicSetval[sid].ext_h == -1) new += sprintf(new, "; %s"    , nan_str);
-  else new += sprintf(new, "; %d"    , dicSetval[sid].ext_h);
-  new += sprintf(new, "; %8.3f" , dicSetval[sid].ext_cTrig);
-  if (dicSetval[sid].inj_T == -1) new += sprintf(new, "; %s"    , nan_str);
-  else new += sprintf(new, "; %lu"   , dicSetval[sid].inj_T);
-  if (dicSetval[sid].inj_h == -1) new += sprintf(new, "; %s"    , nan_str);
-  else new += sprintf(new, "; %d"    , dicSetval[sid].inj_h);
-  new += sprintf(new, "; %8.3f" , dicSetval[sid].inj_cTrig);
-  new += sprintf(new, "; %8.3f" , dicSetval[sid].cPhase);
-
-  // get values
-  new  = strGetval;
-  if (dicGetval[sid].ext_phase == -1) new += sprintf(new, "; %s"   , nan_str);
-  else new += sprintf(new, "; %lu"  , dicGetval[sid].ext_phase);
-  new += sprintf(new, "; %7.3f"    ,  dicGetval[sid].ext_phaseFract);
-  new += sprintf(new, "; %7.3f"    ,  dicGetval[sid].ext_phaseErr);
-  new += sprintf(new, "; %5.3f"    ,  dicGetval[sid].ext_phaseSysmaxErr);
-  new += sprintf(new, "; %7.1f"    ,  dicGetval[sid].ext_dKickMon);
-  new += sprintf(new, "; %7.3f"    ,  dicKickCompLvlExt[sid]);
-  new += sprintf(new, "; %7.1f"    ,  dicGetval[sid].ext_dKickProb);
-  new += sprintf(new, "; %7.1f"    ,  dicKickLenExt[sid]);
-
-  if (isnan(dicGetval[sid].ext_diagPhase) || (dicSetval[sid].ext_T == -1)) new += sprintf(new, "; %s"    , nan_str);
-  else {
-    cor  = 0;
-    act  = b2b_fixTS(dicGetval[sid].ext_diagPhase, cor, dicSetval[sid].ext_T) - cor;
-    new += sprintf(new, "; %8.3f",  act);
-  } // is isnan
+  //if (dicSetval[sid].mode <  1) return;                     // b2b 'off', no need to write data; but maybe it is interesting to see when facility was executed withouot b2b
+
+  head = queueHead;
+  if (head - __atomic_load_n(&queueTail, __ATOMIC_ACQUIRE) >= QUEUELEN) {
+    __atomic_fetch_add(&nDropped, 1, __ATOMIC_RELAXED);
+    return;
+  } // if queue full
+
+  elem = &(queue[head & (QUEUELEN - 1)]);
+  memset(&(elem->rec), 0, sizeof(archval_t));
+  elem->tEnq                 = b2b_getSysTime();
+  elem->rec.utcSecs          = utc_secs[sid];
+  elem->rec.utcMsecs         = utc_msecs[sid];
+  elem->rec.sid              = sid;
+  strncpy(elem->rec.pName, dicPName[sid], B2B_ARCHIVE_PNAMELEN - 1);
+  elem->rec.setval           = dicSetval[sid];
+  elem->rec.getval           = dicGetval[sid];
+  elem->rec.ext_kickLen      = dicKickLenExt[sid];
+  elem->rec.ext_kickCompLvl  = dicKickCompLvlExt[sid];
+  __atomic_store_n(&queueHead, head + 1, __ATOMIC_RELEASE);
+} // recGetvalue
 
-  if (isnan(dicGetval[sid].ext_diagMatch) || (dicSetval[sid].ext_T == -1)) new += sprintf(new, "; %s"    , nan_str);
-  else {
-    cor  = dicSetval[sid].ext_cTrig;
-    act  = b2b_fixTS(dicGetval[sid].ext_diagMatch, cor, dicSetval[sid].ext_T) - cor;
-    new += sprintf(new, "; %8.3f", act);
-  } // else isnan
-
-  if (dicGetval[sid].inj_phase == -1) new += sprintf(new, "; %s"   , nan_str);
-  else new += sprintf(new, "; %lu", dicGetval[sid].inj_phase);
-  new += sprintf(new, "; %7.3f"   , dicGetval[sid].inj_phaseFract);
-  new += sprintf(new, "; %7.3f"   , dicGetval[sid].inj_phaseErr);
-  new += sprintf(new, "; %5.3f"   , dicGetval[sid].inj_phaseSysmaxErr);
-  new += sprintf(new, "; %7.1f"   , dicGetval[sid].inj_dKickMon);
-  new += sprintf(new, "; %7.1f"   , dicGetval[sid].inj_dKickProb);
-
-  if (isnan(dicGetval[sid].inj_diagPhase) || (dicSetval[sid].inj_T == -1)) new += sprintf(new, "; %s"   , nan_str);
-  else {
-    cor  = 0;
-    act  = b2b_fixTS(dicGetval[sid].inj_diagPhase, cor, dicSetval[sid].inj_T) - cor;
-    new += sprintf(new, "; %8.3f",  act);
-  } // else isnan
 
-  if (isnan(dicSetval[sid].inj_cTrig) || isnan(dicGetval[sid].inj_diagMatch) || (dicSetval[sid].inj_T == -1)) new += sprintf(new, "; %s"   , nan_str);
-  else {
-    cor = dicSetval[sid].inj_cTrig - dicSetval[sid].cPhase;
-    act = b2b_fixTS(dicGetval[sid].inj_diagMatch, cor, dicSetval[sid].inj_T) - cor;
-    new += sprintf(new, "; %8.3f",  act);
-  } // else isnan
-
-  for (i=0; i<10; i++) new += sprintf(new, "; %d", ((dicGetval[sid].flagEvtRec  >> i) & 0x1));
-  for (i=0; i<10; i++) new += sprintf(new, "; %d", ((dicGetval[sid].flagEvtErr  >> i) & 0x1));
-  for (i=0; i<10; i++) new += sprintf(new, "; %d", ((dicGetval[sid].flagEvtLate >> i) & 0x1));
-  new += sprintf(new, "; %f; %f; %f; %f; %f; %f", dicGetval[sid].finOff, dicGetval[sid].prrOff, dicGetval[sid].preOff, dicGetval[sid].priOff, dicGetval[sid].kteOff, dicGetval[sid].ktiOff);
-
-  // frequency values; chk: in principle we should check the timestammp of the service too?
-  new = strNueval;
-  if (*(uint32_t *)&(dicDiagval[sid]) == no_link_32)
-    new += sprintf(new, "; NOLINK; NOLINK; NOLINK; NOLINK");
-  else 
-    new += sprintf(new, "; %13.6f; %13.6f; %13.6f; %13.6f", dicDiagval[sid].ext_rfNueAct, dicDiagval[sid].ext_rfNueActErr, dicDiagval[sid].inj_rfNueAct, dicDiagval[sid].inj_rfNueActErr);
-
-  if (!(dataFile = fopen(filename[sid], "a"))) return;
-  fprintf(dataFile, "%s; %s%s%s\n", dicPName[sid], strSetval, strGetval, strNueval);
-  fclose(dataFile); 
-} // recGetvalue
-  
+// receive frequency values; copy them for the writer thread, as DIM overwrites dicDiagval asynchronously
+void recDiagvalue(long *tag, diagval_t *address, int *size)
+{
+  uint32_t sid;
+
+  sid = *tag;
+  if ((sid < 0) || (sid >= B2B_NSID)) return;
+
+  pthread_mutex_lock(&diagLock);
+  flagDiagValid[sid] = (*size != sizeof(uint32_t));
+  if (flagDiagValid[sid]) diagSnap[sid] = *address;
+  pthread_mutex_unlock(&diagLock);
+} // recDiagvalue
+
 
 // receive set values
 void recSetvalue(long *tag, setval_t *address, int *size)
@@ -256,7 +354,7 @@ void dicSubscribeServices(char *prefix)
     dicPNameId[i]      = dic_info_service_stamped(name, MONITORED, 0, &(dicPName[i]), DIMMAXSIZE, 0 , 0, &no_link_str, sizeof(no_link_str));
 
     sprintf(name, "%s-cal_diag_sid%02d", prefix, i);
-    dicDiagvalId[i]    = dic_info_service_stamped(name, MONITORED, 0, &(dicDiagval[i]), sizeof(diagval_t), 0, 0, &no_link_32, sizeof(uint32_t));
+    dicDiagvalId[i]    = dic_info_service_stamped(name, MONITORED, 0, &(dicDiagval[i]), sizeof(diagval_t), recDiagvalue, i, &no_link_32, sizeof(uint32_t));
 
     sprintf(name, "%s-kdde_sid%02d_len", prefix, i);
     dicKickLenExtId[i] = dic_info_service_stamped(name, MONITORED, 0, &(dicKickLenExt[i]), sizeof(double), 0 , 0, &no_link_dbl, sizeof(double));
@@ -272,9 +370,9 @@ void dicSubscribeServices(char *prefix)
 
     // note: presently, the archiver is driven by get values. However, the 'analyzer' only calculates and publishes the the frequency values
     // _after_ the get values are available. Thus, the 'archiver' starts processing the data prior the 'analyzer' has finished its work.
-    // Presently, the frequency values are an 'experimental feature' and a sleep is added to the 'recGetValue' routine to wait for the analyzer.
+    // Presently, the frequency values are an 'experimental feature' and the writer thread waits a bit (NUEDELAY) for the analyzer.
     // In pinciple, one could consider using a change of the analyzed values as a 'trigger' for the archiver; but then the archiver will not
-    // work if the 'analyzer' is not available. Thus, we presently use the workaround of an additional sleep in routine 'recGetValue'. 
+    // work if the 'analyzer' is not available. Thus, we presently use the workaround of a delay in routine 'writerThread'.
   } // for i
 } // dicSubscribeServices
 
@@ -288,17 +386,17 @@ int main(int argc, char** argv) {
 
   char     sprefix[DIMMAXSIZE];             // prefix for system like 'pro'
   char     fprefix[DIMMAXSIZE];             // prefix for file like 'test'
-  int      i;
-  FILE     *dataFile;                       // file for data
-  char     fileMode[10];                    // mode for file
+  int      fileFlags;                       // flags for opening file
+  pthread_t writer;                         // writer thread
 
 
   program       = argv[0];
   getVersion    = 0;
   sprintf(fprefix, "%s", "");
-  sprintf(fileMode, "a");
+  fileFlags     = 0;
+  maxFileSize   = 64 * 1024 * 1024;
 
-  while ((opt = getopt(argc, argv, "f:ehn")) != -1) {
+  while ((opt = getopt(argc, argv, "f:r:ehn")) != -1) {
     switch (opt) {
       case 'e':
         getVersion = 1;
@@ -309,7 +407,14 @@ int main(int argc, char** argv) {
         error = 1;
         break;
       case 'n' :
-        sprintf(fileMode, "w");
+        fileFlags = O_TRUNC;
+        break;
+      case 'r' :
+        maxFileSize = strtoull(optarg, &tmp, 0) * 1024 * 1024;
+        if (*tmp) {
+          fprintf(stderr, "Specify a proper file size, not '%s'!\n", optarg);
+          exit(1);
+        } // if *tmp
         break;
       case 'f' :
         tmp = strtok(optarg, " ");
@@ -344,16 +449,17 @@ int main(int argc, char** argv) {
 
   if (getVersion) printf("%s: version %s\n", program, b2b_version_text(B2B_ARCHIVER_VERSION));
 
-  for (i=0; i<B2B_NSID; i++) {
-    sprintf(filename[i], "%s_%s_sid%02d.dat", fprefix, sprefix, i);
-    printf("open data file %s\n", filename[i]);
-    if (!(dataFile = fopen(filename[i], fileMode))) {
-      fprintf(stderr, "%s: can't open file %s\n", program, filename[i]);
-      exit (1);
-    } // if !file
-    fprintf(dataFile, "%s\n", headerString());
-    fclose(dataFile);
-  } // for i
+  sprintf(filename, "%s_%s.b2ba", fprefix, sprefix);
+  printf("open data file %s\n", filename);
+  if (archiveOpen(fileFlags)) {
+    fprintf(stderr, "%s: can't open file %s\n", program, filename);
+    exit (1);
+  } // if archiveOpen
+
+  if (pthread_create(&writer, NULL, writerThread, NULL)) {
+    fprintf(stderr, "%s: can't start writer thread\n", program);
+    exit (1);
+  } // if pthread_create
 
   dicSubscribeServices(sprefix);
     
@@ -3,10 +3,13 @@
  *
  *  created : 2021
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 27-Sep-2023
+ *  version : 18-Oct-2026
  *
  * subscribes to and displays status of a b2b system (CBU, PM, KD ...)
  *
+ * updates are tracked per system; bursts of updates are coalesced to a frame rate and only
+ * the lines that changed are written to the terminal
+ *
  * ------------------------------------------------------------------------------------------
  * License Agreement for this software:
  *
@@ -34,7 +37,7 @@
  * For all questions and ideas contact: d.beck@gsi.de
  * Last update: 15-April-2019
  *********************************************************************************************/
-#define B2B_CLIENT_SYS_VERSION 0x000702
+#define B2B_CLIENT_SYS_VERSION 0x000800
 
 // standard includes 
 #include <unistd.h> // getopt
@@ -60,6 +63,8 @@ const char* program;
 #define DIMCHARSIZE 32                   // standard size for char services
 #define DIMMAXSIZE  1024                 // max size for service names
 #define SCREENWIDTH 1024                 // width of screen
+#define FPSDEFAULT  1                    // default frame rate [Hz]
+#define NEMPTY      4                    // number of empty lines below data
 
 uint32_t no_link_32    = 0xdeadbeef;
 uint64_t no_link_64    = 0xdeadbeefce420651;
@@ -71,6 +76,17 @@ char     title[SCREENWIDTH+1];                              // title line to be
 char     footer[SCREENWIDTH+1];                             // footer line to be printed
 char     header[SCREENWIDTH+1];                             // header line to be printed
 char     empty[SCREENWIDTH+1];                              // an empty line
+char     printLine[B2BNSYS][SCREENWIDTH+1];                 // lines to be printed
+uint32_t flagUpdate[B2BNSYS];                               // flag: update displayed data of this system; set by any service of this system
+uint32_t fps;                                               // frame rate [Hz]
+
+// benchmark
+int      flagBench;                                         // flag: headless benchmark with synthetic updates, no DIM
+uint64_t benchNUpdate;                                      // number of updates
+uint64_t benchNBuild;                                       // number of lines built
+uint64_t benchNLine;                                        // number of lines written
+uint64_t benchNByte;                                        // number of bytes written
+uint64_t benchNFull;                                        // number of bytes that a redraw of the full screen would have written
 
 const char * sysShortNames[] = {
   "sis18-cbu",
@@ -156,9 +172,13 @@ static void help(void) {
   fprintf(stderr, "  -e                  display version\n");
   fprintf(stderr, "  -s                  subscribe and display system info\n");
   fprintf(stderr, "  -o                  print info only once and exit (useful with '-s')\n");
+  fprintf(stderr, "  -f <fps>            frame rate of screen updates, default %d Hz\n", FPSDEFAULT);
+  fprintf(stderr, "  -b <n>              headless benchmark: render <n> frames from synthetic updates, no DIM\n");
   fprintf(stderr, "\n");
   fprintf(stderr, "Use this tool to display system information on the B2B system\n");
+  fprintf(stderr, "Updates of services are coalesced per system and frame, only lines that changed are written to the terminal.\n");
   fprintf(stderr, "Example1: '%s -s pro'\n", program);
+  fprintf(stderr, "Example2: '%s -b 10000'\n", program);
   fprintf(stderr, "\n");
   fprintf(stderr, "Report software bugs to <d.beck@gsi.de>\n");
   fprintf(stderr, "Version %s. Licensed under the LGPL v3.\n", b2b_version_text(B2B_CLIENT_SYS_VERSION));
@@ -174,6 +194,14 @@ void buildHeader(char * environment)
 } // buildHeader
 
 
+// receive any service of a system; the data are used when the line is rebuilt
+void recService(long *tag, void *address, int *size)
+{
+  if ((*tag < 0) || (*tag >= B2BNSYS)) return;
+  flagUpdate[*tag] = 1;
+} // recService
+
+
 // add all dim services
 void dicSubscribeServices(char *prefix)
 {
@@ -182,17 +210,17 @@ void dicSubscribeServices(char *prefix)
 
   for (i=0; i<B2BNSYS; i++) {
     sprintf(name, "%s_%s_version_fw", prefix, sysShortNames[i]);
-    dicSystem[i].versionId   = dic_info_service(name, MONITORED, 0, (dicSystem[i].version), 8, 0, 0, &no_link_32, sizeof(no_link_32));
+    dicSystem[i].versionId   = dic_info_service(name, MONITORED, 0, (dicSystem[i].version), 8, recService, (long)i, &no_link_32, sizeof(no_link_32));
     sprintf(name, "%s_%s_state", prefix, sysShortNames[i]);
-    dicSystem[i].stateId     = dic_info_service(name, MONITORED, 0, (dicSystem[i].state), 10, 0, 0, &no_link_32, sizeof(no_link_32));
+    dicSystem[i].stateId     = dic_info_service(name, MONITORED, 0, (dicSystem[i].state), 10, recService, (long)i, &no_link_32, sizeof(no_link_32));
     sprintf(name, "%s_%s_hostname", prefix, sysShortNames[i]);
-    dicSystem[i].hostnameId  = dic_info_service(name, MONITORED, 0, (dicSystem[i].hostname), DIMCHARSIZE, 0, 0, &no_link_32, sizeof(no_link_32));
+    dicSystem[i].hostnameId  = dic_info_service(name, MONITORED, 0, (dicSystem[i].hostname), DIMCHARSIZE, recService, (long)i, &no_link_32, sizeof(no_link_32));
     sprintf(name, "%s_%s_status", prefix, sysShortNames[i]);
-    dicSystem[i].statusId    = dic_info_service(name, MONITORED, 0, &(dicSystem[i].status), sizeof(uint64_t), 0, 0, &no_link_64, sizeof(no_link_64));
+    dicSystem[i].statusId    = dic_info_service(name, MONITORED, 0, &(dicSystem[i].status), sizeof(uint64_t), recService, (long)i, &no_link_64, sizeof(no_link_64));
     sprintf(name, "%s_%s_ntransfer", prefix, sysShortNames[i]);
-    dicSystem[i].nTransferId = dic_info_service(name, MONITORED, 0, &(dicSystem[i].nTransfer), sizeof(dicSystem[i].nTransferId), 0, 0, &no_link_32, sizeof(no_link_32));
+    dicSystem[i].nTransferId = dic_info_service(name, MONITORED, 0, &(dicSystem[i].nTransfer), sizeof(dicSystem[i].nTransferId), recService, (long)i, &no_link_32, sizeof(no_link_32));
     sprintf(name, "%s_%s-jitter-check_data", prefix, sysShortNames[i]);
-    dicSystem[i].jitterId    = dic_info_service(name, MONITORED, 0, &(dicSystem[i].jitter), sizeof(dicSystem[i].jitter), 0, 0, &no_link_32, sizeof(no_link_32));
+    dicSystem[i].jitterId    = dic_info_service(name, MONITORED, 0, &(dicSystem[i].jitter), sizeof(dicSystem[i].jitter), recService, (long)i, &no_link_32, sizeof(no_link_32));
     
   } // for i
 } // dicSubscribeServices
@@ -218,64 +246,106 @@ void dicCmdClearJitterChk(char *prefix, uint32_t indexServer)
 } // dicCmdClearJitterChk
 
 
-// print services to screen
-void printServices(int flagOnce)
+// build line of a system for printing
+void buildLine(int i)
 {
-  int i;
-
   char     cTransfer[10];
   char     cStatus[17];
   char     cVersion[9];
   char     cState[11];
   char     cHost[19];
   char     cJitter[5];
-  char     buff[100];
-  time_t   time_date;
   uint32_t *tmp;
   double   maxmin;
 
   //printf("12345678901234567890123456789012345678901234567890123456789012345678901234567890\n");
 
+  if (dicSystem[i].nTransfer == no_link_32)    sprintf(cTransfer, "%9s",         no_link_str);
+  else                                         sprintf(cTransfer, "%9u",         dicSystem[i].nTransfer);
+  if (dicSystem[i].status    == no_link_64)    sprintf(cStatus,  "%13s",         no_link_str);
+  else                                         sprintf(cStatus,  "%13"PRIx64"",  dicSystem[i].status);
+  tmp = (uint32_t *)(&(dicSystem[i].state));
+  if (*tmp == no_link_32)                      sprintf(cState,   "%10s",         no_link_str);
+  else                                         sprintf(cState,   "%10s",         dicSystem[i].state); 
+  tmp = (uint32_t *)(&(dicSystem[i].version));
+  if (*tmp == no_link_32)                      sprintf(cVersion, "%8s",          no_link_str);
+  else                                         sprintf(cVersion, "%8s",          dicSystem[i].version); 
+  tmp = (uint32_t *)(&(dicSystem[i].hostname));
+  if (*tmp == no_link_32)                      sprintf(cHost,   "%16s",          no_link_str);
+  else                                         sprintf(cHost,   "%16s",          dicSystem[i].hostname);
+  tmp = (uint32_t *)(&(dicSystem[i].jitter));
+  if (*tmp == no_link_32)                      sprintf(cJitter, "   ");          // no link, just 'blank' as not all processes have a jitter check
+  else  {
+    if (isnan(dicSystem[i].jitter.ppsAct))     sprintf(cJitter, " err");         // bad state, no WR lock or not PPS signal detected
+    else {
+    // check for fluctations
+      maxmin = dicSystem[i].jitter.ppsMax - dicSystem[i].jitter.ppsMin;
+      if ( maxmin <= 0.1)                      sprintf(cJitter, "  ok");         // good
+      if ((maxmin > 0.1) && (maxmin < 1.1))    sprintf(cJitter, " ~ok");         // hm, up to 1ns is in principle possible
+      if ( maxmin >= 1.1)                      sprintf(cJitter, "%4d", (int)maxmin);
+    } // else isnan
+  } // else nolink
+  sprintf(printLine[i], " %2x %6s %3s %8s %10s %9s %13s %4s %16s", i, ringNames[i], typeNames[i], cVersion, cState, cTransfer, cStatus, cJitter, cHost);
+  benchNBuild++;
+} // buildLine
+
+
+// check for new data and update text for later printing; all updates of a system since the last frame are coalesced
+void buildLines()
+{
+  int i;
+
+  for (i=0; i<B2BNSYS; i++) {
+    if (flagUpdate[i]) {
+      flagUpdate[i] = 0;
+      buildLine(i);
+    } // if flagUpdate
+  } // for i
+} // buildLines
+
+
+// add a line to the screen
+void addLine(uint32_t *line, const char *text)
+{
+  b2b_screen_line(*line, text);
+  (*line)++;
+  benchNFull += strlen(text) + 1;
+} // addLine
+
+
+// print services to screen; unless printed once, only lines that changed are written
+void printServices(int flagOnce)
+{
+  int      i;
+  char     buff[100];
+  time_t   time_date;
+  uint32_t line;
+  uint32_t nLine;
+  uint32_t nByte;
+
+  if (flagOnce) {
+    comlib_term_curpos(1,1);
+    printf("%s\n", header);
+    for (i=0; i<B2BNSYS; i++) printf("%s\n", printLine[i]);
+    for (i=0; i<NEMPTY; i++)  printf("%s\n", empty);
+    return;
+  } // if flagOnce
+
   // footer with date and time
   time_date = time(0);
   strftime(buff,50,"%d-%b-%y %H:%M",localtime(&time_date));
   sprintf(footer, "\033[7m exit <q> | clear status <digit> | print status <s> | help <h>   %s\033[0m", buff);
-  
-  comlib_term_curpos(1,1);
-  
-  if (!flagOnce) printf("%s\n", title);
-  printf("%s\n", header);
-  for (i=0; i<B2BNSYS; i++) {
-    if (dicSystem[i].nTransfer == no_link_32)    sprintf(cTransfer, "%9s",         no_link_str);
-    else                                         sprintf(cTransfer, "%9u",         dicSystem[i].nTransfer);
-    if (dicSystem[i].status    == no_link_64)    sprintf(cStatus,  "%13s",         no_link_str);
-    else                                         sprintf(cStatus,  "%13"PRIx64"",  dicSystem[i].status);
-    tmp = (uint32_t *)(&(dicSystem[i].state));
-    if (*tmp == no_link_32)                      sprintf(cState,   "%10s",         no_link_str);
-    else                                         sprintf(cState,   "%10s",         dicSystem[i].state); 
-    tmp = (uint32_t *)(&(dicSystem[i].version));
-    if (*tmp == no_link_32)                      sprintf(cVersion, "%8s",          no_link_str);
-    else                                         sprintf(cVersion, "%8s",          dicSystem[i].version); 
-    tmp = (uint32_t *)(&(dicSystem[i].hostname));
-    if (*tmp == no_link_32)                      sprintf(cHost,   "%16s",          no_link_str);
-    else                                         sprintf(cHost,   "%16s",          dicSystem[i].hostname);
-    tmp = (uint32_t *)(&(dicSystem[i].jitter));
-    if (*tmp == no_link_32)                      sprintf(cJitter, "   ");          // no link, just 'blank' as not all processes have a jitter check
-    else  {
-      if (isnan(dicSystem[i].jitter.ppsAct))     sprintf(cJitter, " err");         // bad state, no WR lock or not PPS signal detected
-      else {
-      // check for fluctations
-        maxmin = dicSystem[i].jitter.ppsMax - dicSystem[i].jitter.ppsMin;
-        if ( maxmin <= 0.1)                      sprintf(cJitter, "  ok");         // good
-        if ((maxmin > 0.1) && (maxmin < 1.1))    sprintf(cJitter, " ~ok");         // hm, up to 1ns is in principle possible
-        if ( maxmin >= 1.1)                      sprintf(cJitter, "%4d", (int)maxmin);
-      } // else isnan
-    } // else nolink
-    printf(" %2x %6s %3s %8s %10s %9s %13s %4s %16s\n", i, ringNames[i], typeNames[i], cVersion, cState, cTransfer, cStatus, cJitter, cHost);
-  } // for i
 
-  for (i=0; i<4; i++) printf("%s\n", empty);
-  if (!flagOnce) printf("%s\n", footer);
+  line = 1;
+  addLine(&line, title);
+  addLine(&line, header);
+  for (i=0; i<B2BNSYS; i++) addLine(&line, printLine[i]);
+  for (i=0; i<NEMPTY; i++)  addLine(&line, empty);
+  addLine(&line, footer);
+
+  b2b_screen_flush(&nLine, &nByte, !flagBench);
+  benchNLine += nLine;
+  benchNByte += nByte;
 } // printServices
 
 
@@ -296,6 +366,7 @@ void printStatusText()
   } // for i
   printf("press any key to continue\n");
   while (!comlib_term_getChar()) {usleep(200000);}
+  b2b_screen_invalidate();
 } // printStatusText
 
 
@@ -314,17 +385,86 @@ void printHelpText()
   printf("%s\n", empty);
   printf("press any key to continue\n");
   while (!comlib_term_getChar()) {usleep(200000);}
+  b2b_screen_invalidate();
 } // printHelpText
 
 
+// synthetic update of a service of a system
+void benchUpdate(uint32_t i)
+{
+  switch (rand() % 4) {
+    case 0 :                                                // a transfer
+      dicSystem[i].nTransfer++;
+      break;
+    case 1 :                                                // jitter check
+      dicSystem[i].jitter.ppsAct = 123456.0 + (double)(rand() % 100) / 100.0;
+      if (dicSystem[i].jitter.ppsAct < dicSystem[i].jitter.ppsMin) dicSystem[i].jitter.ppsMin = dicSystem[i].jitter.ppsAct;
+      if (dicSystem[i].jitter.ppsAct > dicSystem[i].jitter.ppsMax) dicSystem[i].jitter.ppsMax = dicSystem[i].jitter.ppsAct;
+      break;
+    case 2 :                                                // status
+      dicSystem[i].status = (rand() % 16) ? 0x1 : 0x5;
+      break;
+    default :                                               // state
+      sprintf(dicSystem[i].state, "%s", (rand() % 16) ? "OpReady" : "ERROR");
+      break;
+  } // switch rand
+  benchNUpdate++;
+
+  flagUpdate[i] = 1;
+} // benchUpdate
+
+
+// headless benchmark: renders frames from synthetic updates without writing to the terminal
+// per frame, a burst of 0..15 updates hits random systems; a system may be hit more than once per frame
+void benchmark(uint32_t nFrame)
+{
+  uint32_t i, j;
+  uint32_t nUpdate;
+  uint64_t tStart;
+  uint64_t tStop;
+
+  srand(1);
+  for (i=0; i<B2BNSYS; i++) {
+    sprintf(dicSystem[i].version,  "00.07.02");
+    sprintf(dicSystem[i].state,    "OpReady");
+    sprintf(dicSystem[i].hostname, "scuxl%04u", i);
+    dicSystem[i].status           = 0x1;
+    dicSystem[i].nTransfer        = 0;
+    dicSystem[i].jitter.ppsMin    = 123456.0;
+    dicSystem[i].jitter.ppsMax    = 123456.0;
+    flagUpdate[i]                 = 1;
+  } // for i
+
+  tStart = comlib_getSysTime();
+  for (i=0; i<nFrame; i++) {
+    nUpdate = rand() % 16;
+    for (j=0; j<nUpdate; j++) benchUpdate(rand() % B2BNSYS);
+    buildLines();
+    printServices(0);
+  } // for i
+  tStop  = comlib_getSysTime();
+
+  printf("%s: benchmark of %u frames with synthetic updates\n", program, nFrame);
+  printf("  updates         : %lu\n", benchNUpdate);
+  printf("  lines built     : %lu\n", benchNBuild);
+  printf("  lines written   : %lu\n", benchNLine);
+  printf("  bytes written   : %lu, full redraw %lu (%.1f%%)\n", benchNByte, benchNFull, 100.0 * (double)benchNByte / (double)benchNFull);
+  printf("  time per frame  : %.2f us\n", (double)(tStop - tStart) / 1000.0 / (double)nFrame);
+} // benchmark
+
+
 int main(int argc, char** argv) {
   int opt, error = 0;
   int exitCode   = 0;
-  //  char *tail;
+  char *tail;
 
   int      getVersion;
   int      subscribe;
   int      once;
+  uint32_t nFrame;
+  uint64_t tFrame;
+  uint64_t tNext;
+  int      i;
 
   char     userInput;
   int      sysId;
@@ -338,8 +478,11 @@ int main(int argc, char** argv) {
   subscribe  = 0;
   once       = 0;
   quit       = 0;
+  flagBench  = 0;
+  fps        = FPSDEFAULT;
+  nFrame     = 0;
 
-  while ((opt = getopt(argc, argv, "seho")) != -1) {
+  while ((opt = getopt(argc, argv, "sehof:b:")) != -1) {
     switch (opt) {
       case 'e':
         getVersion = 1;
@@ -350,6 +493,21 @@ int main(int argc, char** argv) {
       case 'o':
         once = 1;
         break;
+      case 'f':
+        fps = strtoul(optarg, &tail, 0);
+        if ((*tail != 0) || (fps == 0)) {
+          fprintf(stderr, "Specify a proper number, not '%s'!\n", optarg);
+          return 1;
+        } // if *tail
+        break;
+      case 'b':
+        nFrame = strtoul(optarg, &tail, 0);
+        if ((*tail != 0) || (nFrame == 0)) {
+          fprintf(stderr, "Specify a proper number, not '%s'!\n", optarg);
+          return 1;
+        } // if *tail
+        flagBench = 1;
+        break;
       case 'h':
         help();
         return 0;
@@ -381,6 +539,12 @@ int main(int argc, char** argv) {
     sprintf(prefix, "b2b");
   } // else optind
 
+  if (flagBench) {
+    buildHeader(environment);
+    benchmark(nFrame);
+    return exitCode;
+  } // if flagBench
+
   comlib_term_clear();
   buildHeader(environment);
   if (getVersion) printf("%s: version %s\n", program, b2b_version_text(B2B_CLIENT_SYS_VERSION));
@@ -389,9 +553,12 @@ int main(int argc, char** argv) {
     printf("b2b-client-sys: starting client using prefix %s\n", prefix);
     sleep(1);
     dicSubscribeServices(prefix);
+    for (i=0; i<B2BNSYS; i++) flagUpdate[i] = 1;
 
     while (!quit) {
+      tFrame = comlib_getSysTime();
       if (once) {sleep(1); quit=1;}                 // wait a bit to get the values
+      buildLines();
       printServices(once);
       if (!quit) {
         sysId = 0xffff;
@@ -414,7 +581,10 @@ int main(int argc, char** argv) {
             printStatusText();
             break;
           default          :
-            usleep(1000000);
+            // wait for next frame; updates arriving meanwhile are coalesced
+            tNext  = tFrame + 1000000000 / fps;
+            tFrame = comlib_getSysTime();
+            if (tNext > tFrame) usleep((tNext - tFrame) / 1000);
         } // switch
       } // if !quit
     } // while
@@ -3,13 +3,16 @@
  *
  *  created : 2023
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 11-Oct-2023
+ *  version : 18-Oct-2026
  *
  * checks jitter between two timing receivers connected via a Lemo cable 
  * the first timing receiver outputs a PPS pulse
  * the second timing receiver timestamps the pulse and does simple statistics
  * the data is published to the network
  *
+ * in addition, overlapping Allan deviation and time deviation at multiple tau as well as histograms are
+ * calculated from a stream; memory is fixed, thus the program may run for days
+ *
  * ------------------------------------------------------------------------------------------
  * License Agreement for this software:
  *
@@ -37,7 +40,7 @@
  * For all questions and ideas contact: d.beck@gsi.de
  * Last update: 15-April-2019
  *********************************************************************************************/
-#define B2B_JITTER_CHECK_VERSION 0x000702
+#define B2B_JITTER_CHECK_VERSION 0x000800
 
 #define __STDC_FORMAT_MACROS
 #define __STDC_CONSTANT_MACROS
@@ -77,6 +80,9 @@ using namespace saftlib;
 using namespace std;
 
 #define FID          0x1                // format ID of timing messages
+#define TAGPPS       17                 // tag of ECA condition for PPS timestamp
+#define ONESEC       1000000000         // one second [ns]
+#define NRING        8192               // length of ring buffers for deviations; must be >= 3 * 2^(B2B_JITTER_NTAU-1) + 1
 
 static const char* program;
 
@@ -89,12 +95,16 @@ static const char* program;
 char        disVersion[DIMCHARSIZE];
 char        disHostname[DIMCHARSIZE];
 char        disState[DIMCHARSIZE];
-jitterChk_t disJitterChk;
+jitterChk_t  disJitterChk;
+jitterDev_t  disJitterDev;
+jitterHist_t disJitterHist;
 
 uint32_t    disVersionId      = 0;
 uint32_t    disHostnameId     = 0;
 uint32_t    disStateId        = 0;
 uint32_t    disJitterChkId    = 0;
+uint32_t    disJitterDevId    = 0;
+uint32_t    disJitterHistId   = 0;
 
 // saftlib
 std::shared_ptr<TimingReceiver_Proxy> ppsReceiver;   // TR for PPS and TS
@@ -118,18 +128,109 @@ uint32_t tN;
 double   tAveOld;
 double   tStreamOld;
 
+// state for Allan deviation and time deviation; sample k is the phase of the k-th PPS of a sequence without gaps
+typedef struct {
+  double   x0;                          // phase of first PPS, subtracted from all values [ns]
+  uint64_t lastSec;                     // second of previous PPS [s, TAI]
+  uint64_t k;                           // number of samples in current sequence
+  double   x[NRING];                    // phase of sample k at [k % NRING]
+  double   p[NRING];                    // sum of phases of samples 0 .. k-1 at [k % NRING]
+  double   sumAdev[B2B_JITTER_NTAU];    // sum of squared second differences
+  double   sumTdev[B2B_JITTER_NTAU];    // sum of squared second differences, averaged over tau
+} devState_t;
+
+devState_t dev;
+
+int          flagReplay;                // flag: replay timestamps from file, no devices, no DIM services
+int          flagVerbose;               // flag: print histograms after replay
+b2b_replay_t *record;                   // recording of received timestamps
+
 
 // clear statistics
 void clearStats()
 {
+  int i;
+
   tMin       = 999999999;
   tMax       = 0;
   tN         = 0;
   tAveOld    = 0;   
   tStreamOld = 0;
+
+  memset(&dev, 0, sizeof(dev));
+  memset(&disJitterDev,  0, sizeof(disJitterDev));
+  memset(&disJitterHist, 0, sizeof(disJitterHist));
+  for (i=0; i<B2B_JITTER_NTAU; i++) {
+    disJitterDev.tau[i]  = (double)(1 << i);
+    disJitterDev.adev[i] = NAN;
+    disJitterDev.tdev[i] = NAN;
+  } // for i
+  disJitterDev.ppsMin    = NAN;
+  disJitterDev.ppsMax    = NAN;
 } // clearStats
 
 
+// add the phase of a PPS to Allan deviation and time deviation
+// tau = m seconds with m = 2^i; with x_k the phase of sample k, the terms are
+// - Allan deviation, overlapping: d_k = x_k - 2 x_(k-m) + x_(k-2m); adev^2 = sum(d_k^2) / (2 n tau^2)
+// - time deviation: sum of d over the last m samples; tdev^2 = sum(s_k^2) / (6 m^2 n), s_k = P_(k+1) - 3 P_(k+1-m) + 3 P_(k+1-2m) - P_(k+1-3m)
+//   with P_j the sum of x_0 .. x_(j-1); thus each sample costs O(B2B_JITTER_NTAU), independent of tau
+void addDeviation(uint64_t sec, double xAct)
+{
+  uint64_t k;
+  uint64_t m;
+  double   d;
+  double   x;
+  int      i;
+
+  if (tN == 1) dev.x0 = xAct;
+  x = xAct - dev.x0;
+
+  // new sequence at start or after a gap; PPS of the same second are ignored
+  if ((dev.k > 0) && (sec <= dev.lastSec)) return;
+  if ((dev.k > 0) && (sec != dev.lastSec + 1)) {
+    disJitterDev.nGap++;
+    dev.k = 0;
+  } // if gap
+  dev.lastSec = sec;
+
+  k                      = dev.k;
+  if (k == 0) dev.p[0]   = 0;
+  dev.x[k % NRING]       = x;
+  dev.p[(k + 1) % NRING] = dev.p[k % NRING] + x;
+
+  for (i=0; i<B2B_JITTER_NTAU; i++) {
+    m = (uint64_t)1 << i;
+    if (k < 2 * m) break;
+    d = x - 2 * dev.x[(k - m) % NRING] + dev.x[(k - 2 * m) % NRING];
+    dev.sumAdev[i] += d * d;
+    disJitterDev.nAdev[i]++;
+    if (k + 1 < 3 * m) continue;
+    d = dev.p[(k + 1) % NRING] - 3 * dev.p[(k + 1 - m) % NRING] + 3 * dev.p[(k + 1 - 2 * m) % NRING] - dev.p[(k + 1 - 3 * m) % NRING];
+    dev.sumTdev[i] += d * d;
+    disJitterDev.nTdev[i]++;
+  } // for i
+
+  dev.k++;
+} // addDeviation
+
+
+// calculate Allan deviation and time deviation from the sums
+void calcDeviation()
+{
+  double tau;
+  double m;
+  int    i;
+
+  for (i=0; i<B2B_JITTER_NTAU; i++) {
+    m   = disJitterDev.tau[i];
+    tau = m * ONESEC;                                                   // [ns], as phase is in [ns]
+    if (disJitterDev.nAdev[i] > 0) disJitterDev.adev[i] = sqrt(dev.sumAdev[i] / (2.0 * disJitterDev.nAdev[i] * tau * tau));
+    if (disJitterDev.nTdev[i] > 0) disJitterDev.tdev[i] = sqrt(dev.sumTdev[i] / (6.0 * m * m * disJitterDev.nTdev[i]));
+  } // for i
+} // calcDeviation
+
+
 // calc basic statistic properties
 void calcStats(double *meanNew,         // new mean value, please remember for later
                double meanOld,          // old mean value (required for 'running stats')
@@ -165,19 +266,33 @@ static void timingMessage(uint32_t tag, saftlib::Time deadline, uint64_t evtId,
   double    tSdev            = 0;
   double    dummy;
 
-  if (tsReceiver->getLocked() && ppsReceiver->getLocked()) sprintf(disState, "%s", b2b_state_text(COMMON_STATE_OPREADY));
-  else                                                     sprintf(disState, "%s", b2b_state_text(COMMON_STATE_ERROR));
+  double    xAct;                   // phase; as tAct, but in the range -0.5s .. 0.5s
+  static double xPrev;              // phase of previous PPS
+  static uint64_t secPrev;          // second of previous PPS
+
+  if (!flagReplay) {
+    if (tsReceiver->getLocked() && ppsReceiver->getLocked()) sprintf(disState, "%s", b2b_state_text(COMMON_STATE_OPREADY));
+    else                                                     sprintf(disState, "%s", b2b_state_text(COMMON_STATE_ERROR));
+  } // if !flagReplay
 
-  if (tag == 17) {
-    tAct = deadline.getTAI() % 1000000000;
+  if (tag == TAGPPS) {
+    tAct = deadline.getTAI() % ONESEC;
+    xAct = (tAct < ONESEC / 2) ? tAct : tAct - ONESEC;
       
     // statistics
     tN++;
     calcStats(&tAve, tAveOld, &tmpStream, tStreamOld, tAct, tN , &dummy, &tSdev);
     tAveOld          = tAve;
     tStreamOld       = tmpStream;
-    if (tAct < tMin) tMin = tAct;
-    if (tAct > tMax) tMax = tAct;
+    if (tAct < tMin) {tMin = tAct; disJitterDev.ppsMin = tAct; disJitterDev.ppsMinTime = deadline.getTAI();}
+    if (tAct > tMax) {tMax = tAct; disJitterDev.ppsMax = tAct; disJitterDev.ppsMaxTime = deadline.getTAI();}
+
+    // deviations and histograms
+    addDeviation(deadline.getTAI() / ONESEC, xAct);
+    disJitterHist.dev[b2b_hist_bin(tAct - tAve)]++;
+    if ((tN > 1) && (deadline.getTAI() / ONESEC == secPrev + 1)) disJitterHist.diff[b2b_hist_bin(xAct - xPrev)]++;
+    xPrev            = xAct;
+    secPrev          = deadline.getTAI() / ONESEC;
     
     //printf("# %6d, act %f, ave %f, sdev %f, min %f, max %f\n", tN, tAct, tAve, tSdev, tMin, tMax);
     
@@ -192,7 +307,12 @@ static void timingMessage(uint32_t tag, saftlib::Time deadline, uint64_t evtId,
     disJitterChk.ppsAct  = NAN;
   } // else locked
 
+  if (flagReplay) return;
+
+  calcDeviation();
   dis_update_service(disJitterChkId);
+  dis_update_service(disJitterDevId);
+  dis_update_service(disJitterHistId);
   dis_update_service(disStateId);
 } // timingMessage
 
@@ -209,14 +329,71 @@ static void recTimeout()
 // this will be called when receiving ECA actions from software action queue
 static void recTimingMessage(uint64_t id, uint64_t param, saftlib::Time deadline, saftlib::Time executed, uint16_t flags, uint32_t tag)
 {
-  int flagLate;
+  int      flagLate;
+  ecamsg_t msg;
 
   flagLate    = flags & 0x1;
 
   timingMessage(tag, deadline, id, param, 0x0, flagLate, 0, 0, 0);
+
+  if (record) {
+    msg.evtId    = id;
+    msg.param    = param;
+    msg.deadline = deadline.getTAI();
+    msg.executed = executed.getTAI();
+    msg.flags    = flags;
+    msg.tef      = 0x0;
+    b2b_record_write(record, &msg);
+  } // if record
 } // recTimingMessag
 
 
+// this will be called for timestamps replayed from a file
+static void replayMessage(uint32_t tag, const ecamsg_t *action)
+{
+  timingMessage(tag, saftlib::makeTimeTAI(action->deadline), action->evtId, action->param, action->tef, action->flags & 0x1, 0, 0, 0);
+} // replayMessage
+
+
+// print results of replay
+static void printResults()
+{
+  time_t secs;
+  char   tMinStr[64];
+  char   tMaxStr[64];
+  double lo, hi;
+  int    center = B2B_HISTNBIN / 2;
+  int    i;
+
+  calcDeviation();
+
+  secs = (time_t)(disJitterDev.ppsMinTime / ONESEC);
+  strftime(tMinStr, sizeof(tMinStr), "%d-%b-%Y_%H:%M:%S", gmtime(&secs));
+  secs = (time_t)(disJitterDev.ppsMaxTime / ONESEC);
+  strftime(tMaxStr, sizeof(tMaxStr), "%d-%b-%Y_%H:%M:%S", gmtime(&secs));
+
+  printf("PPS phase [ns]: n %u, mean %.3f, sdev %.3f, gaps %u\n", disJitterChk.ppsN, disJitterChk.ppsMean, disJitterChk.ppsSdev, disJitterDev.nGap);
+  printf("  min %.3f at %s (TAI)\n", disJitterDev.ppsMin, tMinStr);
+  printf("  max %.3f at %s (TAI)\n", disJitterDev.ppsMax, tMaxStr);
+  printf("%8s %12s %8s %12s %8s\n", "tau [s]", "adev", "n", "tdev [ns]", "n");
+  for (i=0; i<B2B_JITTER_NTAU; i++)
+    printf("%8.0f %12.4e %8u %12.4f %8u\n", disJitterDev.tau[i], disJitterDev.adev[i], disJitterDev.nAdev[i], disJitterDev.tdev[i], disJitterDev.nTdev[i]);
+
+  if (!flagVerbose) return;
+  printf("%24s %10s %10s\n", "bin [ns]", "deviation", "difference");
+  for (i=0; i<B2B_HISTNBIN; i++) {
+    if ((disJitterHist.dev[i] == 0) && (disJitterHist.diff[i] == 0)) continue;
+    if (i == center) {lo = -pow(10, B2B_HISTMINEXP); hi = -lo;}
+    else {
+      lo = pow(10, B2B_HISTMINEXP + (double)(abs(i - center) - 1) / B2B_HISTBINDEC);
+      hi = pow(10, B2B_HISTMINEXP + (double)(abs(i - center)    ) / B2B_HISTBINDEC);
+      if (i < center) {hi = -lo; lo = -pow(10, B2B_HISTMINEXP + (double)(center - i) / B2B_HISTBINDEC);}
+    } // else center
+    printf("%11.3g .. %10.3g %10u %10u\n", lo, hi, disJitterHist.dev[i], disJitterHist.diff[i]);
+  } // for i
+} // printResults
+
+
 // call back for command
 class RecvCommand : public DimCommand
 {
@@ -249,6 +426,12 @@ void disAddServices(char *prefix)
   // jitter data
   sprintf(name, "%s-jitter-check_data", prefix);
   disJitterChkId  = dis_add_service(name, "D:1;I:1;D:4", &(disJitterChk), sizeof(jitterChk_t), 0, 0);
+
+  sprintf(name, "%s-jitter-check_dev", prefix);
+  disJitterDevId  = dis_add_service(name, "D:36;I:24;D:1;X:1;D:1;X:1;I:2", &(disJitterDev), sizeof(jitterDev_t), 0, 0);
+
+  sprintf(name, "%s-jitter-check_hist", prefix);
+  disJitterHistId = dis_add_service(name, "I:146", &(disJitterHist), sizeof(jitterHist_t), 0, 0);
 } // disAddServices
 
                         
@@ -262,12 +445,19 @@ static void help(void) {
   std::cerr << "  -p <n>               specify number of IO where PPS is generated (default '1')" << std::endl;
   std::cerr << "  -t <n>               specify number of IO where timestamp is acquired (default '1')" << std::endl;
   std::cerr << "  -h                   display this help and exit" << std::endl;
+  std::cerr << "  -W <file>            record received timestamps to file" << std::endl;
+  std::cerr << "  -R <file>            replay recorded timestamps from file at maximum speed (no devices, no DIM server)" << std::endl;
+  std::cerr << "  -v                   replay: print histograms" << std::endl;
   std::cerr << std::endl;
   std::cerr << std::endl;
   std::cerr << "This tool uses two timing receivers where IOs are connected via a cable. A PPS pulse is generated on the first" << std::endl;
   std::cerr << "TR, while the a timestamp of the PPS is measured at the second TR. The result is published via DIM." << std::endl;
+  std::cerr << "Besides simple statistics, the overlapping Allan deviation and the time deviation for tau = 1s .. " << (1 << (B2B_JITTER_NTAU - 1)) << "s" << std::endl;
+  std::cerr << "and logarithmic histograms of the deviation from the mean value and of the difference to the previous PPS" << std::endl;
+  std::cerr << "are provided. A missing PPS restarts the calculation of the deviations, the sums are kept." << std::endl;
   std::cerr << std::endl;
   std::cerr << "Example1: '" << program << " tr0 tr1 -p2 -t2'" << std::endl;
+  std::cerr << "Example2: '" << program << " -t2 -R pps.b2br'" << std::endl;
   std::cerr << std::endl;
 
   std::cerr << "Report bugs to <d.beck@gsi.de> !!!" << std::endl;
@@ -396,10 +586,13 @@ int main(int argc, char** argv)
 
   uint64_t evtPrefix = 0xffffa00000000000;
   uint64_t ioPrefix  = 0x0;
+  ecacond_t cond;
+  char     *replayName = NULL;
+  char     *recordName = NULL;
 
   // parse for options
   program = argv[0];
-  while ((opt = getopt(argc, argv, "p:t:h")) != -1) {
+  while ((opt = getopt(argc, argv, "p:t:hR:W:v")) != -1) {
     switch (opt) {
       case 'p' :
         ioPPS = strtol(optarg, &tail, 0);
@@ -423,6 +616,16 @@ int main(int argc, char** argv)
           return 1;
         } // if *tail
         break;
+      case 'R' :
+        replayName  = optarg;
+        flagReplay  = 1;
+        break;
+      case 'W' :
+        recordName  = optarg;
+        break;
+      case 'v' :
+        flagVerbose = 1;
+        break;
       case 'h':
         help();
         return 0;
@@ -432,6 +635,26 @@ int main(int argc, char** argv)
     } // switch opt
   }   // while opt
 
+  // configure condition; convention: prefix contains io number
+  ioPrefix    = (uint64_t)ioTS << 36;
+  evtPrefix  |= ioPrefix;            
+  snoopID     = evtPrefix + 0x1; // last bit is set: rising edge
+  cond.id     = snoopID;
+  cond.mask   = 0xffffffffffffffff;
+  cond.offset = 0;
+  cond.tag    = TAGPPS;
+
+  // replay: no devices, no DIM server
+  if (flagReplay) {
+    clearStats();
+    if (b2b_replay_run(replayName, &cond, 1, &replayMessage) != COMMON_STATUS_OK) {
+      std::cerr << program << ": can't replay file " << replayName << std::endl;
+      return 1;
+    } // if replay
+    printResults();
+    return 0;
+  } // if flagReplay
+
   if (optind >= argc) {
     std::cerr << program << " expecting two non-optional arguments: <device name PPS> <device name TS>" << std::endl;
     help();
@@ -498,17 +721,19 @@ int main(int argc, char** argv)
     std::shared_ptr<SoftwareActionSink_Proxy> sink = SoftwareActionSink_Proxy::create(tsReceiver->NewSoftwareActionSink(""));
     std::shared_ptr<SoftwareCondition_Proxy> condition;
 
-    // configure condition; convention: prefix contains io number
-    ioPrefix   = (uint64_t)ioTS << 36;
-    evtPrefix |= ioPrefix;            
-    snoopID    = evtPrefix + 0x1; // last bit is set: rising edge
+    // configure condition
     //printf("id %llx\n", snoopID);
-    condition  = SoftwareCondition_Proxy::create(sink->NewCondition(false, snoopID, 0xffffffffffffffff, 0));
+    condition  = SoftwareCondition_Proxy::create(sink->NewCondition(false, cond.id, cond.mask, cond.offset));
     condition->setAcceptLate(true);
     condition->setAcceptEarly(true);
     condition->setAcceptConflict(true);
     condition->setAcceptDelayed(true);
-    condition->SigAction.connect(sigc::bind(sigc::ptr_fun(&recTimingMessage), 17));
+    condition->SigAction.connect(sigc::bind(sigc::ptr_fun(&recTimingMessage), cond.tag));
+
+    if (recordName && (b2b_record_open(&record, recordName) != COMMON_STATUS_OK)) {
+      std::cerr << program << ": can't create file " << recordName << std::endl;
+      exit(1);
+    } // if recordName
 
     // configure input to create an event (with timestamp) when LVTTL input is received
     tsInProxy->setEventEnable(false);
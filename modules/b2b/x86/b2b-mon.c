@@ -3,10 +3,13 @@
  *
  *  created : 2021
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 20-Nov-2023
+ *  version : 18-Oct-2026
  *
  * subscribes to and displays status of many b2b transfers
  *
+ * updates are tracked per SID; bursts of updates are coalesced to a frame rate and only
+ * the lines that changed are written to the terminal
+ *
  * ------------------------------------------------------------------------------------------
  * License Agreement for this software:
  *
@@ -34,7 +37,7 @@
  * For all questions and ideas contact: d.beck@gsi.de
  * Last update: 15-April-2019
  *********************************************************************************************/
-#define B2B_MON_VERSION 0x000702
+#define B2B_MON_VERSION 0x000800
 
 // standard includes 
 #include <unistd.h> // getopt
@@ -63,6 +66,9 @@ const char* program;
 #define  TINACTIVE   3600                 // [s]; if the previous data is more in the past than this value, the transfer data is considered inactive
 #define  TOLD        3600 * 24            // [s]; if the previous data is more in the past than this value, the transfer data is considered out of date
 #define  CLIGHT      299792458.0          // speed-of-light in vacuum
+#define  TREBUILD    60                   // [s]; all lines are rebuilt periodically, as the text depends on the age of the data
+#define  FPSDEFAULT  2                    // default frame rate [Hz]
+#define  MINLINES    20                   // minimum number of data lines on screen
 
 uint32_t no_link_32    = 0xdeadbeef;
 uint64_t no_link_64    = 0xdeadbeefce420651;
@@ -102,7 +108,7 @@ uint32_t  dicKickLenInjId[NALLSID];
 
 // set values
 uint32_t flagSetValid[NALLSID];                             // flag: data of this set are valid
-uint32_t flagSetUpdate[NALLSID];                            // flag: update displayed data of this set
+uint32_t flagSetUpdate[NALLSID];                            // flag: update displayed data of this set; set by any service of this SID
 uint32_t set_mode[NALLSID];                                 // b2b mode
 double   set_extT[NALLSID];                                 // extraction, h=1 period [ns]
 double   set_extNue[NALLSID];                               // extraction, h=1 frequency [Hz]
@@ -132,8 +138,8 @@ int      flagPrintOther;                                    // flag: print alter
 int      flagPrintSis18;                                    // flag: print SIDs for SIS18
 int      flagPrintEsr;                                      // flag: print SIDs for ESR
 int      flagPrintYr;                                       // flag: print SIDs for CRYRINg
-int      flagPrintNow;                                      // flag: print stuff to screen NOW
 int      flagPrintNs;                                       // flag: in units of nanoseconds
+uint32_t fps;                                               // frame rate [Hz]
 
 int      modeMask;                                          // mask: marks events used in actual mode
 
@@ -148,6 +154,14 @@ char     printLineN[NALLSID][SCREENWIDTH+1];                // lines to be print
 
 double   one_ns_as = 1000000000.0;
 
+// benchmark
+int      flagBench;                                         // flag: headless benchmark with synthetic updates, no DIM
+uint64_t benchNUpdate;                                      // number of updates
+uint64_t benchNBuild;                                       // number of lines built
+uint64_t benchNLine;                                        // number of lines written
+uint64_t benchNByte;                                        // number of bytes written
+uint64_t benchNFull;                                        // number of bytes that a redraw of the full screen would have written
+
 
 // help
 static void help(void) {
@@ -155,9 +169,13 @@ static void help(void) {
   fprintf(stderr, "\n");
   fprintf(stderr, "  -h                  display this help and exit\n");
   fprintf(stderr, "  -e                  display version\n");
+  fprintf(stderr, "  -f <fps>            frame rate of screen updates, default %d Hz\n", FPSDEFAULT);
+  fprintf(stderr, "  -b <n>              headless benchmark: render <n> frames from synthetic updates, no DIM\n");
   fprintf(stderr, "\n");
   fprintf(stderr, "Use this tool to display information on all transfers of the B2B system\n");
+  fprintf(stderr, "Updates of services are coalesced per SID and frame, only lines that changed are written to the terminal.\n");
   fprintf(stderr, "Example1: '%s pro'\n", program);
+  fprintf(stderr, "Example2: '%s -b 10000'\n", program);
   fprintf(stderr, "\n");
   fprintf(stderr, "Report software bugs to <d.beck@gsi.de>\n");
   fprintf(stderr, "Version %s. Licensed under the LPL v3.\n", b2b_version_text(B2B_MON_VERSION));
@@ -454,16 +472,62 @@ void buildPrintLine(uint32_t idx)
 
 } //buildPrintLine
 
+// convert set values for display
+void convSetvalue(uint32_t idx, setval_t *tmp, uint32_t secs, uint32_t msecs)
+{
+  uint64_t actNsecs;
+  time_t   actT;
+
+  set_mode[idx]      = (*tmp).mode;
+  set_cPhase[idx]    = (*tmp).cPhase;
+
+  if ((*tmp).ext_T == -1) {
+    set_extT[idx]    = 0.0;
+    set_extNue[idx]  = 0.0;
+    set_cPhaseD[idx] = 0.0;
+  } // if extT
+  else {
+    set_extT[idx]    = (double)((*tmp).ext_T)/1000000000.0;
+    set_extNue[idx]  = 1000000000.0 / set_extT[idx];
+    set_cPhaseD[idx] = (double)((*tmp).cPhase) / (double)(set_extT[idx]) * 360.0; 
+  } // else extT
+
+  if ((*tmp).ext_h == -1) set_extH[idx] = 0;
+  else                    set_extH[idx] = (*tmp).ext_h;
+  
+  set_extCTrig[idx]  = (*tmp).ext_cTrig;
+
+  if ((*tmp).inj_T == -1) {
+    set_injT[idx]    = 0.0;
+    set_injNue[idx]  = 0.0;
+  } // if injT
+  else {
+    set_injT[idx]    = (double)((*tmp).inj_T)/1000000000.0;
+    set_injNue[idx]  = 1000000000.0 / set_injT[idx];
+  } // else injT
+
+  if ((*tmp).inj_h == -1) set_injH[idx] = 0;
+  else                    set_injH[idx] = (*tmp).inj_h;
+  
+  set_injCTrig[idx]  = (*tmp).inj_cTrig;
+
+  set_msecs[idx]     = msecs;
+  set_secs[idx]      = (time_t)(secs);
+
+  // calibrate offset between THIS system time and time of set_values
+  actNsecs           = comlib_getSysTime();
+  actT               = (time_t)(actNsecs / 1000000000);
+  secsOffset         = actT - set_secs[idx];
+} // convSetvalue
+
+
 // receive set values
 void recSetvalue(long *tag, setval_t *address, int *size)
 {
-  setval_t *tmp;
   uint32_t secs;
+  uint32_t msecs;
   uint32_t idx;
 
-  uint64_t actNsecs;
-  time_t   actT;
-
   /* printf("tag %lx\n", *tag); */
   if ((*tag < 0) || (*tag >= NALLSID)) return;
   idx = (uint32_t)(*tag);
@@ -472,54 +536,40 @@ void recSetvalue(long *tag, setval_t *address, int *size)
   flagSetValid[idx] = (*size != sizeof(uint32_t));
 
   if (flagSetValid[idx]) {
-    tmp = address;
+    dic_get_timestamp(0, &secs, &msecs);
+    convSetvalue(idx, address, secs, msecs);
+  } // if flagSetValid
+  else set_mode[idx] = 0;
 
-    set_mode[idx]      = (*tmp).mode;
-    set_cPhase[idx]    = (*tmp).cPhase;
+  flagSetUpdate[idx] = 1;
+} // recSetValue
 
-    if ((*tmp).ext_T == -1) {
-      set_extT[idx]    = 0.0;
-      set_extNue[idx]  = 0.0;
-      set_cPhaseD[idx] = 0.0;
-    } // if extT
-    else {
-      set_extT[idx]    = (double)((*tmp).ext_T)/1000000000.0;
-      set_extNue[idx]  = 1000000000.0 / set_extT[idx];
-      set_cPhaseD[idx] = (double)((*tmp).cPhase) / (double)(set_extT[idx]) * 360.0; 
-    } // else extT
 
-    if ((*tmp).ext_h == -1) set_extH[idx] = 0;
-    else                    set_extH[idx] = (*tmp).ext_h;
-    
-    set_extCTrig[idx]  = (*tmp).ext_cTrig;
+// receive any other service of a SID; the data are used when the line is rebuilt
+void recSidvalue(long *tag, void *address, int *size)
+{
+  if ((*tag < 0) || (*tag >= NALLSID)) return;
+  flagSetUpdate[*tag] = 1;
+} // recSidvalue
 
-    if ((*tmp).inj_T == -1) {
-      set_injT[idx]    = 0.0;
-      set_injNue[idx]  = 0.0;
-    } // if injT
-    else {
-      set_injT[idx]    = (double)((*tmp).inj_T)/1000000000.0;
-      set_injNue[idx]  = 1000000000.0 / set_injT[idx];
-    } // else injT
 
-    if ((*tmp).inj_h == -1) set_injH[idx] = 0;
-    else                    set_injH[idx] = (*tmp).inj_h;
-    
-    set_injCTrig[idx]  = (*tmp).inj_cTrig;
+// receive kicker length at injection; this is displayed in the lines of the extraction ring
+void recKickLenInj(long *tag, void *address, int *size)
+{
+  int i;
 
-    dic_get_timestamp(0, &secs, &(set_msecs[idx]));
-    set_secs[idx]      = (time_t)(secs);
+  if ((*tag < 0) || (*tag >= NALLSID)) return;
+  for (i=0; i<NALLSID; i++) if ((flagSetValid[i]) && (i / 16 + 1 == *tag / 16) && (dicSetval[i].inj_sid == *tag % 16)) flagSetUpdate[i] = 1;
+} // recKickLenInj
 
-    // calibrate offset between THIS system time and time of set_values
-    actNsecs           = comlib_getSysTime();
-    actT               = (time_t)(actNsecs / 1000000000);
-    secsOffset         = actT - set_secs[idx];
-  } // if flagSetValid
-  else set_mode[idx] = 0;
 
-  flagSetUpdate[idx] = 1;
-  flagPrintNow = 1;
-} // recSetValue
+// receive level of comparator; changes rarely, thus just rebuild all lines
+void recLevel(long *tag, void *address, int *size)
+{
+  int i;
+
+  for (i=0; i<NALLSID; i++) flagSetUpdate[i] = 1;
+} // recLevel
 
 
 // add all dim services
@@ -544,19 +594,19 @@ void dicSubscribeServices(char *prefix, uint32_t idx)
 
   sprintf(name, "%s_%s-raw_sid%02d_getval", prefix, ringName, sid);
   /* printf("name %s\n", name); */
-  dicGetvalId[idx]       = dic_info_service_stamped(name, MONITORED, 0, &(dicGetval[idx]), sizeof(getval_t), 0 , 0, &no_link_32, sizeof(uint32_t));
+  dicGetvalId[idx]       = dic_info_service_stamped(name, MONITORED, 0, &(dicGetval[idx]), sizeof(getval_t), recSidvalue, (long)idx, &no_link_32, sizeof(uint32_t));
 
   sprintf(name, "%s_%s-cal_diag_sid%02d", prefix, ringName, sid);
   /* printf("name %s\n", name); */
-  dicDiagvalId[idx]      = dic_info_service_stamped(name, MONITORED, 0, &(dicDiagval[idx]), sizeof(diagval_t), 0 , 0, &no_link_32, sizeof(uint32_t));
+  dicDiagvalId[idx]      = dic_info_service_stamped(name, MONITORED, 0, &(dicDiagval[idx]), sizeof(diagval_t), recSidvalue, (long)idx, &no_link_32, sizeof(uint32_t));
 
   sprintf(name, "%s_%s-cal_stat_sid%02d", prefix, ringName,  sid);
   /* printf("name %s\n", name); */
-  dicDiagstatId[idx]     = dic_info_service_stamped(name, MONITORED, 0, &(dicDiagstat[idx]), sizeof(diagstat_t), 0 , 0, &no_link_32, sizeof(uint32_t));
+  dicDiagstatId[idx]     = dic_info_service_stamped(name, MONITORED, 0, &(dicDiagstat[idx]), sizeof(diagstat_t), recSidvalue, (long)idx, &no_link_32, sizeof(uint32_t));
 
   sprintf(name,"%s_%s-pname_sid%02d", prefix, ringName, sid);
   /* printf("name %s\n", name);*/
-  dicPNameId[idx]        = dic_info_service_stamped(name, MONITORED, 0, &(dicPName[idx]), DIMMAXSIZE, 0 , 0, &no_link_str, sizeof(no_link_str));  
+  dicPNameId[idx]        = dic_info_service_stamped(name, MONITORED, 0, &(dicPName[idx]), DIMMAXSIZE, recSidvalue, (long)idx, &no_link_str, sizeof(no_link_str));  
 } // dicSubscribeServices
 
 
@@ -579,10 +629,10 @@ void dicSubscribeKickLenServices(char *prefix, uint32_t idx)
 
   sprintf(name, "%s_%s-kdde_sid%02d_len", prefix, ringName,  sid);
   /* printf("name %s\n", name); */
-  dicKickLenExtId[idx]      = dic_info_service_stamped(name, MONITORED, 0, &(dicKickLenExt[idx]), sizeof(double), 0 , 0, &no_link_dbl, sizeof(double));
+  dicKickLenExtId[idx]      = dic_info_service_stamped(name, MONITORED, 0, &(dicKickLenExt[idx]), sizeof(double), recSidvalue, (long)idx, &no_link_dbl, sizeof(double));
   sprintf(name, "%s_%s-kddi_sid%02d_len", prefix, ringName,  sid);
   /* printf("name %s\n", name); */
-  dicKickLenInjId[idx]      = dic_info_service_stamped(name, MONITORED, 0, &(dicKickLenInj[idx]), sizeof(double), 0 , 0, &no_link_dbl, sizeof(double));
+  dicKickLenInjId[idx]      = dic_info_service_stamped(name, MONITORED, 0, &(dicKickLenInj[idx]), sizeof(double), recKickLenInj, (long)idx, &no_link_dbl, sizeof(double));
 } // dicSubscribeKicklenServices
 
 
@@ -591,19 +641,19 @@ void dicSubscribeLevelServices(char *prefix)
   char     name[DIMMAXSIZE];
   
   sprintf(name, "%s_sis18-kse_setlevel", prefix);
-  dicLevelExtSis18Id = dic_info_service_stamped(name, MONITORED, 0, &dicLevelExtSis18, sizeof(double), 0 , 0, &no_link_32, sizeof(no_link_str));
+  dicLevelExtSis18Id = dic_info_service_stamped(name, MONITORED, 0, &dicLevelExtSis18, sizeof(double), recLevel, 0, &no_link_32, sizeof(no_link_str));
 
   sprintf(name, "%s_esr-ksi_setlevel", prefix);
-  dicLevelInjEsrId   = dic_info_service_stamped(name, MONITORED, 0, &dicLevelInjEsr  , sizeof(double), 0 , 0, &no_link_32, sizeof(no_link_str));
+  dicLevelInjEsrId   = dic_info_service_stamped(name, MONITORED, 0, &dicLevelInjEsr  , sizeof(double), recLevel, 0, &no_link_32, sizeof(no_link_str));
   
   sprintf(name, "%s_esr-kse_setlevel", prefix);
-  dicLevelExtEsrId   = dic_info_service_stamped(name, MONITORED, 0, &dicLevelExtEsr  , sizeof(double), 0 , 0, &no_link_32, sizeof(no_link_str));
+  dicLevelExtEsrId   = dic_info_service_stamped(name, MONITORED, 0, &dicLevelExtEsr  , sizeof(double), recLevel, 0, &no_link_32, sizeof(no_link_str));
   
   sprintf(name, "%s_yr-ksi_setlevel", prefix);
-  dicLevelInjYrId    = dic_info_service_stamped(name, MONITORED, 0, &dicLevelInjYr   , sizeof(double), 0 , 0, &no_link_32, sizeof(no_link_str));
+  dicLevelInjYrId    = dic_info_service_stamped(name, MONITORED, 0, &dicLevelInjYr   , sizeof(double), recLevel, 0, &no_link_32, sizeof(no_link_str));
 
   sprintf(name, "%s_yr-kse_setlevel", prefix);
-  dicLevelExtYrId    = dic_info_service_stamped(name, MONITORED, 0, &dicLevelExtYr   , sizeof(double), 0 , 0, &no_link_32, sizeof(no_link_str));  
+  dicLevelExtYrId    = dic_info_service_stamped(name, MONITORED, 0, &dicLevelExtYr   , sizeof(double), recLevel, 0, &no_link_32, sizeof(no_link_str));  
 } // dicSubscribeLevelServices
 
 // clear status
@@ -611,6 +661,7 @@ void clearStatus()
 {
   printf("not yet implemented, press any key to continue\n");
   while (!comlib_term_getChar()) {usleep(200000);}
+  b2b_screen_invalidate();
 } // clearStatus
 
 
@@ -647,14 +698,25 @@ uint32_t calcFlagPrint()
 } // calcFlagPrint;
 
 
-// print data to screen
+// add a line to the screen
+void addLine(uint32_t *line, const char *text)
+{
+  b2b_screen_line(*line, text);
+  (*line)++;
+  benchNFull += strlen(text) + 1;
+} // addLine
+
+
+// print data to screen; only lines that changed are written
 void printData(char *name)
 {
   char     buff[100];
   char     unitInfo[100];
   time_t   time_date;
   uint32_t nLines;
-  uint32_t minLines = 20;
+  uint32_t line;
+  uint32_t nLine;
+  uint32_t nByte;
   int      i;
 
   nLines = calcFlagPrint();
@@ -666,26 +728,27 @@ void printData(char *name)
   sprintf(title,  "\033[7m B2B Monitor %3s ---------------------------------------------------------------------------------------------------- %s - v%8s\033[0m", name, unitInfo, b2b_version_text(B2B_MON_VERSION));
   sprintf(footer, "\033[7m exit <q> | toggle data <d>, units <u> | toggle inactive <i>, SIS18 <0>, ESR <1>, YR <2> | help <h>                                                 %s\033[0m", buff);
 
-  comlib_term_curpos(1,1);
-
   // printf("123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890\n");
-  printf("%s\n", title);
+  line = 1;
+  addLine(&line, title);
   if (flagPrintOther) {
-    printf("%s\n", headerN);
-    for (i=0; i<NALLSID; i++ ) if (flagPrintIdx[i]) printf("%s\n", printLineN[i]);
-    if (nLines < minLines) for (i=0; i<(minLines-nLines); i++) printf("%s\n", emptyN);
+    addLine(&line, headerN);
+    for (i=0; i<NALLSID; i++ ) if (flagPrintIdx[i]) addLine(&line, printLineN[i]);
+    for (; nLines<MINLINES; nLines++) addLine(&line, emptyN);
   } // if printOther
   else {
-    printf("%s\n", headerK);
-    for (i=0; i<NALLSID; i++ ) if (flagPrintIdx[i]) printf("%s\n", printLineK[i]);
-    if (nLines < minLines) for (i=0; i<(minLines-nLines); i++) printf("%s\n", emptyK);      
+    addLine(&line, headerK);
+    for (i=0; i<NALLSID; i++ ) if (flagPrintIdx[i]) addLine(&line, printLineK[i]);
+    for (; nLines<MINLINES; nLines++) addLine(&line, emptyK);
   } // else printOther
-  printf("%s\n", footer);
+  addLine(&line, footer);
   
   // printf("123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890\n");
-    
-  flagPrintNow = 0;
-} // printServices
+
+  b2b_screen_flush(&nLine, &nByte, !flagBench);
+  benchNLine += nLine;
+  benchNByte += nByte;
+} // printData
   
 
 // print help text to screen
@@ -703,16 +766,127 @@ void printHelpText()
   printf("%s\n", emptyK);
   printf("press any key to continue\n");
   while (!comlib_term_getChar()) {usleep(200000);}
+  b2b_screen_invalidate();
 } // printHelpText
 
 
+// check for new data and update text for later printing; all updates of a SID since the last frame are coalesced
+void buildLines()
+{
+  int i;
+
+  for (i=0; i<NALLSID; i++) {
+    if (flagSetUpdate[i]) {
+      flagSetUpdate[i] = 0;
+      buildPrintLine(i);
+      benchNBuild++;
+    } // if flagSetUpdate
+  } // for i
+} // buildLines
+
+
+// synthetic update of all services of a SID, as for a transfer
+void benchUpdate(uint32_t idx, time_t secs, uint32_t msecs)
+{
+  setval_t set;
+  ring_t   ring;
+  uint32_t sid;
+  double   tmp;
+
+  idx2RingSid(idx, &ring, &sid);
+  if (ring == CRYRING) set.mode = idx % 3;                  // no injection ring after CRYRING
+  else                 set.mode = idx % 5;
+  set.ext_T     = 1000000000000000000 / (800000 + 16 * idx);
+  set.ext_h     = 2;
+  set.ext_cTrig = 100.0 + idx;
+  set.ext_sid   = sid;
+  set.inj_T     = set.ext_T / 2;
+  set.inj_h     = 4;
+  set.inj_cTrig = 200.0 + idx;
+  set.inj_sid   = sid;
+  set.cPhase    = 10.0;
+  dicSetval[idx]    = set;
+  flagSetValid[idx] = 1;
+  convSetvalue(idx, &set, secs, msecs);
+
+  tmp = (double)(rand() % 2000 - 1000);
+  dicGetval[idx].flagEvtRec     = 0xfff;
+  dicGetval[idx].flagEvtErr     = 0x0;
+  dicGetval[idx].ext_dKickMon   = 800.0 + tmp / 100.0;
+  dicGetval[idx].ext_dKickProb  = 1200.0 + tmp / 50.0;
+  dicGetval[idx].inj_dKickMon   = 700.0 - tmp / 100.0;
+  dicGetval[idx].inj_dKickProb  = 1100.0 - tmp / 50.0;
+  dicDiagval[idx].ext_ddsOffAct = tmp / 1000.0;
+  dicDiagval[idx].inj_ddsOffAct = -tmp / 1000.0;
+  dicDiagval[idx].phaseOffAct   = tmp / 200.0;
+  dicDiagval[idx].ext_rfOffAct  = tmp / 1000.0;
+  dicDiagval[idx].inj_rfOffAct  = -tmp / 1000.0;
+  dicDiagval[idx].ext_rfNueAct  = set_extNue[idx] + tmp / 10000.0;
+  dicDiagval[idx].inj_rfNueAct  = set_injNue[idx] - tmp / 10000.0;
+  dicDiagval[idx].ext_rfNueActErr = 0.005;
+  dicDiagval[idx].inj_rfNueActErr = 0.005;
+  dicKickLenExt[idx]            = 2000.0 + tmp / 100.0;
+  dicKickLenInj[idx]            = 2100.0 + tmp / 100.0;
+  sprintf(dicPName[idx], "B2B_BENCH_%02u_%u", idx, rand() % 4);
+  benchNUpdate += 7;                                        // number of services per SID
+
+  flagSetUpdate[idx] = 1;
+} // benchUpdate
+
+
+// headless benchmark: renders frames from synthetic updates without writing to the terminal
+// per frame, a burst of 0..7 transfers hits random SIDs; a SID may be hit more than once per frame
+void benchmark(char *name, uint32_t nFrame)
+{
+  uint32_t i, j;
+  uint32_t nTransfer;
+  uint64_t tStart;
+  uint64_t tStop;
+  time_t   secs;
+  uint32_t msecs;
+
+  srand(1);
+  secs  = time(0);
+  msecs = 0;
+  dicLevelExtSis18 = 1.5;
+  dicLevelInjEsr   = 1.6;
+  dicLevelExtEsr   = 1.7;
+  dicLevelInjYr    = 1.8;
+  dicLevelExtYr    = 1.9;
+
+  tStart = comlib_getSysTime();
+  for (j=0; j<NALLSID; j++) benchUpdate(j, secs, msecs);
+  for (i=0; i<nFrame; i++) {
+    nTransfer = rand() % 8;
+    for (j=0; j<nTransfer; j++) {
+      msecs = (msecs + 7) % 1000;
+      benchUpdate(rand() % NALLSID, secs, msecs);
+    } // for j
+    buildLines();
+    printData(name);
+  } // for i
+  tStop  = comlib_getSysTime();
+
+  printf("%s: benchmark of %u frames with synthetic updates\n", program, nFrame);
+  printf("  updates         : %lu\n", benchNUpdate);
+  printf("  lines built     : %lu\n", benchNBuild);
+  printf("  lines written   : %lu\n", benchNLine);
+  printf("  bytes written   : %lu, full redraw %lu (%.1f%%)\n", benchNByte, benchNFull, 100.0 * (double)benchNByte / (double)benchNFull);
+  printf("  time per frame  : %.2f us\n", (double)(tStop - tStart) / 1000.0 / (double)nFrame);
+} // benchmark
+
+
 int main(int argc, char** argv)
 {
   int opt, error = 0;
   int exitCode   = 0;
-  //  char *tail;
+  char *tail;
 
   int      getVersion;
+  uint32_t nFrame;
+  uint64_t tFrame;
+  uint64_t tNext;
+  uint64_t tRebuild;
 
   char     userInput;
   int      quit;
@@ -731,12 +905,30 @@ int main(int argc, char** argv)
   flagPrintYr       = 1;
   flagPrintOther    = 0;
   flagPrintNs       = 0;
+  flagBench         = 0;
+  fps               = FPSDEFAULT;
+  nFrame            = 0;
 
-  while ((opt = getopt(argc, argv, "eh")) != -1) {
+  while ((opt = getopt(argc, argv, "ehf:b:")) != -1) {
     switch (opt) {
       case 'e':
         getVersion = 1;
         break;
+      case 'f':
+        fps = strtoul(optarg, &tail, 0);
+        if ((*tail != 0) || (fps == 0)) {
+          fprintf(stderr, "Specify a proper number, not '%s'!\n", optarg);
+          return 1;
+        } // if *tail
+        break;
+      case 'b':
+        nFrame = strtoul(optarg, &tail, 0);
+        if ((*tail != 0) || (nFrame == 0)) {
+          fprintf(stderr, "Specify a proper number, not '%s'!\n", optarg);
+          return 1;
+        } // if *tail
+        flagBench = 1;
+        break;
       case 'h':
         help();
         return 0;
@@ -770,6 +962,12 @@ int main(int argc, char** argv)
 
   if (getVersion) printf("%s: version %s\n", program, b2b_version_text(B2B_MON_VERSION));
 
+  buildHeader();
+  if (flagBench) {
+    benchmark(name, nFrame);
+    return exitCode;
+  } // if flagBench
+
   comlib_term_clear();
   printf("%s: starting client using prefix %s\n", program, prefix);
   
@@ -782,25 +980,21 @@ int main(int argc, char** argv)
   } // for i
   dicSubscribeLevelServices(prefix);
 
-  buildHeader();
-  flagPrintNow = 1;
-
   // wait a bit, then rebuild all indices
   usleep(1000000);
+  tRebuild = 0;
   
   while (!quit) {
+    tFrame = comlib_getSysTime();
 
-    // check for new data and update text for later printing
-    for (i=0; i<NALLSID; i++) {
-      if (flagSetUpdate[i]) {
-        flagSetUpdate[i] = 0;
-        flagPrintNow     = 1;
-        buildPrintLine(i);
-      } // if flagSetUpdate
-    } // for i
+    // the text depends on the age of the data, thus rebuild all lines from time to time
+    if (tFrame >= tRebuild) {
+      for (i=0; i<NALLSID; i++) flagSetUpdate[i] = 1;
+      tRebuild = tFrame + (uint64_t)TREBUILD * 1000000000;
+    } // if tRebuild
 
-    
-    if (flagPrintNow) printData(name);
+    buildLines();
+    printData(name);
     if (!quit) {
       userInput = comlib_term_getChar();
       switch (userInput) {
@@ -810,44 +1004,41 @@ int main(int argc, char** argv)
         case 'i' :
           // toggle printing of inactive patterns
           comlib_term_clear();
+          b2b_screen_invalidate();
           flagPrintInactive = !flagPrintInactive;
-          flagPrintNow = 1;
           break;
         case '0' :
           // toggle printint of SIS18 patterns
           flagPrintSis18 = !flagPrintSis18;
-          flagPrintNow = 1;
           break;
         case '1' :
           // toggle printing of ESR patterns
           flagPrintEsr = !flagPrintEsr;
-          flagPrintNow = 1;
           break;
         case '2' :
           // toggle printing of CRYRING patterns
           flagPrintYr = !flagPrintYr;
-          flagPrintNow = 1;
           break;
         case 'd' :
           // toggle printing of data (kicker data or other data)
           flagPrintOther = !flagPrintOther;
-          flagPrintNow = 1;
           break;
         case 'u' :
           // toggle printing of units (nanoseconds or degree), 'secret' option
           flagPrintNs  = !flagPrintNs;
           for (i=0; i<NALLSID; i++) buildPrintLine(i);
-          flagPrintNow = 1;
           break;
         case 'h'         :
           printHelpText();
-          flagPrintNow = 1;
           break;
         case 'q'         :
           quit = 1;
           break;
         default          :
-          usleep(500000);
+          // wait for next frame; updates arriving meanwhile are coalesced
+          tNext  = tFrame + 1000000000 / fps;
+          tFrame = comlib_getSysTime();
+          if (tNext > tFrame) usleep((tNext - tFrame) / 1000);
           break;
       } // switch
     } // if !quit
@@ -0,0 +1,424 @@
+/*******************************************************************************************
+ *  b2b-phasefit-bench.c
+ *
+ *  created : 2026
+ *  author  : Dietrich Beck, GSI-Darmstadt
+ *  version : 18-Oct-2026
+ *
+ * replays synthetic or recorded timestamp sets through the phase fit routines of b2b-pm
+ * - reports fit error and processing time (ns and cycles per set) for each variant
+ * - variants: insertion sort + phase fit (firmware), selection of median + phase fit
+ *
+ * ------------------------------------------------------------------------------------------
+ * License Agreement for this software:
+ *
+ * Copyright (C) 2013  Dietrich Beck
+ * GSI Helmholtzzentrum für Schwerionenforschung GmbH
+ * Planckstraße 1
+ * D-64291 Darmstadt
+ * Germany
+ *
+ * Contact: d.beck@gsi.de
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * For all questions and ideas contact: d.beck@gsi.de
+ * Last update: 15-April-2019
+ *********************************************************************************************/
+#define B2B_PHASEFIT_BENCH_VERSION 0x000800
+
+// standard includes
+#include <unistd.h> // getopt
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>                     // __rdtsc
+#define    HAVE_TSC    1
+#else
+#define    HAVE_TSC    0
+#endif
+
+// b2b
+#include <b2blib.h>                        // API
+#include <b2b.h>                           // FW
+#include <b2b-phasefit.h>                  // phase fit
+
+#define    MAXSAMPLES  1024                // max number of timestamps per set
+#define    ONE_NS_AS   1000000000          // 1 ns [as]
+#define    TBASE_NS    1700000000000000000 // base for synthetic timestamps [ns], realistic TAI
+
+// variants
+enum variant{varSort, varSelect, varSortFit, varSelectFit, varN};
+static const char *varName[varN] = {"sort", "select", "sort+fit", "select+fit"};
+
+const char* program;
+
+uint64_t   TH1_as      = 1283767311562;    // h=1 period [as]
+int        method      = PHFIT_SUBNS;      // fit method
+int        nSamples    = B2B_NSAMPLES;     // number of timestamps per synthetic set
+int        nSets       = 100000;           // number of synthetic sets
+uint64_t   noise_as    = 0;                // sigma of noise on edges [as]
+double     pSwap       = 0.0;              // probability of swapping neighbouring timestamps
+double     pMiss       = 0.0;              // probability of a missing timestamp
+
+uint64_t   *stamps;                        // timestamps of all sets [ns]
+uint64_t   *work;                          // working copy of timestamps [ns]
+uint32_t   *setOff;                        // offset of set in 'stamps'
+uint32_t   *setLen;                        // number of timestamps in set
+uint64_t   *truthNs;                       // true phase of set, ns part
+int64_t    *truthAs;                       // true phase of set, sub-ns part [as]
+b2bt_t     *result;                        // fit results
+int        nTotal;                         // number of sets
+int        nStamps;                        // number of timestamps of all sets
+
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION]\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -h                  display this help and exit\n");
+  fprintf(stderr, "  -e                  display version\n");
+  fprintf(stderr, "  -T<rf-period>       h=1 period [as], default %lu\n", TH1_as);
+  fprintf(stderr, "  -t<fit method>      1: sub-ns fit (default); 0: average fit\n");
+  fprintf(stderr, "  -f<file>            replay timestamp sets from file instead of using synthetic sets\n");
+  fprintf(stderr, "  -s<nSamples>        synthetic: number of timestamps per set, default %d\n", nSamples);
+  fprintf(stderr, "  -d<nSets>           synthetic: number of sets, default %d\n", nSets);
+  fprintf(stderr, "  -r<noise>           synthetic: sigma of noise on rf edges [as]\n");
+  fprintf(stderr, "  -u<probability>     synthetic: probability that two neighbouring timestamps are swapped\n");
+  fprintf(stderr, "  -x<probability>     synthetic: probability that a timestamp is missing\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Use this tool to benchmark the phase fit of b2b-pm on the host. The same timestamp sets are processed\n");
+  fprintf(stderr, "by all variants. For synthetic sets the fit error is the deviation from the true phase. For replayed\n");
+  fprintf(stderr, "sets, the true phase is unknown and the fit error is the deviation from variant '%s'.\n", varName[varSortFit]);
+  fprintf(stderr, "Errors are modulo the rf-period. A file for replay has one set per line, given as timestamps [ns]\n");
+  fprintf(stderr, "separated by white space; lines starting with '#' are ignored.\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Example1: '%s -T1283767311562 -s32 -r100000000 -u0.05'\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report software bugs to <d.beck@gsi.de>\n");
+  fprintf(stderr, "Version %s. Licensed under the LGPL v3.\n", b2b_version_text(B2B_PHASEFIT_BENCH_VERSION));
+} //help
+
+
+// random gaussian noise
+double randGauss(double sigma)
+{
+  double x1, x2;
+
+  x1 = ((double)random() + 1.0) / ((double)RAND_MAX + 1.0);
+  x2 = (double)random() / (double)RAND_MAX;
+
+  return sigma * sqrt(-2 * log(x1)) * cos(2 * M_PI * x2);
+} // randGauss
+
+
+// allocate buffers; returns 0 on success
+int allocSets(int nSet, int nStamp)
+{
+  stamps  = calloc(nStamp, sizeof(uint64_t));
+  work    = calloc(nStamp, sizeof(uint64_t));
+  setOff  = calloc(nSet,   sizeof(uint32_t));
+  setLen  = calloc(nSet,   sizeof(uint32_t));
+  truthNs = calloc(nSet,   sizeof(uint64_t));
+  truthAs = calloc(nSet,   sizeof(int64_t));
+  result  = calloc(nSet,   sizeof(b2bt_t));
+
+  if (!stamps || !work || !setOff || !setLen || !truthNs || !truthAs || !result) return 1;
+  return 0;
+} // allocSets
+
+
+// generate synthetic sets; the true phase is the first rf edge
+void synthSets()
+{
+  int      i, j, k;
+  uint64_t t0_as;                          // first rf edge, relative to TBASE_NS [as]
+  uint64_t tEdge_as;                       // rf edge [as]
+  uint64_t tmp;
+
+  nStamps = 0;
+  for (i=0; i<nTotal; i++) {
+    t0_as      = ((uint64_t)random() % 1000000) * ONE_NS_AS + (uint64_t)random() % ONE_NS_AS;
+    truthNs[i] = TBASE_NS + t0_as / ONE_NS_AS;
+    truthAs[i] = t0_as % ONE_NS_AS;
+    setOff[i]  = nStamps;
+    k          = 0;
+    for (j=0; k<nSamples; j++) {
+      if ((j > 0) && ((double)random() / (double)RAND_MAX < pMiss)) continue;
+      tEdge_as = t0_as + j * TH1_as;
+      if (noise_as) tEdge_as += (int64_t)randGauss((double)noise_as);
+      stamps[nStamps + k] = TBASE_NS + tEdge_as / ONE_NS_AS;  // timestamps are truncated to ns
+      k++;
+    } // for j
+    for (j=0; j<nSamples-1; j++) {
+      if ((double)random() / (double)RAND_MAX < pSwap) {
+        tmp                     = stamps[nStamps + j];
+        stamps[nStamps + j]     = stamps[nStamps + j + 1];
+        stamps[nStamps + j + 1] = tmp;
+      } // if swap
+    } // for j
+    setLen[i]  = nSamples;
+    nStamps   += nSamples;
+  } // for i
+} // synthSets
+
+
+// read sets from file; returns 0 on success
+int readSets(const char *name)
+{
+  FILE     *in;
+  char     *line = NULL;
+  size_t   len   = 0;
+  char     *pos, *tail;
+  uint64_t ts;
+  int      nSet, nStamp, n;
+
+  if (!(in = fopen(name, "r"))) {
+    fprintf(stderr, "%s: can't open file %s\n", program, name);
+    return 1;
+  } // if in
+
+  // 1st pass: count
+  nSet   = 0;
+  nStamp = 0;
+  while (getline(&line, &len, in) != -1) {
+    if (line[0] == '#') continue;
+    n   = 0;
+    pos = line;
+    while ((ts = strtoull(pos, &tail, 0)), tail != pos) {n++; pos = tail;}
+    if (n > MAXSAMPLES) n = MAXSAMPLES;
+    if (n > 0) {nSet++; nStamp += n;}
+  } // while getline
+  if (!nSet) {
+    fprintf(stderr, "%s: no timestamps in file %s\n", program, name);
+    fclose(in);
+    free(line);
+    return 1;
+  } // if !nSet
+  if (allocSets(nSet, nStamp)) {
+    fprintf(stderr, "%s: can't allocate memory\n", program);
+    fclose(in);
+    free(line);
+    return 1;
+  } // if allocSets
+
+  // 2nd pass: read
+  rewind(in);
+  nTotal  = 0;
+  nStamps = 0;
+  while (getline(&line, &len, in) != -1) {
+    if (line[0] == '#') continue;
+    n   = 0;
+    pos = line;
+    while ((n < MAXSAMPLES) && ((ts = strtoull(pos, &tail, 0)), tail != pos)) {stamps[nStamps + n] = ts; n++; pos = tail;}
+    if (n == 0) continue;
+    setOff[nTotal] = nStamps;
+    setLen[nTotal] = n;
+    nStamps       += n;
+    nTotal++;
+  } // while getline
+
+  fclose(in);
+  free(line);
+
+  return 0;
+} // readSets
+
+
+// process all sets with one variant; returns number of failed fits
+int runVariant(int var, double *ns, double *cycles)
+{
+  struct timespec tStart, tStop;
+  uint64_t        cStart = 0, cStop = 0;
+  uint64_t        *set;
+  uint32_t        n;
+  int             i;
+  int             nFail = 0;
+  volatile uint64_t sink = 0;              // keeps the compiler from discarding results
+
+  memcpy(work, stamps, nStamps * sizeof(uint64_t));
+  for (i=0; i<nTotal; i++) result[i].ns = 0x7fffffffffffffff;
+  clock_gettime(CLOCK_MONOTONIC, &tStart);
+#if HAVE_TSC
+  cStart = __rdtsc();
+#endif
+  for (i=0; i<nTotal; i++) {
+    set = work + setOff[i];
+    n   = setLen[i];
+    switch (var) {
+      case varSort :
+        phfit_insertionSort(set, n);
+        sink += set[n >> 1];
+        break;
+      case varSelect :
+        sink += phfit_select(set, n, n >> 1);
+        break;
+      case varSortFit :
+        if (n > 2) phfit_insertionSort(set, n);
+        if (phfit_phaseFit(set, n, TH1_as, method, &(result[i])) != COMMON_STATUS_OK) nFail++;
+        break;
+      case varSelectFit :
+        if (phfit_phaseFitMedian(set, n, TH1_as, method, &(result[i]), 0) != COMMON_STATUS_OK) nFail++;
+        break;
+      default :
+        break;
+    } // switch var
+  } // for i
+#if HAVE_TSC
+  cStop = __rdtsc();
+#endif
+  clock_gettime(CLOCK_MONOTONIC, &tStop);
+
+  *ns     = ((double)(tStop.tv_sec - tStart.tv_sec) * 1000000000.0 + (double)(tStop.tv_nsec - tStart.tv_nsec)) / (double)nTotal;
+  *cycles = (double)(cStop - cStart) / (double)nTotal;
+
+  return nFail;
+} // runVariant
+
+
+// deviation of fitted from true phase, modulo rf-period [as]
+int64_t fitError(int i)
+{
+  int64_t dev_as;
+  int64_t half_as = TH1_as >> 1;
+
+  dev_as  = (int64_t)(result[i].ns - truthNs[i]) * ONE_NS_AS + (int64_t)result[i].ps * 1000000 - truthAs[i];
+  dev_as %= (int64_t)TH1_as;
+  if (dev_as >   half_as) dev_as -= TH1_as;
+  if (dev_as <= -half_as) dev_as += TH1_as;
+
+  return dev_as;
+} // fitError
+
+
+// print statistics of fit error [ps]
+void printError(int nFail)
+{
+  int     i, n;
+  double  dev, ave, sdev, max;
+
+  n = 0; ave = 0; sdev = 0; max = 0;
+  for (i=0; i<nTotal; i++) {
+    if (result[i].ns == 0x7fffffffffffffff) continue;
+    if (truthNs[i]   == 0x7fffffffffffffff) continue;
+    dev   = (double)fitError(i) / 1000000.0;
+    ave  += dev;
+    sdev += dev * dev;
+    if (fabs(dev) > max) max = fabs(dev);
+    n++;
+  } // for i
+  if (n) {
+    ave  = ave / n;
+    sdev = sqrt(sdev / n - ave * ave);
+  } // if n
+  printf(" %8d %10.1f %10.1f %10.1f", nFail, ave, sdev, max);
+} // printError
+
+
+int main(int argc, char** argv)
+{
+  int      opt, error = 0;
+  char     *tail;
+  char     *fileName = NULL;
+  int      i, var, nFail;
+  double   ns, cycles;
+
+  program = argv[0];
+
+  while ((opt = getopt(argc, argv, "T:t:f:s:d:r:u:x:eh")) != -1) {
+    switch (opt) {
+      case 'T' :
+        TH1_as = strtoull(optarg, &tail, 0);
+        if (*tail != 0 || TH1_as == 0) {fprintf(stderr, "Specify a proper number, not '%s'!\n", optarg); exit(1);}
+        break;
+      case 't' :
+        method = strtol(optarg, &tail, 0) ? PHFIT_SUBNS : PHFIT_AVERAGE;
+        break;
+      case 'f' :
+        fileName = optarg;
+        break;
+      case 's' :
+        nSamples = strtol(optarg, &tail, 0);
+        if (*tail != 0 || nSamples < 3 || nSamples > MAXSAMPLES) {fprintf(stderr, "Specify a number 3..%d, not '%s'!\n", MAXSAMPLES, optarg); exit(1);}
+        break;
+      case 'd' :
+        nSets = strtol(optarg, &tail, 0);
+        if (*tail != 0 || nSets < 1) {fprintf(stderr, "Specify a proper number, not '%s'!\n", optarg); exit(1);}
+        break;
+      case 'r' :
+        noise_as = strtoull(optarg, &tail, 0);
+        break;
+      case 'u' :
+        pSwap = strtod(optarg, &tail);
+        break;
+      case 'x' :
+        pMiss = strtod(optarg, &tail);
+        if (pMiss >= 1.0) {fprintf(stderr, "Specify a probability < 1, not '%s'!\n", optarg); exit(1);}
+        break;
+      case 'e' :
+        printf("b2b: phasefit-bench version %s\n", b2b_version_text(B2B_PHASEFIT_BENCH_VERSION));
+        exit(0);
+        break;
+      case 'h' :
+        help();
+        return 0;
+      default :
+        error = 1;
+        break;
+    } // switch opt
+  } // while opt
+
+  if (error) {
+    help();
+    return 1;
+  } // if error
+
+  if (fileName) {
+    if (readSets(fileName)) return 1;
+  } // if fileName
+  else {
+    nTotal = nSets;
+    if (allocSets(nTotal, nTotal * nSamples)) {fprintf(stderr, "%s: can't allocate memory\n", program); return 1;}
+    srandom(time(NULL));
+    synthSets();
+  } // else fileName
+
+  printf("# sets %d, timestamps %d, TH1 %lu as, fit method %s, time source %s\n", nTotal, nStamps, TH1_as,
+         method == PHFIT_SUBNS ? "sub-ns" : "average", HAVE_TSC ? "clock_gettime and TSC" : "clock_gettime");
+  printf("# %10s %10s %10s %8s %10s %10s %10s\n", "variant", "ns/set", "cycles/set", "failed", "err_ave", "err_sdev", "err_max");
+  printf("# %10s %10s %10s %8s %10s %10s %10s\n", "", "", "", "", "[ps]", "[ps]", "[ps]");
+
+  // the replayed sets have no true phase; take it from the firmware variant
+  if (fileName) {
+    runVariant(varSortFit, &ns, &cycles);
+    for (i=0; i<nTotal; i++) {
+      truthNs[i] = result[i].ns;
+      truthAs[i] = (int64_t)result[i].ps * 1000000;
+    } // for i
+  } // if fileName
+
+  for (var=0; var<varN; var++) {
+    nFail = runVariant(var, &ns, &cycles);
+    printf("  %10s %10.1f", varName[var], ns);
+    if (HAVE_TSC) printf(" %10.0f", cycles);
+    else          printf(" %10s", "n/a");
+    if ((var == varSortFit) || (var == varSelectFit)) printError(nFail);
+    printf("\n");
+  } // for var
+
+  return 0;
+} // main
@@ -0,0 +1,331 @@
+/*******************************************************************************************
+ *  b2b-phasematch-test.c
+ *
+ *  created : 2026
+ *  author  : Dietrich Beck, GSI-Darmstadt
+ *  version : 18-Oct-2026
+ *
+ * compares the phase match search of b2b-cbu with reference results for random settings
+ * - exhaustive: all h=1 edges of extraction within the window, must give identical results
+ * - probing   : the previous multi-beat probing of b2b-cbu (without timeout), for comparison
+ *
+ * ------------------------------------------------------------------------------------------
+ * License Agreement for this software:
+ *
+ * Copyright (C) 2013  Dietrich Beck
+ * GSI Helmholtzzentrum für Schwerionenforschung GmbH
+ * Planckstraße 1
+ * D-64291 Darmstadt
+ * Germany
+ *
+ * Contact: d.beck@gsi.de
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * For all questions and ideas contact: d.beck@gsi.de
+ * Last update: 15-April-2019
+ *********************************************************************************************/
+#define B2B_PHASEMATCH_TEST_VERSION 0x000800
+
+// standard includes
+#include <unistd.h> // getopt
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+// b2b
+#include <b2blib.h>                        // API
+#include <b2b.h>                           // FW
+#include <b2b-phasematch.h>                // phase match
+
+#define    ONE_NS_AS   1000000000ULL       // 1 ns [as]
+
+const char* program;
+
+int        nCases      = 2000;             // number of random cases
+uint64_t   seed;                           // seed for random numbers
+int        verbose     = 0;                // print each case
+
+// settings of one case
+typedef struct {
+  uint64_t TH1Ext_as;                      // h=1 period extraction [as]
+  uint64_t TH1Inj_as;                      // h=1 period injection [as]
+  uint32_t nGExt;                          // geometric harmonic extraction
+  uint32_t nGInj;                          // geometric harmonic injection
+  uint64_t tH1Ext_as;                      // h=1 edge extraction [as]
+  uint64_t tH1Inj_as;                      // h=1 edge injection [as]
+  uint64_t tMin_as;                        // begin of window [as]
+  uint64_t tMax_as;                        // end of window [as]
+} case_t;
+
+
+static void help(void) {
+  fprintf(stderr, "Usage: %s [OPTION]\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -h                  display this help and exit\n");
+  fprintf(stderr, "  -e                  display version\n");
+  fprintf(stderr, "  -n<nCases>          number of random cases, default %d\n", nCases);
+  fprintf(stderr, "  -z<seed>            seed for random numbers, default: time\n");
+  fprintf(stderr, "  -v                  print each case\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Use this tool to test the phase match search of b2b-cbu against an exhaustive search and against\n");
+  fprintf(stderr, "the previous multi-beat probing. Returns 1 if the phase match search and the exhaustive search differ.\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "Report software bugs to <d.beck@gsi.de>\n");
+  fprintf(stderr, "Version %s. Licensed under the LGPL v3.\n", b2b_version_text(B2B_PHASEMATCH_TEST_VERSION));
+} //help
+
+
+// uniform random number in [min, max]
+uint64_t randRange(uint64_t min, uint64_t max)
+{
+  uint64_t r;
+
+  r = ((uint64_t)random() << 31) ^ (uint64_t)random();
+
+  return min + r % (max - min + 1);
+} // randRange
+
+
+// generate a random case, periods and harmonics similar to the rings at GSI/FAIR
+void randCase(case_t *cs)
+{
+  uint32_t nG[] = {1, 1, 1, 2, 4, 5};
+
+  cs->nGExt     = nG[random() % 6];
+  cs->nGInj     = nG[random() % 6];
+  cs->TH1Ext_as = randRange(200 * ONE_NS_AS, 5000 * ONE_NS_AS);
+  // injection ring similar to extraction or an integer multiple; with a small detuning
+  cs->TH1Inj_as = (cs->TH1Ext_as / cs->nGExt) * cs->nGInj;
+  cs->TH1Inj_as = cs->TH1Inj_as + (int64_t)cs->TH1Inj_as / 1000 * ((int64_t)randRange(0, 2000) - 1000) / 1000;
+  cs->tMin_as   = randRange(1000, 1000000) * ONE_NS_AS * 1000;
+  cs->tMax_as   = cs->tMin_as + (uint64_t)(B2B_KICKOFFSETMAX - B2B_KICKOFFSETMIN) * ONE_NS_AS - (ONE_NS_AS >> 1);
+  cs->tH1Ext_as = cs->tMin_as - randRange(0, 100000) * ONE_NS_AS;
+  cs->tH1Inj_as = cs->tMin_as - randRange(0, 100000) * ONE_NS_AS;
+} // randCase
+
+
+// exhaustive search over all h=1 edges of extraction within the window
+void exhaustive(case_t *cs, uint64_t *tMatch_as, int64_t *dt_as)
+{
+  uint64_t t, tE, v, M;
+  int64_t  dev, best = 0;
+  int      first = 1;
+
+  M  = cs->TH1Inj_as;
+  if (cs->tH1Ext_as >= cs->tMin_as) tE = cs->tH1Ext_as - ((cs->tH1Ext_as - cs->tMin_as) / cs->TH1Ext_as) * cs->TH1Ext_as;
+  else                              tE = cs->tH1Ext_as + ((cs->tMin_as - cs->tH1Ext_as + cs->TH1Ext_as - 1) / cs->TH1Ext_as) * cs->TH1Ext_as;
+  for (t = tE; t <= cs->tMax_as; t += cs->TH1Ext_as) {
+    if (t >= cs->tH1Inj_as) v = (t - cs->tH1Inj_as) % M;
+    else                    v = (M - (cs->tH1Inj_as - t) % M) % M;
+    if (v <= M - v) dev = (int64_t)v;
+    else            dev = -(int64_t)(M - v);
+    if (first || (llabs(dev) < llabs(best))) {
+      best       = dev;
+      *tMatch_as = t;
+      first      = 0;
+    } // if better
+  } // for t
+  *dt_as = best;
+} // exhaustive
+
+
+// fine tune for individual h=1 cycles, as in b2b-cbu
+void rfFineTune(case_t *cs, uint64_t *tMatch_as, int64_t *dt_as)
+{
+  uint64_t half, nDiff;
+  uint64_t ftTExt_as, ftTInj_as, ftMatchExt_as, ftMatchInj_as;
+  int64_t  ftDtAs1, ftDtAs2, ftDtAs3;
+
+  ftTExt_as     = cs->TH1Ext_as * cs->nGInj;
+  ftTInj_as     = cs->TH1Inj_as * cs->nGExt;
+
+  half          = cs->TH1Ext_as >> 1;
+  nDiff         = (*tMatch_as - cs->tH1Ext_as) / cs->TH1Ext_as;
+  if (((*tMatch_as - cs->tH1Ext_as) % cs->TH1Ext_as) > half) nDiff++;
+  ftMatchExt_as = cs->tH1Ext_as + nDiff * cs->TH1Ext_as;
+
+  half          = cs->TH1Inj_as >> 1;
+  nDiff         = (ftMatchExt_as - cs->tH1Inj_as) / cs->TH1Inj_as;
+  if (((ftMatchExt_as - cs->tH1Inj_as) % cs->TH1Inj_as) > half) nDiff++;
+  ftMatchInj_as = cs->tH1Inj_as + nDiff * cs->TH1Inj_as;
+
+  ftDtAs1 = (int64_t)(ftMatchExt_as - ftTExt_as) - (int64_t)(ftMatchInj_as - ftTInj_as);
+  ftDtAs2 = (int64_t)(ftMatchExt_as)             - (int64_t)(ftMatchInj_as);
+  ftDtAs3 = (int64_t)(ftMatchExt_as + ftTExt_as) - (int64_t)(ftMatchInj_as + ftTInj_as);
+
+  *tMatch_as = ftMatchExt_as;
+  *dt_as     = ftDtAs2;
+  if (llabs(ftDtAs1) < llabs(ftDtAs2)) {*tMatch_as = ftMatchExt_as - ftTExt_as; *dt_as = ftDtAs1;}
+  if (llabs(ftDtAs3) < llabs(ftDtAs2)) {*tMatch_as = ftMatchExt_as + ftTExt_as; *dt_as = ftDtAs3;}
+} // rfFineTune
+
+
+// multi-beat probing as previously done by b2b-cbu, without timeout; returns 0 if match is within window
+int probing(case_t *cs, uint64_t *tMatch_as, int64_t *dt_as, int *nProbes)
+{
+  uint64_t TRfExt_as, TRfInj_as, TSlow_as, TFast_as, tSlow_as, tFast_as;
+  uint64_t tD0_as, Tdiff_as, half, nDiff, tMatch0_as, TBeat_as, tTmp_as, tMatchTmp_as;
+  int64_t  dtTmp_as;
+  int      i;
+
+  TRfExt_as = cs->TH1Ext_as / cs->nGExt;
+  TRfInj_as = cs->TH1Inj_as / cs->nGInj;
+  if (TRfExt_as == TRfInj_as) return 1;
+
+  if (TRfExt_as > TRfInj_as) {TSlow_as = TRfExt_as; tSlow_as = cs->tH1Ext_as; TFast_as = TRfInj_as; tFast_as = cs->tH1Inj_as;}
+  else                       {TSlow_as = TRfInj_as; tSlow_as = cs->tH1Inj_as; TFast_as = TRfExt_as; tFast_as = cs->tH1Ext_as;}
+  while (tSlow_as > tFast_as)              tFast_as = tFast_as + TFast_as;
+  while ((tFast_as - tSlow_as) > TFast_as) tFast_as = tFast_as - TFast_as;
+
+  tD0_as     = tFast_as - tSlow_as;
+  Tdiff_as   = TSlow_as - TFast_as;
+  half       = Tdiff_as >> 1;
+  nDiff      = tD0_as / Tdiff_as;
+  if ((tD0_as % Tdiff_as) > half) nDiff++;
+  tMatch0_as = nDiff * TSlow_as + tSlow_as;
+  TBeat_as   = (TSlow_as / Tdiff_as) * TSlow_as;
+  while (tMatch0_as < cs->tMin_as) tMatch0_as += TBeat_as;
+
+  half       = cs->TH1Ext_as >> 1;
+  nDiff      = (tMatch0_as - cs->tH1Ext_as) / cs->TH1Ext_as;
+  if (((tMatch0_as - cs->tH1Ext_as) % cs->TH1Ext_as) > half) nDiff++;
+  tMatch0_as = cs->tH1Ext_as + nDiff * cs->TH1Ext_as;
+  if (cs->nGInj > cs->nGExt) {
+    half    = cs->TH1Inj_as >> 1;
+    nDiff   = (tMatch0_as - cs->tH1Inj_as) / cs->TH1Inj_as;
+    if (((tMatch0_as - cs->tH1Inj_as) % cs->TH1Inj_as) > half) nDiff++;
+    tTmp_as = cs->tH1Inj_as + nDiff * cs->TH1Inj_as;
+    while (tTmp_as < tMatch0_as) tTmp_as += cs->TH1Inj_as;
+    while (tTmp_as + (cs->TH1Ext_as >> 1) > tMatch0_as) tMatch0_as += cs->TH1Ext_as;
+  } // if nGInj
+
+  *nProbes   = (ONE_NS_AS * (uint64_t)(B2B_KICKOFFSETMAX - B2B_KICKOFFSETMIN)) / TBeat_as;
+  if (*nProbes < 1) *nProbes = 1;
+  *dt_as     = 999999999999;
+  *tMatch_as = tMatch0_as;
+  for (i=0; i<*nProbes; i++) {
+    tMatchTmp_as = tMatch0_as + (uint64_t)i * TBeat_as;
+    rfFineTune(cs, &tMatchTmp_as, &dtTmp_as);
+    if (llabs(dtTmp_as) < llabs(*dt_as)) {*tMatch_as = tMatchTmp_as; *dt_as = dtTmp_as;}
+  } // for i
+
+  if ((*tMatch_as < cs->tMin_as) || (*tMatch_as > cs->tMax_as)) return 1;
+  return 0;
+} // probing
+
+
+// elapsed time [ns]
+double elapsed(struct timespec *t0, struct timespec *t1)
+{
+  return (double)(t1->tv_sec - t0->tv_sec) * 1000000000.0 + (double)(t1->tv_nsec - t0->tv_nsec);
+} // elapsed
+
+
+int main(int argc, char** argv)
+{
+  int             opt, error = 0;
+  char            *tail;
+  int             i;
+  case_t          cs;
+  uint64_t        tMatch_as, tMatchRef_as, tMatchPrb_as;
+  int64_t         dt_as, dtRef_as, dtPrb_as;
+  int             nProbes;
+  int             nFail = 0, nPrbValid = 0, nPrbWorse = 0;
+  double          excess, sumExcess = 0, maxExcess = 0;
+  double          tMatch_ns = 0, tPrb_ns = 0, tRef_ns = 0;
+  struct timespec t0, t1;
+
+  program = argv[0];
+  seed    = time(NULL);
+
+  while ((opt = getopt(argc, argv, "n:z:veh")) != -1) {
+    switch (opt) {
+      case 'n' :
+        nCases = strtol(optarg, &tail, 0);
+        if (*tail != 0 || nCases < 1) {fprintf(stderr, "Specify a proper number, not '%s'!\n", optarg); exit(1);}
+        break;
+      case 'z' :
+        seed   = strtoull(optarg, &tail, 0);
+        break;
+      case 'v' :
+        verbose = 1;
+        break;
+      case 'e' :
+        printf("b2b: phasematch-test version %s\n", b2b_version_text(B2B_PHASEMATCH_TEST_VERSION));
+        exit(0);
+        break;
+      case 'h' :
+        help();
+        return 0;
+      default :
+        error = 1;
+        break;
+    } // switch opt
+  } // while opt
+
+  if (error) {
+    help();
+    return 1;
+  } // if error
+
+  srandom(seed);
+  for (i=0; i<nCases; i++) {
+    randCase(&cs);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (phmatch_bestMatch(cs.tH1Ext_as, cs.TH1Ext_as, cs.tH1Inj_as, cs.TH1Inj_as, cs.tMin_as, cs.tMax_as, &tMatch_as, &dt_as) != COMMON_STATUS_OK) {
+      printf("case %d: phase match search failed\n", i);
+      nFail++;
+      continue;
+    } // if bestMatch
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    tMatch_ns += elapsed(&t0, &t1);
+
+    exhaustive(&cs, &tMatchRef_as, &dtRef_as);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    tRef_ns   += elapsed(&t1, &t0);
+
+    if ((tMatch_as != tMatchRef_as) || (dt_as != dtRef_as)) {
+      printf("case %d: mismatch, TExt %lu, TInj %lu, tExt %lu, tInj %lu, tMin %lu; search %lu/%ld, exhaustive %lu/%ld\n", i,
+             cs.TH1Ext_as, cs.TH1Inj_as, cs.tH1Ext_as, cs.tH1Inj_as, cs.tMin_as, tMatch_as, dt_as, tMatchRef_as, dtRef_as);
+      nFail++;
+    } // if mismatch
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (!probing(&cs, &tMatchPrb_as, &dtPrb_as, &nProbes)) {
+      nPrbValid++;
+      excess = (double)(llabs(dtPrb_as) - llabs(dt_as)) / 1000000.0;
+      if (excess > 0) nPrbWorse++;
+      if (excess > maxExcess) maxExcess = excess;
+      sumExcess += excess;
+    } // if probing
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    tPrb_ns   += elapsed(&t0, &t1);
+
+    if (verbose) printf("case %5d: TExt %13.6f ns, TInj %13.6f ns, nG %u/%u, dt search %10.3f ps, probing %10.3f ps (%d probes)\n", i,
+                        (double)cs.TH1Ext_as / ONE_NS_AS, (double)cs.TH1Inj_as / ONE_NS_AS, cs.nGExt, cs.nGInj, (double)dt_as / 1000000.0,
+                        (double)dtPrb_as / 1000000.0, nProbes);
+  } // for i
+
+  printf("seed %lu, cases %d, failed %d\n", seed, nCases, nFail);
+  printf("time per case [us]: search %10.3f, exhaustive %10.3f, probing %10.3f\n", tMatch_ns / nCases / 1000.0, tRef_ns / nCases / 1000.0,
+         tPrb_ns / nCases / 1000.0);
+  printf("probing: within window %d, worse than search %d, average excess %.3f ps, max excess %.3f ps\n", nPrbValid, nPrbWorse,
+         nPrbValid ? sumExcess / nPrbValid : 0.0, maxExcess);
+
+  return nFail ? 1 : 0;
+} // main
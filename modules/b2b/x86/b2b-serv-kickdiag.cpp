@@ -3,7 +3,7 @@
  *
  *  created : 2023
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 17-Nov-2023
+ *  version : 18-Oct-2026
  *
  * publishes additional diagnostic data of the kicker
  
@@ -37,7 +37,7 @@
  * For all questions and ideas contact: d.beck@gsi.de
  * Last update: 15-April-2019
  *********************************************************************************************/
-#define B2B_SERV_KICKD_VERSION 0x000702
+#define B2B_SERV_KICKD_VERSION 0x000800
 
 #define __STDC_FORMAT_MACROS
 #define __STDC_CONSTANT_MACROS
@@ -77,6 +77,7 @@ using namespace saftlib;
 using namespace std;
 
 #define FID          0x1                // format ID of timing messages
+#define NCOND        4                  // number of ECA conditions
 
 static const char* program;
 
@@ -114,6 +115,10 @@ uint32_t reqMode;                       // requested mode; 0: extraction, 1: inj
 uint32_t reqIO;                         // requested IO to which the magnet probe signal is connected
 uint32_t reqEvtNo;                      // requested event number
 
+int          flagReplay;                // flag: replay timing messages from file, no DIM services
+int          flagVerbose;               // flag: print published data during replay
+b2b_replay_t *record;                   // recording of received timing messages
+
 // init setval
 void initValues(uint32_t sid)
 {
@@ -128,6 +133,13 @@ void initValues(uint32_t sid)
 // update values
 void disUpdateValues(uint32_t sid)
 {
+  if (flagReplay) {
+    disNTransfer++;
+    if (flagVerbose) printf("sid %2u, risingN %u, fallingN %u, risingOffs %.1f, fallingOffs %.1f, len %.1f\n",
+                            sid, disRisingN[sid], disFallingN[sid], disRisingOffs[sid], disFallingOffs[sid], disLen[sid]);
+    return;
+  } // if flagReplay
+
   dis_update_service(disRisingOffsId[sid]);
   dis_update_service(disFallingOffsId[sid]);
   dis_update_service(disRisingNId[sid]);
@@ -195,13 +207,31 @@ static void recTimeout()
 static void recTimingMessage(uint64_t id, uint64_t param, saftlib::Time deadline, saftlib::Time executed, uint16_t flags, uint32_t tag)
 {
   int                 flagLate;
+  ecamsg_t            msg;
 
   flagLate    = flags & 0x1;
 
   timingMessage(tag, deadline, id, param, 0x0, flagLate, 0, 0, 0);
+
+  if (record && (tag != tagKStop)) {    // actions with offset are created again by the replay
+    msg.evtId    = id;
+    msg.param    = param;
+    msg.deadline = deadline.getTAI();
+    msg.executed = executed.getTAI();
+    msg.flags    = flags;
+    msg.tef      = 0x0;
+    b2b_record_write(record, &msg);
+  } // if record
 } // recTimingMessag
 
 
+// this will be called for actions replayed from a file
+static void replayMessage(uint32_t tag, const ecamsg_t *action)
+{
+  timingMessage(tag, saftlib::makeTimeTAI(action->deadline), action->evtId, action->param, action->tef, action->flags & 0x1, 0, 0, 0);
+} // replayMessage
+
+
 // add all dim services
 void disAddServices(char *prefix)
 {
@@ -238,6 +268,39 @@ void disAddServices(char *prefix)
   } // for i
 } // disAddServices
 
+
+// define conditions (ECA filter rules); used for the ECA and for replay
+static void defineConditions(ecacond_t *cond, uint64_t tluIn)
+{
+  int i;
+
+  // CMD_B2B_EXTTRIG, signals start of data collection
+  cond[0].id     = ((uint64_t)FID << 60) | ((uint64_t)reqRing  << 48) | ((uint64_t)reqEvtNo << 36);
+  cond[0].mask   = 0xfffffff000000000;
+  cond[0].offset = 0;
+  cond[0].tag    = tagKStart;
+
+  // CMD_B2B_EXTTRIG, +100ms (!), signals stop of data collection
+  cond[1].id     = ((uint64_t)FID << 60) | ((uint64_t)reqRing  << 48) | ((uint64_t)reqEvtNo << 36);
+  cond[1].mask   = 0xfffffff000000000;
+  cond[1].offset = 100000000;
+  cond[1].tag    = tagKStop;
+
+  // IO input rising edge
+  cond[2].id     = ((uint64_t)0xf << 60) | ((uint64_t)0xfff  << 48) | ((uint64_t)tluIn << 36 | (uint64_t)000000001);
+  cond[2].mask   = 0xffffffffffffffff;
+  cond[2].offset = 0;
+  cond[2].tag    = tagKRising;
+
+  // IO input falling edge
+  cond[3].id     = ((uint64_t)0xf << 60) | ((uint64_t)0xfff  << 48) | ((uint64_t)tluIn << 36 | (uint64_t)000000000);
+  cond[3].mask   = 0xffffffffffffffff;
+  cond[3].offset = 0;
+  cond[3].tag    = tagKFalling;
+
+  for (i=0; i<NCOND; i++) cond[i].reserved = 0;
+} // defineConditions
+
                         
 using namespace saftlib;
 using namespace std;
@@ -251,11 +314,17 @@ static void help(void) {
   std::cerr << "  -i<index>            specify input (1..N; [default is IO1])" << std::endl;
   std::cerr << "  -h                   display this help and exit" << std::endl;
   std::cerr << "  -f                   use the first attached device (and ignore <device name>)" << std::endl;
+  std::cerr << "  -W<file>             record received timing messages to file" << std::endl;
+  std::cerr << "  -R<file>             replay recorded timing messages from file at maximum speed (no device, no DIM server)" << std::endl;
+  std::cerr << "  -v                   replay: print published data (included in the measured latency)" << std::endl;
   std::cerr << std::endl;
   std::cerr << std::endl;
   std::cerr << "This tool provides a server for additional kicker diagnostic data" << std::endl;
+  std::cerr << "A replay feeds the timing messages through the conditions and the data handling of the server and" << std::endl;
+  std::cerr << "reports the number of messages per second and the latency per action." << std::endl;
   std::cerr << std::endl;
   std::cerr << "Example1: '" << program << " tr0 -r0 pro'" << std::endl;
+  std::cerr << "Example2: '" << program << " -r0 -R kickdiag.b2br'" << std::endl;
   std::cerr << std::endl;
 
   std::cerr << "Report bugs to <d.beck@gsi.de> !!!" << std::endl;
@@ -271,9 +340,11 @@ int main(int argc, char** argv)
   int i;
 
   // variables snoop event
-  uint64_t snoopID     = 0x0;
   uint64_t tluIn       = 0x0;
   int      nCondition  = 0;
+  ecacond_t cond[NCOND];
+  char     *replayName = NULL;
+  char     *recordName = NULL;
 
   // variables attach, remove
   char    *deviceName = NULL;
@@ -292,7 +363,7 @@ int main(int argc, char** argv)
 
   // parse for options
   program = argv[0];
-  while ((opt = getopt(argc, argv, "r:m:i:hf")) != -1) {
+  while ((opt = getopt(argc, argv, "r:m:i:hfR:W:v")) != -1) {
     switch (opt) {
       case 'r' :
         switch (strtol(optarg, &tail, 0)) {
@@ -338,6 +409,16 @@ int main(int argc, char** argv)
       case 'f' :
         useFirstDev = true;
         break;
+      case 'R' :
+        replayName  = optarg;
+        flagReplay  = 1;
+        break;
+      case 'W' :
+        recordName  = optarg;
+        break;
+      case 'v' :
+        flagVerbose = 1;
+        break;
       case 'h':
         help();
         return 0;
@@ -347,7 +428,7 @@ int main(int argc, char** argv)
     } // switch opt
   }   // while opt
 
-  if (optind >= argc) {
+  if ((optind >= argc) && (!flagReplay)) {
     std::cerr << program << " expecting one non-optional arguments: <device name>" << std::endl;
     help();
     return 1;
@@ -359,20 +440,17 @@ int main(int argc, char** argv)
     return 0;
   } // if optind
 
-  deviceName = argv[optind];
-  gethostname(disHostname, 32);
-
   switch(reqRing) {
     case SIS18_RING :
-      nCondition = 4;
+      nCondition = NCOND;
       sprintf(ringName, "sis18");
       break;
     case ESR_RING :
-      nCondition = 4;
+      nCondition = NCOND;
       sprintf(ringName, "esr");
       break;
     case CRYRING_RING :
-      nCondition = 4;
+      nCondition = NCOND;
       sprintf(ringName, "yr");
       break;
     default :
@@ -396,6 +474,20 @@ int main(int argc, char** argv)
   // data
   disNTransfer          = 0;
   for (i=0; i< B2B_NSID; i++ ) initValues(i);
+  defineConditions(cond, tluIn);
+
+  // replay: no device, no DIM server
+  if (flagReplay) {
+    if (b2b_replay_run(replayName, cond, nCondition, &replayMessage) != COMMON_STATUS_OK) {
+      std::cerr << program << ": can't replay file " << replayName << std::endl;
+      return 1;
+    } // if replay
+    printf("  transfers     : %u\n", disNTransfer);
+    return 0;
+  } // if flagReplay
+
+  deviceName = argv[optind];
+  gethostname(disHostname, 32);
  
   if (optind+1 < argc) { 
     if (!reqMode) sprintf(prefix, "b2b_%s_%s-kdde", argv[++optind], ringName);  // extraction
@@ -431,33 +523,17 @@ int main(int argc, char** argv)
     std::shared_ptr<SoftwareActionSink_Proxy> sink = SoftwareActionSink_Proxy::create(receiver->NewSoftwareActionSink(""));
     std::shared_ptr<SoftwareCondition_Proxy> condition[nCondition];
     uint32_t tag[nCondition];
-    uint32_t tmpTag;
 
     // define conditions (ECA filter rules)
+    for (i=0; i<nCondition; i++) {
+      condition[i]  = SoftwareCondition_Proxy::create(sink->NewCondition(false, cond[i].id, cond[i].mask, cond[i].offset));
+      tag[i]        = cond[i].tag;
+    } // for i
 
-    // CMD_B2B_EXTTRIG, signals start of data collection
-    tmpTag        = tagKStart;
-    snoopID       = ((uint64_t)FID << 60) | ((uint64_t)reqRing  << 48) | ((uint64_t)reqEvtNo << 36);
-    condition[0]  = SoftwareCondition_Proxy::create(sink->NewCondition(false, snoopID, 0xfffffff000000000, 0));
-    tag[0]        = tmpTag;
-  
-    // CMD_B2B_EXTTRIG, +100ms (!), signals stop of data collection
-    tmpTag        = tagKStop;        
-    snoopID       = ((uint64_t)FID << 60) | ((uint64_t)reqRing  << 48) | ((uint64_t)reqEvtNo << 36);
-    condition[1]  = SoftwareCondition_Proxy::create(sink->NewCondition(false, snoopID, 0xfffffff000000000, 100000000));
-    tag[1]        = tmpTag;
-
-    // IO input rising edge
-    tmpTag        = tagKRising;
-    snoopID       = ((uint64_t)0xf << 60) | ((uint64_t)0xfff  << 48) | ((uint64_t)tluIn << 36 | (uint64_t)000000001);
-    condition[2]  = SoftwareCondition_Proxy::create(sink->NewCondition(false, snoopID, 0xffffffffffffffff, 0));
-    tag[2]        = tmpTag;
-
-    // IO input falling edge
-    tmpTag        = tagKFalling;
-    snoopID       = ((uint64_t)0xf << 60) | ((uint64_t)0xfff  << 48) | ((uint64_t)tluIn << 36 | (uint64_t)000000000);
-    condition[3]  = SoftwareCondition_Proxy::create(sink->NewCondition(false, snoopID, 0xffffffffffffffff, 0));
-    tag[3]        = tmpTag;
+    if (recordName && (b2b_record_open(&record, recordName) != COMMON_STATUS_OK)) {
+      std::cerr << program << ": can't create file " << recordName << std::endl;
+      exit(1);
+    } // if recordName
 
     // let's go!
     for (i=0; i<nCondition; i++) {
@@ -3,7 +3,7 @@
  *
  *  created : 2021
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 20-Nov-2023
+ *  version : 18-Oct-2026
  *
  * publishes raw data of the b2b system
  *
@@ -34,7 +34,7 @@
  * For all questions and ideas contact: d.beck@gsi.de
  * Last update: 15-April-2019
  *********************************************************************************************/
-#define B2B_SERV_RAW_VERSION 0x000702
+#define B2B_SERV_RAW_VERSION 0x000801
 
 #define __STDC_FORMAT_MACROS
 #define __STDC_CONSTANT_MACROS
@@ -53,6 +53,7 @@
 #include <inttypes.h>
 #include <unistd.h>
 #include <math.h>
+#include <stddef.h>
 
 // saftlib includes
 #include "SAFTd.h"
@@ -74,6 +75,8 @@ using namespace saftlib;
 using namespace std;
 
 #define FID          0x1                // format ID of timing messages
+#define NCONDMAX     32                 // max number of ECA conditions
+#define NEVTNO       32                 // number of b2b event numbers, starting at B2B_ECADO_B2B_PMEXT
 
 static const char* program;
 
@@ -105,6 +108,10 @@ uint32_t reqExtRing;                    // requested extraction ring
 uint32_t sid;                           // Sequence ID
 uint32_t bpid;                          // Beam Process ID
 
+int          flagReplay;                // flag: replay timing messages from file, no DIM services
+int          flagVerbose;               // flag: print published data during replay
+b2b_replay_t *record;                   // recording of received timing messages
+
 
 // init setval
 void initSetval(setval_t *setval)
@@ -163,16 +170,36 @@ void disUpdateSetval(uint32_t sid, uint64_t tStart, setval_t setval)
   msecs  /= 1000000;
   
   disSetval[sid] = setval;
+  disNTransfer++;
+  if (flagReplay) return;
+
   dis_set_timestamp(disSetvalId[sid], secs, msecs);
   dis_update_service(disSetvalId[sid]);
-  
-  disNTransfer++;
   dis_update_service(disNTransferId);
 } // disUpdateSetval
  
 
+// print published data of a transfer as CSV line, used for replay
+void printTransfer(uint32_t sid, uint32_t secs, uint32_t msecs)
+{
+  archval_t rec;
+  char      line[B2B_ARCHIVE_CSVLEN];
+
+  memset(&rec, 0, sizeof(rec));
+  rec.utcSecs         = secs;
+  rec.utcMsecs        = msecs;
+  rec.sid             = sid;
+  rec.setval          = disSetval[sid];
+  rec.getval          = disGetval[sid];
+  rec.ext_kickLen     = NAN;
+  rec.ext_kickCompLvl = NAN;
+  b2b_archive_csvLine(line, &rec);
+  printf("%s\n", line);
+} // printTransfer
+
+
 // update get value
- void disUpdateGetval(uint32_t sid, uint64_t tStart, getval_t getval)
+void disUpdateGetval(uint32_t sid, uint64_t tStart, getval_t getval)
 {
   uint32_t secs;
   uint32_t msecs;
@@ -181,153 +208,251 @@ void disUpdateSetval(uint32_t sid, uint64_t tStart, setval_t setval)
   msecs  /= 1000000;
   
   disGetval[sid] = getval;
+  if (flagReplay) {
+    if (flagVerbose) printTransfer(sid, secs, msecs);
+    return;
+  } // if flagReplay
+
   dis_set_timestamp(disGetvalId[sid], secs, msecs);
   dis_update_service(disGetvalId[sid]);
 } // disUpdateGetval
 
 
-// handle received timing message
-static void timingMessage(uint32_t tag, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t isLate, uint32_t isEarly, uint32_t isConflict, uint32_t isDelayed)
+// data of the transfer in progress
+typedef struct {
+  int      flagActive;                  // flag: b2b is active
+  uint64_t tStart;                      // time of transfer (UTC)
+  setval_t setval;                      // set values
+  getval_t getval;                      // get values
+} xfer_t;
+
+xfer_t xfer;
+
+// timing messages are described by a table per ring; each entry maps (gid, evtNo, offset) to a handler and to fields of the
+// get values; all entries with the same gid and offset share one ECA condition, the tag of that condition is the row of the
+// dispatch table and the event number is the column
+struct evtDesc_s;
+typedef void (*evtHandler_t)(const struct evtDesc_s *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid);
+
+typedef struct evtDesc_s {
+  uint32_t     gid;                     // group ID
+  uint32_t     evtNo;                   // event number, B2B_ECADO_B2B_PMEXT .. +NEVTNO-1
+  uint64_t     offset;                  // offset of ECA condition [ns]
+  uint32_t     tag;                     // event tag; bit in flagEvtRec, flagEvtErr and flagEvtLate
+  evtHandler_t handler;                 // handler
+  uint64_t     errMask;                 // error flag within evtId; 0: none
+  size_t       field[5];                // offsets of fields in getval_t; meaning depends on handler
+  size_t       fieldSet;                // offset of field in setval_t; meaning depends on handler
+} evtDesc_t;
+
+#define GETF(desc, i)   ((float *)((char *)&(xfer.getval) + (desc)->field[i]))
+#define GOFF(name)      offsetof(getval_t, name)
+#define SOFF(name)      offsetof(setval_t, name)
+
+const evtDesc_t *dispatch[NCONDMAX][NEVTNO];  // [row = ECA tag][evtNo - B2B_ECADO_B2B_PMEXT]; NULL: not handled
+uint32_t         nDispatch;                   // number of rows
+
+
+// CMD_B2B_START, start of data collection
+static void hStart(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
+{
+  sid                              = recSid;
+  xfer.tStart                      = deadline.getUTC();
+
+  initSetval(&(xfer.setval));
+  xfer.setval.mode                 = 0;      // in the simplest case mode is '0' (OFF)
+  xfer.setval.ext_sid              = sid;
+
+  initGetval(&(xfer.getval));
+  xfer.getval.tCBS                 = deadline.getTAI();
+} // hStart
+
+
+// CMD_B2B_START +100ms, stop of data collection
+static void hStop(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
 {
-  uint32_t            recSid;          // received SID
-  int                 flagErr;
+  xfer.flagActive                  = 0;
+  disUpdateSetval(sid, xfer.tStart, xfer.setval);
+  disUpdateGetval(sid, xfer.tStart, xfer.getval);
+} // hStop
 
-  static int          flagActive;      // flag: b2b is active
-  static setval_t     setval;          // set values
-  static getval_t     getval;          // get values
-  static uint64_t     tStart;          // time of transfer
 
-  //uint64_t one_ns_as = 1000000000;
-  fdat_t   tmp;
-  float    tmpf;
+// PMEXT, set values of extraction
+static void hPme(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
+{
+  float tmpf;
+
+  xfer.setval.mode                 = ((param & 0x00f0000000000000) >> 52);
+  xfer.setval.ext_h                = ((param & 0xff00000000000000) >> 56);
+  xfer.setval.ext_T                = ((param & 0x000fffffffffffff));    // [as]
+  if (xfer.setval.mode > 0) {
+    tmpf                           = comlib_half2float((uint16_t)((tef & 0xffff0000)  >> 16)); // [us, hfloat]; chk for NAN?
+    xfer.setval.ext_cTrig          = tmpf * 1000.0;                     // [ns]
+  } // if mode
+  if (xfer.setval.mode > 2) {
+    tmpf                           = comlib_half2float((uint16_t)( tef & 0x0000ffff));         // [us, hfloat]; chk for NAN?
+    xfer.setval.inj_cTrig          = tmpf * 1000.0;                     // [ns]
+  } // if mode
+} // hPme
+
+
+// PMINJ, set values of injection
+static void hPmi(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
+{
+  float tmpf;
+
+  xfer.setval.inj_h                = ((param & 0xff00000000000000) >> 56);
+  xfer.setval.inj_T                = ((param & 0x000fffffffffffff));    // [as]
+  if (xfer.setval.mode > 3) {
+    tmpf                           = comlib_half2float((uint16_t)((tef & 0xffff0000) >> 16));              // [us, hfloat]]
+    xfer.setval.cPhase             = tmpf  * 1000;                      // [ns]
+  } // if mode
+} // hPmi
+
+
+// PREXT, PRINJ: result of phase measurement; fields: phase, phaseFract, phaseErr, phaseSysmaxErr, offset to CBS; fieldSet: T
+static void hPhase(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
+{
+  uint64_t T;
+
+  T                                = *(uint64_t *)((char *)&(xfer.setval) + desc->fieldSet);
+  *(uint64_t *)((char *)&(xfer.getval) + desc->field[0]) = param;
+  *GETF(desc, 1)                   = (float)( tef & 0x0000ffff) / 1000.0;
+  *GETF(desc, 2)                   = (float)((tef & 0xffff0000) >> 16) / 1000.0;
+  *GETF(desc, 3)                   = (float)b2b_calc_max_sysdev_ps(T, B2B_NSAMPLES, 0) / 1000.0;
+  *GETF(desc, 4)                   = (float)(param - xfer.getval.tCBS);
+} // hPhase
+
+
+// TRIGGEREXT, kicker trigger extraction
+static void hKte(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
+{
+  float tmpf;
+
+  xfer.getval.kteOff               = deadline.getTAI() - xfer.getval.tCBS;
+  tmpf                             = comlib_half2float((uint16_t)((tef & 0xffff0000) >> 16));        // [us, hfloat]
+  xfer.getval.finOff               = tmpf * 1000.0;
+  tmpf                             = comlib_half2float((uint16_t)(tef & 0x0000ffff));                // [us, hfloat]
+  xfer.getval.prrOff               = tmpf * 1000.0;
+} // hKte
+
+
+// TRIGGERINJ, kicker trigger injection
+static void hKti(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
+{
+  xfer.setval.inj_sid              = recSid;
+  xfer.getval.ktiOff               = deadline.getTAI() - xfer.getval.tCBS;
+} // hKti
+
+
+// DIAGKICKEXT, DIAGKICKINJ: kick diagnostic; fields: dKickProb, dKickMon
+// data types within parameter field are 'int' as this a. should be easy for the users b. granularity is 1ns only
+static void hKick(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
+{
   uint32_t tmpu;
 
+  tmpu                             = (uint32_t)(param & 0x00000000ffffffff);
+  *GETF(desc, 0)                   = (tmpu == 0x7fffffff) ? NAN : tmpu;
+  tmpu                             = (uint32_t)((param & 0xffffffff00000000) >> 32);
+  *GETF(desc, 1)                   = (tmpu == 0x7fffffff) ? NAN : tmpu;
+} // hKick
+
+
+// DIAGEXT, DIAGINJ: result of diagnostic; fields: diagMatch, diagPhase
+// chk: consider changing 0x7fffffff to NAN in b2b-pm.c after beam time 2024
+static void hDiag(const evtDesc_t *desc, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t recSid)
+{
+  fdat_t tmp;
+
+  tmp.data                         = ((param & 0x00000000ffffffff));
+  *GETF(desc, 0)                   = (tmp.data == 0x7fffffff) ? NAN : tmp.f;
+  tmp.data                         = ((param & 0xffffffff00000000) >> 32);
+  *GETF(desc, 1)                   = (tmp.data == 0x7fffffff) ? NAN : tmp.f;
+} // hDiag
+
+
+// tables of timing messages
+// gid                  evtNo                      offset     tag       hdlr    errMask            fields of getval_t                                                                                   fieldSet
+const evtDesc_t evtSis18[] = {
+  {SIS18_RING         , B2B_ECADO_B2B_START      , 0        , tagStart, hStart, 0                , {0}                                                                                                , 0          },
+  {SIS18_RING         , B2B_ECADO_B2B_START      , 100000000, tagStop , hStop , 0                , {0}                                                                                                , 0          },
+  {SIS18_B2B_EXTRACT  , B2B_ECADO_B2B_PMEXT      , 0        , tagPme  , hPme  , 0                , {0}                                                                                                , 0          },
+  {SIS18_B2B_EXTRACT  , B2B_ECADO_B2B_PREXT      , 0        , tagPre  , hPhase, B2B_ERRFLAG_PMEXT, {GOFF(ext_phase), GOFF(ext_phaseFract), GOFF(ext_phaseErr), GOFF(ext_phaseSysmaxErr), GOFF(preOff)}, SOFF(ext_T)},
+  {SIS18_B2B_EXTRACT  , B2B_ECADO_B2B_DIAGEXT    , 0        , tagPde  , hDiag , 0                , {GOFF(ext_diagMatch), GOFF(ext_diagPhase)}                                                         , 0          },
+  {SIS18_B2B_ESR      , B2B_ECADO_B2B_PMEXT      , 0        , tagPme  , hPme  , 0                , {0}                                                                                                , 0          },
+  {SIS18_B2B_ESR      , B2B_ECADO_B2B_PMINJ      , 0        , tagPmi  , hPmi  , 0                , {0}                                                                                                , 0          },
+  {SIS18_B2B_ESR      , B2B_ECADO_B2B_PREXT      , 0        , tagPre  , hPhase, B2B_ERRFLAG_PMEXT, {GOFF(ext_phase), GOFF(ext_phaseFract), GOFF(ext_phaseErr), GOFF(ext_phaseSysmaxErr), GOFF(preOff)}, SOFF(ext_T)},
+  {SIS18_B2B_ESR      , B2B_ECADO_B2B_PRINJ      , 0        , tagPri  , hPhase, B2B_ERRFLAG_PMINJ, {GOFF(inj_phase), GOFF(inj_phaseFract), GOFF(inj_phaseErr), GOFF(inj_phaseSysmaxErr), GOFF(priOff)}, SOFF(inj_T)},
+  {SIS18_B2B_ESR      , B2B_ECADO_B2B_DIAGEXT    , 0        , tagPde  , hDiag , 0                , {GOFF(ext_diagMatch), GOFF(ext_diagPhase)}                                                         , 0          },
+  {SIS18_B2B_ESR      , B2B_ECADO_B2B_DIAGINJ    , 0        , tagPdi  , hDiag , 0                , {GOFF(inj_diagMatch), GOFF(inj_diagPhase)}                                                         , 0          },
+  {SIS18_RING         , B2B_ECADO_B2B_TRIGGEREXT , 0        , tagKte  , hKte  , B2B_ERRFLAG_CBU  , {0}                                                                                                , 0          },
+  {SIS18_RING         , B2B_ECADO_B2B_DIAGKICKEXT, 0        , tagKde  , hKick , B2B_ERRFLAG_KDEXT, {GOFF(ext_dKickProb), GOFF(ext_dKickMon)}                                                          , 0          },
+  {ESR_RING           , B2B_ECADO_B2B_TRIGGERINJ , 0        , tagKti  , hKti  , B2B_ERRFLAG_CBU  , {0}                                                                                                , 0          },
+  {ESR_RING           , B2B_ECADO_B2B_DIAGKICKINJ, 0        , tagKdi  , hKick , B2B_ERRFLAG_KDINJ, {GOFF(inj_dKickProb), GOFF(inj_dKickMon)}                                                          , 0          }
+};
+
+const evtDesc_t evtEsr[] = {
+  {ESR_RING           , B2B_ECADO_B2B_START      , 0        , tagStart, hStart, 0                , {0}                                                                                                , 0          },
+  {ESR_RING           , B2B_ECADO_B2B_START      , 100000000, tagStop , hStop , 0                , {0}                                                                                                , 0          },
+  {ESR_B2B_EXTRACT    , B2B_ECADO_B2B_PMEXT      , 0        , tagPme  , hPme  , 0                , {0}                                                                                                , 0          },
+  {ESR_B2B_EXTRACT    , B2B_ECADO_B2B_PREXT      , 0        , tagPre  , hPhase, B2B_ERRFLAG_PMEXT, {GOFF(ext_phase), GOFF(ext_phaseFract), GOFF(ext_phaseErr), GOFF(ext_phaseSysmaxErr), GOFF(preOff)}, SOFF(ext_T)},
+  {ESR_B2B_EXTRACT    , B2B_ECADO_B2B_DIAGEXT    , 0        , tagPde  , hDiag , 0                , {GOFF(ext_diagMatch), GOFF(ext_diagPhase)}                                                         , 0          },
+  {ESR_B2B_CRYRING    , B2B_ECADO_B2B_PMEXT      , 0        , tagPme  , hPme  , 0                , {0}                                                                                                , 0          },
+  {ESR_B2B_CRYRING    , B2B_ECADO_B2B_PMINJ      , 0        , tagPmi  , hPmi  , 0                , {0}                                                                                                , 0          },
+  {ESR_B2B_CRYRING    , B2B_ECADO_B2B_PREXT      , 0        , tagPre  , hPhase, B2B_ERRFLAG_PMEXT, {GOFF(ext_phase), GOFF(ext_phaseFract), GOFF(ext_phaseErr), GOFF(ext_phaseSysmaxErr), GOFF(preOff)}, SOFF(ext_T)},
+  {ESR_B2B_CRYRING    , B2B_ECADO_B2B_PRINJ      , 0        , tagPri  , hPhase, B2B_ERRFLAG_PMINJ, {GOFF(inj_phase), GOFF(inj_phaseFract), GOFF(inj_phaseErr), GOFF(inj_phaseSysmaxErr), GOFF(priOff)}, SOFF(inj_T)},
+  {ESR_B2B_CRYRING    , B2B_ECADO_B2B_DIAGEXT    , 0        , tagPde  , hDiag , 0                , {GOFF(ext_diagMatch), GOFF(ext_diagPhase)}                                                         , 0          },
+  {ESR_B2B_CRYRING    , B2B_ECADO_B2B_DIAGINJ    , 0        , tagPdi  , hDiag , 0                , {GOFF(inj_diagMatch), GOFF(inj_diagPhase)}                                                         , 0          },
+  {ESR_RING           , B2B_ECADO_B2B_TRIGGEREXT , 0        , tagKte  , hKte  , B2B_ERRFLAG_CBU  , {0}                                                                                                , 0          },
+  {ESR_RING           , B2B_ECADO_B2B_DIAGKICKEXT, 0        , tagKde  , hKick , B2B_ERRFLAG_KDEXT, {GOFF(ext_dKickProb), GOFF(ext_dKickMon)}                                                          , 0          },
+  {CRYRING_RING       , B2B_ECADO_B2B_TRIGGERINJ , 0        , tagKti  , hKti  , B2B_ERRFLAG_CBU  , {0}                                                                                                , 0          },
+  {CRYRING_RING       , B2B_ECADO_B2B_DIAGKICKINJ, 0        , tagKdi  , hKick , B2B_ERRFLAG_KDINJ, {GOFF(inj_dKickProb), GOFF(inj_dKickMon)}                                                          , 0          }
+};
+
+const evtDesc_t evtCryring[] = {
+  {CRYRING_RING       , B2B_ECADO_B2B_START      , 0        , tagStart, hStart, 0                , {0}                                                                                                , 0          },
+  {CRYRING_RING       , B2B_ECADO_B2B_START      , 100000000, tagStop , hStop , 0                , {0}                                                                                                , 0          },
+  {CRYRING_B2B_EXTRACT, B2B_ECADO_B2B_PMEXT      , 0        , tagPme  , hPme  , 0                , {0}                                                                                                , 0          },
+  {CRYRING_B2B_EXTRACT, B2B_ECADO_B2B_PREXT      , 0        , tagPre  , hPhase, B2B_ERRFLAG_PMEXT, {GOFF(ext_phase), GOFF(ext_phaseFract), GOFF(ext_phaseErr), GOFF(ext_phaseSysmaxErr), GOFF(preOff)}, SOFF(ext_T)},
+  {CRYRING_B2B_EXTRACT, B2B_ECADO_B2B_DIAGEXT    , 0        , tagPde  , hDiag , 0                , {GOFF(ext_diagMatch), GOFF(ext_diagPhase)}                                                         , 0          },
+  {CRYRING_RING       , B2B_ECADO_B2B_TRIGGEREXT , 0        , tagKte  , hKte  , B2B_ERRFLAG_CBU  , {0}                                                                                                , 0          },
+  {CRYRING_RING       , B2B_ECADO_B2B_DIAGKICKEXT, 0        , tagKde  , hKick , B2B_ERRFLAG_KDEXT, {GOFF(ext_dKickProb), GOFF(ext_dKickMon)}                                                          , 0          }
+};
+
+
+// handle received timing message; the tag is the row of the dispatch table
+static void timingMessage(uint32_t tag, saftlib::Time deadline, uint64_t evtId, uint64_t param, uint32_t tef, uint32_t isLate, uint32_t isEarly, uint32_t isConflict, uint32_t isDelayed)
+{
+  const evtDesc_t *desc;
+  uint32_t        recSid;              // received SID
+  uint32_t        evtIdx;              // column of dispatch table
+  int             flagErr;
+
   recSid      = ((evtId  & 0x00000000fff00000) >> 20);
+  evtIdx      = ((evtId  & 0x0000fff000000000) >> 36) - B2B_ECADO_B2B_PMEXT;
 
   // check ranges
-  if (recSid  > B2B_NSID)                 return;
-  if (tag > tagStop)                      return;
-  if ((!flagActive) && (tag != tagStart)) return;
-  //printf("tag %d\n", tag);
+  if (recSid  >= B2B_NSID)                               return;
+  if ((tag >= nDispatch) || (evtIdx >= NEVTNO))          return;
+  if ((desc = dispatch[tag][evtIdx]) == NULL)            return;
+  if ((!xfer.flagActive) && (desc->tag != tagStart))     return;
+
   // mark message as received
-  getval.flagEvtRec  |= 0x1 << tag;
-  getval.flagEvtLate |= isLate << tag;;
-  
-  switch (tag) {
-    case tagStart   :
-      sid                          = recSid;
-      tStart                       = deadline.getUTC();
-      flagActive                   = 1;
-      
-      initSetval(&setval);
-      setval.mode                  = 0;      // in the simplest case mode is '0' (OFF)
-      setval.ext_sid               = sid;
-
-      initGetval(&getval);
-      getval.flagEvtRec            = 0x1 << tag;
-      getval.flagEvtLate           = isLate << tag;
-      getval.tCBS                  = deadline.getTAI();
-      break;
-    case tagStop    :
-      flagActive       = 0;
-      disUpdateSetval(sid, tStart, setval);
-      disUpdateGetval(sid, tStart, getval);      
-      break;
-    case tagPme     :
-      setval.mode              = ((param & 0x00f0000000000000) >> 52);
-      setval.ext_h             = ((param & 0xff00000000000000) >> 56);
-      setval.ext_T             = ((param & 0x000fffffffffffff));    // [as]
-      if (setval.mode > 0) {
-        tmpf                   = comlib_half2float((uint16_t)((tef & 0xffff0000)  >> 16)); // [us, hfloat]; chk for NAN?
-        setval.ext_cTrig       = tmpf * 1000.0;                     // [ns]
-      } // if mode
-      if (setval.mode > 2) {
-        tmpf                   = comlib_half2float((uint16_t)( tef & 0x0000ffff));         // [us, hfloat]; chk for NAN?
-        setval.inj_cTrig        = tmpf * 1000.0;                     // [ns]
-      } // if mode
-      break;
-    case tagPmi     :
-      setval.inj_h             = ((param & 0xff00000000000000) >> 56);
-      setval.inj_T             = ((param & 0x000fffffffffffff));    // [as]
-      if (setval.mode > 3) {
-        tmpf                   = comlib_half2float((uint16_t)((tef & 0xffff0000) >> 16));              // [us, hfloat]]
-        setval.cPhase          = tmpf  * 1000;                      // [ns]
-      } // if mode
-      break;
-    case tagPre     :
-      getval.preOff             = (float)(param - getval.tCBS);
-      getval.ext_phase          = param;
-      getval.ext_phaseFract     = (float)( tef & 0x0000ffff) / 1000.0 ;
-      getval.ext_phaseErr       = (float)((tef & 0xffff0000) >> 16) / 1000.0;
-      getval.ext_phaseSysmaxErr = (float)b2b_calc_max_sysdev_ps(setval.ext_T, B2B_NSAMPLES, 0) / 1000.0;
-      flagErr                   = ((evtId & B2B_ERRFLAG_PMEXT) != 0);
-      getval.flagEvtErr        |= flagErr << tag;
-      break;
-    case tagPri     :
-      getval.priOff             = (float)(param - getval.tCBS);
-      getval.inj_phase          = param;
-      getval.inj_phaseFract     = (float)( tef & 0x0000ffff) / 1000.0;
-      getval.inj_phaseErr       = (float)((tef & 0xffff0000) >> 16) / 1000.0;
-      getval.inj_phaseSysmaxErr = (float)b2b_calc_max_sysdev_ps(setval.inj_T, B2B_NSAMPLES, 0) / 1000.0;
-      flagErr                   = ((evtId & B2B_ERRFLAG_PMINJ) != 0);
-      getval.flagEvtErr        |= flagErr << tag;
-      break;     
-    case tagKte     :
-      getval.kteOff            = deadline.getTAI() - getval.tCBS;
-      tmpf                     = comlib_half2float((uint16_t)((tef & 0xffff0000) >> 16));        // [us, hfloat]
-      getval.finOff            = tmpf * 1000.0;
-      tmpf                     = comlib_half2float((uint16_t)(tef & 0x0000ffff));                // [us, hfloat]
-      getval.prrOff            = tmpf * 1000.0;
-      flagErr                  = ((evtId & B2B_ERRFLAG_CBU) != 0);
-      getval.flagEvtErr       |= flagErr << tag;
-      break;
-    case tagKti     :
-      setval.inj_sid           = recSid;;
-      getval.ktiOff            = deadline.getTAI() - getval.tCBS;
-      flagErr                  = ((evtId    & 0x0000000000000010) >> 4);
-      getval.flagEvtErr       |= flagErr << tag;
-      break;
-    case tagKde     :          // data types within parameter field are 'int' as this a. should be easy for the users b. granularity is 1ns only
-      tmpu                     = (uint32_t)(param & 0x00000000ffffffff);
-      if (tmpu == 0x7fffffff) getval.ext_dKickProb = NAN;
-      else                    getval.ext_dKickProb = tmpu;
-      tmpu                     = (uint32_t)((param & 0xffffffff00000000) >> 32);
-      if (tmpu == 0x7fffffff) getval.ext_dKickMon  = NAN;
-      else                    getval.ext_dKickMon  = tmpu;
-      flagErr                  = ((evtId & B2B_ERRFLAG_KDEXT) != 0);
-      getval.flagEvtErr       |= flagErr << tag;
-      break;
-    case tagKdi     :          // data types within parameter field are 'int' as this a. should be easy for the users b. granularity is 1ns only
-      tmpu                     = (uint32_t)(param & 0x00000000ffffffff);
-      if (tmpu == 0x7fffffff) getval.inj_dKickProb = NAN;
-      else                    getval.inj_dKickProb = tmpu;
-      tmpu                     = (uint32_t)((param & 0xffffffff00000000) >> 32);
-      if (tmpu == 0x7fffffff) getval.inj_dKickMon  = NAN;
-      else                    getval.inj_dKickMon  = tmpu;
-      flagErr                  = ((evtId & B2B_ERRFLAG_KDINJ) != 0);
-      getval.flagEvtErr       |= flagErr << tag;
-      break;
-    case tagPde     :         // chk: consider changing 0x7fffffff to NAN in b2b-pm.c after beam time 2024
-      tmp.data                 = ((param & 0x00000000ffffffff));
-      if (tmp.data == 0x7fffffff) getval.ext_diagMatch = NAN;
-      else                        getval.ext_diagMatch = (double)tmp.f;
-      tmp.data                 = ((param & 0xffffffff00000000) >> 32);
-      if (tmp.data == 0x7fffffff) getval.ext_diagPhase = NAN;
-      else                        getval.ext_diagPhase = (double)tmp.f;
-      break;
-    case tagPdi     :         // chk: consider changing 0x7fffffff to NAN in b2b-pm.c after beam time 2024
-      tmp.data                 = ((param & 0x00000000ffffffff));
-      if (tmp.data == 0x7fffffff) getval.inj_diagMatch = NAN;
-      else                        getval.inj_diagMatch = (double)tmp.f;
-      tmp.data                 = ((param & 0xffffffff00000000) >> 32);
-      if (tmp.data == 0x7fffffff) getval.inj_diagPhase = NAN;
-      else                        getval.inj_diagPhase = (double)tmp.f;
-      break;
-    default         :
-      ;
-  } // switch tag
-  
-  //printf("out tag %d, bpid %d\n", tag, bpid);
+  if (desc->tag == tagStart) {
+    xfer.flagActive               = 1;
+    desc->handler(desc, deadline, evtId, param, tef, recSid);
+    xfer.getval.flagEvtRec        = 0x1 << desc->tag;
+    xfer.getval.flagEvtLate       = isLate << desc->tag;
+    return;
+  } // if tagStart
+  xfer.getval.flagEvtRec         |= 0x1 << desc->tag;
+  xfer.getval.flagEvtLate        |= isLate << desc->tag;
+  if (desc->errMask) {
+    flagErr                       = ((evtId & desc->errMask) != 0);
+    xfer.getval.flagEvtErr       |= flagErr << desc->tag;
+  } // if errMask
+
+  desc->handler(desc, deadline, evtId, param, tef, recSid);
 } // timingmessage
 
 
@@ -343,6 +468,14 @@ static void timingMessage(uint32_t tag, saftlib::Time deadline, uint64_t evtId,
 } // recTimingMessag*/
 
 
+// this will be called for actions replayed from a file
+static void replayMessage(uint32_t tag, const ecamsg_t *action)
+{
+  timingMessage(tag, saftlib::makeTimeTAI(action->deadline), action->evtId, action->param, action->tef,
+                action->flags & 0x1, (action->flags >> 1) & 0x1, (action->flags >> 2) & 0x1, (action->flags >> 3) & 0x1);
+} // replayMessage
+
+
 // call back for command
 class RecvCommand : public DimCommand
 {
@@ -393,6 +526,62 @@ void disAddServices(char *prefix)
   } // for i
 } // disAddServices
 
+// build the dispatch table and the conditions (ECA filter rules) from a table of timing messages, returns number of conditions
+// all messages of a gid with the same offset share one condition: a range covering all b2b event numbers if there are
+// several messages, otherwise an exact match; conditions are used for the ECA and for replay
+static uint32_t buildDispatch(const evtDesc_t *desc, uint32_t nDesc, ecacond_t *cond)
+{
+  uint32_t gid[NCONDMAX];               // gid of row
+  uint32_t nEvt[NCONDMAX];              // number of messages of row
+  uint32_t evtNo[NCONDMAX];             // event number of (last) message of row
+  uint32_t i, row;
+
+  memset(dispatch, 0, sizeof(dispatch));
+  nDispatch = 0;
+
+  for (i=0; i<nDesc; i++) {
+    if (desc[i].evtNo - B2B_ECADO_B2B_PMEXT >= NEVTNO) continue;
+    for (row=0; row<nDispatch; row++) if ((gid[row] == desc[i].gid) && (cond[row].offset == desc[i].offset)) break;
+    if (row == nDispatch) {
+      if (nDispatch == NCONDMAX) break;
+      gid[row]         = desc[i].gid;
+      nEvt[row]        = 0;
+      cond[row].offset = desc[i].offset;
+      nDispatch++;
+    } // if row
+    dispatch[row][desc[i].evtNo - B2B_ECADO_B2B_PMEXT] = &(desc[i]);
+    evtNo[row]         = desc[i].evtNo;
+    nEvt[row]++;
+  } // for i
+
+  for (row=0; row<nDispatch; row++) {
+    if (nEvt[row] == 1) {
+      cond[row].id     = ((uint64_t)FID << 60) | ((uint64_t)gid[row] << 48) | ((uint64_t)evtNo[row] << 36);
+      cond[row].mask   = 0xfffffff000000000;
+    } // if nEvt
+    else {
+      cond[row].id     = ((uint64_t)FID << 60) | ((uint64_t)gid[row] << 48) | ((uint64_t)B2B_ECADO_B2B_PMEXT << 36);
+      cond[row].mask   = 0xfffffe0000000000;                                      // evtNo B2B_ECADO_B2B_PMEXT .. +NEVTNO-1
+    } // else nEvt
+    cond[row].tag      = row;
+    cond[row].reserved = 0;
+  } // for row
+
+  return nDispatch;
+} // buildDispatch
+
+
+// define conditions (ECA filter rules) of a ring, returns number of conditions
+static uint32_t defineConditions(uint32_t ring, ecacond_t *cond)
+{
+  switch (ring) {
+    case SIS18_RING   : return buildDispatch(evtSis18  , sizeof(evtSis18)   / sizeof(evtDesc_t), cond);
+    case ESR_RING     : return buildDispatch(evtEsr    , sizeof(evtEsr)     / sizeof(evtDesc_t), cond);
+    case CRYRING_RING : return buildDispatch(evtCryring, sizeof(evtCryring) / sizeof(evtDesc_t), cond);
+    default           : return 0;
+  } // switch ring
+} // defineConditions
+
                         
 //using namespace saftlib;
 //using namespace std;
@@ -404,14 +593,20 @@ static void help(void) {
   std::cerr << "  -e<index>            specify extraction ring (0: SIS18[default], 1: ESR, 2: CRYRING)" << std::endl;
   std::cerr << "  -h                   display this help and exit" << std::endl;
   std::cerr << "  -f                   use the first attached device (and ignore <device name>)" << std::endl;
+  std::cerr << "  -W<file>             record received timing messages to file" << std::endl;
+  std::cerr << "  -R<file>             replay recorded timing messages from file at maximum speed (no device, no DIM server)" << std::endl;
+  std::cerr << "  -v                   replay: print published data as CSV lines (included in the measured latency)" << std::endl;
   std::cerr << std::endl;
   std::cerr << std::endl;
   std::cerr << "This tool provides a server for raw b2b data." << std::endl;
+  std::cerr << "A replay feeds the timing messages through the conditions and the data handling of the server and" << std::endl;
+  std::cerr << "reports the number of messages per second and the latency per action." << std::endl;
   std::cerr << std::endl;
   std::cerr << "Important notice: This program uses the ECA action queue of an lm32(!). Only one instance of this" << std::endl;
   std::cerr << "programm shall be used. Other programs (from host or lm32) must not access that action  queue. " << std::endl;
   std::cerr << std::endl;
   std::cerr << "Example1: '" << program << " tr0 -e0 pro'" << std::endl;
+  std::cerr << "Example2: '" << program << " -e0 -R sis18.b2br'" << std::endl;
   std::cerr << std::endl;
 
   std::cerr << "Report bugs to <d.beck@gsi.de> !!!" << std::endl;
@@ -427,8 +622,10 @@ int main(int argc, char** argv)
 
 
   // variables snoop event
-  uint64_t snoopID     = 0x0;
+  ecacond_t cond[NCONDMAX];
   int      nCondition  = 0;
+  char     *replayName = NULL;
+  char     *recordName = NULL;
 
   char tmp[752];
   int i;
@@ -446,7 +643,7 @@ int main(int argc, char** argv)
 
   // parse for options
   program = argv[0];
-  while ((opt = getopt(argc, argv, "e:hf")) != -1) {
+  while ((opt = getopt(argc, argv, "e:hfR:W:v")) != -1) {
     switch (opt) {
       case 'e' :
         switch (strtol(optarg, &tail, 0)) {
@@ -465,6 +662,16 @@ int main(int argc, char** argv)
       case 'f' :
         useFirstDev = true;
         break;
+      case 'R' :
+        replayName  = optarg;
+        flagReplay  = 1;
+        break;
+      case 'W' :
+        recordName  = optarg;
+        break;
+      case 'v' :
+        flagVerbose = 1;
+        break;
       case 'h':
         help();
         return 0;
@@ -474,7 +681,7 @@ int main(int argc, char** argv)
     } // switch opt
   }   // while opt
 
-  if (optind >= argc) {
+  if ((optind >= argc) && (!flagReplay)) {
     std::cerr << program << " expecting one non-optional arguments: <device name>" << std::endl;
     help();
     return 1;
@@ -486,20 +693,14 @@ int main(int argc, char** argv)
     return 0;
   } // if optind
 
-  deviceName = argv[optind];
-  gethostname(disHostname, 32);
-
   switch(reqExtRing) {
     case SIS18_RING :
-      nCondition = 15;
       sprintf(ringName, "sis18");
       break;
     case ESR_RING :
-      nCondition = 15;
       sprintf(ringName, "esr");
       break;
     case CRYRING_RING :
-      nCondition = 7;
       sprintf(ringName, "yr");
       break;
     default :
@@ -512,7 +713,22 @@ int main(int argc, char** argv)
     initSetval(&(disSetval[i]));
     initGetval(&(disGetval[i]));
   } // for i
-  
+  nCondition = defineConditions(reqExtRing, cond);
+
+  // replay: no device, no DIM server
+  if (flagReplay) {
+    if (flagVerbose) printf("%s\n", b2b_archive_csvHeader());
+    if (b2b_replay_run(replayName, cond, nCondition, &replayMessage) != COMMON_STATUS_OK) {
+      std::cerr << program << ": can't replay file " << replayName << std::endl;
+      return 1;
+    } // if replay
+    printf("  transfers     : %u\n", disNTransfer);
+    return 0;
+  } // if flagReplay
+
+  deviceName = argv[optind];
+  gethostname(disHostname, 32);
+
   if (optind+1 < argc) sprintf(prefix, "b2b_%s_%s", argv[++optind], ringName);
   else                 sprintf(prefix, "b2b_%s", ringName);
 
@@ -559,246 +775,10 @@ int main(int argc, char** argv)
 
     // create action sink for ecpu
     std::shared_ptr<EmbeddedCPUCondition_Proxy> condition[nCondition];
-    //uint32_t tag[nCondition];
-    uint32_t tmpTag;
 
     // define conditions (ECA filter rules)
-    switch (reqExtRing) {
-      case SIS18_RING : 
-
-        // SIS18, CMD_B2B_START, signals start of data collection
-        tmpTag        = tagStart;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_RING << 48) | ((uint64_t)B2B_ECADO_B2B_START << 36);
-        condition[0]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[0]        = tmpTag;
-        
-        // SIS18, CMD_B2B_START, +100ms (!), signals stop of data collection
-        tmpTag        = tagStop;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_RING << 48) | ((uint64_t)B2B_ECADO_B2B_START << 36);
-        condition[1]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 100000000, tmpTag));
-        //tag[1]        = tmpTag;
-        
-        // SIS18 to extraction, PMEXT,
-        tmpTag        = tagPme;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_PMEXT << 36);
-        condition[2]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[2]        = tmpTag;
-
-        // SIS18 to extraction, PREXT
-        tmpTag        = tagPre;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_PREXT << 36);
-        condition[3]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[3]        = tmpTag;
-
-        // SIS18 to extraction, DIAGEXT
-        tmpTag        = tagPde;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGEXT << 36);
-        condition[4]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[4]        = tmpTag;
-
-        // SIS18 to ESR, PMEXT
-        tmpTag        = tagPme;       
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_ESR << 48) | ((uint64_t)B2B_ECADO_B2B_PMEXT << 36);
-        condition[5]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[5]        = tmpTag;
-
-        // SIS18 to ESR, PMINJ
-        tmpTag        = tagPmi;       
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_ESR << 48) | ((uint64_t)B2B_ECADO_B2B_PMINJ << 36);
-        condition[6]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[6]        = tmpTag;
-
-        // SIS18 to ESR, PREXT
-        tmpTag        = tagPre;       
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_ESR << 48) | ((uint64_t)B2B_ECADO_B2B_PREXT << 36);
-        condition[7]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[7]        = tmpTag;
-
-        // SIS18 to ESR, PRINJ
-        tmpTag        = tagPri;       
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_ESR << 48) | ((uint64_t)B2B_ECADO_B2B_PRINJ << 36);
-        condition[8]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[8]        = tmpTag;
-   
-        // SIS18 to ESR, DIAGEXT
-        tmpTag        = tagPde;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_ESR << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGEXT << 36);
-        condition[9]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[9]        = tmpTag;
-
-        // SIS18 to ESR, DIAGINJ
-        tmpTag        = tagPdi;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_B2B_ESR << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGINJ << 36);
-        condition[10] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[10]       = tmpTag;
-        
-        // SIS18 extraction kicker trigger
-        tmpTag        = tagKte;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_RING << 48) | ((uint64_t)B2B_ECADO_B2B_TRIGGEREXT << 36);
-        condition[11] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[11]       = tmpTag;
-        
-        // SIS18 extraction kicker diagnostic
-        tmpTag        = tagKde;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)SIS18_RING << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGKICKEXT << 36);
-        condition[12] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[12]       = tmpTag;
-        
-        // ESR injection kicker trigger
-        tmpTag        = tagKti;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_RING << 48) | ((uint64_t)B2B_ECADO_B2B_TRIGGERINJ << 36);
-        condition[13] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[13]       = tmpTag;
-        
-        // ESR injection kicker diagnostic
-        tmpTag        = tagKdi;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_RING << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGKICKINJ << 36);
-        condition[14] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[14]       = tmpTag;
-        
-        break;
-      case ESR_RING : 
-
-        // ESR, CMD_B2B_START, signals start of data collection
-        tmpTag        = tagStart;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_RING << 48) | ((uint64_t)B2B_ECADO_B2B_START << 36);
-        condition[0]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[0]        = tmpTag;
-        
-        // ESR, CMD_B2B_START, +100ms (!), signals stop of data collection 
-        tmpTag        = tagStop;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_RING << 48) | ((uint64_t)B2B_ECADO_B2B_START << 36);
-        condition[1]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 100000000, tmpTag));
-        //tag[1]        = tmpTag;
-        
-        // ESR to extraction, PMEXT, 
-        tmpTag        = tagPme;       
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_PMEXT << 36);
-        condition[2]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[2]        = tmpTag;
-
-        // ESR to extraction, PREXT
-        tmpTag        = tagPre;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_PREXT << 36);
-        condition[3]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[3]        = tmpTag;
-
-        // ESR to extraction, DIAGEXT
-        tmpTag        = tagPde;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGEXT << 36);
-        condition[4]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[4]        = tmpTag;
-       
-        // ESR to CRYRING, PMEXT
-        tmpTag        = tagPme;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_CRYRING << 48) | ((uint64_t)B2B_ECADO_B2B_PMEXT << 36);
-        condition[5]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[5]        = tmpTag;
-
-        // ESR to CRYRING, PMINJ
-        tmpTag        = tagPmi;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_CRYRING << 48) | ((uint64_t)B2B_ECADO_B2B_PMINJ << 36);
-        condition[6]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[6]        = tmpTag;
-
-        // ESR to CRYRING, PREXT
-        tmpTag        = tagPre;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_CRYRING << 48) | ((uint64_t)B2B_ECADO_B2B_PREXT << 36);
-        condition[7]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[7]        = tmpTag;
-
-        // ESR to CRYRING, PRINJ
-        tmpTag        = tagPri;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_CRYRING << 48) | ((uint64_t)B2B_ECADO_B2B_PRINJ << 36);
-        condition[8]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[8]        = tmpTag;
-   
-        // ESR to CRYRING, DIAGEXT
-        tmpTag        = tagPde;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_CRYRING << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGEXT << 36);
-        condition[9]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[9]        = tmpTag;
-
-        // ESR to CRYRING, DIAGINJ
-        tmpTag        = tagPdi;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_B2B_CRYRING << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGINJ << 36);
-        condition[10] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[10]       = tmpTag;
-
-        // ESR extraction kicker trigger
-        tmpTag        = tagKte;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_RING << 48) | ((uint64_t)B2B_ECADO_B2B_TRIGGEREXT << 36);
-        condition[11] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[11]       = tmpTag;
-        
-        // ESR extraction kicker diagnostic
-        tmpTag        = tagKde;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)ESR_RING << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGKICKEXT << 36);
-        condition[12] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[12]       = tmpTag;
-
-        // CRYRING injection kicker trigger
-        tmpTag        = tagKti;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_RING << 48) | ((uint64_t)B2B_ECADO_B2B_TRIGGERINJ << 36);
-        condition[13] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[13]       = tmpTag;
-        
-        // CRYRING injection kicker diagnostic
-        tmpTag        = tagKdi;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_RING << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGKICKINJ << 36);
-        condition[14] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[14]       = tmpTag;
-
-        break;
-      case CRYRING_RING : 
-
-        // CRYRING, CMD_B2B_START, signals start of data collection
-        tmpTag        = tagStart;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_RING << 48) | ((uint64_t)B2B_ECADO_B2B_START << 36);
-        condition[0]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[0]        = tmpTag;
-        
-        // CRYRING, CMD_B2B_START, +100ms (!), signals stop of data collection 
-        tmpTag        = tagStop;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_RING << 48) | ((uint64_t)B2B_ECADO_B2B_START << 36);
-        condition[1]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 100000000, tmpTag));
-        //tag[1]        = tmpTag;
-        
-        // CRYRING to extraction, PMEXT, 
-        tmpTag        = tagPme;        
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_PMEXT << 36);
-        condition[2]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[2]        = tmpTag;
-
-        // CRYRING to extraction, PREXT
-        tmpTag        = tagPre;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_PREXT << 36);
-        condition[3]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[3]        = tmpTag;
-
-        // CRYRING to extraction, DIAGEXT
-        tmpTag        = tagPde;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_B2B_EXTRACT << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGEXT << 36);
-        condition[4]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[4]        = tmpTag;
-       
-        // CRYRING extraction kicker trigger
-        tmpTag        = tagKte;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_RING << 48) | ((uint64_t)B2B_ECADO_B2B_TRIGGEREXT << 36);
-        condition[5]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[5]        = tmpTag;
-        
-        // CRYRING extraction kicker diagnostic
-        tmpTag        = tagKde;
-        snoopID       = ((uint64_t)FID << 60) | ((uint64_t)CRYRING_RING << 48) | ((uint64_t)B2B_ECADO_B2B_DIAGKICKEXT << 36);
-        condition[6]  = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, snoopID, 0xfffffff000000000, 0, tmpTag));
-        //tag[6]        = tmpTag;
-
-        break;
-      default :
-        std::cerr << "Extraction ring " << reqExtRing << " does not exit" << std::endl;
-        exit(1);
-    } // switch extRing
+    for (i=0; i<nCondition; i++)
+      condition[i] = EmbeddedCPUCondition_Proxy::create(e_cpu->NewCondition(false, cond[i].id, cond[i].mask, cond[i].offset, cond[i].tag));
 
     // let's go!
     for (i=0; i<nCondition; i++) {
@@ -829,12 +809,18 @@ int main(int argc, char** argv)
     uint32_t      qIdx = 0;
     uint64_t      t1, t2;
     uint32_t      tmp32;
+    ecamsg_t      msg;
 
     sprintf(ebPath, "%s", receiver->getEtherbonePath().c_str());
     if ((ebStatus = comlib_ecaq_open(ebPath, qIdx, &device, &ecaq_base)) != EB_OK) {
       std::cerr << program << ": can't open lm32 ECA queue" << std::endl;
       exit(1);
     } // if ebStatus
+
+    if (recordName && (b2b_record_open(&record, recordName) != COMMON_STATUS_OK)) {
+      std::cerr << program << ": can't create file " << recordName << std::endl;
+      exit(1);
+    } // if recordName
     
     while(true) {
       //      saftlib::wait_for_signal();
@@ -848,9 +834,19 @@ int main(int argc, char** argv)
         deadline_t = saftlib::makeTimeTAI(deadline);
         //t2         = comlib_getSysTime(); printf("msg: tag %x, id %lx, tef %lx, dtu %lu\n", recTag, evtId, tef, (uint32_t)(t2 -t1));
         timingMessage(recTag, deadline_t, evtId, param, tef, isLate, isEarly, isConflict, isDelayed);
+        if (record && (cond[recTag].offset == 0)) {     // actions with offset are created again by the replay
+          msg.evtId    = evtId;
+          msg.param    = param;
+          msg.deadline = deadline;
+          msg.executed = 0;                              // not available from the ECA queue
+          msg.flags    = isLate | (isEarly << 1) | (isConflict << 2) | (isDelayed << 3);
+          msg.tef      = tef;
+          b2b_record_write(record, &msg);
+        } // if record
       }
     } // while true
     comlib_ecaq_close(device);
+    b2b_replay_close(record);
     
   } // try
   catch (const saftbus::Error& error) {
@@ -3,7 +3,7 @@
  *
  *  created : 2023
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 21-Sep-2023
+ *  version : 18-Oct-2026
  *
  * simple simulation program for b2b measurements
  * - phase diagnostics
@@ -35,9 +35,11 @@
  * For all questions and ideas contact: d.beck@gsi.de
  * Last update: 15-April-2019
  *********************************************************************************************/
-#define B2BSIM_VERSION 0x000702
+#define B2BSIM_VERSION 0x000800
 #define MAXSAMPLES     1000
 #define MAXDATA        10000000
+#define MAXGRID        100000               // max number of points of parameter grid
+#define MAXTHREADS     256                  // max number of threads for grid
 
 // standard includes 
 #include <unistd.h> // getopt
@@ -47,20 +49,15 @@
 #include <stdint.h>
 #include <math.h>
 #include <time.h>
+#include <pthread.h>
 
 // b2b includes
 #include <b2blib.h>
+#include <b2b-phasefit.h>
 
 const char* program;
 static int getVersion = 0;
 
-typedef struct{                                      
-  uint64_t ns;                             // full nanoseconds of time
-  int32_t  ps;                             // ps fraction of time, should be positive
-  uint32_t dps;                            // uncertainty [ps]
-} b2bt_t;
-
-
 uint64_t   TH1_as      = 1283767311562;     // h=1 period [as]
 uint64_t   one_ns_as   = 1000000000;        // 1 ns [as]
 int        mode        = 1;                 // simulate, 1: single phase 2: phase difference
@@ -73,12 +70,57 @@ uint64_t   tOffset2_as = 2000000000;        // offset of first timestamp of 2nd
 uint64_t   noiseO_as   = 0;                 // amplitude of noise on tOffset 
 char       filename[1024];                  // file name for output
 FILE       *dataFile;                       // file for data
+uint64_t   seed;                            // seed for random numbers
+uint64_t   nPeriods;                        // number of periods between two measurements
+int        flagNPeriods = 0;                // nPeriods given by user
 
-uint64_t   tEdge_as[MAXSAMPLES];            // rising edges of h=1 signal
-uint64_t   tEdgeNoisy_as[MAXSAMPLES];       // rising edges of h=1 signal with noise
-uint64_t   tStamp[MAXSAMPLES];              // tStamps
 double     dev[MAXDATA];                    // deviation for stdev
 
+// state of one simulation; each thread works on its own
+typedef struct {
+  uint64_t key;                             // key of random number stream
+  uint64_t ctr;                             // counter of random number stream
+  uint64_t TH1_as;                          // h=1 period [as]
+  int      nSamples;                        // number of samples
+  uint64_t noise_as;                        // noise on timestamps [as]
+  uint64_t tEdge_as[MAXSAMPLES];            // rising edges of h=1 signal
+  uint64_t tEdgeNoisy_as[MAXSAMPLES];       // rising edges of h=1 signal with noise
+  uint64_t tStamp[MAXSAMPLES];              // tStamps
+  uint64_t tEdge1_as;                       // 2nd edge of 1st series (used as reference)
+  uint64_t tEdgeNoisy1_as;                  // 2nd edge of 1st series with noise
+  int64_t  tPhase1_as;                      // fitted phase of 1st series
+  uint32_t width_as;                        // width of fit of 1st series
+} simctx_t;
+
+// parameter grid, each axis is given as 'first:last:nSteps'
+typedef struct {
+  uint64_t first;
+  uint64_t last;
+  int      n;
+} axis_t;
+
+axis_t     gridNoise   = {0, 0, 0};         // noise on timestamps [as]
+axis_t     gridSamples = {0, 0, 0};         // number of samples
+axis_t     gridTH1     = {0, 0, 0};         // h=1 period [as]
+int        nThreads    = 0;                 // number of threads, 0: number of cores
+
+// result of one grid point; all values [ns]
+typedef struct {
+  uint64_t TH1_as;
+  int      nSamples;
+  uint64_t noise_as;
+  double   ave;
+  double   stdev;
+  double   min;
+  double   max;
+  double   aveWidth;
+  double   maxWidth;
+} simres_t;
+
+simres_t   *gridRes;                        // results of grid
+int        nGrid;                           // number of grid points
+int        gridNext;                        // next grid point to be processed
+
 
 static void help(void) {
   fprintf(stderr, "Usage: %s [OPTION] <etherbone-device>\n", program);
@@ -98,177 +140,284 @@ static void help(void) {
   fprintf(stderr, "  -i <scan increment>     scan increment [fs]\n");
   fprintf(stderr, "  -f <filename>           write data to file\n");
   fprintf(stderr, "  -n <nPeriods>           number of periods between two measurements\n");
+  fprintf(stderr, "  -z <seed>               seed for random numbers, default: time\n");
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  parameter grid (Monte Carlo), axes are given as <first>:<last>:<nSteps>\n");
+  fprintf(stderr, "  -R <grid noise ts>      grid of noise on timestamps [fs]\n");
+  fprintf(stderr, "  -S <grid nSamples>      grid of number of samples\n");
+  fprintf(stderr, "  -P <grid rf-period>     grid of hf period (h=1) [fs]\n");
+  fprintf(stderr, "  -j <nThreads>           number of threads for grid, default: number of cores\n");
   fprintf(stderr, "\n");
   fprintf(stderr, "Example1: '%s -T732996993 -m1 -t1 -c1 -i20000 -d500 -s30'\n", program);
+  fprintf(stderr, "Example2: '%s -T732996993 -d10000 -z42 -R0:200000:21 -S4:64:16'\n", program);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "If any grid option is given, the simulation runs for all points of the grid in parallel and prints\n");
+  fprintf(stderr, "one line per grid point; axes not given use the respective single value. Each grid point has its\n");
+  fprintf(stderr, "own stream of random numbers, results are identical for a given seed, regardless of '-j'.\n");
   fprintf(stderr, "\n");
   fprintf(stderr, "Report software bugs to <d.beck@gsi.de>\n");
   fprintf(stderr, "Version %x. Licensed under the LGPL v3.\n", B2BSIM_VERSION);
 } //help
 
 
-// perform fit of phase with sub-ns
-int32_t phaseFitAverage(uint64_t TH1_as, uint32_t nSamples, b2bt_t *phase_t, uint32_t *width_as) {
-  int64_t  one_ns_as        = 1000000000;   // conversion ns to as
-  int64_t  max_diff_as = TH1_as >> 2;       // maximum difference shall be a quarter of the rf-period
-  
-  int      i;
-  uint64_t tFirst_ns;                       // first timestamp [ns]
-  //uint64_t nPeriods;                      // number of rf periods
-  uint64_t diff_stamp_as;                   // difference between actual and first timestamp [as]
-  int64_t  sum_rfperiods_as;                // sum of all rf-periods [as] 
-  int64_t  deviation_as;                    // deviation between measured and projected timestamp [as]
-  int64_t  abs_deviation_as;                // absolute value of deviation [as]
-  int64_t  sum_deviation_as;                // sum of all deviations [as]
-  int64_t  ave_deviation_as;                // average of all deviations [as]
-  int64_t  max_deviation_as;                // maximum of all deviations [as]
-  int64_t  min_deviation_as;                // minimum of all deviations [as]
-  int64_t  subnsfit_dev_as;                 // sub-ns-fit deviation [as]
-  uint32_t dev_width_as;                    // width of window of all 'deviation_as'
-  b2bt_t   ts_t;                            // timestamp [ps]
-  int      nGood;                           // number of good timestamps
-
-  // The idea is similar to the native sub-ns fit. As the main difference, the fractional part is 
-  // not calculated by the _two_ extremes only, but by using the average of _all_ samples.
-  // The algorithm is as follows
-  // - always start from the 1st 'good' timestamp (which is the tStamp[1], tStamp[0] might be bad)
-  // - for tStamp[i], add (i-1)*rf-period to the first timestamp and calc the difference to tStamp[i]
-  // - average all the differences -> one obtains the mean value of all differences
-  // - use the mean values as fractional part and add this to the value of tStamp[1]
-  // Be aware: timestamps are sorted, but maybe incomplete. The algorithm stops at the first missing timestamp.
-
-  if (TH1_as==0)    return 1;               // rf period must be known
-  if (nSamples < 3) return 1;               // need at least three measurements
-
-  // init stuff
-  tFirst_ns = tStamp[1];              // don't use 1st timestamp tStamp[0]: start with 2nd timestamp tStamp[1]
-  sum_deviation_as = 0;
-  sum_rfperiods_as = 0;
-  nGood            = 0;
-  max_deviation_as = 0;
-  min_deviation_as = 0;
-
-  // calc sum deviation of all timestamps
-  for (i=1; i<nSamples; i++) {        // include 1st timestamp too (important for little statistics)
-  //for (i=1; i<27; i++) {  // HACK      // include 1st timestamp too (important for little statistics)
-    
-    diff_stamp_as = (tStamp[i] - tFirst_ns) * one_ns_as;
-
-    // we use ther number of iterations as the number of rf-periods; thus, the algorithm will
-    // stop at the first missing timestamp
-    deviation_as  = diff_stamp_as - sum_rfperiods_as;
-
-    //printf("diff_stamp_ns    %13.3f\n", (double)diff_stamp_as     / 1000000000.0);
-    //printf("sum_rfperiods_ns %13.3f\n", (double)sum_rfperiods_as  / 1000000000.0);
-    //printf("deviation_as    %13.3f\n",  (double)deviation_as      / 1000000000.0);
-
-    if (deviation_as < 0) abs_deviation_as = -deviation_as;
-    else                  abs_deviation_as =  deviation_as;
-    // do a simple consistency check - don't accept differences larger than max_diff
-    if (abs_deviation_as < max_diff_as) {
-      sum_deviation_as += deviation_as;
-      nGood++;
-      // simple statistics
-      if (deviation_as > max_deviation_as) max_deviation_as = deviation_as;
-      if (deviation_as < min_deviation_as) min_deviation_as = deviation_as;
-    } // if abs_deviation in range
-
-    // increment rf period for next iteration
-    sum_rfperiods_as += TH1_as;
-  } // for i
 
-  // if result invalid, return with error
-  if (nGood < 1) {
-    (*phase_t).ns  = 0x7fffffffffffffff;
-    (*phase_t).ps  = 0x7fffffff;
-    (*phase_t).dps = 0x7fffffff;
-    return 1;
-  } // if nGood < 1
-
-  // calculate average and jitter (= a quarter of the max-min window)
-  ave_deviation_as = sum_deviation_as / nGood;
-  subnsfit_dev_as  = (max_deviation_as + min_deviation_as) >> 1; 
-  dev_width_as     = (uint32_t)(max_deviation_as - min_deviation_as);
-  // calculate a phase value and convert to ps
-  ts_t.ns          = tFirst_ns;
-  if (fit ==1 ) ts_t.ps = subnsfit_dev_as  / 1000000;  // sub-ns fit
-  else          ts_t.ps = ave_deviation_as / 1000000;  // average fit
-  ts_t.dps         = dev_width_as  / nGood / 1000000;  // chk 
-  *phase_t         = ts_t;
-  *width_as        = dev_width_as;
-
-  //printf("nSamples %d, nGood %d, ts_t [ns] %d, ts_t [ps] %d, dt [ps] %d\n", nSamples, nGood, ts_t.ns, ts_t.ps, ts_t.dps);
-  return 0;
-} //phaseFitAverage
 
+// counter based random numbers (splitmix64): the n-th number of a stream depends only on key and n
+uint64_t rand64(simctx_t *ctx) {
+  uint64_t z;
+
+  z = ctx->key + (++ctx->ctr) * 0x9e3779b97f4a7c15;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+
+  return z ^ (z >> 31);
+} // rand64
 
-void calcTEdge_as(uint64_t t0_as) {                                // calculates a series of rising h=1 edges
+
+// uniform random number in (0, 1]
+double randUniform(simctx_t *ctx) {
+  return (double)((rand64(ctx) >> 11) + 1) * (1.0 / 9007199254740992.0);
+} // randUniform
+
+
+void calcTEdge_as(simctx_t *ctx, uint64_t t0_as) {                 // calculates a series of rising h=1 edges
   int    i;
 
-  for (i=0; i<nSamples; i++) tEdge_as[i] = t0_as + i * TH1_as;
+  for (i=0; i<ctx->nSamples; i++) ctx->tEdge_as[i] = t0_as + i * ctx->TH1_as;
 } // calcTEdge
 
 
 // random gaussian noise
 // formula: z = sqrt(-2 * ln(x1)) * cos(2*pi*x2)
-double randGauss(double sigma, double x0) {
+double randGauss(simctx_t *ctx, double sigma, double x0) {
   double x1, x2, z;
 
-  x1 = (double)random() / (double)RAND_MAX;
-  x2 = (double)random() / (double)RAND_MAX;
-  z  = sqrt(-2 * log(x1)) * cos(2 * 3.14 * x2);
+  x1 = randUniform(ctx);
+  x2 = randUniform(ctx);
+  z  = sqrt(-2 * log(x1)) * cos(2 * M_PI * x2);
   z  = z * sigma + x0;
 
-  //printf("z: %13.3f\n", z);
-
   return z;
 }  // randGauss
 
 
-
-int64_t calcNoise_as(int64_t sigma_noise_as) {
+int64_t calcNoise_as(simctx_t *ctx, int64_t sigma_noise_as) {
   double   noise;
   int64_t  noise_as;
   double   sigma;
 
-  //noise = (double)noise_fs * ((double)random() / (double)RAND_MAX); // fs, 0..noise_fs
-  //noise = noise - (double)noise_fs / 2.0;                           // fs, -noise_fs/2 .. +noise_fs/2
-  //noise = noise / 1000000.0;                                        // ns
-
   sigma    = (double)sigma_noise_as / (double)one_ns_as;
-  noise    = randGauss(sigma, 0);
+  noise    = randGauss(ctx, sigma, 0);
   noise_as = (int64_t)(noise * one_ns_as);
-  //printf("sigmas_noise   %13ld\n", sigma_noise_as);
-  //printf("gauss noise    %13.0f\n", noise * one_ns_as);
-  //printf("gauss_noise_as %13ld\n",  noise_as);
 
   return noise_as;
 } // calcNoise
 
 
-void calcTEdgeNoisy_as() {                            // adds noise to h=1 eges 
+void calcTEdgeNoisy_as(simctx_t *ctx) {               // adds noise to h=1 eges
   int      i;
-  int64_t  cnoise_as;
-
-  for (i=0; i<nSamples; i++) {
-    cnoise_as        =  calcNoise_as(noise_as);
-    tEdgeNoisy_as[i] = tEdge_as[i] + cnoise_as;
-    //printf("--\n");
-    //printf("edge      %14lu\n",  tEdge_as[i]);
-    //printf("noise     %14ld\n",  cnoise_as);
-    //printf("edgeNoisy %14lu\n",  tEdgeNoisy_as[i]);
+  double   sigma;
+  double   r, phi;
+
+  // Box-Muller provides two independent numbers per pair of uniform numbers, use both
+  sigma = (double)ctx->noise_as / (double)one_ns_as;
+  for (i=0; i<ctx->nSamples; i+=2) {
+    r   = sigma * sqrt(-2 * log(randUniform(ctx)));
+    phi = 2 * M_PI * randUniform(ctx);
+    ctx->tEdgeNoisy_as[i]     = ctx->tEdge_as[i]     + (int64_t)(r * cos(phi) * one_ns_as);
+    if (i + 1 < ctx->nSamples)
+      ctx->tEdgeNoisy_as[i+1] = ctx->tEdge_as[i + 1] + (int64_t)(r * sin(phi) * one_ns_as);
   } // for i
 } // calcTEdgenoisy_as
 
 
-void calcTStamp() {
+void calcTStamp(simctx_t *ctx) {
   int    i;
 
-  for (i=0; i<nSamples; i++) tStamp[i] = floor(tEdgeNoisy_as[i] / one_ns_as);
-  //printf("tstamp   %lu \n", tStamp[0]);
-  //printf("edgenosy %lu \n", tEdgeNoisy_as[0]);
+  for (i=0; i<ctx->nSamples; i++) ctx->tStamp[i] = ctx->tEdgeNoisy_as[i] / one_ns_as;
 } // calcTstamps
 
 
+// simulates one measurement; returns deviation [as]
+int64_t simMeasure(simctx_t *ctx, uint64_t tOff1_as, uint64_t nPer) {
+  b2bt_t   phase_t;
+  int64_t  offsetNoise_as;
+  int64_t  tPhase2_as;
+  int64_t  diff_as = 0;
+  uint32_t width_as;
+  int      method  = (fit == 1) ? PHFIT_SUBNS : PHFIT_AVERAGE;
+  uint64_t tOff2_as;
+
+  tOff2_as            = tOff1_as + nPer * ctx->TH1_as;
+  offsetNoise_as      = calcNoise_as(ctx, noiseO_as);
+  calcTEdge_as(ctx, tOff1_as + offsetNoise_as);
+  calcTEdgeNoisy_as(ctx);
+  calcTStamp(ctx);
+  phfit_phaseFitAverage(ctx->tStamp, ctx->nSamples, ctx->TH1_as, method, &phase_t, &width_as);
+  ctx->tPhase1_as     = phase_t.ns * one_ns_as + phase_t.ps * 1000000 + one_ns_as / 2;
+  ctx->tEdge1_as      = ctx->tEdge_as[1];
+  ctx->tEdgeNoisy1_as = ctx->tEdgeNoisy_as[1];
+  ctx->width_as       = width_as;
+
+  switch (mode) {
+    case 1 :
+      diff_as    = ctx->tPhase1_as - ctx->tEdgeNoisy_as[1];
+      break;
+    case 2 :
+      calcTEdge_as(ctx, tOff2_as + offsetNoise_as);
+      calcTEdgeNoisy_as(ctx);
+      calcTStamp(ctx);
+      phfit_phaseFitAverage(ctx->tStamp, ctx->nSamples, ctx->TH1_as, method, &phase_t, &width_as);
+      tPhase2_as = phase_t.ns * one_ns_as + phase_t.ps * 1000000 + one_ns_as / 2;
+      diff_as    = tPhase2_as - ctx->tPhase1_as;
+      diff_as    = diff_as % ctx->TH1_as;
+      if (diff_as > (ctx->TH1_as >> 1)) diff_as = diff_as - ctx->TH1_as;
+      break;
+    default :
+      break;
+  } //switch mode
+
+  return diff_as;
+} // simMeasure
+
+
+// value of axis at index
+uint64_t axisValue(axis_t *axis, uint64_t dflt, int idx) {
+  if (axis->n < 1) return dflt;
+  if (axis->n < 2) return axis->first;
+
+  return axis->first + (uint64_t)((double)(axis->last - axis->first) * (double)idx / (double)(axis->n - 1));
+} // axisValue
+
+
+// parses 'first:last:nSteps'; values below 'min' are rejected; returns 0 on success
+int axisParse(axis_t *axis, char *arg, uint64_t scale, uint64_t min) {
+  char *tail;
+  long n;
+
+  if (strchr(arg, '-')) return 1;                                          // strtoull silently wraps negative values
+  axis->first = strtoull(arg, &tail, 0) * scale;
+  if (*tail != ':') return 1;
+  axis->last  = strtoull(tail + 1, &tail, 0) * scale;
+  if (*tail != ':') return 1;
+  n           = strtol(tail + 1, &tail, 0);
+  if ((*tail != 0) || (n < 1) || (n > MAXGRID) || (axis->first < min) || (axis->last < axis->first)) return 1;
+  axis->n     = n;
+
+  return 0;
+} // axisParse
+
+
+// simulates one grid point; all statistics in sequential order, thus independent of the thread
+void simGridPoint(simctx_t *ctx, int idx) {
+  simres_t *res = &(gridRes[idx]);
+  uint64_t nPer;
+  double   d, delta, m2;
+  int      i;
+  int      nN  = gridNoise.n   > 0 ? gridNoise.n   : 1;
+  int      nS  = gridSamples.n > 0 ? gridSamples.n : 1;
+
+  ctx->key      = seed ^ ((uint64_t)idx * 0xd1b54a32d192ed03);
+  ctx->ctr      = 0;
+  ctx->noise_as = axisValue(&gridNoise,   noise_as, idx % nN);
+  ctx->nSamples = axisValue(&gridSamples, nSamples, (idx / nN) % nS);
+  ctx->TH1_as   = axisValue(&gridTH1,     TH1_as,   idx / (nN * nS));
+  if (flagNPeriods) nPer = nPeriods;
+  else              nPer = ((uint64_t)15900000 * one_ns_as) / ctx->TH1_as;
+
+  res->TH1_as   = ctx->TH1_as;
+  res->nSamples = ctx->nSamples;
+  res->noise_as = ctx->noise_as;
+  res->ave      = 0;
+  res->min      = 1000;
+  res->max      = -1000;
+  res->aveWidth = 0;
+  res->maxWidth = 0;
+  m2            = 0;
+
+  // Welford's algorithm, no need to store the deviations
+  for (i=0; i<nData; i++) {
+    d              = (double)simMeasure(ctx, tOffset1_as, nPer) / (double)one_ns_as;
+    delta          = d - res->ave;
+    res->ave      += delta / (i + 1);
+    m2            += delta * (d - res->ave);
+    if (d > res->max) res->max = d;
+    if (d < res->min) res->min = d;
+    res->aveWidth += (double)ctx->width_as / one_ns_as;
+    if ((double)ctx->width_as / one_ns_as > res->maxWidth) res->maxWidth = (double)ctx->width_as / one_ns_as;
+  } // for i
+  res->aveWidth /= nData;
+  res->stdev     = sqrt(m2 / nData);
+} // simGridPoint
+
+
+// worker thread for grid; grabs the next grid point until done
+void *gridWorker(void *arg) {
+  simctx_t *ctx;
+  int      idx;
+
+  if (!(ctx = malloc(sizeof(simctx_t)))) return NULL;
+  while ((idx = __atomic_fetch_add(&gridNext, 1, __ATOMIC_RELAXED)) < nGrid) simGridPoint(ctx, idx);
+  free(ctx);
+
+  return NULL;
+} // gridWorker
+
+
+// runs all points of the grid and prints the results; returns 0 on success
+int simGrid() {
+  pthread_t       threads[MAXTHREADS];
+  struct timespec tStart, tStop;
+  FILE            *out;
+  simres_t        *res;
+  int             i, n;
+  uint64_t        nPoints;
+
+  // each axis has at most MAXGRID steps, thus the product fits into 64 bit
+  nPoints = (uint64_t)(gridNoise.n > 0 ? gridNoise.n : 1) * (uint64_t)(gridSamples.n > 0 ? gridSamples.n : 1) * (uint64_t)(gridTH1.n > 0 ? gridTH1.n : 1);
+  if (nPoints > MAXGRID) {
+    printf("grid: too many points %lu, max is %d\n", nPoints, MAXGRID);
+    return 1;
+  } // if nPoints
+  nGrid = nPoints;
+  for (i=0; i<gridSamples.n; i++) {
+    n = axisValue(&gridSamples, nSamples, i);
+    if ((n < 3) || (n > MAXSAMPLES)) {
+      printf("option 'S' (grid nSamples): valid range is 3..%d\n", MAXSAMPLES);
+      return 1;
+    } // if n
+  } // for i
+  if (!(gridRes = calloc(nGrid, sizeof(simres_t)))) return 1;
+
+  if (nThreads < 1)          nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+  if (nThreads < 1)          nThreads = 1;
+  if (nThreads > MAXTHREADS) nThreads = MAXTHREADS;
+  if (nThreads > nGrid)      nThreads = nGrid;
+
+  clock_gettime(CLOCK_MONOTONIC, &tStart);
+  gridNext = 0;
+  for (i=1; i<nThreads; i++) pthread_create(&(threads[i]), NULL, gridWorker, NULL);
+  gridWorker(NULL);
+  for (i=1; i<nThreads; i++) pthread_join(threads[i], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &tStop);
+
+  out = dataFile ? dataFile : stdout;
+  fprintf(out, "# b2b-sim grid: mode %d, fit %d, nData %d, seed %lu, points %d, threads %d, time %.3f s\n", mode, fit, nData, seed, nGrid, nThreads,
+          (double)(tStop.tv_sec - tStart.tv_sec) + (double)(tStop.tv_nsec - tStart.tv_nsec) / 1000000000.0);
+  fprintf(out, "# %13s %8s %13s %13s %13s %13s %13s %13s %13s %13s\n", "T_rev[ns]", "nSamples", "noise[ns]", "ave[ps]", "stdev[ps]",
+          "min[ps]", "max[ps]", "aveWidth[ps]", "maxWidth[ps]", "maxSysDev[ps]");
+  for (i=0; i<nGrid; i++) {
+    res = &(gridRes[i]);
+    fprintf(out, "  %13.6f %8d %13.6f %13.3f %13.3f %13.3f %13.3f %13.3f %13.3f %13u\n", (double)res->TH1_as / (double)one_ns_as, res->nSamples,
+            (double)res->noise_as / (double)one_ns_as, res->ave * 1000, res->stdev * 1000, res->min * 1000, res->max * 1000, res->aveWidth * 1000,
+            res->maxWidth * 1000, b2b_calc_max_sysdev_ps(res->TH1_as, res->nSamples, 0));
+  } // for i
+  free(gridRes);
+
+  return 0;
+} // simGrid
+
+
 int main(int argc, char** argv) {
   //const char* command;
 
@@ -276,32 +425,32 @@ int main(int argc, char** argv) {
   int  exitCode   = 0;
   char *tail;
   char *tmp;
+  long lTmp;
 
-  b2bt_t   phase_t;
-  int64_t  tPhase1_as, tPhase2_as;
+  simctx_t *ctx;
+  int64_t  tPhase1_as;
   double   tEdge1        = 0;
   double   tEdgeNoisy1;
   int64_t  diff_as;
-  uint32_t width_as;
   int      scanType      = 0;                 // 0: don't scan, 1: tOffset1
   uint64_t scanInc_as    = 1;                 // increment of scan
-  int64_t  offsetNoise_as;
   double   max           = -1000;
   double   min           = 1000;
   double   ave           = 0;
   double   stdev         = 0;
   double   ave_width     = 0;
   uint32_t max_width_as  = 0;
-  uint64_t nPeriods;
+  int      flagGrid      = 0;
   
   int     i;
   
   sprintf(filename, "%s", "");
+  seed             = time(NULL);
   nPeriods         = (floor)(((uint64_t)15900000 * one_ns_as) / TH1_as);
  
   program = argv[0];    
 
-  while ((opt = getopt(argc, argv, "T:c:i:t:n:f:m:o:p:s:r:d:eh")) != -1) {
+  while ((opt = getopt(argc, argv, "T:c:i:t:n:f:m:o:p:s:r:d:z:R:S:P:j:eh")) != -1) {
     switch (opt) {
       case 'e' :
         getVersion = 1;
@@ -342,6 +491,39 @@ int main(int argc, char** argv) {
         break;
       case 'n' :
         nPeriods    = strtol(optarg, &tail, 0);
+        flagNPeriods = 1;
+        break;
+      case 'z' :
+        seed        = strtoull(optarg, &tail, 0);
+        break;
+      case 'R' :
+        if (axisParse(&gridNoise, optarg, 1000, 0)) {                         // fs -> as
+          fprintf(stderr, "specify a proper grid <first>:<last>:<nSteps>, not '%s'!\n", optarg);
+          exit(1);
+        } // if axisParse
+        flagGrid    = 1;
+        break;
+      case 'S' :
+        if (axisParse(&gridSamples, optarg, 1, 0)) {
+          fprintf(stderr, "specify a proper grid <first>:<last>:<nSteps>, not '%s'!\n", optarg);
+          exit(1);
+        } // if axisParse
+        flagGrid    = 1;
+        break;
+      case 'P' :
+        if (axisParse(&gridTH1, optarg, 1000, 1)) {                        // fs -> as; period must not be zero
+          fprintf(stderr, "specify a proper grid <first>:<last>:<nSteps>, not '%s'!\n", optarg);
+          exit(1);
+        } // if axisParse
+        flagGrid    = 1;
+        break;
+      case 'j' :
+        lTmp        = strtol(optarg, &tail, 0);
+        if ((tail == optarg) || (*tail != 0) || (lTmp < 0) || (lTmp > MAXTHREADS)) {
+          fprintf(stderr, "specify a proper number of threads 0..%d, not '%s'!\n", MAXTHREADS, optarg);
+          exit(1);
+        } // if lTmp
+        nThreads    = lTmp;
         break;
       case 'f' :
         tmp = strtok(optarg, " ");
@@ -385,10 +567,20 @@ int main(int argc, char** argv) {
     dataFile = fopen(filename, "w");
   } // if output file
 
-  srandom(time(NULL));
+  if (flagGrid) {
+    exitCode = simGrid();
+    if (dataFile) fclose(dataFile);
+    return exitCode;
+  } // if flagGrid
+
+  if (!(ctx = malloc(sizeof(simctx_t)))) return 1;
+  ctx->key         = seed;
+  ctx->ctr         = 0;
+  ctx->TH1_as      = TH1_as;
+  ctx->nSamples    = nSamples;
+  ctx->noise_as    = noise_as;
   tEdgeNoisy1      = 0;
   tPhase1_as       = 0;
-  tPhase2_as       = 0;
   diff_as          = 0;
   ave_width        = 0;
   // looping over j can be used to produce nice figures 
@@ -407,34 +599,13 @@ int main(int argc, char** argv) {
     } // switch scanType
     tOffset2_as     = tOffset1_as + nPeriods * TH1_as;
 
-    offsetNoise_as   = calcNoise_as(noiseO_as);
-    calcTEdge_as(tOffset1_as + offsetNoise_as);
-    calcTEdgeNoisy_as();
-    calcTStamp();
-    phaseFitAverage(TH1_as, nSamples, &phase_t, &width_as);
-    tPhase1_as     = phase_t.ns * one_ns_as + phase_t.ps * 1000000 + one_ns_as / 2;
-    tEdge1         = (double)(tEdge_as[1])      / one_ns_as;
-    tEdgeNoisy1    = (double)(tEdgeNoisy_as[1]) / one_ns_as;
-    ave_width     += (double)width_as           / one_ns_as;
-    if (width_as > max_width_as) max_width_as = width_as;
-
-    switch (mode) {
-      case 1 :
-        diff_as    = tPhase1_as - tEdgeNoisy_as[1];
-        break;
-      case 2 :
-        calcTEdge_as(tOffset2_as + offsetNoise_as);
-        calcTEdgeNoisy_as();
-        calcTStamp();
-        phaseFitAverage(TH1_as, nSamples, &phase_t, &width_as);
-        tPhase2_as = phase_t.ns * one_ns_as + phase_t.ps * 1000000 + one_ns_as / 2;
-        diff_as    = tPhase2_as - tPhase1_as;
-        diff_as    = diff_as % TH1_as;
-        if (diff_as > (TH1_as >> 1)) diff_as = diff_as - TH1_as;
-        break;
-      default :
-        break;
-    } //switch mode
+    diff_as         = simMeasure(ctx, tOffset1_as, nPeriods);
+    tPhase1_as      = ctx->tPhase1_as;
+    tEdge1          = (double)(ctx->tEdge1_as)      / one_ns_as;
+    tEdgeNoisy1     = (double)(ctx->tEdgeNoisy1_as) / one_ns_as;
+    ave_width      += (double)ctx->width_as         / one_ns_as;
+    if (ctx->width_as > max_width_as) max_width_as = ctx->width_as;
+
     dev[i]  = (double)diff_as / (double)one_ns_as;
     //printf("dev %13.3f\n", dev[i]);
     ave    += dev[i];
@@ -489,6 +660,7 @@ int main(int argc, char** argv) {
   printf("'native' max_sysdev from b2blib [ps]: %u\n", b2b_calc_max_sysdev_ps(TH1_as, nSamples, 1));
   
   if (dataFile) fclose(dataFile);
+  free(ctx);
   
   return exitCode;
 }
@@ -3,7 +3,7 @@
  *
  *  created : 2020
  *  author  : Dietrich Beck, GSI-Darmstadt
- *  version : 18-Oct-2023
+ *  version : 18-Oct-2026
  *
  * library for b2b
  *
@@ -41,6 +41,7 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <math.h>
+#include <time.h>
 
 // etherbone
 #include <etherbone.h>
@@ -121,6 +122,22 @@ uint64_t b2b_getSysTime()
 } // b2b_getSysTime()
 
 
+int b2b_hist_bin(double val)
+{
+  int    center = B2B_HISTNBIN / 2;
+  double dec;
+  int    k;
+
+  dec = log10(fabs(val)) - B2B_HISTMINEXP;
+  if (!(dec >= 0)) return center;                         // also handles val == 0
+  k   = (int)(dec * B2B_HISTBINDEC);
+  if (k >= center) k = center - 1;
+
+  if (val > 0) return center + 1 + k;
+  else         return center - 1 - k;
+} // b2b_hist_bin
+
+
 const char* b2b_status_text(uint32_t code)
 {  
   static char message[256];
@@ -338,6 +355,414 @@ uint32_t b2b_calc_max_sysdev_ps(uint64_t TH1_as, uint32_t nSamples, uint32_t pri
 } //  b2b_calc_max_sysdev_ps
 
 
+const char* b2b_archive_csvHeader()
+{
+  return "patternName; time_CBS_UTC; sid; mode; ext_T [as]; ext_h; ext_cTrig; inj_T; inj_h; inj_cTrig; cPhase; ext_phase; ext_phaseFract; ext_phaseErr; ext_maxsysErr; ext_dKickMon; ext_kickCompLvl; ext_dkickProb; ext_kickLen; ext_diagPhase; ext_diag_Match; inj_phase; inj_phaseFract; inj_phaseErr; inj_maxsysErr; inj_dKickMon; inj_dKickProb; inj_diagPhase; inj_diagMatch; received PME; PMI; PRE; PRI; KTE; KTI; KDE; KDI; PDE; PDI; error PME; PMI; PRE; PRI; KTE; KTI; KDE; KDI; PDE; PDI; late PME; PMI; PRE; PRI; KTE; KTI; KDE; KDI; PDE; PDI; fin-CBS; prr-CBS; t0E-CBS; t0I-CBS; kte-CBS; kti-CBS; ext_nueGet; ext_dNueGet; inj_nueGet; inj_dNueGet";
+} // b2b_archive_csvHeader
+
+
+int b2b_archive_csvLine(char *line, archval_t *rec)
+{
+  setval_t *set = &(rec->setval);
+  getval_t *get = &(rec->getval);
+  char     tCBS[256];
+  time_t   secs;
+  double   cor;
+  double   act;
+  char     *new;
+  int      i;
+
+  secs = (time_t)rec->utcSecs;
+  strftime(tCBS, 52, "%d-%b-%Y_%H:%M:%S", gmtime(&secs));
+
+  new  = line;
+  new += sprintf(new, "%.*s; ", B2B_ARCHIVE_PNAMELEN, rec->pName);
+
+  // set values
+  new += sprintf(new, "%s.%03d; %d; %d", tCBS, rec->utcMsecs, rec->sid, set->mode);
+  if (set->ext_T == -1) new += sprintf(new, "; nan");
+  else new += sprintf(new, "; %lu"   , set->ext_T);
+  if (set->ext_h == -1) new += sprintf(new, "; nan");
+  else new += sprintf(new, "; %d"    , set->ext_h);
+  new += sprintf(new, "; %8.3f" , set->ext_cTrig);
+  if (set->inj_T == -1) new += sprintf(new, "; nan");
+  else new += sprintf(new, "; %lu"   , set->inj_T);
+  if (set->inj_h == -1) new += sprintf(new, "; nan");
+  else new += sprintf(new, "; %d"    , set->inj_h);
+  new += sprintf(new, "; %8.3f" , set->inj_cTrig);
+  new += sprintf(new, "; %8.3f" , set->cPhase);
+
+  // get values
+  if (get->ext_phase == -1) new += sprintf(new, "; nan");
+  else new += sprintf(new, "; %lu"  , get->ext_phase);
+  new += sprintf(new, "; %7.3f"    ,  get->ext_phaseFract);
+  new += sprintf(new, "; %7.3f"    ,  get->ext_phaseErr);
+  new += sprintf(new, "; %5.3f"    ,  get->ext_phaseSysmaxErr);
+  new += sprintf(new, "; %7.1f"    ,  get->ext_dKickMon);
+  new += sprintf(new, "; %7.3f"    ,  rec->ext_kickCompLvl);
+  new += sprintf(new, "; %7.1f"    ,  get->ext_dKickProb);
+  new += sprintf(new, "; %7.1f"    ,  rec->ext_kickLen);
+
+  if (isnan(get->ext_diagPhase) || (set->ext_T == -1)) new += sprintf(new, "; nan");
+  else {
+    cor  = 0;
+    act  = b2b_fixTS(get->ext_diagPhase, cor, set->ext_T) - cor;
+    new += sprintf(new, "; %8.3f",  act);
+  } // is isnan
+
+  if (isnan(get->ext_diagMatch) || (set->ext_T == -1)) new += sprintf(new, "; nan");
+  else {
+    cor  = set->ext_cTrig;
+    act  = b2b_fixTS(get->ext_diagMatch, cor, set->ext_T) - cor;
+    new += sprintf(new, "; %8.3f", act);
+  } // else isnan
+
+  if (get->inj_phase == -1) new += sprintf(new, "; nan");
+  else new += sprintf(new, "; %lu", get->inj_phase);
+  new += sprintf(new, "; %7.3f"   , get->inj_phaseFract);
+  new += sprintf(new, "; %7.3f"   , get->inj_phaseErr);
+  new += sprintf(new, "; %5.3f"   , get->inj_phaseSysmaxErr);
+  new += sprintf(new, "; %7.1f"   , get->inj_dKickMon);
+  new += sprintf(new, "; %7.1f"   , get->inj_dKickProb);
+
+  if (isnan(get->inj_diagPhase) || (set->inj_T == -1)) new += sprintf(new, "; nan");
+  else {
+    cor  = 0;
+    act  = b2b_fixTS(get->inj_diagPhase, cor, set->inj_T) - cor;
+    new += sprintf(new, "; %8.3f",  act);
+  } // else isnan
+
+  if (isnan(set->inj_cTrig) || isnan(get->inj_diagMatch) || (set->inj_T == -1)) new += sprintf(new, "; nan");
+  else {
+    cor = set->inj_cTrig - set->cPhase;
+    act = b2b_fixTS(get->inj_diagMatch, cor, set->inj_T) - cor;
+    new += sprintf(new, "; %8.3f",  act);
+  } // else isnan
+
+  for (i=0; i<10; i++) new += sprintf(new, "; %d", ((get->flagEvtRec  >> i) & 0x1));
+  for (i=0; i<10; i++) new += sprintf(new, "; %d", ((get->flagEvtErr  >> i) & 0x1));
+  for (i=0; i<10; i++) new += sprintf(new, "; %d", ((get->flagEvtLate >> i) & 0x1));
+  new += sprintf(new, "; %f; %f; %f; %f; %f; %f", get->finOff, get->prrOff, get->preOff, get->priOff, get->kteOff, get->ktiOff);
+
+  // frequency values
+  if (!rec->flagNueValid)
+    new += sprintf(new, "; NOLINK; NOLINK; NOLINK; NOLINK");
+  else
+    new += sprintf(new, "; %13.6f; %13.6f; %13.6f; %13.6f", rec->ext_rfNueAct, rec->ext_rfNueActErr, rec->inj_rfNueAct, rec->inj_rfNueActErr);
+
+  return new - line;
+} // b2b_archive_csvLine
+
+
+// replay of recorded timing messages
+#define REPLAY_NBUF  1024                        // number of records read at once
+#define REPLAY_NHIST 4096                        // number of 1ns bins of latency histogram
+
+typedef struct {
+  ecamsg_t  action;                              // action
+  uint32_t  tag;                                 // tag of action
+  uint64_t  seq;                                 // sequence number; keeps the order of actions with the same deadline
+} pending_t;
+
+struct b2b_replay_s {
+  FILE            *file;                         // recorded timing messages
+  const ecacond_t *cond;                         // conditions
+  uint32_t        nCond;                         // number of conditions
+  ecamsg_t        buf[REPLAY_NBUF];              // read buffer
+  uint32_t        nBuf;                          // number of records in read buffer
+  uint32_t        iBuf;                          // index of next record in read buffer
+  pending_t       pending[B2B_REPLAY_NPENDING];  // actions waiting for their deadline, binary min-heap
+  uint32_t        nPending;                      // number of pending actions
+  uint64_t        seq;                           // sequence number of next action
+  uint64_t        nMsg;                          // number of timing messages read
+};
+
+
+// compare two pending actions; returns 1 if a is due before b
+static int replay_before(const pending_t *a, const pending_t *b)
+{
+  if (a->action.deadline != b->action.deadline) return a->action.deadline < b->action.deadline;
+  return a->seq < b->seq;
+} // replay_before
+
+
+uint32_t b2b_replay_open(b2b_replay_t **replay, const char *filename, const ecacond_t *cond, uint32_t nCond)
+{
+  b2b_replay_t *r;
+  ecahdr_t     hdr;
+
+  *replay = NULL;
+  if ((r = (b2b_replay_t *)calloc(1, sizeof(b2b_replay_t))) == NULL) return B2BLIB_STATUS_ERROR;
+  if ((r->file = fopen(filename, "rb")) == NULL) {free(r); return B2BLIB_STATUS_ERROR;}
+
+  if ((fread(&hdr, sizeof(hdr), 1, r->file) != 1) || (hdr.magic != B2B_REPLAY_MAGIC) || (hdr.version != B2B_REPLAY_VERSION) || (hdr.recSize != sizeof(ecamsg_t))) {
+    fclose(r->file);
+    free(r);
+    return B2BLIB_STATUS_OUTOFRANGE;
+  } // if hdr
+
+  r->cond  = cond;
+  r->nCond = nCond;
+  *replay  = r;
+
+  return B2BLIB_STATUS_OK;
+} // b2b_replay_open
+
+
+uint32_t b2b_replay_next(b2b_replay_t *replay, uint32_t *tag, ecamsg_t *action)
+{
+  b2b_replay_t *r = replay;
+  ecamsg_t     *msg;
+  pending_t    tmp;
+  uint32_t     i, j, k;
+
+  while (1) {
+    // refill read buffer
+    if ((r->iBuf == r->nBuf) && (r->file != NULL)) {
+      r->nBuf = fread(r->buf, sizeof(ecamsg_t), REPLAY_NBUF, r->file);
+      r->iBuf = 0;
+      if (r->nBuf == 0) {fclose(r->file); r->file = NULL;}
+    } // if iBuf
+    msg = (r->iBuf < r->nBuf) ? &(r->buf[r->iBuf]) : NULL;
+
+    // deliver earliest pending action, if it is due before the next timing message
+    if ((r->nPending > 0) && ((msg == NULL) || (r->pending[0].action.deadline <= msg->deadline))) {
+      *tag    = r->pending[0].tag;
+      *action = r->pending[0].action;
+      r->pending[0] = r->pending[--r->nPending];
+      i = 0;
+      while ((k = 2 * i + 1) < r->nPending) {
+        if ((k + 1 < r->nPending) && replay_before(&(r->pending[k + 1]), &(r->pending[k]))) k++;
+        if (!replay_before(&(r->pending[k]), &(r->pending[i]))) break;
+        tmp = r->pending[i]; r->pending[i] = r->pending[k]; r->pending[k] = tmp;
+        i   = k;
+      } // while k
+      return B2BLIB_STATUS_OK;
+    } // if nPending
+
+    if (msg == NULL) return B2BLIB_STATUS_TIMEDOUT;
+
+    // create actions for all matching conditions
+    for (j=0; j<r->nCond; j++) {
+      if ((msg->evtId & r->cond[j].mask) != (r->cond[j].id & r->cond[j].mask)) continue;
+      if (r->nPending == B2B_REPLAY_NPENDING) return B2BLIB_STATUS_OUTOFRANGE;
+      i = r->nPending++;
+      r->pending[i].action           = *msg;
+      r->pending[i].action.deadline += r->cond[j].offset;
+      r->pending[i].tag              = r->cond[j].tag;
+      r->pending[i].seq              = r->seq++;
+      while ((i > 0) && replay_before(&(r->pending[i]), &(r->pending[(i - 1) / 2]))) {
+        k   = (i - 1) / 2;
+        tmp = r->pending[i]; r->pending[i] = r->pending[k]; r->pending[k] = tmp;
+        i   = k;
+      } // while i
+    } // for j
+    r->iBuf++;
+    r->nMsg++;
+  } // while 1
+} // b2b_replay_next
+
+
+// time of monotonic clock [ns]
+static uint64_t replay_getTime()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * (uint64_t)1000000000 + ts.tv_nsec;
+} // replay_getTime
+
+
+uint32_t b2b_replay_run(const char *filename, const ecacond_t *cond, uint32_t nCond, b2b_replay_handler_t handler)
+{
+  b2b_replay_t *r;
+  uint32_t     status;
+  uint32_t     tag;
+  ecamsg_t     action;
+  uint64_t     *hist;                            // histogram of latency, 1ns bins
+  uint64_t     nAction;
+  uint64_t     sum, min, max, overhead;
+  uint64_t     tStart, tStop, t0, t1, dt;
+  uint64_t     n50, n99, n999, cnt;
+  int          p50, p99, p999;
+  int          i;
+
+  if ((status = b2b_replay_open(&r, filename, cond, nCond)) != B2BLIB_STATUS_OK) return status;
+  if ((hist = (uint64_t *)calloc(REPLAY_NHIST, sizeof(uint64_t))) == NULL) {b2b_replay_close(r); return B2BLIB_STATUS_ERROR;}
+
+  // overhead of reading the clock, subtracted from the latency
+  overhead = 0xffffffffffffffff;
+  for (i=0; i<1000; i++) {
+    t0 = replay_getTime();
+    t1 = replay_getTime();
+    if (t1 - t0 < overhead) overhead = t1 - t0;
+  } // for i
+
+  nAction = 0;
+  sum     = 0;
+  min     = 0xffffffffffffffff;
+  max     = 0;
+  tStart  = replay_getTime();
+  while ((status = b2b_replay_next(r, &tag, &action)) == B2BLIB_STATUS_OK) {
+    t0 = replay_getTime();
+    handler(tag, &action);
+    t1 = replay_getTime();
+    dt = t1 - t0;
+    if (dt > overhead) dt -= overhead;
+    else               dt  = 0;
+    sum += dt;
+    if (dt < min) min = dt;
+    if (dt > max) max = dt;
+    hist[dt < REPLAY_NHIST ? dt : REPLAY_NHIST - 1]++;
+    nAction++;
+  } // while status
+  tStop  = replay_getTime();
+
+  if (status == B2BLIB_STATUS_TIMEDOUT) status = B2BLIB_STATUS_OK;
+  else fprintf(stderr, "b2blib: replay of %s aborted after %lu messages, more than %d pending actions\n", filename, r->nMsg, B2B_REPLAY_NPENDING);
+
+  // percentiles; bins are 1ns wide, the last bin holds all larger values
+  n50  = (nAction * 500  + 999) / 1000;
+  n99  = (nAction * 990  + 999) / 1000;
+  n999 = (nAction * 999  + 999) / 1000;
+  p50  = p99 = p999 = -1;
+  cnt  = 0;
+  for (i=0; i<REPLAY_NHIST; i++) {
+    cnt += hist[i];
+    if ((p50  < 0) && (cnt >= n50)  && (n50  > 0)) p50  = i;
+    if ((p99  < 0) && (cnt >= n99)  && (n99  > 0)) p99  = i;
+    if ((p999 < 0) && (cnt >= n999) && (n999 > 0)) p999 = i;
+  } // for i
+
+  printf("replay of %s\n", filename);
+  printf("  messages      : %lu\n", r->nMsg);
+  printf("  actions       : %lu\n", nAction);
+  printf("  elapsed [ms]  : %.3f\n", (double)(tStop - tStart) / 1000000.0);
+  if (tStop > tStart)
+    printf("  messages/s    : %.0f\n", (double)r->nMsg * 1000000000.0 / (double)(tStop - tStart));
+  if (nAction > 0) {
+    printf("  latency [ns]  : mean %.1f, min %lu, max %lu (clock overhead %lu subtracted)\n", (double)sum / (double)nAction, min, max, overhead);
+    printf("  latency [ns]  : p50 %d, p99 %d, p99.9 %d%s\n", p50, p99, p999, (p999 == REPLAY_NHIST - 1) ? " (overflow)" : "");
+  } // if nAction
+
+  free(hist);
+  b2b_replay_close(r);
+
+  return status;
+} // b2b_replay_run
+
+
+uint32_t b2b_record_open(b2b_replay_t **record, const char *filename)
+{
+  b2b_replay_t *r;
+  ecahdr_t     hdr;
+
+  *record = NULL;
+  if ((r = (b2b_replay_t *)calloc(1, sizeof(b2b_replay_t))) == NULL) return B2BLIB_STATUS_ERROR;
+  if ((r->file = fopen(filename, "wb")) == NULL) {free(r); return B2BLIB_STATUS_ERROR;}
+
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic   = B2B_REPLAY_MAGIC;
+  hdr.version = B2B_REPLAY_VERSION;
+  hdr.recSize = sizeof(ecamsg_t);
+  if (fwrite(&hdr, sizeof(hdr), 1, r->file) != 1) {
+    fclose(r->file);
+    free(r);
+    return B2BLIB_STATUS_ERROR;
+  } // if fwrite
+  *record = r;
+
+  return B2BLIB_STATUS_OK;
+} // b2b_record_open
+
+
+uint32_t b2b_record_write(b2b_replay_t *record, const ecamsg_t *msg)
+{
+  if ((record == NULL) || (record->file == NULL)) return B2BLIB_STATUS_ERROR;
+  if (fwrite(msg, sizeof(ecamsg_t), 1, record->file) != 1) return B2BLIB_STATUS_ERROR;
+  fflush(record->file);                          // rate of timing messages is low; don't lose data if the server gets killed
+  record->nMsg++;
+
+  return B2BLIB_STATUS_OK;
+} // b2b_record_write
+
+
+void b2b_replay_close(b2b_replay_t *replay)
+{
+  if (replay == NULL) return;
+  if (replay->file != NULL) fclose(replay->file);
+  free(replay);
+} // b2b_replay_close
+
+
+// text screen with delta rendering
+#define SCREEN_ESCLEN  16                        // max length of escape sequences per line
+
+static char     screenShown[B2B_SCREEN_NLINE][B2B_SCREEN_WIDTH + 1];  // lines as shown on the terminal
+static char     screenOut[B2B_SCREEN_NLINE * (B2B_SCREEN_WIDTH + SCREEN_ESCLEN) + SCREEN_ESCLEN];  // output of one frame
+static uint32_t screenOutLen;                    // length of output
+static uint32_t screenNOut;                      // number of lines in output
+static uint32_t screenNFrame;                    // number of lines of current frame
+static uint32_t screenNShown;                    // number of lines on the terminal
+static int      screenValid;                     // flag: screenShown is what is on the terminal
+
+
+void b2b_screen_invalidate()
+{
+  screenValid = 0;
+} // b2b_screen_invalidate
+
+
+void b2b_screen_line(uint32_t line, const char *text)
+{
+  char *shown;
+
+  if ((line < 1) || (line > B2B_SCREEN_NLINE)) return;
+  shown = screenShown[line - 1];
+  if (line > screenNFrame) screenNFrame = line;
+
+  if (screenValid && (line <= screenNShown) && (strncmp(shown, text, B2B_SCREEN_WIDTH) == 0)) return;
+  strncpy(shown, text, B2B_SCREEN_WIDTH);
+  shown[B2B_SCREEN_WIDTH] = '\0';
+
+  // position cursor, print text, erase rest of line
+  screenOutLen += sprintf(screenOut + screenOutLen, "\033[%u;1H%s\033[K", line, shown);
+  screenNOut++;
+} // b2b_screen_line
+
+
+uint32_t b2b_screen_flush(uint32_t *nLine, uint32_t *nByte, int flagPrint)
+{
+  uint32_t status = B2BLIB_STATUS_OK;
+  uint32_t i;
+
+  // erase lines of the previous frame that are not part of this frame
+  for (i=screenNFrame + 1; i<=screenNShown; i++) {
+    screenOutLen += sprintf(screenOut + screenOutLen, "\033[%u;1H\033[K", i);
+    screenShown[i - 1][0] = '\0';
+    screenNOut++;
+  } // for i
+
+  // park cursor below the frame
+  if (screenNOut) screenOutLen += sprintf(screenOut + screenOutLen, "\033[%u;1H", screenNFrame + 1);
+
+  if (flagPrint && screenOutLen) {
+    if (fwrite(screenOut, 1, screenOutLen, stdout) != screenOutLen) status = B2BLIB_STATUS_ERROR;
+    fflush(stdout);
+  } // if flagPrint
+
+  *nLine       = screenNOut;
+  *nByte       = screenOutLen;
+  screenNShown = screenNFrame;
+  screenNFrame = 0;
+  screenNOut   = 0;
+  screenOutLen = 0;
+  screenValid  = 1;
+
+  return status;
+} // b2b_screen_flush
+
+
 uint32_t b2b_firmware_open(uint64_t *ebDevice, const char* devName, uint32_t cpu, uint32_t *address)
 {
   eb_status_t         status;
@@ -1,6 +1,24 @@
 #include "ScheduleEdge.h"
 
 #include <iostream>
+#include <map>
+
+/* Copies the attributes. The references vertex_source and vertex_target keep their
+ * objects, the vertices are copied into these objects.
+ */
+ScheduleEdge& ScheduleEdge::operator=(const ScheduleEdge& e) {
+  name = e.name;
+  type = e.type;
+  _draw_ = e._draw_;
+  _hdraw_ = e._hdraw_;
+  pos = e.pos;
+  color = e.color;
+  vertex_source = e.vertex_source;
+  vertex_target = e.vertex_target;
+  protocol = e.protocol;
+  typeId = e.typeId;
+  return *this;
+}
 
 int ScheduleEdge::compare(const ScheduleEdge& e1, const ScheduleEdge& e2) {
   //~ std::cout << "--E " << e1 << ", " << e1.name << " maps to " << e2 << ", " << e2.name << std::endl;
@@ -9,7 +27,8 @@ int ScheduleEdge::compare(const ScheduleEdge& e1, const ScheduleEdge& e2) {
   std::string value1 = std::string("");
   std::string value2 = std::string("");
   if (e1.name == e2.name) {
-    result = e1.type.compare(e2.type);
+    // prepared edges with the same known type need no string compare.
+    result = (e1.typeId != edgeType::UNKNOWN && e1.typeId == e2.typeId) ? 0 : e1.type.compare(e2.type);
     key = "type";
     value1 = e1.type;
     value2 = e2.type;
@@ -25,6 +44,17 @@ int ScheduleEdge::compare(const ScheduleEdge& e1, const ScheduleEdge& e2) {
   return result;
 }
 
+void ScheduleEdge::prepare() {
+  static const std::map<std::string, edgeType> types = {
+      {"defdst", edgeType::DEFDST},       {"altdst", edgeType::ALTDST},       {"baddefdst", edgeType::BADDEFDST}, {"target", edgeType::TARGET},
+      {"flowdst", edgeType::FLOWDST},     {"flushovr", edgeType::FLUSHOVR},   {"switchdst", edgeType::SWITCHDST}, {"origindst", edgeType::ORIGINDST},
+      {"listdst", edgeType::LISTDST},     {"meta", edgeType::META},           {"dynid", edgeType::DYNID},         {"dynpar0", edgeType::DYNPAR0},
+      {"dynpar1", edgeType::DYNPAR1},     {"dyntef", edgeType::DYNTEF},       {"dynres", edgeType::DYNRES},       {"priolo", edgeType::PRIOLO},
+      {"priohi", edgeType::PRIOHI},       {"prioil", edgeType::PRIOIL}};
+  auto it = types.find(this->type);
+  this->typeId = (it == types.end()) ? edgeType::UNKNOWN : it->second;
+}
+
 std::string ScheduleEdge::printProtocol() {
   return std::string("Edge: ") + std::string(*this) + std::string(": ") + this->protocol;
 }
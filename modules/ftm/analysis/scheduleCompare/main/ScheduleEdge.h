@@ -1,6 +1,9 @@
 #ifndef SCHEDULE_EDGE_H
 #define SCHEDULE_EDGE_H
 
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/string.hpp>
+#include <cstdint>
 #include <string>
 
 #include "ScheduleVertex.h"
@@ -19,7 +22,12 @@ class ScheduleEdge {
   // protocol of failed compare
   std::string protocol = std::string("");
 
+  ScheduleEdge() = default;
+  ScheduleEdge(const ScheduleEdge& e) = default;
+  ScheduleEdge& operator=(const ScheduleEdge& e);
   int compare(const ScheduleEdge& e1, const ScheduleEdge& e2);
+  // converts the type into a type id. Call after the type is set.
+  void prepare();
   operator std::string();
   std::string printProtocol();
 
@@ -29,6 +37,17 @@ class ScheduleEdge {
   inline bool operator>(const ScheduleEdge& rhs) { return compare(*this, rhs) > 0; }
   inline bool operator<=(const ScheduleEdge& rhs) { return compare(*this, rhs) <= 0; }
   inline bool operator>=(const ScheduleEdge& rhs) { return compare(*this, rhs) >= 0; }
+
+ private:
+  // UNKNOWN is used for unprepared edges and for other types.
+  enum class edgeType : uint8_t { UNKNOWN, DEFDST, ALTDST, BADDEFDST, TARGET, FLOWDST, FLUSHOVR, SWITCHDST, ORIGINDST, LISTDST, META, DYNID, DYNPAR0, DYNPAR1, DYNTEF, DYNRES, PRIOLO, PRIOHI, PRIOIL };
+  edgeType typeId = edgeType::UNKNOWN;
+  friend class boost::serialization::access;
+  // used by the graph cache of batch mode. vertex_source and vertex_target are set after loading.
+  template <class Archive>
+  void serialize(Archive& ar, const unsigned int version) {
+    ar & name & type & _draw_ & _hdraw_ & pos & color;
+  }
 };
 
 std::ostream& operator<<(std::ostream& os, const ScheduleEdge& edge);
@@ -15,6 +15,11 @@ class GraphProperties {
   std::string xdotversion = std::string("");
   std::string _draw_ = std::string("");
   std::string bb = std::string("");
+
+  template <class Archive>
+  void serialize(Archive& ar, const unsigned int version) {
+    ar & name & xdotversion & _draw_ & bb;
+  }
 };
 
 // Using a vecS graphs => the index maps are implicit.
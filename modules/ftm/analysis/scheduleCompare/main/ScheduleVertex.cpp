@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <map>
 #include <sstream>
 
 std::ostream& operator<<(std::ostream& os, const ScheduleVertex& vertex) {
@@ -17,40 +18,79 @@ void ScheduleVertex::switchCompareNames(const bool flag){
   this->compareNames = flag;
 }
 
+/*
+ * Attributes compared for each vertex type, in the order they are compared.
+ * The first differing attribute is reported in the protocol.
+ */
+const std::vector<ScheduleVertex::attributeSpec>* ScheduleVertex::attributesOfType(const std::string& type) {
+  using V = ScheduleVertex;
+  static const std::vector<attributeSpec> block = {
+      {"tperiod", &V::tperiod, valueType::STRING},     {"cpu", &V::cpu, valueType::STRING},         {"patentry", &V::patentry, valueType::BOOLEAN},
+      {"patexit", &V::patexit, valueType::BOOLEAN},    {"pattern", &V::pattern, valueType::STRING}, {"bpentry", &V::bpentry, valueType::BOOLEAN},
+      {"bpexit", &V::bpexit, valueType::BOOLEAN},      {"beamproc", &V::beamproc, valueType::STRING}, {"qlo", &V::qlo, valueType::BOOLEAN},
+      {"qhi", &V::qhi, valueType::BOOLEAN},            {"qil", &V::qil, valueType::BOOLEAN}};
+  static const std::vector<attributeSpec> flow = {
+      {"pattern", &V::pattern, valueType::STRING},     {"cpu", &V::cpu, valueType::STRING},         {"beamproc", &V::beamproc, valueType::STRING},
+      {"patentry", &V::patentry, valueType::BOOLEAN},  {"bpentry", &V::bpentry, valueType::BOOLEAN}, {"qlo", &V::qlo, valueType::BOOLEAN},
+      {"qhi", &V::qhi, valueType::BOOLEAN},            {"qil", &V::qil, valueType::BOOLEAN},        {"target", &V::target, valueType::STRING},
+      {"tvalid", &V::tvalid, valueType::STRING},       {"toffs", &V::toffs, valueType::STRING},     {"tabs", &V::tabs, valueType::BOOLEAN},
+      {"prio", &V::prio, valueType::STRING},           {"reps", &V::reps, valueType::STRING},       {"qty", &V::qty, valueType::STRING},
+      {"permanent", &V::permanent, valueType::BOOLEAN}, {"dst", &V::dst, valueType::STRING}};
+  static const std::vector<attributeSpec> flush = {
+      {"target", &V::target, valueType::STRING}, {"tvalid", &V::tvalid, valueType::STRING}, {"tabs", &V::tabs, valueType::BOOLEAN},
+      {"clear", &V::clear, valueType::STRING},   {"ovr", &V::ovr, valueType::STRING}};
+  // listdst, qbuf and qinfo
+  static const std::vector<attributeSpec> meta = {
+      {"pattern", &V::pattern, valueType::STRING}, {"cpu", &V::cpu, valueType::STRING}, {"beamproc", &V::beamproc, valueType::STRING}};
+  static const std::vector<attributeSpec> noop = {
+      {"pattern", &V::pattern, valueType::STRING}, {"cpu", &V::cpu, valueType::STRING}, {"tvalid", &V::tvalid, valueType::STRING},
+      {"vabs", &V::vabs, valueType::BOOLEAN},      {"toffs", &V::toffs, valueType::STRING}, {"prio", &V::prio, valueType::STRING},
+      {"qty", &V::qty, valueType::STRING},         {"beamproc", &V::beamproc, valueType::STRING}};
+  static const std::vector<attributeSpec> cswitch = {
+      {"target", &V::target, valueType::STRING}, {"tvalid", &V::tvalid, valueType::STRING}, {"tabs", &V::tabs, valueType::BOOLEAN},
+      {"dst", &V::dst, valueType::STRING}};
+  static const std::vector<attributeSpec> origin = {{"pattern", &V::pattern, valueType::STRING}, {"thread", &V::thread, valueType::STRING}};
+  static const std::vector<attributeSpec> startthread = {
+      {"pattern", &V::pattern, valueType::STRING}, {"startoffs", &V::startoffs, valueType::STRING}, {"thread", &V::thread, valueType::STRING}};
+  static const std::vector<attributeSpec> tmsg = {
+      {"pattern", &V::pattern, valueType::STRING},    {"cpu", &V::cpu, valueType::STRING},           {"beamproc", &V::beamproc, valueType::STRING},
+      {"patentry", &V::patentry, valueType::BOOLEAN}, {"bpentry", &V::bpentry, valueType::BOOLEAN},   {"toffs", &V::toffs, valueType::STRING},
+      {"tef", &V::tef, valueType::STRING},            {"par", &V::par, valueType::HEX},              {"id", &V::id, valueType::STRING},
+      {"fid", &V::fid, valueType::STRING},            {"gid", &V::gid, valueType::STRING},           {"evtno", &V::evtno, valueType::STRING},
+      {"sid", &V::sid, valueType::STRING},            {"bpid", &V::bpid, valueType::STRING},         {"beamin", &V::beamin, valueType::STRING},
+      {"bpcstart", &V::bpcstart, valueType::STRING},  {"reqnobeam", &V::reqnobeam, valueType::STRING}, {"vacc", &V::vacc, valueType::STRING},
+      {"res", &V::res, valueType::STRING}};
+  static const std::vector<attributeSpec> wait = {
+      {"target", &V::target, valueType::STRING}, {"tvalid", &V::tvalid, valueType::STRING}, {"tabs", &V::tabs, valueType::BOOLEAN},
+      {"twait", &V::twait, valueType::STRING},   {"wabs", &V::wabs, valueType::BOOLEAN}};
+  static const std::map<std::string, const std::vector<attributeSpec>*> types = {
+      {"block", &block}, {"blockalign", &block}, {"flow", &flow},     {"flush", &flush},   {"listdst", &meta},          {"noop", &noop}, {"qbuf", &meta},
+      {"qinfo", &meta},  {"switch", &cswitch},   {"origin", &origin}, {"startthread", &startthread}, {"tmsg", &tmsg}, {"wait", &wait}};
+  auto it = types.find(type);
+  return (it == types.end()) ? nullptr : it->second;
+}
+
 int ScheduleVertex::compare(const ScheduleVertex& v1, const ScheduleVertex& v2) {
   //~ std::cout << "--V " << v1.name << ", " << v2.name << " | " << v1.protocol << std::endl;
   if (!v1.compareNames || v1.name == v2.name) {
-    if (v1.type == "") {
+    if (v1.typeId != vertexType::UNKNOWN && v1.typeId == v2.typeId) {
+      // both vertices are prepared and have the same known type.
+      return (v1.typeId == vertexType::NONE) ? 0 : compareTyped(v1, v2);
+    } else if (v1.type == "") {
       return 0;
     } else if (v1.type == v2.type) {
-      if ("block" == v1.type || "blockalign" == v1.type) {
-        return compareBlock(v1, v2);
-      } else if ("flow" == v1.type) {
-        return compareFlow(v1, v2);
-      } else if ("flush" == v1.type) {
-        return compareFlush(v1, v2);
-      } else if ("listdst" == v1.type) {
-        return compareListdst(v1, v2);
-      } else if ("noop" == v1.type) {
-        return compareNoop(v1, v2);
-      } else if ("qbuf" == v1.type) {
-        return compareQbuf(v1, v2);
-      } else if ("qinfo" == v1.type) {
-        return compareQinfo(v1, v2);
-      } else if ("switch" == v1.type) {
-        return compareSwitch(v1, v2);
-      } else if ("origin" == v1.type) {
-        return compareOrigin(v1, v2);
-      } else if ("startthread" == v1.type) {
-        return compareStartthread(v1, v2);
-      } else if ("tmsg" == v1.type) {
-        //~ std::cout << "--V tmsg " << compareTmsg(v1, v2) << std::endl;
-        return compareTmsg(v1, v2);
-      } else if ("wait" == v1.type) {
-        return compareWait(v1, v2);
-      } else {
+      const std::vector<attributeSpec>* attributes = attributesOfType(v1.type);
+      if (attributes == nullptr) {
         return -1;
       }
+      int result = 0;
+      for (auto& attribute : *attributes) {
+        result = compareValues(v1.*attribute.member, v2.*attribute.member, attribute.key, attribute.type);
+        if (result != 0) {
+          return result;
+        }
+      }
+      return result;
     } else {
       return v1.type.compare(v2.type);
     }
@@ -63,350 +103,127 @@ int ScheduleVertex::compare(const ScheduleVertex& v1, const ScheduleVertex& v2)
   }
 }
 
-int ScheduleVertex::compareBlock(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = compareValues(v1.tperiod, v2.tperiod, "tperiod", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.cpu, v2.cpu, "cpu", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.patentry, v2.patentry, "patentry", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.patexit, v2.patexit, "patexit", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.bpentry, v2.bpentry, "bpentry", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.bpexit, v2.bpexit, "bpexit", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.beamproc, v2.beamproc, "beamproc", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.qlo, v2.qlo, "qlo", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.qhi, v2.qhi, "qhi", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.qil, v2.qil, "qil", valueType::BOOLEAN);
-  return result;
-}
-
-int ScheduleVertex::compareFlow(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.cpu, v2.cpu, "cpu", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.beamproc, v2.beamproc, "beamproc", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.patentry, v2.patentry, "patentry", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.bpentry, v2.bpentry, "bpentry", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.qlo, v2.qlo, "qlo", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.qhi, v2.qhi, "qhi", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.qil, v2.qil, "qil", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.target, v2.target, "target", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tvalid, v2.tvalid, "tvalid", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.toffs, v2.toffs, "toffs", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tabs, v2.tabs, "tabs", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.prio, v2.prio, "prio", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.reps, v2.reps, "reps", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.qty, v2.qty, "qty", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.permanent, v2.permanent, "permanent", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.dst, v2.dst, "dst", valueType::STRING);
-  return result;
-}
-
-int ScheduleVertex::compareFlush(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = compareValues(v1.target, v2.target, "target", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tvalid, v2.tvalid, "tvalid", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tabs, v2.tabs, "tabs", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.clear, v2.clear, "clear", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.ovr, v2.ovr, "ovr", valueType::STRING);
-  return result;
-}
-
-int ScheduleVertex::compareListdst(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.cpu, v2.cpu, "cpu", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.beamproc, v2.beamproc, "beamproc", valueType::STRING);
-  return result;
-}
-
-int ScheduleVertex::compareNoop(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.cpu, v2.cpu, "cpu", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tvalid, v2.tvalid, "tvalid", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.vabs, v2.vabs, "vabs", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.toffs, v2.toffs, "toffs", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.prio, v2.prio, "prio", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.qty, v2.qty, "qty", valueType::STRING);
-  if (result != 0) {
-    return result;
+/*
+ * Compares the typed values of two prepared vertices of the same type.
+ * Same results as compareValues on the strings, without parsing the values again.
+ */
+int ScheduleVertex::compareTyped(const ScheduleVertex& v1, const ScheduleVertex& v2) {
+  for (size_t i = 0; i < v1.attributes->size(); i++) {
+    const attributeSpec& attribute = (*v1.attributes)[i];
+    const typedValue& value1 = v1.values[i];
+    const typedValue& value2 = v2.values[i];
+    int result = 0;
+    if (attribute.type == valueType::BOOLEAN) {
+      result = (value1.state < 0) ? -1 : (value1.state != value2.state);
+    } else if (attribute.type == valueType::HEX && (value1.state || value2.state)) {
+      result = (value1.number < value2.number) ? -1 : (value1.number > value2.number);
+    } else {
+      result = (v1.*attribute.member).compare(v2.*attribute.member);
+    }
+    if (result != 0) {
+      return recordResult(result, attribute.key, v1.*attribute.member, v2.*attribute.member);
+    }
   }
-  result = compareValues(v1.beamproc, v2.beamproc, "beamproc", valueType::STRING);
-  return result;
+  return 0;
 }
 
-int ScheduleVertex::compareQbuf(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-    int result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.cpu, v2.cpu, "cpu", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.beamproc, v2.beamproc, "beamproc", valueType::STRING);
-  return result;
- }
-
-int ScheduleVertex::compareQinfo(const ScheduleVertex& v1, const ScheduleVertex& v2) {   int result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.cpu, v2.cpu, "cpu", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.beamproc, v2.beamproc, "beamproc", valueType::STRING);
-  return result;
- }
-
-int ScheduleVertex::compareSwitch(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = -1;
-  result = compareValues(v1.target, v2.target, "target", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tvalid, v2.tvalid, "tvalid", valueType::STRING);
-  if (result != 0) {
-    return result;
+void ScheduleVertex::prepare() {
+  this->typeId = typeIdOf(this->type);
+  this->attributes = attributesOfType(this->type);
+  this->values.clear();
+  if (this->attributes == nullptr) {
+    if (this->typeId != vertexType::NONE) {
+      this->typeId = vertexType::UNKNOWN;
+    }
+    return;
   }
-  result = compareValues(v1.tabs, v2.tabs, "tabs", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
+  this->values.reserve(this->attributes->size());
+  for (auto& attribute : *this->attributes) {
+    this->values.push_back(typedValueOf(this->*attribute.member, attribute.type));
   }
-  result = compareValues(v1.dst, v2.dst, "dst", valueType::STRING);
-  return result;
 }
 
-int ScheduleVertex::compareOrigin(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = -1;
-  result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
+/*
+ * Returns true, if both vertices have the same type. Uses the type ids of prepared vertices.
+ */
+bool ScheduleVertex::sameType(const ScheduleVertex& other) const {
+  if (this->typeId != vertexType::UNKNOWN && this->typeId == other.typeId) {
+    return true;
   }
-  result = compareValues(v1.thread, v2.thread, "thread", valueType::STRING);
-  return result;
+  return this->type == other.type;
 }
 
-int ScheduleVertex::compareStartthread(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = -1;
-  result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.startoffs, v2.startoffs, "startoffs", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.thread, v2.thread, "thread", valueType::STRING);
-  return result;
+ScheduleVertex::vertexType ScheduleVertex::typeIdOf(const std::string& type) {
+  static const std::map<std::string, vertexType> types = {
+      {"", vertexType::NONE},           {"block", vertexType::BLOCK},   {"blockalign", vertexType::BLOCKALIGN},
+      {"flow", vertexType::FLOW},       {"flush", vertexType::FLUSH},   {"listdst", vertexType::LISTDST},
+      {"noop", vertexType::NOOP},       {"qbuf", vertexType::QBUF},     {"qinfo", vertexType::QINFO},
+      {"switch", vertexType::SWITCH},   {"origin", vertexType::ORIGIN}, {"startthread", vertexType::STARTTHREAD},
+      {"tmsg", vertexType::TMSG},       {"wait", vertexType::WAIT}};
+  auto it = types.find(type);
+  return (it == types.end()) ? vertexType::UNKNOWN : it->second;
 }
 
-int ScheduleVertex::compareTmsg(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = compareValues(v1.pattern, v2.pattern, "pattern", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.cpu, v2.cpu, "cpu", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.beamproc, v2.beamproc, "beamproc", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.patentry, v2.patentry, "patentry", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.bpentry, v2.bpentry, "bpentry", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.toffs, v2.toffs, "toffs", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tef, v2.tef, "tef", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.par, v2.par, "par", valueType::HEX);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.id, v2.id, "id", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.fid, v2.fid, "fid", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.gid, v2.gid, "gid", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.evtno, v2.evtno, "evtno", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.sid, v2.sid, "sid", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.bpid, v2.bpid, "bpid", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.beamin, v2.beamin, "beamin", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.bpcstart, v2.bpcstart, "bpcstart", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.reqnobeam, v2.reqnobeam, "reqnobeam", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.vacc, v2.vacc, "vacc", valueType::STRING);
-  if (result != 0) {
-    return result;
+/*
+ * Converts an attribute value the same way as compareBoolean and compareHex do.
+ */
+ScheduleVertex::typedValue ScheduleVertex::typedValueOf(const std::string& value, valueType type) {
+  typedValue result = {0, 0};
+  if (type == valueType::BOOLEAN) {
+    if (("1" == value) || ("True" == value) || ("true" == value)) {
+      result.state = 1;
+    } else if (value.empty() || ("0" == value) || ("False" == value) || ("false" == value)) {
+      result.state = 0;
+    } else {
+      result.state = -1;
+    }
+  } else if (type == valueType::HEX) {
+    unsigned long x = 0;
+    std::stringstream stream;
+    result.state = startsWith(value, "0x", false);
+    if (result.state) {
+      stream << std::hex;
+    }
+    stream << value;
+    stream >> x;
+    result.number = x;
   }
-  result = compareValues(v1.res, v2.res, "res", valueType::STRING);
   return result;
 }
 
-int ScheduleVertex::compareWait(const ScheduleVertex& v1, const ScheduleVertex& v2) {
-  int result = compareValues(v1.target, v2.target, "target", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tvalid, v2.tvalid, "tvalid", valueType::STRING);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.tabs, v2.tabs, "tabs", valueType::BOOLEAN);
-  if (result != 0) {
-    return result;
-  }
-  result = compareValues(v1.twait, v2.twait, "twait", valueType::STRING);
-  if (result != 0) {
-    return result;
+/*
+ * Returns a key which is equal for all vertices that compare equal. Used as the initial
+ * vertex invariant for isomorphism checks. Boolean values are normalised, hex values are
+ * left out since compareHex is not transitive. Returns an empty string if the vertex matches
+ * any other vertex (no type) and thus has no usable invariant.
+ */
+std::string ScheduleVertex::invariantKey() const {
+  if (this->type.empty()) {
+    return std::string("");
+  }
+  std::string key = this->type;
+  if (this->compareNames) {
+    key += '\x1f' + this->name;
+  }
+  const std::vector<attributeSpec>* attributes = attributesOfType(this->type);
+  if (attributes != nullptr) {
+    for (auto& attribute : *attributes) {
+      const std::string& value = this->*attribute.member;
+      key += '\x1f';
+      if (attribute.type == valueType::BOOLEAN) {
+        if (("1" == value) || ("True" == value) || ("true" == value)) {
+          key += "1";
+        } else if (value.empty() || ("0" == value) || ("False" == value) || ("false" == value)) {
+          key += "0";
+        } else {
+          key += "?" + value;
+        }
+      } else if (attribute.type == valueType::STRING) {
+        key += value;
+      }
+    }
   }
-  result = compareValues(v1.wabs, v2.wabs, "wabs", valueType::BOOLEAN);
-  return result;
+  return key;
 }
 
 int ScheduleVertex::compareBoolean(const std::string& bool1, const std::string& bool2) {
@@ -421,8 +238,8 @@ int ScheduleVertex::compareBoolean(const std::string& bool1, const std::string&
 
 int ScheduleVertex::compareHex(const std::string& hex1, const std::string& hex2) {
   if (startsWith(hex1, "0x", false) && startsWith(hex2, "0X", false)) {
-    unsigned long x1;
-    unsigned long x2;
+    unsigned long x1 = 0;
+    unsigned long x2 = 0;
     std::stringstream hexStream1;
     std::stringstream hexStream2;
     hexStream1 << std::hex << hex1;
@@ -437,8 +254,8 @@ int ScheduleVertex::compareHex(const std::string& hex1, const std::string& hex2)
       return 0;
     }
   } else if (startsWith(hex1, "0x", false) && !startsWith(hex2, "0X", false)) {
-    unsigned long x1;
-    unsigned long x2;
+    unsigned long x1 = 0;
+    unsigned long x2 = 0;
     std::stringstream hexStream1;
     std::stringstream stream2;
     hexStream1 << std::hex << hex1;
@@ -453,8 +270,8 @@ int ScheduleVertex::compareHex(const std::string& hex1, const std::string& hex2)
       return 0;
     }
   } else if (!startsWith(hex1, "0x", false) && startsWith(hex2, "0X", false)) {
-    unsigned long x1;
-    unsigned long x2;
+    unsigned long x1 = 0;
+    unsigned long x2 = 0;
     std::stringstream stream1;
     std::stringstream hexStream2;
     stream1 << hex1;
@@ -482,6 +299,10 @@ int ScheduleVertex::compareValues(const std::string& value1, const std::string&
   } else {
     result = value1.compare(value2);
   }
+  return recordResult(result, key, value1, value2);
+}
+
+int ScheduleVertex::recordResult(int result, const std::string& key, const std::string& value1, const std::string& value2) {
   if (result != 0) {
     protocol += " compare: " + std::to_string(result) + ", key: " + key + ", value1: '" + value1 + "', value2: '" + value2 + "'.";
   }
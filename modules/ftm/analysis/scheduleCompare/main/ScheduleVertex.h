@@ -1,7 +1,11 @@
 #ifndef SCHEDULE_VERTEX_H
 #define SCHEDULE_VERTEX_H
 
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/string.hpp>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class ScheduleVertex {
  public:
@@ -66,8 +70,12 @@ class ScheduleVertex {
   std::string protocol = std::string("");
 
   int compare(const ScheduleVertex& v1, const ScheduleVertex& v2);
+  // converts the attributes used by compare into typed values. Call after the attributes are set.
+  void prepare();
+  bool sameType(const ScheduleVertex& other) const;
   std::string printProtocol();
   void switchCompareNames(const bool flag);
+  std::string invariantKey() const;
   operator std::string();
   inline bool operator==(const ScheduleVertex& rhs) { return compare(*this, rhs) == 0; }
   inline bool operator!=(const ScheduleVertex& rhs) { return compare(*this, rhs) != 0; }
@@ -77,24 +85,42 @@ class ScheduleVertex {
   inline bool operator>=(const ScheduleVertex& rhs) { return compare(*this, rhs) >= 0; }
 
  private:
+  friend class boost::serialization::access;
+  // used by the graph cache of batch mode. The protocol is not stored.
+  template <class Archive>
+  void serialize(Archive& ar, const unsigned int version) {
+    ar & name & label & pos & _draw_ & _ldraw_ & _hdraw_ & height & width & type & tperiod & qlo & qhi & qil & toffs & tef & par & id & fid & gid;
+    ar & evtno & sid & bpid & beamin & bpcstart & reqnobeam & vacc & res & tvalid & tabs & target & dst & reps & prio & twait & wabs & clear & ovr;
+    ar & beamproc & pattern & patentry & patexit & bpentry & bpexit & permanent & thread & startoffs & cpu & qty & vabs & flags & shape & penwidth;
+    ar & fillcolor & color & style;
+  }
   enum class valueType { STRING, BOOLEAN, HEX };
+  // UNKNOWN is used for unprepared vertices and for types without attribute table.
+  enum class vertexType : uint8_t { UNKNOWN, NONE, BLOCK, BLOCKALIGN, FLOW, FLUSH, LISTDST, NOOP, QBUF, QINFO, SWITCH, ORIGIN, STARTTHREAD, TMSG, WAIT };
+  // BOOLEAN: state 1 (true), 0 (false or empty), -1 (invalid). HEX: state 1 if the value starts with 0x, number is the parsed value.
+  struct typedValue {
+    uint64_t number;
+    int8_t state;
+  };
   bool compareNames = true;
-  int compareBlock(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareFlow(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareFlush(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareListdst(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareNoop(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareQbuf(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareQinfo(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareSwitch(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareOrigin(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareStartthread(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareTmsg(const ScheduleVertex& v1, const ScheduleVertex& v2);
-  int compareWait(const ScheduleVertex& v1, const ScheduleVertex& v2);
+  vertexType typeId = vertexType::UNKNOWN;
+  struct attributeSpec {
+    const char* key;
+    std::string ScheduleVertex::*member;
+    valueType type;
+  };
+  // set by prepare, the attribute table of the type and the typed values in the order of the table.
+  const std::vector<attributeSpec>* attributes = nullptr;
+  std::vector<typedValue> values;
+  static const std::vector<attributeSpec>* attributesOfType(const std::string& type);
+  static vertexType typeIdOf(const std::string& type);
+  typedValue typedValueOf(const std::string& value, valueType type);
+  int compareTyped(const ScheduleVertex& v1, const ScheduleVertex& v2);
   int compareBoolean(const std::string& bool1, const std::string& bool2);
   int compareHex(const std::string& hex1, const std::string& hex2);
   bool startsWith(std::string value, std::string start, bool caseSensitive);
   int compareValues(const std::string& value1, const std::string& value2, const std::string& key, valueType type);
+  int recordResult(int result, const std::string& key, const std::string& value1, const std::string& value2);
 };
 
 std::ostream& operator<<(std::ostream& os, const ScheduleVertex& vertex);
@@ -26,6 +26,12 @@ struct configuration {
   bool blocksSeparated = false;
   // option -c
   bool check = false;
+  // option -j: number of threads for batch mode, 0 for one per CPU
+  unsigned int threads = 0;
+  // option -k: cache directory for parsed graphs in batch mode
+  std::string cacheDir = std::string("");
+  // option -m: manifest file for batch mode
+  std::string manifest = std::string("");
   // replaceChain: -c <n>
   int chainCount = INT_MAX;
   // option -n
@@ -17,11 +17,7 @@ bool parseSchedule(std::string &dot_file, ScheduleGraph &g, boost::dynamic_prope
     }
     result = read_graphviz(std::cin, g, dp, "name");
     if (result) {
-      auto edge_pair = edges(g);
-      for (auto iter = edge_pair.first; iter != edge_pair.second; iter++) {
-        g[*iter].vertex_source = g[source(*iter, g)];
-        g[*iter].vertex_target = g[target(*iter, g)];
-      }
+      prepareGraph(g);
     }
     if (config.superverbose) {
       std::cout << "read " << num_vertices(g) << " vertices, " << num_edges(g) << " edges." << std::endl;
@@ -35,11 +31,7 @@ bool parseSchedule(std::string &dot_file, ScheduleGraph &g, boost::dynamic_prope
     std::istream dot_stream(&fileBuffer);
     result = read_graphviz(dot_stream, g, dp, "name");
     if (result) {
-      auto edge_pair = edges(g);
-      for (auto iter = edge_pair.first; iter != edge_pair.second; iter++) {
-        g[*iter].vertex_source = g[source(*iter, g)];
-        g[*iter].vertex_target = g[target(*iter, g)];
-      }
+      prepareGraph(g);
     }
     if (config.superverbose) {
       std::cout << "read " << num_vertices(g) << " vertices, " << num_edges(g) << " edges." << std::endl;
@@ -51,6 +43,21 @@ bool parseSchedule(std::string &dot_file, ScheduleGraph &g, boost::dynamic_prope
   return result;
 }
 
+/* Converts the attributes of all vertices and edges into typed values once, such that
+ * compares do not parse the strings again. Sets the vertices of the edges.
+ */
+void prepareGraph(ScheduleGraph &g) {
+  BGL_FORALL_VERTICES(v, g, ScheduleGraph) {
+    g[v].prepare();
+  }
+  auto edge_pair = edges(g);
+  for (auto iter = edge_pair.first; iter != edge_pair.second; iter++) {
+    g[*iter].prepare();
+    g[*iter].vertex_source = g[source(*iter, g)];
+    g[*iter].vertex_target = g[target(*iter, g)];
+  }
+}
+
 inline bool file_exists(const std::string &file_name) {
   struct stat buffer;
   return (stat(file_name.c_str(), &buffer) == 0);
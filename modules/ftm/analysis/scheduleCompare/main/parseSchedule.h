@@ -7,5 +7,6 @@
 #include "scheduleIsomorphism.h"
 
 bool parseSchedule(std::string& dot_file, ScheduleGraph& g, boost::dynamic_properties& dp, configuration& config);
+void prepareGraph(ScheduleGraph& g);
 
 #endif
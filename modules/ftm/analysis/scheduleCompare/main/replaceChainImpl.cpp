@@ -11,9 +11,10 @@ int replaceChain(ScheduleGraph& graph1, configuration& config) {
 bool ReplaceChain::findStartOfChain() {
   // result = true means: found start of a chain and this->startOfChain
   // is the VertexNum of the start.
+  // Replacing a chain does not change the degrees of the remaining vertices. Thus the
+  // scan continues with the vertex where the last chain was found.
   bool result = false;
-  BOOST_FOREACH (VertexDescriptor descriptor, vertices(*g)) {
-    VertexNum v = boost::get(id, descriptor);
+  for (VertexNum v = scanStart; v < num_vertices(*g); v++) {
     if (c->superverbose) {
       std::cout << "0 findStartOfChain v: " << v << ", startOfChain: " << startOfChain << std::endl;
     }
@@ -29,6 +30,7 @@ bool ReplaceChain::findStartOfChain() {
           ", out: " << (s != ULONG_MAX ? std::to_string(boost::out_degree(s, *g)) : "unknown") << std::endl;
       }
       if (s != ULONG_MAX && boost::in_degree(s, *g) <= 1 && boost::out_degree(s, *g) <= 1) {
+        scanStart = v;
         break;
       }
     }
@@ -113,9 +115,7 @@ VertexNum ReplaceChain::predecessor(VertexNum v, bool inChain) {
     if (c->blocksSeparated && inChain) {
       VertexNum candidate = boost::get(id, source1);
       //~ std::cout << "predecessor v: " << v << " candidate: " << candidate << std::endl;
-      std::string vType = (*g)[v].type;
-      std::string pType = (*g)[candidate].type;
-      if (vType.compare(pType) == 0) {
+      if ((*g)[v].sameType((*g)[candidate])) {
         predecessor = candidate;
       }
     } else {
@@ -143,9 +143,7 @@ VertexNum ReplaceChain::successor(VertexNum v, bool inChain) {
     if (c->blocksSeparated && inChain) {
       VertexNum candidate = boost::get(id, target1);
       //~ std::cout << "successor v: " << v << " candidate: " << candidate << std::endl;
-      std::string vType = (*g)[v].type;
-      std::string sType = (*g)[candidate].type;
-      if (vType.compare(sType) == 0) {
+      if ((*g)[v].sameType((*g)[candidate])) {
         successor = candidate;
       }
     } else {
@@ -319,18 +317,21 @@ bool ReplaceChain::insertEdges() {
   // 'top to bottom'.
   // loop through the set is the wrong way.
   VertexNum v = startOfChain;
+  VertexNum p = anyPredecessor(startOfChain);
   while (chain.count(v) > 0) {
     createVertexAndEdges(v);
     v = anySuccessor(v);
   }
+  rescanNeighbours(p, v);
   if (chain.size() < 4) {
     (*g)[newVertexNum].name = newName;
     (*g)[newVertexNum].label = newLabel;
   }
   chainStatus("insertEdges", std::cout);
-  for (auto reverseIterator = chain.rbegin(); reverseIterator != chain.rend(); reverseIterator++) {
-    boost::clear_vertex(*reverseIterator, *g);
-    boost::remove_vertex(*reverseIterator, *g);
+  // remove the edges now, the vertices are removed by replaceChainLoop.
+  for (auto v : chain) {
+    boost::clear_vertex(v, *g);
+    removedVertices.insert(v);
   }
   // prepare for the next chain.
   startOfChain = ULONG_MAX;
@@ -339,6 +340,24 @@ bool ReplaceChain::insertEdges() {
   return true;
 }
 
+void ReplaceChain::rescanNeighbours(VertexNum p, VertexNum s) {
+  // The new vertex has no type. With 'blocks separated' this may change predecessorInChain and
+  // successorInChain for the vertex p before the chain and for the vertex s after the chain and
+  // its successors. Thus continue the next scan at the lowest of these vertices.
+  if (p != ULONG_MAX && chain.count(p) == 0) {
+    scanStart = std::min(scanStart, p);
+  }
+  VertexNum v = s;
+  while (v != ULONG_MAX && chain.count(v) == 0) {
+    scanStart = std::min(scanStart, v);
+    VertexNum next = successorInChain(v);
+    if (next == s || (next != ULONG_MAX && boost::in_degree(next, *g) != 1)) {
+      break;
+    }
+    v = next;
+  }
+}
+
 bool ReplaceChain::replaceSingleChain() {
   bool result = false;
   if (findStartOfChain()) {
@@ -366,9 +385,39 @@ int ReplaceChain::replaceChainLoop() {
     }
     result = replaceSingleChain();
   }
+  removeVertices(*g, removedVertices);
+  removedVertices.clear();
+  scanStart = 0;
   return result;
 }
 
+/* Removes the vertices in one pass by building a new graph without them.
+ * remove_vertex on a vecS graph renumbers all vertices and edges, removing the vertices
+ * one by one is quadratic. The order of the remaining vertices and edges is kept.
+ */
+void removeVertices(ScheduleGraph& graph1, const VertexSet& deletes) {
+  if (deletes.empty()) {
+    return;
+  }
+  ScheduleGraph result;
+  result[boost::graph_bundle] = graph1[boost::graph_bundle];
+  std::vector<VertexNum> newIndex(num_vertices(graph1), ULONG_MAX);
+  BGL_FORALL_VERTICES(v, graph1, ScheduleGraph) {
+    if (deletes.count(v) == 0) {
+      newIndex[v] = boost::add_vertex(graph1[v], result);
+    }
+  }
+  // edges(graph1) lists the edges in the order they were added.
+  BGL_FORALL_EDGES(e, graph1, ScheduleGraph) {
+    VertexNum s = newIndex[source(e, graph1)];
+    VertexNum t = newIndex[target(e, graph1)];
+    if (s != ULONG_MAX && t != ULONG_MAX) {
+      boost::add_edge(s, t, graph1[e], result);
+    }
+  }
+  graph1.swap(result);
+}
+
 void ReplaceChain::outputGraph() {
   if (!c->silent) {
     std::cout << "Output to file: '" << c->outputFile << "', " << counterReplacedChains
@@ -10,6 +10,7 @@ typedef boost::graph_traits<ScheduleGraph>::edge_descriptor EdgeDescriptor;
 typedef boost::graph_traits<ScheduleGraph>::vertex_descriptor VertexDescriptor;
 
 int replaceChain(ScheduleGraph& graph1, configuration& config);
+void removeVertices(ScheduleGraph& graph1, const VertexSet& deletes);
 
 class ReplaceChain {
   public:
@@ -25,6 +26,7 @@ class ReplaceChain {
     bool checkToReplace(VertexNum v);
     void createVertexAndEdges(VertexNum v);
     bool insertEdges();
+    void rescanNeighbours(VertexNum p, VertexNum s);
     bool getStartOfChain(VertexNum v, VertexNum first);
     EdgeDescriptor* createEdgeProperties(VertexNum v1, VertexNum v2, VertexNum v3, bool flag);
     VertexNum createVertexProperties(VertexNum v);
@@ -50,6 +52,10 @@ class ReplaceChain {
     void getAfterEdge(VertexNum v);
     VertexId id = boost::get(boost::vertex_index, *g);
     VertexSet chain = {};
+    // vertices of replaced chains. These are cleared at once and removed in one batch at the end.
+    VertexSet removedVertices = {};
+    // vertices before scanStart are known not to start a chain.
+    VertexNum scanStart = 0;
     void printChain(std::string title);
     void chainStatus(std::string title, std::ostream& out);
     std::string newName;
@@ -0,0 +1,253 @@
+#include "scheduleBatch.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/graph/adj_list_serialize.hpp>
+
+#include "parseSchedule.h"
+#include "scheduleIsomorphism.h"
+
+namespace {
+// version of the cache file format, increment on changes of the serialized classes.
+const std::string cacheMagic = std::string("scheduleCompare graph cache 1");
+std::mutex errorMutex;
+
+/* Runs task(i) for i in [0, count) on config.threads worker threads.
+ */
+void runParallel(size_t count, configuration& config, const std::function<void(size_t)>& task) {
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t i = next++; i < count; i = next++) {
+      task(i);
+    }
+  };
+  unsigned int threads = (config.threads > 0) ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min<size_t>(threads, std::max<size_t>(count, 1));
+  std::vector<std::thread> pool;
+  for (unsigned int i = 1; i < threads; i++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : pool) {
+    thread.join();
+  }
+}
+
+std::string cacheFileName(const std::string& dotFile, configuration& config) {
+  std::stringstream stream;
+  stream << config.cacheDir << "/" << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>()(dotFile) << ".graph";
+  return stream.str();
+}
+}  // namespace
+
+/* Batch mode: compares all schedules listed in the manifest with each other or, if dot files
+ * are given, each of the dot files with all schedules of the manifest. Each schedule is parsed
+ * once. Comparisons run in parallel. The result matrix is written tab separated to stdout or
+ * to the output file: one row per schedule, one column per manifest entry, each cell holds the
+ * result code of the comparison as listed in configuration.h.
+ */
+int scheduleBatch(const std::string& manifest, const std::vector<std::string>& dotFiles, configuration& config) {
+  std::vector<std::string> columns;
+  if (!readManifest(manifest, columns)) {
+    std::cerr << "Reading manifest " << manifest << ", file not found." << std::endl;
+    return FILE_NOT_FOUND;
+  }
+  bool allPairs = dotFiles.empty();
+  std::vector<std::string> rows = allPairs ? columns : dotFiles;
+
+  // parse each file once.
+  std::vector<std::string> files(columns);
+  files.insert(files.end(), rows.begin(), rows.end());
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  std::vector<CachedSchedule> schedules(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    schedules[i].dotFile = files[i];
+  }
+  runParallel(schedules.size(), config, [&](size_t i) { loadSchedule(schedules[i], config); });
+  auto scheduleOf = [&](const std::string& dotFile) -> CachedSchedule& {
+    return schedules[std::lower_bound(files.begin(), files.end(), dotFile) - files.begin()];
+  };
+
+  // compare. The matrix is not symmetric even in all pairs mode: for graphs of equal size,
+  // untyped vertices of the first graph match anything. Thus compare both triangles.
+  std::vector<int> results(rows.size() * columns.size(), -1);
+  std::vector<std::pair<size_t, size_t>> tasks;
+  for (size_t row = 0; row < rows.size(); row++) {
+    for (size_t column = 0; column < columns.size(); column++) {
+      tasks.emplace_back(row, column);
+    }
+  }
+  runParallel(tasks.size(), config, [&](size_t i) {
+    size_t row = tasks[i].first;
+    size_t column = tasks[i].second;
+    CachedSchedule& schedule1 = scheduleOf(rows[row]);
+    CachedSchedule& schedule2 = scheduleOf(columns[column]);
+    int result;
+    if (schedule1.status != EXIT_SUCCESS) {
+      result = schedule1.status;
+    } else if (schedule2.status != EXIT_SUCCESS) {
+      result = schedule2.status;
+    } else {
+      // the compare writes protocols to the smaller graph, use a private copy of it.
+      configuration taskConfig(config);
+      taskConfig.silent = true;
+      std::string dotFile1(schedule1.dotFile), dotFile2(schedule2.dotFile);
+      if (isSmallerGraph(schedule1.graph, schedule2.graph)) {
+        ScheduleGraph graph1(schedule1.graph);
+        result = compareSchedules(graph1, schedule2.graph, dotFile1, dotFile2, taskConfig);
+      } else {
+        ScheduleGraph graph2(schedule2.graph);
+        result = compareSchedules(schedule1.graph, graph2, dotFile1, dotFile2, taskConfig);
+      }
+    }
+    results[row * columns.size() + column] = result;
+  });
+
+  std::ofstream outputFile;
+  if (!config.outputFile.empty()) {
+    outputFile.open(config.outputFile);
+    if (!outputFile) {
+      std::cerr << "Writing result matrix to " << config.outputFile << " failed." << std::endl;
+      return FILE_NOT_FOUND;
+    }
+  }
+  std::ostream& out = config.outputFile.empty() ? std::cout : outputFile;
+  out << "schedule";
+  for (auto& column : columns) {
+    out << "\t" << column;
+  }
+  out << std::endl;
+  for (size_t row = 0; row < rows.size(); row++) {
+    out << rows[row];
+    for (size_t column = 0; column < columns.size(); column++) {
+      out << "\t" << results[row * columns.size() + column];
+    }
+    out << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
+
+/* Reads the list of dot files from the manifest, one file per line.
+ * Empty lines and lines starting with '#' are ignored. Relative paths are relative to the
+ * directory of the manifest.
+ */
+bool readManifest(const std::string& manifest, std::vector<std::string>& dotFiles) {
+  std::ifstream in(manifest);
+  if (!in) {
+    return false;
+  }
+  std::string directory;
+  size_t slash = manifest.find_last_of('/');
+  if (slash != std::string::npos) {
+    directory = manifest.substr(0, slash + 1);
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    line.erase(0, line.find_first_not_of(" \t\r"));
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    dotFiles.push_back((line[0] == '/') ? line : directory + line);
+  }
+  return true;
+}
+
+void loadSchedule(CachedSchedule& schedule, configuration& config) {
+  if (!config.cacheDir.empty() && loadCachedGraph(schedule, config)) {
+    schedule.status = EXIT_SUCCESS;
+  } else {
+    int result = -1;
+    bool parsed = false;
+    try {
+      boost::dynamic_properties dp = setDynamicProperties(schedule.graph, config);
+      parsed = parseSchedule(schedule.dotFile, schedule.graph, dp, config);
+    } catch (boost::property_not_found& excep) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      std::cerr << "Parsing " << schedule.dotFile << ": Property not found" << excep.what() << std::endl;
+      result = PARSE_ERROR;
+    } catch (boost::bad_graphviz_syntax& excep) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      std::cerr << "Parsing " << schedule.dotFile << ": Bad Graphviz syntax: " << excep.what() << std::endl;
+      result = PARSE_ERROR_GRAPHVIZ;
+    }
+    if (!parsed) {
+      schedule.status = (result == -1) ? FILE_NOT_FOUND : result;
+      return;
+    }
+    schedule.status = EXIT_SUCCESS;
+    if (!config.cacheDir.empty()) {
+      saveCachedGraph(schedule, config);
+    }
+  }
+  switchCompareNames(schedule.graph, config.compareNames);
+}
+
+/* Loads the graph of a schedule from the cache directory. The cached graph is used only if
+ * size and modification time of the dot file and the syntax check option are unchanged.
+ */
+bool loadCachedGraph(CachedSchedule& schedule, configuration& config) {
+  struct stat buffer;
+  if (stat(schedule.dotFile.c_str(), &buffer) != 0) {
+    return false;
+  }
+  std::ifstream in(cacheFileName(schedule.dotFile, config), std::ios::binary);
+  if (!in) {
+    return false;
+  }
+  try {
+    boost::archive::binary_iarchive archive(in);
+    std::string magic, dotFile;
+    long long size, modified, modifiedNs;
+    bool check;
+    archive >> magic >> dotFile >> size >> modified >> modifiedNs >> check;
+    if (magic != cacheMagic || dotFile != schedule.dotFile || size != (long long)buffer.st_size || modified != (long long)buffer.st_mtim.tv_sec ||
+        modifiedNs != (long long)buffer.st_mtim.tv_nsec || check != config.check) {
+      return false;
+    }
+    archive >> schedule.graph;
+  } catch (std::exception& excep) {
+    schedule.graph.clear();
+    return false;
+  }
+  prepareGraph(schedule.graph);
+  return true;
+}
+
+void saveCachedGraph(CachedSchedule& schedule, configuration& config) {
+  struct stat buffer;
+  if (stat(schedule.dotFile.c_str(), &buffer) != 0) {
+    return;
+  }
+  // write to a temporary file first, parallel runs must not see partial cache files.
+  std::string cacheFile = cacheFileName(schedule.dotFile, config);
+  std::string tempFile = cacheFile + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  {
+    std::ofstream out(tempFile, std::ios::binary);
+    if (!out) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      std::cerr << "Writing cache file " << tempFile << " failed." << std::endl;
+      return;
+    }
+    boost::archive::binary_oarchive archive(out);
+    long long size = buffer.st_size, modified = buffer.st_mtim.tv_sec, modifiedNs = buffer.st_mtim.tv_nsec;
+    archive << cacheMagic << schedule.dotFile << size << modified << modifiedNs << config.check;
+    archive << schedule.graph;
+  }
+  std::rename(tempFile.c_str(), cacheFile.c_str());
+}
@@ -0,0 +1,24 @@
+#ifndef SCHEDULE_BATCH_H
+#define SCHEDULE_BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "ScheduleGraph.h"
+#include "configuration.h"
+
+// A parsed schedule of the batch, shared read-only by all comparisons.
+struct CachedSchedule {
+  std::string dotFile;
+  ScheduleGraph graph;
+  // EXIT_SUCCESS if the graph is usable, otherwise FILE_NOT_FOUND, PARSE_ERROR or PARSE_ERROR_GRAPHVIZ.
+  int status = FILE_NOT_FOUND;
+};
+
+int scheduleBatch(const std::string& manifest, const std::vector<std::string>& dotFiles, configuration& config);
+bool readManifest(const std::string& manifest, std::vector<std::string>& dotFiles);
+void loadSchedule(CachedSchedule& schedule, configuration& config);
+bool loadCachedGraph(CachedSchedule& schedule, configuration& config);
+void saveCachedGraph(CachedSchedule& schedule, configuration& config);
+
+#endif
@@ -91,9 +91,7 @@ int compactGraph(ScheduleGraph& graph1, configuration& config) {
     if (config.verbose) {
       printSet(deleteVertices, "Vertices to delete");
     }
-    for (auto reverseIterator = deleteVertices.rbegin(); reverseIterator != deleteVertices.rend(); reverseIterator++) {
-      remove_vertex(*reverseIterator, graph1);
-    }
+    removeVertices(graph1, deleteVertices);
     saveSchedule(graph1, config);
     return 0;
 }
@@ -1,8 +1,10 @@
 #include "scheduleCompare.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 
+#include "scheduleBatch.h"
 #include "scheduleIsomorphism.h"
 
 int main(int argc, char* argv[]) {
@@ -10,7 +12,7 @@ int main(int argc, char* argv[]) {
   int opt;
   char* program = argv[0];
   configuration config;
-  while ((opt = getopt(argc, argv, "chnstvV")) != -1) {
+  while ((opt = getopt(argc, argv, "chj:k:m:no:stvV")) != -1) {
     switch (opt) {
       case 'v':
         if (config.silent) {
@@ -46,6 +48,26 @@ int main(int argc, char* argv[]) {
       case 't':
         config.test = true;
         break;
+      case 'j': {
+        char* tail;
+        unsigned long threads = strtoul(optarg, &tail, 10);
+        if (*optarg < '0' || *optarg > '9' || *tail != '\0' || threads > 4096) {
+          std::cerr << program << ": option -j expects a number of threads, not '" << optarg << "'." << std::endl;
+          error = BAD_ARGUMENTS;
+        } else {
+          config.threads = threads;
+        }
+        break;
+      }
+      case 'k':
+        config.cacheDir = std::string(optarg);
+        break;
+      case 'm':
+        config.manifest = std::string(optarg);
+        break;
+      case 'o':
+        config.outputFile = std::string(optarg);
+        break;
       default:
         std::cerr << program << ": bad option " << std::endl;
         error = BAD_ARGUMENTS;
@@ -54,6 +76,13 @@ int main(int argc, char* argv[]) {
   }
   if (error) {
     return error;
+  } else if (!config.manifest.empty()) {
+    if (config.test || config.verbose) {
+      std::cerr << program << ": options -t and -v are not applicable with -m." << std::endl;
+      return BAD_ARGUMENTS;
+    }
+    std::vector<std::string> dotFiles(argv + optind, argv + argc);
+    return scheduleBatch(config.manifest, dotFiles, config);
   } else {
     if (argc < 2) {
       usage(program);
@@ -71,11 +100,18 @@ int main(int argc, char* argv[]) {
 
 void usage(char* program) {
   std::cerr << "Usage: " << program << " <dot file 1> <dot file 2>" << std::endl;
+  std::cerr << "       " << program << " -m <manifest> [<dot file> ...]" << std::endl;
   std::cerr << "Checks that graphs in <dot file 1> and <dot file 2> are isomorphic, i.e. describe the same schedule." << std::endl;
   std::cerr << "Options: " << std::endl;
   std::cerr << "        -c: check dot syntax (stops parsing on all unknown attributes)." << std::endl;
   std::cerr << "        -h: help and usage." << std::endl;
+  std::cerr << "        -j <n>: batch mode, number of threads. Default is one per CPU." << std::endl;
+  std::cerr << "        -k <dir>: batch mode, cache parsed graphs in binary form in <dir>. Cache files are renewed when a dot file changes." << std::endl;
+  std::cerr << "        -m <manifest>: batch mode, compare all dot files listed in <manifest> (one per line) with each other." << std::endl;
+  std::cerr << "                If dot files are given as arguments, compare each of them with all files of the manifest." << std::endl;
+  std::cerr << "                Prints a tab separated matrix of return codes, the return code is EXIT_SUCCESS if the matrix is complete." << std::endl;
   std::cerr << "        -n: do not compare names of vertices. Not applicable with option -t." << std::endl;
+  std::cerr << "        -o <file>: batch mode, write the result matrix to <file> instead of stdout." << std::endl;
   std::cerr << "        -s: silent mode, no output, only return code. Usefull for automated tests." << std::endl;
   std::cerr << "        -t: test a single graph: compare each vertex with itself. This tests the vertex comparator." << std::endl;
   std::cerr << "        -v: verbose output." << std::endl;
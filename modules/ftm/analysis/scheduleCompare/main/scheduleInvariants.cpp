@@ -0,0 +1,193 @@
+#include "scheduleInvariants.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include <boost/graph/graph_traits.hpp>
+
+/* Computes the invariants of both graphs.
+ * Initial labels are derived from the vertex attributes (ScheduleVertex::invariantKey).
+ * If both graphs have the same size, labels are refined Weisfeiler-Lehman style with the
+ * labels of the neighbours and the edge labels until the partition is stable. After each
+ * step the multisets of labels of both graphs must be equal, otherwise the graphs are not
+ * isomorphic. For a subgraph check, graph1 has to fit into graph2: each label must occur in
+ * graph2 at least as often as in graph1 and a candidate vertex in graph2 needs at least the
+ * degree per edge label of the vertex in graph1.
+ */
+ScheduleInvariants::ScheduleInvariants(const ScheduleGraph& graph1, const ScheduleGraph& graph2) : graph1_(graph1), graph2_(graph2) {
+  sameSize = (num_vertices(graph1_) == num_vertices(graph2_) && num_edges(graph1_) == num_edges(graph2_));
+  initialLabels();
+  if (!usable) {
+    return;
+  }
+  edgeLabels();
+  if (sameSize) {
+    compatible = sameMultiset(label1, label2);
+    if (compatible) {
+      refine();
+    }
+  } else {
+    compatible = containedMultiset(label1, label2);
+  }
+}
+
+bool ScheduleInvariants::isCandidate(long unsigned int v1, long unsigned int v2) const {
+  if (!usable) {
+    return true;
+  }
+  if (label1[v1] != label2[v2]) {
+    return false;
+  }
+  // the refined labels include the degrees, check them only for subgraphs.
+  return sameSize || (dominates(out2[v2], out1[v1]) && dominates(in2[v2], in1[v1]));
+}
+
+bool ScheduleInvariants::uniqueMapping(std::vector<long unsigned int>& mapping) const {
+  if (!usable || !compatible || !sameSize) {
+    return false;
+  }
+  // labels of both graphs are equal multisets, thus each label occurs once in graph2 as well.
+  std::vector<long unsigned int> vertexOfLabel(label1.size() + label2.size(), label2.size());
+  for (size_t v = 0; v < label2.size(); v++) {
+    if (vertexOfLabel[label2[v]] != label2.size()) {
+      return false;
+    }
+    vertexOfLabel[label2[v]] = v;
+  }
+  mapping.resize(label1.size());
+  for (size_t v = 0; v < label1.size(); v++) {
+    mapping[v] = vertexOfLabel[label1[v]];
+  }
+  return true;
+}
+
+void ScheduleInvariants::initialLabels() {
+  std::unordered_map<std::string, int> dictionary;
+  label1.resize(num_vertices(graph1_));
+  label2.resize(num_vertices(graph2_));
+  BGL_FORALL_VERTICES(v, graph1_, ScheduleGraph) {
+    std::string key = graph1_[v].invariantKey();
+    if (key.empty()) {
+      // a vertex without type matches any vertex.
+      usable = false;
+      return;
+    }
+    label1[v] = dictionary.emplace(key, dictionary.size()).first->second;
+  }
+  BGL_FORALL_VERTICES(v, graph2_, ScheduleGraph) {
+    label2[v] = dictionary.emplace(graph2_[v].invariantKey(), dictionary.size()).first->second;
+  }
+}
+
+void ScheduleInvariants::edgeLabels() {
+  std::map<std::pair<std::string, std::string>, int> dictionary;
+  auto collect = [&dictionary](const ScheduleGraph& graph, std::vector<adjacencyVector>& outAdjacent, std::vector<adjacencyVector>& inAdjacent) {
+    outAdjacent.resize(num_vertices(graph));
+    inAdjacent.resize(num_vertices(graph));
+    BGL_FORALL_EDGES(e, graph, ScheduleGraph) {
+      int label = dictionary.emplace(std::make_pair(graph[e].name, graph[e].type), dictionary.size()).first->second;
+      outAdjacent[source(e, graph)].emplace_back(label, target(e, graph));
+      inAdjacent[target(e, graph)].emplace_back(label, source(e, graph));
+    }
+  };
+  collect(graph1_, outAdjacent1, inAdjacent1);
+  collect(graph2_, outAdjacent2, inAdjacent2);
+  if (!sameSize) {
+    for (auto& adjacent : outAdjacent1) out1.push_back(degrees(adjacent));
+    for (auto& adjacent : inAdjacent1) in1.push_back(degrees(adjacent));
+    for (auto& adjacent : outAdjacent2) out2.push_back(degrees(adjacent));
+    for (auto& adjacent : inAdjacent2) in2.push_back(degrees(adjacent));
+  }
+}
+
+ScheduleInvariants::degreeVector ScheduleInvariants::degrees(const adjacencyVector& adjacent) {
+  std::map<int, int> count;
+  for (auto& edge : adjacent) {
+    count[edge.first]++;
+  }
+  return degreeVector(count.begin(), count.end());
+}
+
+void ScheduleInvariants::refine() {
+  std::vector<int> all(label1);
+  all.insert(all.end(), label2.begin(), label2.end());
+  std::sort(all.begin(), all.end());
+  size_t classes = std::unique(all.begin(), all.end()) - all.begin();
+
+  // signature of a vertex: own label, labels of (edge, neighbour) for out edges, then for in edges.
+  auto signature = [](int label, const adjacencyVector& outAdjacent, const adjacencyVector& inAdjacent, const std::vector<int>& labels) {
+    std::vector<std::pair<int, int>> outPairs, inPairs;
+    for (auto& edge : outAdjacent) outPairs.emplace_back(edge.first, labels[edge.second]);
+    for (auto& edge : inAdjacent) inPairs.emplace_back(edge.first, labels[edge.second]);
+    std::sort(outPairs.begin(), outPairs.end());
+    std::sort(inPairs.begin(), inPairs.end());
+    std::vector<int> result;
+    result.reserve(2 * (outPairs.size() + inPairs.size()) + 3);
+    result.push_back(label);
+    result.push_back(-1);
+    for (auto& p : outPairs) {
+      result.push_back(p.first);
+      result.push_back(p.second);
+    }
+    result.push_back(-2);
+    for (auto& p : inPairs) {
+      result.push_back(p.first);
+      result.push_back(p.second);
+    }
+    return result;
+  };
+
+  // each round splits at least one class or the partition is stable.
+  while (classes < label1.size() + label2.size()) {
+    std::map<std::vector<int>, int> dictionary;
+    std::vector<int> next1(label1.size()), next2(label2.size());
+    for (size_t v = 0; v < label1.size(); v++) {
+      next1[v] = dictionary.emplace(signature(label1[v], outAdjacent1[v], inAdjacent1[v], label1), dictionary.size()).first->second;
+    }
+    for (size_t v = 0; v < label2.size(); v++) {
+      next2[v] = dictionary.emplace(signature(label2[v], outAdjacent2[v], inAdjacent2[v], label2), dictionary.size()).first->second;
+    }
+    rounds++;
+    if (!sameMultiset(next1, next2)) {
+      compatible = false;
+      return;
+    }
+    label1.swap(next1);
+    label2.swap(next2);
+    if (dictionary.size() == classes) {
+      break;
+    }
+    classes = dictionary.size();
+  }
+}
+
+bool ScheduleInvariants::sameMultiset(const std::vector<int>& labels1, const std::vector<int>& labels2) const {
+  std::vector<int> sorted1(labels1), sorted2(labels2);
+  std::sort(sorted1.begin(), sorted1.end());
+  std::sort(sorted2.begin(), sorted2.end());
+  return sorted1 == sorted2;
+}
+
+bool ScheduleInvariants::containedMultiset(const std::vector<int>& labels1, const std::vector<int>& labels2) const {
+  std::vector<int> sorted1(labels1), sorted2(labels2);
+  std::sort(sorted1.begin(), sorted1.end());
+  std::sort(sorted2.begin(), sorted2.end());
+  return std::includes(sorted2.begin(), sorted2.end(), sorted1.begin(), sorted1.end());
+}
+
+/* Returns true, if 'large' has at least the count of 'small' for each edge label.
+ */
+bool ScheduleInvariants::dominates(const degreeVector& large, const degreeVector& small) {
+  auto it = large.begin();
+  for (auto& degree : small) {
+    while (it != large.end() && it->first < degree.first) {
+      it++;
+    }
+    if (it == large.end() || it->first != degree.first || it->second < degree.second) {
+      return false;
+    }
+  }
+  return true;
+}
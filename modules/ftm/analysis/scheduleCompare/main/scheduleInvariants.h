@@ -0,0 +1,52 @@
+#ifndef SCHEDULE_INVARIANTS_H
+#define SCHEDULE_INVARIANTS_H
+
+#include <utility>
+#include <vector>
+
+#include "ScheduleGraph.h"
+
+/* Vertex invariants of two schedule graphs used to prune the isomorphism search.
+ * Invariants are computed on both graphs with shared label dictionaries, such that
+ * equal labels in graph 1 and graph 2 denote equal invariants.
+ */
+class ScheduleInvariants {
+ public:
+  ScheduleInvariants(const ScheduleGraph& graph1, const ScheduleGraph& graph2);
+  // false if the graphs have no usable invariants (vertices without type). Then no pruning is possible.
+  bool isUsable() const { return usable; }
+  // false if the invariants prove that graph1 is not isomorphic to (a subgraph of) graph2.
+  bool isCompatible() const { return compatible; }
+  // true if vertex v1 of graph1 may be mapped to vertex v2 of graph2.
+  bool isCandidate(long unsigned int v1, long unsigned int v2) const;
+  // true if each label occurs exactly once in both graphs. Then the only candidate mapping is returned in 'mapping'.
+  bool uniqueMapping(std::vector<long unsigned int>& mapping) const;
+  // number of refinement rounds done.
+  int getRounds() const { return rounds; }
+
+ private:
+  // (edge label, count) pairs, sorted by edge label
+  typedef std::vector<std::pair<int, int>> degreeVector;
+  // (edge label, adjacent vertex) pairs
+  typedef std::vector<std::pair<int, long unsigned int>> adjacencyVector;
+  const ScheduleGraph& graph1_;
+  const ScheduleGraph& graph2_;
+  bool usable = true;
+  bool compatible = true;
+  // true, if both graphs have the same number of vertices and edges. Then the full refinement applies.
+  bool sameSize = false;
+  int rounds = 0;
+  std::vector<int> label1, label2;
+  std::vector<adjacencyVector> outAdjacent1, outAdjacent2, inAdjacent1, inAdjacent2;
+  std::vector<degreeVector> out1, out2, in1, in2;
+
+  void initialLabels();
+  void edgeLabels();
+  static degreeVector degrees(const adjacencyVector& adjacent);
+  void refine();
+  bool sameMultiset(const std::vector<int>& labels1, const std::vector<int>& labels2) const;
+  bool containedMultiset(const std::vector<int>& labels1, const std::vector<int>& labels2) const;
+  static bool dominates(const degreeVector& large, const degreeVector& small);
+};
+
+#endif
@@ -4,16 +4,20 @@
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/properties.hpp>
 #include <boost/graph/vf2_sub_graph_iso.hpp>
+#include <algorithm>
+#include <memory>
+#include <tuple>
 
 #include "parseSchedule.h"
 #include "printSchedule.h"
 #include "scheduleCompare.h"
 #include "scheduleCompact.h"
+#include "scheduleInvariants.h"
 
 template <typename Graph1>
 class iso_callback {
  public:
-  iso_callback(const Graph1& graph1, const Graph1& graph2) : graph1_(graph1), graph2_(graph2) {}
+  iso_callback(const Graph1& graph1, const Graph1& graph2, bool stopAfterFirst = false) : graph1_(graph1), graph2_(graph2), stopAfterFirst_(stopAfterFirst) {}
   template <typename CorrespondenceMap1To2, typename CorrespondenceMap2To1>
   bool operator()(CorrespondenceMap1To2 f, CorrespondenceMap2To1) {
     BGL_FORALL_VERTICES_T(v, graph1_, Graph1) {
@@ -22,7 +26,18 @@ class iso_callback {
     set_of_vertex_iso_map.push_back(vertex_iso_map);
     vertex_iso_map.clear();
     isomorphismCounter++;
-    return true;
+    // returning false stops the search.
+    return !stopAfterFirst_;
+  }
+
+  // record an isomorphism found without the VF2 search.
+  void add(const std::vector<long unsigned int>& mapping) {
+    for (long unsigned int v = 0; v < mapping.size(); v++) {
+      vertex_iso_map.emplace_back(v, mapping[v]);
+    }
+    set_of_vertex_iso_map.push_back(vertex_iso_map);
+    vertex_iso_map.clear();
+    isomorphismCounter++;
   }
 
   std::vector<std::vector<std::pair<int, int>>> get_setvmap() {
@@ -39,6 +54,7 @@ class iso_callback {
   std::vector<std::pair<int, int>> vertex_iso_map;
   std::vector<std::vector<std::pair<int, int>>> set_of_vertex_iso_map;
   int isomorphismCounter = 1;
+  bool stopAfterFirst_;
 };
 
 template <typename Graph1>
@@ -57,15 +73,20 @@ void printIsomorphisms(std::ostream& out, std::vector<std::vector<std::pair<int,
 template <typename Graph1>
 class GraphCompare {
  public:
-  GraphCompare(Graph1& graph1, const Graph1& graph2) : graph1_(graph1), graph2_(graph2) {}
+  GraphCompare(Graph1& graph1, const Graph1& graph2, const ScheduleInvariants* invariants = nullptr) : graph1_(graph1), graph2_(graph2), invariants_(invariants) {}
   bool operator()(long unsigned int v1, long unsigned int v2) {
     //~ std::cout << "GraphCompare: " << v1 << ", " << v2 << std::endl;
+    // cheap check of the invariants first, avoids the attribute compare for most pairs.
+    if (invariants_ != nullptr && !invariants_->isCandidate(v1, v2)) {
+      return false;
+    }
     return graph1_[v1] == graph2_[v2];
   }
 
  private:
   Graph1& graph1_;
   const Graph1& graph2_;
+  const ScheduleInvariants* invariants_;
 };
 
 template <typename Graph1>
@@ -83,6 +104,124 @@ class EdgeCompare {
   const Graph1& graph2_;
 };
 
+/* Checks if 'mapping' from the vertices of graph1 to the vertices of graph2 is an isomorphism.
+ * Both graphs must have the same number of vertices and edges. Vertices are compared as in
+ * the VF2 search, edges by name and type.
+ */
+bool isIsomorphism(ScheduleGraph& graph1, ScheduleGraph& graph2, const std::vector<long unsigned int>& mapping) {
+  typedef std::tuple<long unsigned int, std::string, std::string> edgeKey;
+  BGL_FORALL_VERTICES(v, graph1, ScheduleGraph) {
+    if (!(graph1[v] == graph2[mapping[v]])) {
+      return false;
+    }
+    std::vector<edgeKey> out1, out2;
+    BGL_FORALL_OUTEDGES(v, e, graph1, ScheduleGraph) {
+      out1.emplace_back(mapping[target(e, graph1)], graph1[e].name, graph1[e].type);
+    }
+    BGL_FORALL_OUTEDGES(mapping[v], e, graph2, ScheduleGraph) {
+      out2.emplace_back(target(e, graph2), graph2[e].name, graph2[e].type);
+    }
+    std::sort(out1.begin(), out1.end());
+    std::sort(out2.begin(), out2.end());
+    if (out1 != out2) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool isSmallerGraph(const ScheduleGraph& graph1, const ScheduleGraph& graph2) {
+  return !(num_vertices(graph1) > num_vertices(graph2) || (num_vertices(graph1) == num_vertices(graph2) && num_edges(graph1) > num_edges(graph2)));
+}
+
+/* Compares two parsed schedules. The smaller graph is matched against the larger one.
+ * Compare protocols are written to the vertices and edges of the smaller graph.
+ */
+int compareSchedules(ScheduleGraph& graph1, ScheduleGraph& graph2, std::string& dotFile1, std::string& dotFile2, configuration& config) {
+  int result = -1;
+  // Use the smaller graph as graph1.
+  ScheduleGraph *ref1, *ref2;
+  std::string *refName1, *refName2;
+  if (!isSmallerGraph(graph1, graph2)) {
+    ref1 = &graph2;
+    refName1 = &dotFile2;
+    ref2 = &graph1;
+    refName2 = &dotFile1;
+  } else {
+    ref1 = &graph1;
+    refName1 = &dotFile1;
+    ref2 = &graph2;
+    refName2 = &dotFile2;
+  }
+
+  // create predicates for edges
+  //~ typedef boost::property_map_equivalent<EdgeNameMap, EdgeNameMap> edge_compare_t;
+  //~ edge_compare_t edge_compare = make_property_map_equivalent(boost::get(&ScheduleEdge::type, *ref1), get(&ScheduleEdge::type, *ref2));
+  // Alternative:
+  EdgeCompare<ScheduleGraph> edgeComparator(*ref1, *ref2);
+
+  // Vertex invariants reject non-isomorphic graphs before the search and restrict the candidates during the search.
+  // In verbose mode all vertex pairs are compared to get the complete protocol of failed compares.
+  std::unique_ptr<ScheduleInvariants> invariants;
+  if (!config.verbose) {
+    invariants.reset(new ScheduleInvariants(*ref1, *ref2));
+  }
+  // Create callback. In silent mode only the existence of an isomorphism is of interest.
+  iso_callback<ScheduleGraph> callback(*ref1, *ref2, config.silent);
+  // create predicates for vertices
+  GraphCompare<ScheduleGraph> graphComparator(*ref1, *ref2, invariants.get());
+  // Print out all subgraph isomorphism mappings between graph1 and graph2.
+  // Function vertex_order_by_mult is used to compute the order of
+  // vertices of graph1. This is the order in which the vertices are examined
+  // during the matching process.
+  bool isomorphic = false;
+  std::vector<long unsigned int> mapping;
+  if (invariants && !invariants->isCompatible()) {
+    isomorphic = false;
+  } else if (invariants && invariants->uniqueMapping(mapping)) {
+    // each vertex has a unique invariant, so this mapping is the only candidate.
+    isomorphic = isIsomorphism(*ref1, *ref2, mapping);
+    if (isomorphic) {
+      callback.add(mapping);
+    }
+  } else {
+    isomorphic = vf2_subgraph_iso(*ref1,                              // const GraphSmall& graph_small
+                        *ref2,                                        // const GraphLarge& graph_large,
+                        std::ref(callback),                           // SubGraphIsoMapCallback user_callback,
+                        get(boost::vertex_index, *ref1),              // IndexMapSmall index_map_small,
+                        get(boost::vertex_index, *ref2),              // IndexMapLarge index_map_large,
+                        vertex_order_by_mult(*ref1),                  // const VertexOrderSmall& vertex_order_small,
+                        std::ref(edgeComparator),                     // EdgeEquivalencePredicate edge_comp,
+                        std::ref(graphComparator));                   // VertexEquivalencePredicate vertex_comp)
+  }
+  std::string isSubgraph = "";
+  if (num_vertices(*ref1) == num_vertices(*ref2) && num_edges(*ref1) == num_edges(*ref2)) {
+    result = (isomorphic ? EXIT_SUCCESS : NOT_ISOMORPHIC);
+  } else {
+    result = (isomorphic ? SUBGRAPH_ISOMORPHIC : NOT_ISOMORPHIC);
+    isSubgraph = "a subgraph of ";
+  }
+
+  if (!config.silent) {
+    std::cout << "Graph " << getGraphName(*ref1) << " (" << *refName1 << ") is " << (isomorphic ? "" : "NOT ") << "isomorphic to "
+              << isSubgraph << "graph " << getGraphName(*ref2) << " (" << *refName2 << ")." << std::endl;
+    if (config.verbose) {
+      std::string prefix = "Isomorphism " + std::to_string(callback.getIsomorphismCounter()) + ", Graph 1, ";
+      listVertexProtocols(*ref1, prefix);
+      listEdgeProtocols(*ref1, prefix);
+    }
+    // get vector from callback
+    auto set_of_isomorphisms = callback.get_setvmap();
+
+    if (set_of_isomorphisms.size() > 0) {
+      // output vector size here
+      std::cout << "Number of isomorphisms: " << set_of_isomorphisms.size() << std::endl;
+      printIsomorphisms(std::cout, set_of_isomorphisms, *ref1, *ref2, config.superverbose);
+    }
+  }
+  return result;
+}
+
 /* This is the main method to check for an isomorphism. It contains the call to vf2_subgraph_iso.
  */
 int scheduleIsomorphic(std::string dotFile1, std::string dotFile2, configuration& config) {
@@ -117,70 +256,7 @@ int scheduleIsomorphic(std::string dotFile1, std::string dotFile2, configuration
     // set the flag for comparing the names on all vertices of both graphs.
     switchCompareNames(graph1, config.compareNames);
     switchCompareNames(graph2, config.compareNames);
-    // Use the smaller graph as graph1.
-    ScheduleGraph *ref1, *ref2;
-    std::string *refName1, *refName2;
-    if (num_vertices(graph1) > num_vertices(graph2) ||
-        (num_vertices(graph1) == num_vertices(graph2) && num_edges(graph1) > num_edges(graph2))) {
-      ref1 = &graph2;
-      refName1 = &dotFile2;
-      ref2 = &graph1;
-      refName2 = &dotFile1;
-    } else {
-      ref1 = &graph1;
-      refName1 = &dotFile1;
-      ref2 = &graph2;
-      refName2 = &dotFile2;
-    }
-
-    // create predicates for edges
-    //~ typedef boost::property_map_equivalent<EdgeNameMap, EdgeNameMap> edge_compare_t;
-    //~ edge_compare_t edge_compare = make_property_map_equivalent(boost::get(&ScheduleEdge::type, *ref1), get(&ScheduleEdge::type, *ref2));
-    // Alternative:
-    EdgeCompare<ScheduleGraph> edgeComparator(*ref1, *ref2);
-
-    // Create callback
-    iso_callback<ScheduleGraph> callback(*ref1, *ref2);
-    // create predicates for vertices
-    GraphCompare<ScheduleGraph> graphComparator(*ref1, *ref2);
-    // Print out all subgraph isomorphism mappings between graph1 and graph2.
-    // Function vertex_order_by_mult is used to compute the order of
-    // vertices of graph1. This is the order in which the vertices are examined
-    // during the matching process.
-    bool isomorphic = vf2_subgraph_iso(*ref1,                           // const GraphSmall& graph_small
-                          *ref2,                                        // const GraphLarge& graph_large,
-                          std::ref(callback),                           // SubGraphIsoMapCallback user_callback,
-                          get(boost::vertex_index, *ref1),              // IndexMapSmall index_map_small,
-                          get(boost::vertex_index, *ref2),              // IndexMapLarge index_map_large,
-                          vertex_order_by_mult(*ref1),                  // const VertexOrderSmall& vertex_order_small,
-                          std::ref(edgeComparator),                     // EdgeEquivalencePredicate edge_comp,
-                          std::ref(graphComparator));                   // VertexEquivalencePredicate vertex_comp)
-    std::string isSubgraph = "";
-    if (num_vertices(*ref1) == num_vertices(*ref2) && num_edges(*ref1) == num_edges(*ref2)) {
-      result = (isomorphic ? EXIT_SUCCESS : NOT_ISOMORPHIC);
-    } else {
-      result = (isomorphic ? SUBGRAPH_ISOMORPHIC : NOT_ISOMORPHIC);
-      isSubgraph = "a subgraph of ";
-    }
-
-    if (!config.silent) {
-      std::cout << "Graph " << getGraphName(*ref1) << " (" << *refName1 << ") is " << (isomorphic ? "" : "NOT ") << "isomorphic to "
-                << isSubgraph << "graph " << getGraphName(*ref2) << " (" << *refName2 << ")." << std::endl;
-      if (config.verbose) {
-        std::string prefix = "Isomorphism " + std::to_string(callback.getIsomorphismCounter()) + ", Graph 1, ";
-        listVertexProtocols(*ref1, prefix);
-        listEdgeProtocols(*ref1, prefix);
-      }
-      // get vector from callback
-      auto set_of_isomorphisms = callback.get_setvmap();
-
-      if (set_of_isomorphisms.size() > 0) {
-        // output vector size here
-        std::cout << "Number of isomorphisms: " << set_of_isomorphisms.size() << std::endl;
-        printIsomorphisms(std::cout, set_of_isomorphisms, *ref1, *ref2, config.superverbose);
-      }
-    }
-    return result;
+    return compareSchedules(graph1, graph2, dotFile1, dotFile2, config);
   } else {
     return (result == -1) ? FILE_NOT_FOUND : result;
   }
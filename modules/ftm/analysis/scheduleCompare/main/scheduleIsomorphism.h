@@ -7,6 +7,8 @@
 #include "scheduleCompare.h"
 
 int scheduleIsomorphic(std::string dotFile1, std::string dotfile2, configuration& config);
+int compareSchedules(ScheduleGraph& graph1, ScheduleGraph& graph2, std::string& dotFile1, std::string& dotFile2, configuration& config);
+bool isSmallerGraph(const ScheduleGraph& graph1, const ScheduleGraph& graph2);
 int testSingleGraph(std::string dotFile1, configuration& config);
 void listVertexProtocols(ScheduleGraph& graph, const std::string prefix);
 void listEdgeProtocols(ScheduleGraph& graph, const std::string prefix);
@@ -0,0 +1,58 @@
+import common_scheduleCompare
+import subprocess
+import tempfile
+
+"""Class tests scheduleCompare in batch mode (option -m).
+"""
+class TestBatch(common_scheduleCompare.CommonScheduleCompare):
+
+  def callBatch(self, options, expectedReturnCode=0):
+    """Run scheduleCompare in batch mode and return the result matrix as list of rows.
+    """
+    process = subprocess.run([self.binary] + options, stderr=subprocess.PIPE, stdout=subprocess.PIPE)
+    self.assertEqual(process.returncode, expectedReturnCode, f'wrong return code {process.returncode}, options: {options}\nstderr: {process.stderr.decode("utf-8")}')
+    return [line.split('\t') for line in process.stdout.decode('utf-8').splitlines()]
+
+  def test_batch_all_pairs(self):
+    """Compare all schedules of the manifest with each other. The matrix is symmetric with 0 on the diagonal.
+    """
+    matrix = self.callBatch(['-m', 'batch/manifest.txt'])
+    self.assertEqual(matrix[0], ['schedule', 'batch/../dot_block/tperiod-10.dot', 'batch/../dot_block/tperiod-11.dot', 'batch/../schedules/size6.dot'])
+    self.assertEqual([row[1:] for row in matrix[1:]], [['0', '1', '1'], ['1', '0', '1'], ['1', '1', '0']])
+
+  def test_batch_one_to_many(self):
+    """Compare a schedule with all schedules of the manifest.
+    """
+    matrix = self.callBatch(['-m', 'batch/manifest.txt', '-j', '2', 'dot_block/tperiod-11.dot'])
+    self.assertEqual(matrix[1], ['dot_block/tperiod-11.dot', '1', '0', '1'])
+
+  def test_batch_asymmetric(self):
+    """Untyped vertices of the first graph match anything, so the matrix is not symmetric.
+    """
+    matrix = self.callBatch(['-m', 'batch/manifest-asymmetric.txt'])
+    self.assertEqual(matrix[0], ['schedule', 'batch/untyped.dot', 'batch/typed.dot'])
+    self.assertEqual([row[1:] for row in matrix[1:]], [['0', '0'], ['1', '0']])
+
+  def test_batch_bad_threads(self):
+    """A non-numeric number of threads gives BAD_ARGUMENTS.
+    """
+    self.callBatch(['-m', 'batch/manifest.txt', '-j', 'abc'], expectedReturnCode=11)
+
+  def test_batch_missing_file(self):
+    """A missing dot file gives FILE_NOT_FOUND in its row and column.
+    """
+    matrix = self.callBatch(['-m', 'batch/manifest-missing.txt'])
+    self.assertEqual([row[1:] for row in matrix[1:]], [['0', '13'], ['13', '13']])
+
+  def test_batch_missing_manifest(self):
+    """A missing manifest gives FILE_NOT_FOUND.
+    """
+    self.callBatch(['-m', 'batch/no-manifest.txt'], expectedReturnCode=13)
+
+  def test_batch_cache(self):
+    """Parsed graphs are stored in the cache directory, the second run uses the cache with the same results.
+    """
+    with tempfile.TemporaryDirectory() as cacheDir:
+      matrix1 = self.callBatch(['-m', 'batch/manifest.txt', '-k', cacheDir])
+      matrix2 = self.callBatch(['-m', 'batch/manifest.txt', '-k', cacheDir])
+      self.assertEqual(matrix1, matrix2)
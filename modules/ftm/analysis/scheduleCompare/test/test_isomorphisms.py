@@ -90,3 +90,21 @@ class TestIsomorphisms(common_scheduleCompare.CommonScheduleCompare):
     """
     self.callScheduleCompare('permutations/x-edge-types0.dot', 'permutations/x-edge-types0a.dot', '-n', expectedReturnCode=1, linesCerr=0, linesCout=1)
 
+
+  def test_typed_schedule_itself(self):
+    """Compare a schedule with typed vertices with itself.
+    All vertices have unique invariants, the isomorphism is found without search.
+    """
+    self.callScheduleCompare('schedules/size6.dot', 'schedules/size6.dot', expectedReturnCode=0, linesCerr=0, linesCout=3)
+
+  def test_typed_schedule_itself_n(self):
+    """Compare a schedule with typed vertices with itself, without comparing names.
+    The vertex attributes are unique, there is one isomorphism.
+    """
+    self.callScheduleCompare('schedules/size6.dot', 'schedules/size6.dot', '-n', expectedReturnCode=0, linesCerr=0, linesCout=3)
+
+  def test_typed_schedules_attribute_differs(self):
+    """Compare two schedules of the same size where one vertex attribute differs.
+    The invariants of the vertices differ, schedules are not isomorphic.
+    """
+    self.callScheduleCompare('dot_block/tperiod-10.dot', 'dot_block/tperiod-11.dot', '-s', expectedReturnCode=1, linesCerr=0, linesCout=0)
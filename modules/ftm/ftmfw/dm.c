@@ -76,6 +76,13 @@ uint64_t* const diffwts   = (uint64_t*) &_startshared[(SHCTL_DIAG + T_DIAG_WAR_1
 uint32_t* const bcklogmax = (uint32_t*) &_startshared[(SHCTL_DIAG + T_DIAG_BCKLOG_STRK )  >> 2];  
 uint32_t* const badwaitcnt = (uint32_t*) &_startshared[(SHCTL_DIAG + T_DIAG_BAD_WAIT_CNT )  >> 2];
 #endif
+#ifdef PROFILING
+uint32_t* const prof       = (uint32_t*) &_startshared[(SHCTL_DIAG + T_DIAG_PROF )  >> 2];
+uint32_t* const profstlcnt = (uint32_t*) &_startshared[(SHCTL_DIAG + T_DIAG_PROF_STL_CNT )  >> 2];
+uint32_t* const profstlmax = (uint32_t*) &_startshared[(SHCTL_DIAG + T_DIAG_PROF_STL_MAX )  >> 2];
+uint8_t nodeProfSlots[_NODE_TYPE_END_];
+uint8_t actProfSlots[_ACT_TYPE_END_];
+#endif
 uint32_t* const start   = (uint32_t*)&_startshared[(SHCTL_THR_CTL + T_TC_START)   >> 2];          
 uint32_t* const running = (uint32_t*)&_startshared[(SHCTL_THR_CTL + T_TC_RUNNING) >> 2];          
 uint32_t* const abort1  = (uint32_t*)&_startshared[(SHCTL_THR_CTL + T_TC_ABORT)   >> 2];          
@@ -144,6 +151,25 @@ void dmInit() {
   actionFuncs[ACT_TYPE_WAIT]            = execWait;
 
   uint8_t i;
+  #ifdef PROFILING
+    for(i=0; i < _NODE_TYPE_END_; i++) nodeProfSlots[i] = _PROF_SLOT_QTY_;
+    for(i=0; i < _ACT_TYPE_END_; i++)  actProfSlots[i]  = _PROF_SLOT_QTY_;
+    nodeProfSlots[NODE_TYPE_TMSG]         = PROF_TMSG;
+    nodeProfSlots[NODE_TYPE_CNOOP]        = PROF_CMD;
+    nodeProfSlots[NODE_TYPE_CFLOW]        = PROF_CMD;
+    nodeProfSlots[NODE_TYPE_CFLUSH]       = PROF_CMD;
+    nodeProfSlots[NODE_TYPE_CWAIT]        = PROF_CMD;
+    nodeProfSlots[NODE_TYPE_CSWITCH]      = PROF_SWITCH;
+    nodeProfSlots[NODE_TYPE_BLOCK_FIXED]  = PROF_BLOCK;
+    nodeProfSlots[NODE_TYPE_BLOCK_ALIGN]  = PROF_BLOCK_ALIGN;
+    actProfSlots[ACT_TYPE_FLUSH]          = PROF_ACT_FLUSH;
+    actProfSlots[ACT_TYPE_WAIT]           = PROF_ACT_WAIT;
+    for(i=0; i < ((_PROF_SLOT_QTY_ * _T_PROF_SLOT_SIZE_) >> 2); i++) prof[i] = 0;
+    *profstlcnt = 0;
+    *profstlmax = 0;
+    *status    |= SHCTL_STATUS_PROFILE_SMSK;
+  #endif
+
   for(i=0; i < _THR_QTY_; i++) {
     //set thread times to infinity
     uint32_t* tp = (uint32_t*)(p + (( SHCTL_THR_DAT + i * _T_TD_SIZE_) >> 2));
@@ -192,6 +218,21 @@ uint64_t  dummyDeadlineFunc (uint32_t* node, uint32_t* thrData)               {
 
 uint32_t* dummyActionFunc (uint32_t* node, uint32_t* cmd, uint32_t* thrData)  { *status |= SHCTL_STATUS_BAD_ACT_TYPE_SMSK;  return LM32_NULL_PTR;}
 
+#ifdef PROFILING
+void profRecord(uint8_t idx, uint32_t cyc) {
+  if (idx >= _PROF_SLOT_QTY_) return;
+  uint32_t* slot = prof + ((idx * _T_PROF_SLOT_SIZE_) >> 2);
+  slot[T_PROF_SLOT_CNT >> 2]++;
+  slot[T_PROF_SLOT_MAX >> 2] = (cyc > slot[T_PROF_SLOT_MAX >> 2]) ? cyc : slot[T_PROF_SLOT_MAX >> 2];
+  *(uint64_t*)&slot[T_PROF_SLOT_SUM >> 2] += cyc;
+}
+
+void profStall(uint32_t cyc) {
+  *profstlcnt += (cyc > PROF_STALL_THRS);
+  *profstlmax  = (cyc > *profstlmax) ? cyc : *profstlmax;
+}
+#endif
+
 uint8_t getNodeType(uint32_t* node) {
   uint32_t* tmpType;
   uint32_t msk;
@@ -361,6 +402,7 @@ uint32_t* cmd(uint32_t* node, uint32_t* thrData) {
   e[(T_CMD_ACT + 2 * _32b_SIZE_) >> 2]  = node[(CMD_ACT + 2 * _32b_SIZE_) >> 2];
 
   *wrIdx = (*wrIdx + 1) & Q_IDX_MAX_OVF_MSK; //increase write index
+  *((uint8_t *)tg + BLOCK_CMDQ_WR_IDXS) = (uint8_t)(BLOCK_CMDQ_PENDING_SMSK >> 24); //flag target as having pending commands. Must come after index increment
 
   DBPRINT2("#%02u: Sending Cmd 0x%08x, Target: 0x%08x, next: 0x%08x\n", cpuId, node[NODE_HASH >> 2], (uint32_t)tg, node[NODE_DEF_DEST_PTR >> 2]);
   return ret;
@@ -412,6 +454,7 @@ uint32_t* tmsg(uint32_t* node, uint32_t* thrData) {
   #endif
 
   //disptach timing message to priority queue
+  PROF_START(tPq);
   atomic_on();
   #ifdef USE_SW_TX_CONTROL
     #pragma message ( "HW Priority Queue deactivated, using software access to EBM!" )
@@ -436,6 +479,7 @@ uint32_t* tmsg(uint32_t* node, uint32_t* thrData) {
     *(pFpqData + (PRIO_DAT_TS_LO >> 2))  = thrData[T_TD_DEADLINE_LO >> 2];
   #endif   
   atomic_off();
+  PROF_STALL(tPq);
 
   ++(*((uint64_t*)&thrData[T_TD_MSG_CNT >> 2])); //increment thread message counter
   ++(*count); //increment cpu message counter
@@ -443,6 +487,14 @@ uint32_t* tmsg(uint32_t* node, uint32_t* thrData) {
   return (uint32_t*)node[NODE_DEF_DEST_PTR >> 2];
 }
 
+/// Clears a block's pending bit once all of its queues are empty.
+/** Writers increment a wr index first and set the pending bit afterwards (the host does both in one word write).
+ *  Re-checking the indices after clearing therefore catches any command that arrived in between. */
+static inline void blockClearPending(uint8_t* pending, uint32_t* awrOffs, uint32_t* ardOffs) {
+  *pending = 0;
+  if((*awrOffs & BLOCK_CMDQ_WR_IDXS_SMSK) != (*ardOffs & BLOCK_CMDQ_RD_IDXS_SMSK)) *pending = (uint8_t)(BLOCK_CMDQ_PENDING_SMSK >> 24);
+}
+
 uint32_t* block(uint32_t* node, uint32_t* thrData) {
   DBPRINT2("#%02u: Checking Block 0x%08x\n", cpuId, node[NODE_HASH >> 2]);
   uint32_t *ret = (uint32_t*)node[NODE_DEF_DEST_PTR >> 2];
@@ -451,18 +503,29 @@ uint32_t* block(uint32_t* node, uint32_t* thrData) {
   uint8_t skipOne = 0;
 
   uint32_t *ardOffs = node + (BLOCK_CMDQ_RD_IDXS >> 2), *awrOffs = node + (BLOCK_CMDQ_WR_IDXS >> 2);
-  uint32_t bufOffs, elOffs, prio, actTmp, atype, qFlags = *((uint32_t*)(node + (BLOCK_CMDQ_FLAGS >> 2)));
+  uint8_t  *pending = (uint8_t *)awrOffs; // top byte of wr indices word, holds the pending summary bit
+  uint32_t bufOffs, elOffs, prio, actTmp, atype, qFlags;
   uint32_t qty;
 
   node[NODE_FLAGS >> 2] |= NFLG_PAINT_LM32_SMSK; // set paint bit to mark this node as visited
 
+  // Fast path: the vast majority of block visits find no commands. Pending bit clear -> nothing to do, take default successor.
+  if(!(*awrOffs & BLOCK_CMDQ_PENDING_SMSK)) return ret;
+
+  qFlags = *((uint32_t*)(node + (BLOCK_CMDQ_FLAGS >> 2)));
+
   //3 ringbuffers -> 3 wr indices, 3 rd indices (one per priority).
   //////////////////////////////////////////////////////////////////////////////////////////////////////
   // Check queues for pending commands
   // If Do not Read flag is not set and the indices differ, there's work to do
 
-  if(!(qFlags & BLOCK_CMDQ_DNR_SMSK) 
-  && ((*awrOffs & BLOCK_CMDQ_WR_IDXS_SMSK) != (*ardOffs & BLOCK_CMDQ_RD_IDXS_SMSK)) ) {
+  if((*awrOffs & BLOCK_CMDQ_WR_IDXS_SMSK) == (*ardOffs & BLOCK_CMDQ_RD_IDXS_SMSK)) {
+    // queues are drained (e.g. by a flush), drop pending bit
+    blockClearPending(pending, awrOffs, ardOffs);
+    return ret;
+  }
+
+  if(!(qFlags & BLOCK_CMDQ_DNR_SMSK)) {
     
     //Iterate over queues, highest priority first. If we find a pending command that has reached its valid time, we take it.
     int32_t i;
@@ -510,7 +573,9 @@ uint32_t* block(uint32_t* node, uint32_t* thrData) {
     DBPRINT3("#%02u: Act 0x%08x, Qty is at %d\n", cpuId, *act, qty);
 
     if(qty) {
+      PROF_START(tAct);
       ret = actionFuncs[atype](node, cmd, thrData);       //carry out the type specific action
+      PROF_STOP(tAct, actProfSlots[atype]);
       //decrement qty bitfield in working copy and write back to action field
       actTmp &= ~ACT_QTY_SMSK; //clear qty
       actTmp |= ((--qty) & ACT_QTY_MSK) << ACT_QTY_POS;
@@ -522,6 +587,8 @@ uint32_t* block(uint32_t* node, uint32_t* thrData) {
 
     *(rdIdx) = (*rdIdx + (uint8_t)(qty == 0) ) & Q_IDX_MAX_OVF_MSK; //pop element if qty exhausted
 
+    if((*awrOffs & BLOCK_CMDQ_WR_IDXS_SMSK) == (*ardOffs & BLOCK_CMDQ_RD_IDXS_SMSK)) blockClearPending(pending, awrOffs, ardOffs); // last command popped
+
     //If we could skip and there are more cmds pending, exit and let the scheduler come back directly to this block for the next cmd in our queue
     if( skipOne && ((*awrOffs & BLOCK_CMDQ_WR_IDXS_SMSK) != (*ardOffs & BLOCK_CMDQ_RD_IDXS_SMSK)) ) {
       DBPRINT2("#%02u: Found more pending commands, skip deactivated cmd and process next cmd\n" );
@@ -105,6 +105,37 @@ extern uint32_t* const badwaitcnt;      ///< ptr to bad waittime count
 //#endif
 //@}
 
+/** @name Profiling counters
+ *  Per handler invocation count, max and cumulative cycles and priority queue write stalls. Only active if built with PROFILING.
+ *  Cycles are taken from the CPU's WB timer tick counter. Block handler cycles include the action they executed.
+ */
+//@{ 
+#ifdef PROFILING
+extern uint32_t* const prof;            ///< ptr to profiling slots
+extern uint32_t* const profstlcnt;      ///< ptr to priority queue write stall count
+extern uint32_t* const profstlmax;      ///< ptr to priority queue write max stall cycles
+extern uint8_t nodeProfSlots[_NODE_TYPE_END_]; ///< node type to profiling slot lookup, _PROF_SLOT_QTY_ if not profiled
+extern uint8_t actProfSlots[_ACT_TYPE_END_];   ///< action type to profiling slot lookup, _PROF_SLOT_QTY_ if not profiled
+
+/// Returns the low word of the CPU's tick counter. Differences are valid for intervals below 2^32 ticks
+static inline uint32_t profTick() { return *(pCpuWbTimer+(WB_TIMER_TIMESTAMP_LO >> 2)); }
+
+/// Adds one invocation taking cyc cycles to profiling slot idx
+void profRecord(uint8_t idx, uint32_t cyc);
+
+/// Records a priority queue write taking cyc cycles, counts a stall if above PROF_STALL_THRS
+void profStall(uint32_t cyc);
+
+  #define PROF_START(t)         uint32_t t = profTick()
+  #define PROF_STOP(t, idx)     profRecord(idx, profTick() - t)
+  #define PROF_STALL(t)         profStall(profTick() - t)
+#else
+  #define PROF_START(t)
+  #define PROF_STOP(t, idx)
+  #define PROF_STALL(t)
+#endif
+//@}
+
 /** @name Ptrs to scheduler control registers (start, running, abort)
  *  Provides a shorthand to the scheduler's start, running and abort registers used for thread control
  */
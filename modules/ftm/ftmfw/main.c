@@ -49,6 +49,8 @@
 uint8_t cpuId;  
 uint8_t cpuQty;
 
+#define BURST_MAX 64 ///< Max. number of nodes processed per burst. Bounds the time until an abort is served and the time is sampled again
+
 
 
 /// Debug Interrupt console output
@@ -151,13 +153,15 @@ void init()
     2. Abort bits set corresponding threads' deadlines to MAX_INT
     3. Whole EDF heap is sorted
 
-    Thread processing is done in four steps:
-    1. Check if top element is within due time window (current time + 1ms. This is sufficient lead time for processing, network lag, etc)
+    Thread processing is done in bursts. System time is sampled once per burst, then these steps are repeated
+    as long as the top element is due:
+    1. Check if top element is within due time window (sampled time + thread's preptime. This is sufficient lead time for processing, network lag, etc)
     2. If so, get node type and call appropriate handler. Process all side effects and return successor node.
     3. Calculate new deadline for succesor node
     4. Create temporary heap element from new deadline and successor node
     5. Replace heap top element by temp element and sort 
     (if thread reached a stop, its deadline is now MAX_INT and it ends up at the bottom of the heap)
+    Preptimes are cached per thread and refreshed from shared memory whenever the scheduler is idle or a thread is started.
     
     Start works as follows:
     1. Start bits sets threads' running bits to 1
@@ -174,6 +178,9 @@ void main(void) {
   uint32_t* tp;
   uint32_t** np;
   uint32_t backlog = 0;
+  uint32_t burst;
+  uint64_t now;
+  uint64_t prepTimes[_THR_QTY_];    // preptime cache, refreshed when idle. Saves two shared memory reads per processed node
 
 
   init();
@@ -204,6 +211,8 @@ void main(void) {
 
   DBPRINT1("#%02u: Base shared ram 0x%08x\n", cpuId, (uint32_t*)&_startshared);
 
+  for(i=0; i<_THR_QTY_; i++) prepTimes[i] = *(uint64_t*)(p + (( SHCTL_THR_STA + i * _T_TS_SIZE_ + T_TS_PREPTIME ) >> 2));
+
    while (1) {
 
 
@@ -218,20 +227,36 @@ void main(void) {
       *abort1 = 0; // clear abort bits
     }
 
-    //the workhorse. check if most urgent node is due and process it if this is the case.
+    //the workhorse. take one time sample, then process all nodes due within their thread's preparation window in deadline order.
+    //A burst ends after BURST_MAX nodes or on an abort request, so a thread far behind its deadlines cannot lock out the abort handling
+    now   = getSysTime();
+    burst = BURST_MAX;
     uint8_t thrIdx = *(uint32_t*)(pT(hp) + (T_TD_FLAGS >> 2)) & 0x7;
-    if (DL(pT(hp))  <= getSysTime() + *(uint64_t*)(p + (( SHCTL_THR_STA + thrIdx * _T_TS_SIZE_ + T_TS_PREPTIME   ) >> 2) )) {
-      //node is due. Execute it, then update cursor and deadline, return control to scheduler
-      backlog++;
-      *pncN(hp)   = (uint32_t)nodeFuncs[getNodeType(pN(hp))](pN(hp), pT(hp));       //process node and return thread's next node
-      DL(pT(hp))  = (uint64_t)deadlineFuncs[getNodeType(pN(hp))](pN(hp), pT(hp));   // return thread's next deadline (returns infinity on upcoming NULL ptr)
-      *running   &= ~((DL(pT(hp)) == -1ULL) << thrIdx);                             // clear running bit if deadline is at infinity
-      heapReplace(0);                                                               // call scheduler, re-sort only current thread
+    if (DL(pT(hp))  <= now + prepTimes[thrIdx]) {
+      do {
+        //node is due. Execute it, then update cursor and deadline, return control to scheduler
+        backlog++;
+        #ifdef PROFILING
+          uint8_t nodeType = getNodeType(pN(hp));
+        #endif
+        PROF_START(tNode);
+        *pncN(hp)   = (uint32_t)nodeFuncs[getNodeType(pN(hp))](pN(hp), pT(hp));       //process node and return thread's next node
+        PROF_STOP(tNode, nodeProfSlots[nodeType]);
+        DL(pT(hp))  = (uint64_t)deadlineFuncs[getNodeType(pN(hp))](pN(hp), pT(hp));   // return thread's next deadline (returns infinity on upcoming NULL ptr)
+        *running   &= ~((DL(pT(hp)) == -1ULL) << thrIdx);                             // clear running bit if deadline is at infinity
+        heapReplace(0);                                                               // call scheduler, re-sort only current thread
+        thrIdx = *(uint32_t*)(pT(hp) + (T_TD_FLAGS >> 2)) & 0x7;                      // next most urgent thread
+      } while ((--burst) && !(*abort1) && (DL(pT(hp))  <= now + prepTimes[thrIdx]));
+      // burst done. backlog is only evaluated on the next idle pass, so consecutive bursts under load still count as one backlog
 
     } else {
       //nothing due right now. Check for requests of new threads to be started
       *bcklogmax   = ((backlog > *bcklogmax) ? backlog : *bcklogmax);
       backlog = 0;
+      #ifdef PROFILING
+        *status |= SHCTL_STATUS_PROFILE_SMSK; // host may have cleared status, restore profiling flag
+      #endif
+      for(i=0; i<_THR_QTY_; i++) prepTimes[i] = *(uint64_t*)(p + (( SHCTL_THR_STA + i * _T_TS_SIZE_ + T_TS_PREPTIME ) >> 2)); // refresh preptime cache while idle
 
       if(*start) { //check start bitfield for any request
         for(i=0;i<_THR_QTY_;i++) { //iterate
@@ -253,6 +278,7 @@ void main(void) {
             uint32_t* msgcnt    = (uint32_t*)&thrData[T_TD_MSG_CNT];
 
             DBPRINT1("#%02u: ThrIdx %u, Preptime: %s\n", cpuId, i, print64(*prepTime, 0));
+            prepTimes[i] = *prepTime;
 
 	    //init fields
             if (!(*startTime)) {*currTime = getSysTime() + (*prepTime << 1); } // if 0, set to now + 2 * preptime
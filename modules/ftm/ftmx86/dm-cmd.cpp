@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <inttypes.h>
 #include <time.h>
 #include <unistd.h>
@@ -77,9 +79,11 @@ static void help(const char *program) {
   fprintf(stderr, "  -p <priority>            The priority of the command (0 = Low, 1 = High, 2 = Interlock), default is 0\n");
   fprintf(stderr, "  -q <quantity>            The number of times the command will be inserted into the target queue, default is 1\n");
   fprintf(stderr, "  -s                       Changes to the schedule are permanent\n");
+  fprintf(stderr, "  -r <repetitions>         Prepare the command once and send it <repetitions> times (noop, flow and relwait only)\n");
   fprintf(stderr, "\nDiagnostics:\n");
   fprintf(stderr, "  diag                               Show time statistics and detailed information on uptime and recent changes\n");
   fprintf(stderr, "  cleardiag                          Clears all CPU and HW statistics and details \n");
+  fprintf(stderr, "  profile                            Show firmware handler profiling counters (firmware must be built with PROFILING)\n");
   fprintf(stderr, "  cfghwdiag <TAI / ns> <Stall / ns>  Sets observation window for ECA TAI time continuity and CPU stall streaks\n");
   fprintf(stderr, "  starthwdiag                        Starts HW diagnostic data acquisition\n");
   fprintf(stderr, "  stophwdiag                         Stops HW diagnostic data acquisition\n");
@@ -207,6 +211,23 @@ void showRawStatus(const char *netaddress, CarpeDM& cdm) {
   }
 }
 
+void showFwProfile(CarpeDM& cdm) {
+  uint8_t cpuQty = cdm.getCpuQty();
+  FwProfileReport pr;
+
+  for(uint8_t i=0; i < cpuQty; i++) {
+    cdm.getFwProfile(i, pr);
+    printf("\nCpu %u: ", pr.cpu);
+    if (!pr.enabled) { printf("firmware was built without profiling\n"); continue; }
+    printf("ECA write stalls %u, max %u cycles\n", pr.stallCnt, pr.stallMax);
+    printf("%-12s %12s %12s %12s %20s\n", "Handler", "Calls", "Avg Cyc", "Max Cyc", "Sum Cyc");
+    for(unsigned j=0; j < _PROF_SLOT_QTY_; j++) {
+      printf("%-12s %12u %12llu %12u %20llu\n", pr.slot[j].name.c_str(), pr.slot[j].cnt,
+        (long long unsigned int)(pr.slot[j].cnt ? pr.slot[j].sumCycles / pr.slot[j].cnt : 0), pr.slot[j].maxCycles, (long long unsigned int)pr.slot[j].sumCycles);
+    }
+  }
+}
+
 void showHealth(const char *netaddress, CarpeDM& cdm, bool verbose) {
   std::string show;
   uint8_t cpuQty = cdm.getCpuQty();
@@ -346,11 +367,11 @@ int main(int argc, char* argv[]) {
 
 
   int32_t tmp, error=0;
-  uint32_t cpuIdx = 0, thrIdx = 0, cmdPrio = PRIO_LO, cmdQty = 1;
+  uint32_t cpuIdx = 0, thrIdx = 0, cmdPrio = PRIO_LO, cmdQty = 1, repetitions = 0;
   uint64_t cmdTvalid = 0, longtmp;
 
 // start getopt
-   while ((opt = getopt(argc, argv, "shvc:p:l:t:q:i:daf")) != -1) {
+   while ((opt = getopt(argc, argv, "shvc:p:l:t:q:i:dafr:")) != -1) {
       switch (opt) {
           case 'f':
             force = true;
@@ -395,6 +416,13 @@ int main(int argc, char* argv[]) {
               error = -1;
             } else {cmdQty = (uint32_t)tmp;}
             break;
+         case 'r':
+            tmp = strtol(optarg, NULL, 0);
+            if (tmp < 1) {
+              std::cerr << program << ": Repetitions must be a positive number" << std::endl;
+              error = -1;
+            } else {repetitions = (uint32_t)tmp;}
+            break;
          case 'c':
             tmp = strtol(optarg, NULL, 0);
             if (tmp < 0) {
@@ -500,8 +528,19 @@ int main(int argc, char* argv[]) {
 
 
 
+  // Read-only queries only need names for a few node addresses. Skip the full schedule download for them, carpeDM resolves names on demand
+  bool lazy = false;
+  if ((typeName != NULL) && (cmdFilename == NULL)) {
+    std::string tmpCmd(typeName);
+    std::vector<std::string> lazyCommands = {"status", "rawstatus", "details", "diag", "profile", "cursor", "running", "deadline", "heap"};
+    std::vector<std::string> lazyGetters  = {dnt::sCmdOrigin, "starttime", "preptime"};
+    lazy = (std::find(lazyCommands.begin(), lazyCommands.end(), tmpCmd) != lazyCommands.end())
+        || (targetName.empty() && (std::find(lazyGetters.begin(), lazyGetters.end(), tmpCmd) != lazyGetters.end()));
+  }
+
   try {
-   cdm.download();
+   if (lazy) cdm.downloadLazy();
+   else      cdm.download();
   } catch (std::runtime_error const& err) {
     std::cerr << program << ": Download from CPU "<< cpuIdx << " failed. Cause: " << err.what() << std::endl;
     return -7;
@@ -567,6 +606,21 @@ int main(int argc, char* argv[]) {
       }
     }
 
+    if (repetitions > 0) {
+      std::string prepType = (cmp == "relwait") ? dnt::sCmdWait : cmp;
+      if ((prepType != dnt::sCmdNoop) && (prepType != dnt::sCmdFlow) && (prepType != dnt::sCmdWait)) {std::cerr << program << ": Option -r supports noop, flow and relwait only" << std::endl; return -1; }
+      if ((prepType != dnt::sCmdNoop) && ((para == NULL) || (para == std::string("")))) {std::cerr << program << ": " << cmp << " needs a destination or wait time" << std::endl; return -1; }
+      try {
+        PreparedCommand pc = cdm.prepareCommand(prepType, targetName, (prepType == dnt::sCmdFlow ? para : ""), cmdPrio, cmdQty, permanent,
+                                                (prepType == dnt::sCmdWait ? strtoll(para, NULL, 0) : 0));
+        for (uint32_t i = 0; i < repetitions; i++) cdm.sendPreparedCommand(pc, true, cmdTvalid);
+      } catch (std::runtime_error const& err) {
+        std::cerr << program << ": Could not send prepared " << cmp << " command. Cause: " << err.what() << std::endl;
+        return -1;
+      }
+      return 0;
+    }
+
     if      (cmp == dnt::sCmdNoop)  {
       cdm.createQCommand(ew, cmp, targetName, cmdPrio, cmdQty, true, 0, thrIdx);
     }
@@ -582,6 +636,10 @@ int main(int argc, char* argv[]) {
       showHealth(netaddress, cdm, verbose);
       return 0;
     }
+    else if (cmp == "profile") {
+      showFwProfile(cdm);
+      return 0;
+    }
     else if (cmp == "flowpattern")  {
       if (( targetName.empty()) || (para == NULL) || ( para == std::string(""))) {std::cerr << program << ": Need valid target and destination pattern names " << std::endl; return -1; }
 
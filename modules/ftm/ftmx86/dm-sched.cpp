@@ -24,14 +24,20 @@ static void help(const char *program) {
   fprintf(stderr, "  overwrite  <.dot file>    Overwrites all Schedules on DM with the one in the input file, already existing nodes on the DM will be erased. \n");
   fprintf(stderr, "  remove     <.dot file>    Removes the schedule in the input file from the DM, nodes with hashes (names) not present on the DM will be ignored \n");
   fprintf(stderr, "  keep       <.dot file>    Removes everything BUT the schedule in the input file from the DM, nodes with hashes (names) not present on the DM will be ignored.\n");
+  fprintf(stderr, "  sync       <.dot file>    Changes the DM to match the schedule in the input file. Only removed, added and modified nodes are uploaded.\n");
   fprintf(stderr, "  rawvisited                Show 'visited' (1) / 'not visited' (0) for all nodes.\n");
   fprintf(stderr, "  chkrem     <.dot file>    Checks if all patterns in given dot can be removed safely\n");
+  fprintf(stderr, "  timing    [<.dot file>]   Static timing analysis of input file (or of the schedule on the DM if none given), predicted message rate and worst case backlog per CPU\n");
+  fprintf(stderr, "  place      <.dot file>    Dry run, shows which CPU add would assign to nodes without cpu attribute and the predicted load per CPU\n");
+  fprintf(stderr, "  -c         <ns>           Processing time per node in ns assumed by timing analysis, default is %llu\n", TIMING_NODE_COST_DEFAULT);
+  fprintf(stderr, "  -t                        Timing analysis on add/overwrite, warn if the schedule is predicted to overload the DM\n");
+  fprintf(stderr, "  -T                        Timing analysis on add/overwrite, refuse upload if the schedule is predicted to overload the DM (unless forced)\n");
   fprintf(stderr, "  -n                        No verify, status will not be read after operation\n");
   fprintf(stderr, "  -o         <.dot file>    Specify output file name, default is '%s'\n", outfile);
   fprintf(stderr, "  -s                        Show Meta Nodes. Download will not only contain schedules, but also queues, etc. \n");
   fprintf(stderr, "  -v                        Verbose operation, print more details\n");
   fprintf(stderr, "  -d                        Debug operation, print everything\n");
-  fprintf(stderr, "  -f                        Force, overrides the safety check for clear, remove, overwrite and keep\n");
+  fprintf(stderr, "  -f                        Force, overrides the safety check for clear, remove, overwrite, keep and sync\n");
 
   fprintf(stderr, "\n");
 }
@@ -42,8 +48,11 @@ int main(int argc, char* argv[]) {
 
   bool update = true, verbose = false, strip=true, cmdValid = false, force = false, debug=false, writefile=false;
   bool reqStatus = false;
+  TimingCheck timingCheck = TimingCheck::OFF;
+  uint64_t nodeCost = TIMING_NODE_COST_DEFAULT;
 
   int opt;
+  char *tail;
   const char *program = argv[0];
   const char *netaddress, *inputFilename = NULL, *cmdName = "status", *outputFilename = outfile;
 //  const char *dirname = (const char *)getcwd(dirnameBuff, 80);
@@ -51,7 +60,7 @@ int main(int argc, char* argv[]) {
 
 
 // start getopt
-   while ((opt = getopt(argc, argv, "fnshvo:d")) != -1) {
+   while ((opt = getopt(argc, argv, "fnshvo:dtTc:")) != -1) {
       switch (opt) {
 
          case 'o':
@@ -65,6 +74,19 @@ int main(int argc, char* argv[]) {
          case 'd':
             debug = true;
             break;
+         case 't':
+            timingCheck = TimingCheck::WARN;
+            break;
+         case 'T':
+            timingCheck = TimingCheck::ERROR;
+            break;
+         case 'c':
+            nodeCost = strtoull(optarg, &tail, 0);
+            if (*tail != 0) {
+              std::cerr << std::endl << program << ": option -c expects a processing time in ns" << std::endl;
+              error = -1;
+            }
+            break;
 
          case 'n':
             update = false;
@@ -119,6 +141,8 @@ int main(int argc, char* argv[]) {
 
   if(verbose) cdm.verboseOn();
   if(debug)   cdm.debugOn();
+  cdm.setTimingCheck(timingCheck);
+  cdm.setTimingNodeCost(nodeCost);
 
 
   try {
@@ -134,7 +158,7 @@ int main(int argc, char* argv[]) {
 
     std::string cmd(cmdName);
 
-    if ((cmd == "add" || cmd == "overwrite" || cmd == "remove" || cmd == "keep") && inputFilename == NULL) { std::cerr << std::endl << program << "Command <" << cmd << "> requires a .dot file" << std::endl; return -8; }
+    if ((cmd == "add" || cmd == "overwrite" || cmd == "remove" || cmd == "keep" || cmd == "sync" || cmd == "place") && inputFilename == NULL) { std::cerr << std::endl << program << "Command <" << cmd << "> requires a .dot file" << std::endl; return -8; }
 
     try {
       if (cmd == "clear")     { cdm.clear(force); cmdValid = true;}
@@ -142,8 +166,11 @@ int main(int argc, char* argv[]) {
       if (cmd == "overwrite") { cdm.overwriteDotFile(inputFilename, force); cmdValid = true;}
       if (cmd == "remove")    { cdm.download(); cdm.removeDotFile(inputFilename, force); cmdValid = true;}
       if (cmd == "keep")      { cdm.download(); cdm.keepDotFile(inputFilename, force); cmdValid = true;}
+      if (cmd == "sync")      { cdm.download(); cdm.syncDotFile(inputFilename, force); cmdValid = true;}
       if (cmd == "status")    { cmdValid = true; reqStatus = true;}
       if ((cmd == "status" && writefile) || cmd == "dump") { cdm.downloadDotFile(outputFilename, strip); cmdValid = true; reqStatus = false; update=false;}
+      if (cmd == "timing")    { std::cout << (inputFilename == NULL ? cdm.timingReportDown() : cdm.timingReportDotFile(inputFilename)) << std::endl; cmdValid = true; reqStatus = false; update=false;}
+      if (cmd == "place")     { std::cout << cdm.placementReportDotFile(inputFilename) << std::endl; cmdValid = true; reqStatus = false; update=false;}
       if (cmd == "rawvisited"){ cdm.download(); cdm.showPaint(); cmdValid = true; reqStatus = false; update=false;}
       if (cmd == "chkrem")    {
         /*
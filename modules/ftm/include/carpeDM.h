@@ -73,8 +73,14 @@ public:
                void writeUpDotFile(const std::string& fn, bool filterMeta);
 
 // Schedule Manipulation ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-                int assignNodesToCpus();                            // NOT YET IMPLEMENTED // TODO assign a cpu to each node object. Currently taken from input .dot
+        std::string placementReportDot(const std::string& s);       // dry run of cpu assignment for all nodes without cpu tag, returns predicted load per cpu
+        std::string placementReportDotFile(const std::string& fn);
+               bool timingAnalysis(Graph& g, std::vector<TimingReport>& vTr, std::string& report); // static timing analysis, predicted message rate and worst case backlog per cpu
+        std::string timingReportDot(const std::string& s);
+        std::string timingReportDotFile(const std::string& fn);
+        std::string timingReportDown();
                 int download();                                     // Download binary from LM32 SoC and create Graph
+                int downloadLazy();                                 // Download bitmaps and mgmt data only, defer graph creation
         std::string downloadDot(bool filterMeta);
                void downloadDotFile(const std::string& fn, bool filterMeta);
                 int addDot(const std::string& s, bool force);                   // add all nodes and/or edges in dot file
@@ -85,6 +91,8 @@ public:
                 int keepDotFile(const std::string& fn, bool force);
                 int removeDot(const std::string& s, bool force);    // removes all nodes in input file
                 int removeDotFile(const std::string& fn, bool force);
+                int syncDot(const std::string& s, bool force);      // changes the DM to match the input file, uploads only the differences
+                int syncDotFile(const std::string& fn, bool force);
                 int clear(bool force);                              // clears all nodes from DM
 
 // Command Generation and Dispatch ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -92,6 +100,8 @@ public:
               vStrC getLockedBlocks(bool checkReadLock, bool checkWriteLock);
                 int sendCommandsDot(const std::string& s); //Sends a dotfile of commands to the DM
                 int sendCommandsDotFile(const std::string& fn);
+    PreparedCommand prepareCommand(const std::string& type, const std::string& target, const std::string& destination, uint8_t cmdPrio, uint8_t cmdQty, bool perma, uint64_t cmdTwait); // Resolves a noop, flow or wait command once for repeated dispatch
+                int sendPreparedCommand(PreparedCommand& pc, bool vabs, uint64_t cmdTvalid);
                void halt();
                 int staticFlushPattern(const std::string& sPattern, bool prioIl, bool prioHi, bool prioLo, bool force);
                 int staticFlushBlock(const std::string& sBlock, bool prioIl, bool prioHi, bool prioLo, bool force);
@@ -147,6 +157,7 @@ std::pair<int, int> findRunningPattern(const std::string& sPattern); // get cpu
             vEbwrs& createFlushCommand(vEbwrs& ew, const std::string& type, const std::string& target, const std::string& destination, uint8_t  cmdPrio, uint8_t cmdQty, bool vabs, uint64_t cmdTvalid, bool qIl, bool qHi, bool qLo);
             vEbwrs& createFullCommand(vEbwrs& ew, const std::string& type, const std::string& target, const std::string& destination, uint8_t  cmdPrio, uint8_t cmdQty, bool vabs, uint64_t cmdTvalid, bool perma, bool qIl, bool qHi, bool qLo, uint64_t cmdTwait, bool abswait, bool lockRd, bool lockWr, uint8_t cmdThr);
             vEbwrs& createCommand(vEbwrs& ew, const std::string& type, const std::string& target, const std::string& destination, uint8_t  cmdPrio, uint8_t cmdQty, bool vabs, uint64_t cmdTvalid, bool perma, bool qIl, bool qHi, bool qLo,  uint64_t cmdTwait, bool abswait, bool lockRd, bool lockWr, uint8_t cmdThr );
+            vEbwrs& createPreparedCommand(vEbwrs& ew, PreparedCommand& pc, bool vabs, uint64_t cmdTvalid);
                 int send(vEbwrs& ew);
             //FIXME workaround for flawed template approach (disambiguation of member functin pointers failing). no time to figure it out right  now, get the job done first
             //convenience wrappers without eb cycle control, send immediately
@@ -184,8 +195,13 @@ std::pair<int, int> findRunningPattern(const std::string& sPattern); // get cpu
                void optimisedS2ROn();                    // Optimised Safe2remove on
                void optimisedS2ROff();                   // Optimised Safe2remove off
                bool isOptimisedS2R() const;                                     // tell if Safe2remove optimisation is on or off
+               void setTimingCheck(TimingCheck level);                          // Static timing analysis before upload: off, warn or error
+        TimingCheck getTimingCheck() const;
+               void setTimingNodeCost(uint64_t ns);                             // Assumed firmware processing time per node for timing analysis
+           uint64_t getTimingNodeCost() const;
                bool isValidDMCpu(uint8_t cpuIdx);                               // Check if CPU is registered as running a valid firmware
       HealthReport& getHealth(uint8_t cpuIdx, HealthReport &hr);                // FIXME why reference in, reference out ? its not like you can add to this report ...
+   FwProfileReport& getFwProfile(uint8_t cpuIdx, FwProfileReport &pr);          // Firmware handler profiling counters, needs firmware built with PROFILING
        QueueReport& getQReport(const std::string& blockName, QueueReport& qr);  // FIXME why reference in, reference out ? its not like you can add to this report ...
        std::string& getRawQReport(const std::string& blockName, std::string& report) ;
            uint64_t getDmWrTime();
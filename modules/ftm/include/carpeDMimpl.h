@@ -43,12 +43,16 @@ private:
 
   uint64_t modTime;
   bool freshDownload = false;
+  bool lazyDownload  = false; // atDown holds bitmaps and mgmt data only, gDown is empty
+  uint32_t schedVersion = 0;   // incremented on every upload and download, outdates prepared commands
 
   bool verbose  = false;
   bool debug    = false;
   bool sim      = false;
   bool testmode = false;
   bool optimisedS2R = true;
+  TimingCheck timingCheck = TimingCheck::OFF;
+  uint64_t timingNodeCost = TIMING_NODE_COST_DEFAULT;
   std::ostream& sLog;
   std::ostream& sErr;
 
@@ -77,6 +81,7 @@ private:
   int remove(Graph& g, bool force);
   int keep(Graph& g, bool force);
   int overwrite(Graph& g,  bool force);
+  int sync(Graph& g, bool force);
   int clear_raw(bool force);
   bool validate(Graph& g, AllocTable& at, bool force);
 
@@ -93,11 +98,14 @@ private:
 
   void parseDownloadData(const vBuf& downloadData);
   void parseDownloadMgmt(const vBuf& downloadData);
+  void recoverMgmtTables();
+  void completeLazyDownload() { if (lazyDownload) download(); }
   void checkTablesForSubgraph(Graph& g);
 
   //void resetThrMsgCnt(uint8_t cpuIdx, uint8_t thrIdx);
   void baseUploadOnDownload();
   void prepareUpload(); //Process Graph for uploading to LM32 SoC
+  node_ptr createNodeObject(Graph& g, vertex_t v, uint32_t hash, uint8_t cpu);
   void mergeUploadDuplicates(vertex_t borg, vertex_t victim);
 
   void addToDict(Graph& g);
@@ -227,8 +235,15 @@ public:
                void writeUpDotFile(const std::string& fn, bool filterMeta);
 
 // Schedule Manipulation ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-                int assignNodesToCpus();                            // NOT YET IMPLEMENTED // TODO assign a cpu to each node object. Currently taken from input .dot
+                int assignNodesToCpus(Graph& g, Graph& gResident, AllocTable& at, std::string& report); // assign a cpu to each node in g without cpu tag
+        std::string placementReportDot(const std::string& s);       // dry run of cpu assignment, returns predicted load per cpu
+        std::string placementReportDotFile(const std::string& fn);
+               bool timingAnalysis(Graph& g, std::vector<TimingReport>& vTr, std::string& report); // static timing analysis, predicted message rate and worst case backlog per cpu
+        std::string timingReportDot(const std::string& s);
+        std::string timingReportDotFile(const std::string& fn);
+        std::string timingReportDown();
                 int download();                                     // Download binary from LM32 SoC and create Graph
+                int downloadLazy();                                 // Download bitmaps and mgmt data only, defer graph creation
         std::string downloadDot(bool filterMeta);
                void downloadDotFile(const std::string& fn, bool filterMeta);
                 int addDot(const std::string& s, bool force);                   // add all nodes and/or edges in dot file
@@ -239,6 +254,8 @@ public:
                 int keepDotFile(const std::string& fn, bool force);
                 int removeDot(const std::string& s, bool force);    // removes all nodes in input file
                 int removeDotFile(const std::string& fn, bool force);
+                int syncDot(const std::string& s, bool force);      // changes the DM to match the input file, uploads only the differences
+                int syncDotFile(const std::string& fn, bool force);
                 int clear(bool force);                              // clears all nodes from DM
 
 // Command Generation and Dispatch ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -247,6 +264,8 @@ public:
                 int sendCommandsDot(const std::string& s); //Sends a dotfile of commands to the DM
                 int sendCommandsDotFile(const std::string& fn);
                 int sendCommand(const std::string& targetName, uint8_t cmdPrio, mc_ptr mc); //Send a command to Block <targetName> on CPU <cpuIdx> via Etherbone
+    PreparedCommand prepareCommand(const std::string& type, const std::string& target, const std::string& destination, uint8_t cmdPrio, uint8_t cmdQty, bool perma, uint64_t cmdTwait); // Resolves a noop, flow or wait command once for repeated dispatch
+                int sendPreparedCommand(PreparedCommand& pc, bool vabs, uint64_t cmdTvalid);
                void halt();
                 int staticFlushPattern(const std::string& sPattern, bool prioIl, bool prioHi, bool prioLo, bool force);
                 int staticFlushBlock(const std::string& sBlock, bool prioIl, bool prioHi, bool prioLo, bool force);
@@ -255,6 +274,7 @@ public:
   // Short Live Infos from DM hardware reads /////////////////////////////////////////////////////////////////////////////////////////////////////////////
   const std::string getThrOrigin(uint8_t cpuIdx, uint8_t thrIdx);      // Returns the Node the Thread will start from
   const std::string getThrCursor(uint8_t cpuIdx, uint8_t thrIdx);      // Returns the Node the Thread is currently processing
+  const std::string getNodeNameAtAdr(uint8_t cpuIdx, uint32_t adr);    // Returns the name of the Node at the given internal address
            uint64_t getThrMsgCnt(uint8_t cpuIdx, uint8_t thrIdx);
            uint32_t getThrRun(uint8_t cpuIdx);                                  // Get bitfield showing running threads
            uint32_t getStatus(uint8_t cpuIdx);
@@ -306,6 +326,7 @@ std::pair<int, int> findRunningPattern(const std::string& sPattern); // get cpu
             vEbwrs& createFullCommand(vEbwrs& ew, const std::string& type, const std::string& target, const std::string& destination, uint8_t  cmdPrio, uint8_t cmdQty, bool vabs, uint64_t cmdTvalid, bool perma, bool qIl, bool qHi, bool qLo, uint64_t cmdTwait, bool abswait, bool lockRd, bool lockWr, uint8_t cmdThr);
             vEbwrs& createCommandBurst(vEbwrs& ew, Graph& g);
             vEbwrs& createMiniCommand(vEbwrs& ew, const std::string& targetName, uint8_t cmdPrio, mc_ptr mc);
+            vEbwrs& createPreparedCommand(vEbwrs& ew, PreparedCommand& pc, bool vabs, uint64_t cmdTvalid);
             vEbwrs& createCommand(vEbwrs& ew, const std::string& type, const std::string& target, const std::string& destination, uint8_t  cmdPrio, uint8_t cmdQty, bool vabs, uint64_t cmdTvalid, bool perma, bool qIl, bool qHi, bool qLo,  uint64_t cmdTwait, bool abswait, bool lockRd, bool lockWr, uint8_t cmdThr);
                 int send(vEbwrs& ew);
 /*
@@ -365,8 +386,13 @@ std::pair<int, int> findRunningPattern(const std::string& sPattern); // get cpu
                void optimisedS2ROn() {optimisedS2R = true;}                     // Optimised Safe2remove on
                void optimisedS2ROff(){optimisedS2R = false;}                    // Optimised Safe2remove off
                bool isOptimisedS2R() const {return optimisedS2R;}               // tell if Safe2remove optimisation is on or off
+               void setTimingCheck(TimingCheck level) {timingCheck = level;}     // Static timing analysis before upload: off, warn or error
+        TimingCheck getTimingCheck() const {return timingCheck;}
+               void setTimingNodeCost(uint64_t ns) {timingNodeCost = ns;}       // Assumed firmware processing time per node for timing analysis
+           uint64_t getTimingNodeCost() const {return timingNodeCost;}
                bool isValidDMCpu(uint8_t cpuIdx);                               // Check if CPU is registered as running a valid firmware
       HealthReport& getHealth(uint8_t cpuIdx, HealthReport &hr);                // FIXME why reference in, reference out ? its not like you can add to this report ...
+   FwProfileReport& getFwProfile(uint8_t cpuIdx, FwProfileReport &pr);          // Firmware handler profiling counters, needs firmware built with PROFILING
        QueueReport& getQReport(const std::string& blockName, QueueReport& qr);  // FIXME why reference in, reference out ? its not like you can add to this report ...
        std::string& getRawQReport(const std::string& blockName, std::string& report) ;
            uint64_t getDmWrTime() {return ebd.getDmWrTime();}
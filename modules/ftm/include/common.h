@@ -16,6 +16,8 @@
 //@{
 enum class AdrType {EXT, INT, MGMT, PEER, UNKNOWN}; ///< WB Address types for perspectives of different WB bus masters
 enum class TransferDir {UPLOAD, DOWNLOAD}; ///< DM communication transfer direction. Upload (DM to host) or download (host to DM)
+#define TIMING_NODE_COST_DEFAULT 3000ULL ///< Assumed LM32 processing time per node in ns for static timing analysis
+enum class TimingCheck {OFF, WARN, ERROR}; ///< Static timing analysis on upload. Off, warn about predicted overload or refuse upload (unless forced)
 
 
 enum class FwId { FWID_RAM_TOO_SMALL      = -1,
@@ -168,6 +170,45 @@ typedef struct {
   uint32_t  stat;
 } HealthReport;
 
+/// Predicted load of a DM CPU from static timing analysis of a schedule
+/** Contains the sum over all cycles a CPU's threads walk. Peak rate, burst and backlog assume all threads to be aligned,
+ *  i.e. the worst case. Backlog is the number of nodes which cannot be processed before their deadline at the given cost per node.
+ */
+typedef struct {
+  int       cpu;
+  uint32_t  cycles;
+  uint64_t  prepTime;
+  uint64_t  nodeCost;
+  double    avgMsgRate;
+  double    avgNodeRate;
+  double    peakMsgRate;
+  uint64_t  minSpacing;
+  double    utilisation;
+  uint32_t  burstNodes;
+  uint32_t  backlog;
+  bool      overload;
+} TimingReport;
+
+/// Firmware profiling counters of one node or action handler
+typedef struct {
+  std::string name;
+  uint32_t  cnt;
+  uint32_t  maxCycles;
+  uint64_t  sumCycles;
+} FwProfileSlot;
+
+/// Report on DM firmware handler profiling
+/** Invocation counts, cumulative and max cycles per profiled node/action handler and priority queue (ECA) write stalls.
+ *  Only filled if the firmware was built with PROFILING, see enabled.
+ */
+typedef struct {
+  uint8_t   cpu;
+  bool      enabled;
+  FwProfileSlot slot[_PROF_SLOT_QTY_];
+  uint32_t  stallCnt;
+  uint32_t  stallMax;
+} FwProfileReport;
+
 /// Report on DM's WB bus stall behaviour
 /** Report contains DM's diagnostic values for the maximum wait time (stall) CPUs have experienced when trying to access the WB system bus.
  *
@@ -340,6 +381,21 @@ inline vEbrds& operator+=(vEbrds& A, const vEbrds &B)
  *
  */
 vBl leadingOne(size_t length);
+
+/// Precompiled queue command for repeated dispatch
+/** Holds a queue command with target, addresses and content resolved once by prepareCommand. The write operations are staged ready to send,
+ *  on each dispatch only the command slot addresses, valid time, write index and mod time are patched in.
+ *  A prepared command is bound to the schedule it was prepared for. After an upload or download it is outdated and must be prepared again.
+ */
+typedef struct {
+  std::string target;
+  uint32_t hash     = 0;
+  uint8_t  cpu      = 0;
+  uint8_t  prio     = 0;
+  vAdr     slotAdrs;        ///< external start address of each command slot of the queue, indexed by write index
+  vEbwrs   ew;              ///< staged command content, write index and mod info
+  uint32_t version  = 0;    ///< schedule version the command was prepared for
+} PreparedCommand;
 //@}
 
 
@@ -0,0 +1,9 @@
+#ifndef _DOT_WRITER_H_
+#define _DOT_WRITER_H_
+#include <string>
+#include "graph.h"
+
+// Appends graph g in .dot format to out. With filterMeta, meta nodes (queues, destination lists) and their edges are left out.
+void writeDot(std::string& out, const Graph& g, bool filterMeta);
+
+#endif
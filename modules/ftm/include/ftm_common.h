@@ -136,6 +136,21 @@
 /** @name Diagnostic Logging layout definitions
  */
 //@{ 
+#define PROF_TMSG               0   ///< Profiling slot index, timing message handler
+#define PROF_BLOCK              1   ///< Profiling slot index, fixed block handler
+#define PROF_BLOCK_ALIGN        2   ///< Profiling slot index, aligned block handler
+#define PROF_CMD                3   ///< Profiling slot index, command handler (noop, flow, flush, wait)
+#define PROF_SWITCH             4   ///< Profiling slot index, switch handler
+#define PROF_ACT_FLUSH          5   ///< Profiling slot index, flush action, executed inside block handlers
+#define PROF_ACT_WAIT           6   ///< Profiling slot index, wait action, executed inside block handlers
+#define _PROF_SLOT_QTY_         7   ///< Number of profiling slots
+#define PROF_STALL_THRS         64  ///< Priority queue writes taking longer than this many cycles are counted as stalls
+
+#define T_PROF_SLOT_CNT     (0)                              			///< Invocation count
+#define T_PROF_SLOT_MAX     (T_PROF_SLOT_CNT      + _32b_SIZE_ ) 		///< Maximum cycles of a single invocation
+#define T_PROF_SLOT_SUM     (T_PROF_SLOT_MAX      + _32b_SIZE_ ) 		///< Cumulative cycles of all invocations
+#define _T_PROF_SLOT_SIZE_  (T_PROF_SLOT_SUM      + _64b_SIZE_ )    ///< Size of a profiling slot
+
 #define T_MOD_INFO_TS      (0)                             ///< Timestamp of last modification
 #define T_MOD_INFO_IID     (T_MOD_INFO_TS   + _TS_SIZE_  ) ///< Issuer ID of last modification
 #define T_MOD_INFO_MID     (T_MOD_INFO_IID  + _64b_SIZE_ ) ///< Machine ID of last modification
@@ -156,9 +171,12 @@
 #define T_DIAG_WAR_1ST_TS   (T_DIAG_WAR_1ST_HASH  + _32b_SIZE_ ) 		///< TS at first diff warning
 #define T_DIAG_BCKLOG_STRK  (T_DIAG_WAR_1ST_TS    + _TS_SIZE_  ) 		///< Maximum Backlog streak size
 #define T_DIAG_BAD_WAIT_CNT (T_DIAG_BCKLOG_STRK   + _32b_SIZE_ ) 		///< Maximum Backlog streak size
+#define T_DIAG_PROF         (T_DIAG_BAD_WAIT_CNT  + _32b_SIZE_ ) 		///< Profiling slots, one per profiled node/action handler. Only written by firmware built with PROFILING
+#define T_DIAG_PROF_STL_CNT (T_DIAG_PROF          + _PROF_SLOT_QTY_ * _T_PROF_SLOT_SIZE_ ) ///< Profiling, count of priority queue (ECA) writes stalling longer than PROF_STALL_THRS cycles
+#define T_DIAG_PROF_STL_MAX (T_DIAG_PROF_STL_CNT  + _32b_SIZE_ ) 		///< Profiling, longest priority queue (ECA) write stall in cycles
 #define _T_DIAG_SIZE_       (256)
 
-#if _T_DIAG_SIZE_ < (T_DIAG_BAD_WAIT_CNT + _32b_SIZE_)
+#if _T_DIAG_SIZE_ < (T_DIAG_PROF_STL_MAX + _32b_SIZE_)
   #error Actual diagnostics area size exceeds fixed _T_DIAG_SIZE_
 #endif
 
@@ -239,6 +257,13 @@
 #define SHCTL_STATUS_DM_INIT_SMSK       (SHCTL_STATUS_DM_INIT_MSK << SHCTL_STATUS_DM_INIT_POS)
 //@}
 
+/** @name Global status register - Firmware was built with profiling counters */
+//@{
+#define SHCTL_STATUS_PROFILE_MSK        0x1
+#define SHCTL_STATUS_PROFILE_POS        4
+#define SHCTL_STATUS_PROFILE_SMSK       (SHCTL_STATUS_PROFILE_MSK << SHCTL_STATUS_PROFILE_POS)
+//@}
+
 /** @name Global status register - Error status bit */
 //@{
 #define SHCTL_STATUS_DM_ERROR_MSK       0x1
@@ -445,6 +470,15 @@
 #define BLOCK_CMDQ_WR_IDXS_SMSK BLOCK_CMDQ_WR_IDXS_MSK
 //@}
 
+/** @name Block bit field defs - Pending summary bit in unused top byte of write indices.
+ *  Set by every writer together with (host) or right after (LM32) a write index increment, cleared by the owning LM32 when all queues are drained.
+ *  Lets block() skip the queue index comparison when nothing is pending. Not covered by BLOCK_CMDQ_WR_IDXS_SMSK. */
+//@{
+#define BLOCK_CMDQ_PENDING_MSK  0x1
+#define BLOCK_CMDQ_PENDING_POS  24
+#define BLOCK_CMDQ_PENDING_SMSK (BLOCK_CMDQ_PENDING_MSK << BLOCK_CMDQ_PENDING_POS)
+//@}
+
 /** @name Block bit field defs - Read indices */
 //@{
 #define BLOCK_CMDQ_RD_IDXS_MSK  BLOCK_CMDQ_WR_IDXS_SMSK
@@ -765,6 +799,7 @@
 #define OP_TYPE_SCH_OVERWRITE       0x13	///< Schedule - overwrite all nodes with graph
 #define OP_TYPE_SCH_REMOVE          0x14	///< Schedule - remove graph
 #define OP_TYPE_SCH_KEEP            0x15	///< Schedule - keep graph
+#define OP_TYPE_SCH_SYNC            0x16	///< Schedule - sync to graph, upload differences only
 
 #define OP_TYPE_CMD_BASE            0x20	///< Command - base offset for all command op types
 #define OP_TYPE_CMD_FLOW            (OP_TYPE_CMD_BASE + ACT_TYPE_FLOW)	///< Command - flow
@@ -168,6 +168,10 @@ Graph& mycopy_graph(const T& original, Graph& cpy, vertex_map_t& vmap) {
   return cpy;
 }
 
+// Copies the graph, but the vertices of the copy share the node objects of the original. Call writableNode before modifying one
+Graph& sharedcopy_graph(const Graph& original, Graph& cpy, vertex_map_t& vmap);
+// Clones the vertex' node object if it is still shared with another graph, returns the vertex' own node object
+node_ptr& writableNode(myVertex& vertex);
 
 /*
 
@@ -2,7 +2,7 @@
 #define _VISITOR_VERTEX_WRITER_H_
 #include <stdint.h>
 #include <stdlib.h>
-#include <iostream>
+#include <string>
 #include "common.h"
 
 class Node;
@@ -30,12 +30,20 @@ class DestList;
 
 enum class FormatNum {DEC, HEX, HEX16, HEX32, HEX64, BIT, BOOL};
 
+// Text the vertex writer appends to. The former stream based writer printed the cpu in the number base
+// left over from the previous vertex, hexBase tracks that base to keep the output unchanged.
+struct VertexText {
+  std::string s;
+  bool hexBase = false;
+};
+
 
 
  class VisitorVertexWriter {
-    std::ostream& out;
-    void pushStart() const { out << "["; };
-    void pushEnd()   const { out << "]"; };
+    VertexText& out;
+    void pushStart() const { out.s += '['; };
+    void pushEnd()   const { out.s += ']'; };
+    void pushNumber(uint64_t v, bool hex, unsigned width = 0) const;
     void pushPair(const std::string& p, uint64_t v, FormatNum format) const;
     void pushPair(const std::string& p, const std::string& v) const;
     void pushSingle(const std::string& p) const;
@@ -47,7 +55,7 @@ enum class FormatNum {DEC, HEX, HEX16, HEX32, HEX64, BIT, BOOL};
     void pushStopEyecandy(const Node& el) const;
     void pushMembershipInfo(const Node& el) const;
   public:
-    VisitorVertexWriter(std::ostream& out) : out(out) {};
+    VisitorVertexWriter(VertexText& out) : out(out) {};
     ~VisitorVertexWriter() {};
     virtual void visit(const BlockFixed& el) const;
     virtual void visit(const BlockAlign& el) const;
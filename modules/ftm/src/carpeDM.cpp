@@ -57,8 +57,14 @@
   void CarpeDM::writeUpDotFile(const std::string& fn, bool filterMeta)                 { return impl_->writeUpDotFile(fn, filterMeta);}
 
 // Schedule Manipulation ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-  int CarpeDM::assignNodesToCpus()                                                     { return impl_->assignNodesToCpus();}                            // NOT YET IMPLEMENTED // TODO assign a cpu to each node object. Currently taken from input .dot
+  std::string CarpeDM::placementReportDot(const std::string& s)                        { return impl_->placementReportDot(s);}                          // dry run of cpu assignment for all nodes without cpu tag
+  std::string CarpeDM::placementReportDotFile(const std::string& fn)                   { return impl_->placementReportDotFile(fn);}
+  bool CarpeDM::timingAnalysis(Graph& g, std::vector<TimingReport>& vTr, std::string& report) { return impl_->timingAnalysis(g, vTr, report);}     // static timing analysis, predicted message rate and worst case backlog per cpu
+  std::string CarpeDM::timingReportDot(const std::string& s)                           { return impl_->timingReportDot(s);}
+  std::string CarpeDM::timingReportDotFile(const std::string& fn)                      { return impl_->timingReportDotFile(fn);}
+  std::string CarpeDM::timingReportDown()                                              { return impl_->timingReportDown();}
   int CarpeDM::download()                                                              { return impl_->download();}                                     // Download binary from LM32 SoC and create Graph
+  int CarpeDM::downloadLazy()                                                          { return impl_->downloadLazy();}                                 // Download bitmaps and mgmt data only, defer graph creation
   std::string CarpeDM::downloadDot(bool filterMeta)                                    { return impl_->downloadDot(filterMeta);}
   void CarpeDM::downloadDotFile(const std::string& fn, bool filterMeta)                { return impl_->downloadDotFile(fn, filterMeta);}
   int CarpeDM::addDot(const std::string& s, bool force)                                { return impl_->addDot(s, force);}                   // add all nodes and/or edges in dot file
@@ -69,6 +75,8 @@
   int CarpeDM::keepDotFile(const std::string& fn, bool force)                          { return impl_->keepDotFile(fn, force);}
   int CarpeDM::removeDot(const std::string& s, bool force)                             { return impl_->removeDot(s, force);}    // removes all nodes in input file
   int CarpeDM::removeDotFile(const std::string& fn, bool force)                        { return impl_->removeDotFile(fn, force);}
+  int CarpeDM::syncDot(const std::string& s, bool force)                               { return impl_->syncDot(s, force);}      // changes the DM to match the input file, uploads only the differences
+  int CarpeDM::syncDotFile(const std::string& fn, bool force)                          { return impl_->syncDotFile(fn, force);}
   int CarpeDM::clear(bool force)                                                       { return impl_->clear(force);}                              // clears all nodes from DM
 
 // Command Generation and Dispatch ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -76,6 +84,9 @@
 vStrC CarpeDM::getLockedBlocks(bool checkReadLock, bool checkWriteLock)                                         { return impl_->getLockedBlocks(checkReadLock, checkWriteLock);}
 int CarpeDM::sendCommandsDot(const std::string& s)                                                              { return impl_->sendCommandsDot(s);} //Sends a dotfile of commands to the DM
 int CarpeDM::sendCommandsDotFile(const std::string& fn)                                                         { return impl_->sendCommandsDotFile(fn);}
+PreparedCommand CarpeDM::prepareCommand(const std::string& type, const std::string& target, const std::string& destination, uint8_t cmdPrio, uint8_t cmdQty, bool perma, uint64_t cmdTwait)
+{ return impl_->prepareCommand(type, target, destination, cmdPrio, cmdQty, perma, cmdTwait);}
+int CarpeDM::sendPreparedCommand(PreparedCommand& pc, bool vabs, uint64_t cmdTvalid)                          { return impl_->sendPreparedCommand(pc, vabs, cmdTvalid);}
 
 void CarpeDM::halt()                                                                                            { return impl_->halt();}
 int CarpeDM::staticFlushPattern(const std::string& sPattern, bool prioIl, bool prioHi, bool prioLo, bool force) { return impl_->staticFlushPattern(sPattern, prioIl, prioHi, prioLo, force);}
@@ -148,6 +159,9 @@ vEbwrs& CarpeDM::createFullCommand(vEbwrs& ew, const std::string& type, const st
 
 vEbwrs& CarpeDM::createCommand(vEbwrs& ew, const std::string& type, const std::string& target, const std::string& destination, uint8_t  cmdPrio, uint8_t cmdQty, bool vabs, uint64_t cmdTvalid, bool perma, bool qIl, bool qHi, bool qLo,  uint64_t cmdTwait, bool abswait, bool lockRd, bool lockWr, uint8_t cmdThr)
 { return impl_->createCommand(ew, type, target, destination, cmdPrio, cmdQty, vabs, cmdTvalid, perma,qIl, qHi, qLo, cmdTwait, abswait, lockRd, lockWr, cmdThr );}
+
+vEbwrs& CarpeDM::createPreparedCommand(vEbwrs& ew, PreparedCommand& pc, bool vabs, uint64_t cmdTvalid)
+{ return impl_->createPreparedCommand(ew, pc, vabs, cmdTvalid);}
                 
 
                 int CarpeDM::send(vEbwrs& ew) {return impl_->send(ew);}
@@ -187,8 +201,13 @@ vEbwrs& CarpeDM::createCommand(vEbwrs& ew, const std::string& type, const std::s
      void CarpeDM::optimisedS2ROn()                                                         { return impl_->optimisedS2ROn();}                    // Optimised Safe2remove on
      void CarpeDM::optimisedS2ROff()                                                        { return impl_->optimisedS2ROff();}                   // Optimised Safe2remove off
      bool CarpeDM::isOptimisedS2R() const                                                   { return impl_->isOptimisedS2R();}                                     // tell if Safe2remove optimisation is on or off
+     void CarpeDM::setTimingCheck(TimingCheck level)                                        { return impl_->setTimingCheck(level);}                                // Static timing analysis before upload: off, warn or error
+     TimingCheck CarpeDM::getTimingCheck() const                                            { return impl_->getTimingCheck();}
+     void CarpeDM::setTimingNodeCost(uint64_t ns)                                           { return impl_->setTimingNodeCost(ns);}                                // Assumed firmware processing time per node for timing analysis
+     uint64_t CarpeDM::getTimingNodeCost() const                                            { return impl_->getTimingNodeCost();}
      bool CarpeDM::isValidDMCpu(uint8_t cpuIdx)                                             { return impl_->isValidDMCpu(cpuIdx);}                               // Check if CPU is registered as running a valid firmware
      HealthReport& CarpeDM::getHealth(uint8_t cpuIdx, HealthReport &hr)                     { return impl_->getHealth(cpuIdx, hr);}                // FIXME why reference in, reference out ? its not like you can add to this report ...
+     FwProfileReport& CarpeDM::getFwProfile(uint8_t cpuIdx, FwProfileReport &pr)            { return impl_->getFwProfile(cpuIdx, pr);}             // Firmware handler profiling counters, needs firmware built with PROFILING
      QueueReport& CarpeDM::getQReport(const std::string& blockName, QueueReport& qr)        { return impl_->getQReport(blockName, qr);}  // FIXME why reference in, reference out ? its not like you can add to this report ...
      std::string& CarpeDM::getRawQReport(const std::string& blockName, std::string& report) { return impl_->getRawQReport(blockName, report);}
      uint64_t CarpeDM::getDmWrTime()                                                        { return impl_->getDmWrTime();}
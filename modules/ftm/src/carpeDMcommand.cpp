@@ -404,6 +404,101 @@ vEbwrs& CarpeDM::CarpeDMimpl::createCommandBurst(vEbwrs& ew, Graph& g) {
     return ew;
   }
 
+  // Resolves target, queue slot addresses and command content once. Dispatch via createPreparedCommand only patches slot, valid time, write index and mod time.
+  PreparedCommand CarpeDM::CarpeDMimpl::prepareCommand(const std::string& type, const std::string& target, const std::string& destination, uint8_t cmdPrio, uint8_t cmdQty, bool perma, uint64_t cmdTwait) {
+    PreparedCommand pc;
+    mc_ptr mc;
+    uint8_t b[_T_CMD_SIZE_ + _32b_SIZE_] = {0};
+
+    completeLazyDownload(); // needs the block's queue buffer lists
+
+    if (type == dnt::sCmdNoop) {
+      mc = (mc_ptr) new MiniNoop(0, cmdPrio, cmdQty );
+    } else if (type == dnt::sCmdFlow) {
+      uint32_t adr = LM32_NULL_PTR;
+      try { adr = getNodeAdr(destination, TransferDir::DOWNLOAD, AdrType::INT); } catch (std::runtime_error const& err) {
+        throw std::runtime_error("Destination '" + destination + "'' invalid: " + std::string(err.what()));
+      }
+      mc = (mc_ptr) new MiniFlow(0, cmdPrio, cmdQty, adr, perma );
+    } else if (type == dnt::sCmdWait) {
+      mc = (mc_ptr) new MiniWait(0, cmdPrio, cmdTwait, false, false );
+    }
+    else { throw std::runtime_error("Command type <" + type + "> cannot be prepared, only noop, flow and wait are supported!\n");}
+
+    pc.target = target;
+    pc.prio   = cmdPrio;
+    pc.hash   = hm.lookup(target, "prepareCommand: unknown target ");
+    auto it   = atDown.lookupHash(pc.hash, carpeDMcommand::exIntro);
+    auto* x   = (AllocMeta*)&(*it);
+    pc.cpu    = x->cpu;
+
+    uint32_t blAdr = writeBeBytesToLeNumber<uint32_t>((uint8_t*)&x->b[BLOCK_CMDQ_PTRS + cmdPrio * _PTR_SIZE_]);
+    if(blAdr == LM32_NULL_PTR) {throw std::runtime_error( "Block Node does not have requested queue"); }
+    it = atDown.lookupAdr(x->cpu, atDown.adrConv(AdrType::INT, AdrType::MGMT, x->cpu, blAdr), carpeDMcommand::exIntro);
+    auto* pmBl = (AllocMeta*)&(*it);
+    for (uint8_t wrIdx = 0; wrIdx <= Q_IDX_MAX_MSK; wrIdx++) {
+      ptrdiff_t bufIdx   = wrIdx / (_MEM_BLOCK_SIZE / _T_CMD_SIZE_  );
+      ptrdiff_t elemIdx  = wrIdx % (_MEM_BLOCK_SIZE / _T_CMD_SIZE_  );
+      pc.slotAdrs.push_back(atDown.adrConv(AdrType::INT, AdrType::EXT, pmBl->cpu, writeBeBytesToLeNumber<uint32_t>((uint8_t*)&pmBl->b[bufIdx * _PTR_SIZE_])) + elemIdx * _T_CMD_SIZE_);
+    }
+
+    // same layout as createMiniCommand: command words, write index, mod info. Slot and valid time are placeholders until dispatch
+    for(uint32_t adr = pc.slotAdrs[0]; adr < pc.slotAdrs[0] + _T_CMD_SIZE_; adr += _32b_SIZE_) pc.ew.va.push_back(adr);
+    pc.ew.va.push_back(atDown.adrConv(AdrType::MGMT, AdrType::EXT, x->cpu, x->adr) + BLOCK_CMDQ_WR_IDXS);
+    pc.ew.vcs += leadingOne(pc.ew.va.size());
+    mc->serialise(b);
+    pc.ew.vb.insert( pc.ew.vb.end(), b, b + _T_CMD_SIZE_ + _32b_SIZE_);
+
+    uint8_t opType = OP_TYPE_CMD_BASE + ((mc->getAct() >> ACT_TYPE_POS) & ACT_TYPE_MSK);
+    if ((((mc->getAct() >> ACT_TYPE_POS) & ACT_TYPE_MSK) == ACT_TYPE_FLOW)
+     && (boost::dynamic_pointer_cast<MiniFlow>(mc)->getDst() == LM32_NULL_PTR)) { opType = OP_TYPE_CMD_STOP; }
+    createCmdModInfo(pc.ew, pc.cpu, 0, opType);
+
+    pc.version = schedVersion;
+    return pc;
+  }
+
+  vEbwrs& CarpeDM::CarpeDMimpl::createPreparedCommand(vEbwrs& ew, PreparedCommand& pc, bool vabs, uint64_t cmdTvalid) {
+    const size_t cmdWords = _T_CMD_SIZE_ / _32b_SIZE_;
+
+    if (pc.version != schedVersion) throw std::runtime_error("Prepared command for block <" + pc.target + "> is outdated, the schedule has changed since. Prepare it again\n");
+
+    //check for covenants
+    if(optimisedS2R) {
+      cmI c = ct.lookup(pc.target);
+      if (ct.isOk(c) && isCovenantPending(c)) {
+        if(c->prio < pc.prio) throw std::runtime_error("Command preemption (prio " + std::to_string((int)pc.prio) + ") at block <" + pc.target + "> would violate a safe2remove-covenant!");
+      }
+    }
+
+    BlockLock& lock = lm.add(pc.target);
+    lock.wr.set = true;
+    lock.wr.clr = true;
+
+    adjustValidTime(cmdTvalid, vabs);
+
+    //get Write and Read indices and check if queue is not full
+    auto it = atDown.lookupHash(pc.hash, carpeDMcommand::exIntro);
+    auto* x = (AllocMeta*)&(*it);
+    uint8_t eWrIdx = ( writeBeBytesToLeNumber<uint32_t>((uint8_t*)&x->b[BLOCK_CMDQ_WR_IDXS]) >> (pc.prio * 8)) & Q_IDX_MAX_OVF_MSK;
+    uint8_t eRdIdx = ( writeBeBytesToLeNumber<uint32_t>((uint8_t*)&x->b[BLOCK_CMDQ_RD_IDXS]) >> (pc.prio * 8)) & Q_IDX_MAX_OVF_MSK;
+    if (((eWrIdx & Q_IDX_MAX_MSK) == (eRdIdx & Q_IDX_MAX_MSK)) && (eWrIdx != eRdIdx)) {throw std::runtime_error( pc.target + " queue of prio " + std::to_string((int)pc.prio) + " is full, can't write.\n");}
+
+    size_t adrOffs = ew.va.size();
+    size_t datOffs = ew.vb.size();
+    ew.va.insert(ew.va.end(), pc.ew.va.begin(), pc.ew.va.end());
+    ew.vb.insert(ew.vb.end(), pc.ew.vb.begin(), pc.ew.vb.end());
+    ew.vcs.insert(ew.vcs.end(), pc.ew.vcs.begin(), pc.ew.vcs.end());
+
+    uint32_t slotAdr = pc.slotAdrs[eWrIdx & Q_IDX_MAX_MSK];
+    for (size_t i = 0; i < cmdWords; i++) ew.va[adrOffs + i] = slotAdr + i * _32b_SIZE_;
+    writeLeNumberToBeBytes<uint64_t>((uint8_t*)&ew.vb[datOffs + T_CMD_TIME], cmdTvalid);
+    writeLeNumberToBeBytes<uint32_t>((uint8_t*)&ew.vb[datOffs + _T_CMD_SIZE_], getCmdInc(pc.hash, pc.prio));
+    writeLeNumberToBeBytes<uint64_t>((uint8_t*)&ew.vb[datOffs + _T_CMD_SIZE_ + _32b_SIZE_], modTime); // mod info starts with the mod time
+
+    return ew;
+  }
+
 
   //Returns the external address of a thread's command register area
   uint32_t CarpeDM::CarpeDMimpl::getThrCmdAdr(uint8_t cpuIdx) {
@@ -438,13 +533,7 @@ vEbwrs& CarpeDM::CarpeDMimpl::createCommandBurst(vEbwrs& ew, Graph& g) {
 
     adr = ebd.read32b( getThrInitialNodeAdr(cpuIdx, thrIdx));
 
-    if (adr == LM32_NULL_PTR) return DotStr::Node::Special::sIdle;
-    try {
-      auto x = atDown.lookupAdr(cpuIdx, atDown.adrConv(AdrType::INT, AdrType::MGMT,cpuIdx, adr));
-      return gDown[x->v].name;
-    } catch (...) {
-      return DotStr::Misc::sUndefined;
-    }
+    return getNodeNameAtAdr(cpuIdx, adr);
   }
 
   //DEBUG Sets the cursor
@@ -465,10 +554,35 @@ vEbwrs& CarpeDM::CarpeDMimpl::createCommandBurst(vEbwrs& ew, Graph& g) {
 
     //std::cout << "#" << (int) cpuIdx << ", " << (int)thrIdx << std::hex << " 0x" << adr << std::endl;
 
+    return getNodeNameAtAdr(cpuIdx, adr);
+  }
+
+  //Returns the name of the node at a cpu internal address. After a lazy download, the node's flags and hash are read from the DM
+  const std::string CarpeDM::CarpeDMimpl::getNodeNameAtAdr(uint8_t cpuIdx, uint32_t adr) {
     if (adr == LM32_NULL_PTR) return DotStr::Node::Special::sIdle;
     try {
-      auto x = atDown.lookupAdr(cpuIdx, atDown.adrConv(AdrType::INT, AdrType::MGMT,cpuIdx, adr));
-      return gDown[x->v].name;
+      uint32_t mgmtAdr = atDown.adrConv(AdrType::INT, AdrType::MGMT,cpuIdx, adr);
+      if (!lazyDownload) {
+        auto x = atDown.lookupAdr(cpuIdx, mgmtAdr);
+        return gDown[x->v].name;
+      }
+
+      // only used nodes can be resolved, same as with a full download
+      MemPool& mem = atDown.getMemories().at(cpuIdx);
+      if (mgmtAdr < mem.bmpOffs || (mgmtAdr - mem.bmpOffs) % _MEM_BLOCK_SIZE) return DotStr::Misc::sUndefined;
+      uint32_t bitIdx = (mgmtAdr - mem.bmpOffs) / _MEM_BLOCK_SIZE;
+      if (bitIdx < mem.bmpSize / _MEM_BLOCK_SIZE || bitIdx >= mem.bmpBits || !mem.getBmpBit(bitIdx)) return DotStr::Misc::sUndefined;
+
+      uint32_t extAdr = atDown.adrConv(AdrType::MGMT, AdrType::EXT,cpuIdx, mgmtAdr);
+      vBuf vDl = ebd.readCycle({extAdr + NODE_HASH, extAdr + NODE_FLAGS});
+      uint32_t hash  = writeBeBytesToLeNumber<uint32_t>((uint8_t*)&vDl[0]);
+      uint32_t flags = writeBeBytesToLeNumber<uint32_t>((uint8_t*)&vDl[_32b_SIZE_]);
+      if (((flags >> NFLG_TYPE_POS) & NFLG_TYPE_MSK) == NODE_TYPE_MGMT) return DotStr::Misc::sUndefined;
+      if (hm.contains(hash)) return hm.lookup(hash);
+
+      std::stringstream stream;
+      stream << "0x" << std::setfill ('0') << std::setw(sizeof(uint32_t)*2) << std::hex << hash;
+      return DotStr::Misc::sHashType + stream.str();
     } catch (...) {
       return DotStr::Misc::sUndefined;
     }
@@ -691,6 +805,8 @@ const vAdr CarpeDM::CarpeDMimpl::getCmdWrAdrs(uint32_t hash, uint8_t prio) {
     eWrIdx = ( writeBeBytesToLeNumber<uint32_t>((uint8_t*)&x->b[BLOCK_CMDQ_WR_IDXS]) >> (prio * 8)) & Q_IDX_MAX_OVF_MSK;
     //assign to index vector
     newIdxs = ( writeBeBytesToLeNumber<uint32_t>((uint8_t*)&x->b[BLOCK_CMDQ_WR_IDXS]) & ~(0xff << (prio * 8))) | (((eWrIdx +1)  & Q_IDX_MAX_OVF_MSK) << (prio * 8));
+    //flag block as having pending commands. Same word as the indices, so the LM32 sees both at once
+    newIdxs |= BLOCK_CMDQ_PENDING_SMSK;
     //write back so next call will find correct value without need for another download
     writeLeNumberToBeBytes<uint32_t>((uint8_t*)&x->b[BLOCK_CMDQ_WR_IDXS], newIdxs);
 
@@ -626,6 +626,7 @@ HealthReport& CarpeDM::CarpeDMimpl::getHealth(uint8_t cpuIdx, HealthReport &hr)
     case OP_TYPE_SCH_OVERWRITE  : hr.smodOpType = "Overwrite"; break;
     case OP_TYPE_SCH_REMOVE     : hr.smodOpType = "Remove";    break;
     case OP_TYPE_SCH_KEEP       : hr.smodOpType = "Keep";      break;
+    case OP_TYPE_SCH_SYNC       : hr.smodOpType = "Sync";      break;
     default                     : hr.smodOpType = "    ?";     break;
   }
 
@@ -680,6 +681,37 @@ HealthReport& CarpeDM::CarpeDMimpl::getHealth(uint8_t cpuIdx, HealthReport &hr)
 
 }
 
+/** Read the firmware profiling slots and the status register of a CPU in one EB read cycle.
+ * The counters are only maintained by firmware built with PROFILING, which also sets the profile bit in the status register.
+ */
+FwProfileReport& CarpeDM::CarpeDMimpl::getFwProfile(uint8_t cpuIdx, FwProfileReport &pr) {
+  static const std::string slotNames[_PROF_SLOT_QTY_] = {"tmsg", "block", "blockAlign", "cmd", "switch", "act flush", "act wait"};
+  uint32_t const baseAdr = atDown.getMemories()[cpuIdx].extBaseAdr + atDown.getMemories()[cpuIdx].sharedOffs;
+
+  vAdr profAdr;
+  vBuf profBuf;
+  uint8_t* b;
+
+  for (uint32_t offs = T_DIAG_PROF; offs < T_DIAG_PROF_STL_MAX + _32b_SIZE_; offs += _32b_SIZE_) profAdr.push_back(baseAdr + SHCTL_DIAG + offs);
+  profAdr.push_back(baseAdr + SHCTL_STATUS);
+  profBuf = ebd.readCycle(profAdr);
+  b = (uint8_t*)&profBuf[0] - T_DIAG_PROF; // so we can use T_DIAG offsets
+
+  pr.cpu      = cpuIdx;
+  pr.enabled  = (writeBeBytesToLeNumber<uint32_t>(b + T_DIAG_PROF_STL_MAX + _32b_SIZE_) & SHCTL_STATUS_PROFILE_SMSK) != 0; // status comes after last profiling element
+  for (unsigned i = 0; i < _PROF_SLOT_QTY_; i++) {
+    uint8_t* slot = b + T_DIAG_PROF + i * _T_PROF_SLOT_SIZE_;
+    pr.slot[i].name      = slotNames[i];
+    pr.slot[i].cnt       = writeBeBytesToLeNumber<uint32_t>(slot + T_PROF_SLOT_CNT);
+    pr.slot[i].maxCycles = writeBeBytesToLeNumber<uint32_t>(slot + T_PROF_SLOT_MAX);
+    pr.slot[i].sumCycles = writeBeBytesToLeNumber<uint64_t>(slot + T_PROF_SLOT_SUM);
+  }
+  pr.stallCnt = writeBeBytesToLeNumber<uint32_t>(b + T_DIAG_PROF_STL_CNT);
+  pr.stallMax = writeBeBytesToLeNumber<uint32_t>(b + T_DIAG_PROF_STL_MAX);
+
+  return pr;
+}
+
 void CarpeDM::CarpeDMimpl::show(const std::string& title, const std::string& logDictFile, TransferDir dir, bool filterMeta ) {
 
   Graph& g        = (dir == TransferDir::UPLOAD ? gUp  : gDown);
@@ -4,6 +4,8 @@
 #include <iostream>
 #include <string>
 #include <inttypes.h>
+#include <thread>
+#include <exception>
 #include <boost/graph/graphviz.hpp>
 #include <boost/graph/copy.hpp>
 #include <boost/algorithm/string.hpp>
@@ -19,6 +21,16 @@
 
 namespace dnt = DotStr::Node::TypeVal;
 
+namespace {
+  // A node decoded from the download buffer, waiting to be added to graph and alloctable
+  struct DownloadedNode {
+    uint32_t    localAdr, adr, hash, flags;
+    std::string name, pattern, beamproc, sFlags, type;
+    node_ptr    np;
+    std::string error; // message for sErr if the node type is not supported
+  };
+}
+
 
   //Generate download Bmp addresses. For downloads, this has to be two pass: get bmps first, then use them to get the node locations to read
   vEbrds CarpeDM::CarpeDMimpl::gatherDownloadBmpVector() {
@@ -97,6 +109,11 @@ namespace dnt = DotStr::Node::TypeVal;
 
     if(verbose) sLog << "Mgmt found " << std::dec << found << " data chunks. Total " << nodeCnt << " nodes scanned. Trying to recover GroupTable ..." << std::endl;
 
+    recoverMgmtTables();
+  }
+
+  // Rebuilds grouptable, hashmap and covenanttable from the mgmt nodes registered in atDown
+  void CarpeDM::CarpeDMimpl::recoverMgmtTables() {
     // recover container
     vBuf aux = atDown.recoverMgmt();
     vBuf tmpMgmtRecovery = decompress(aux);
@@ -133,107 +150,121 @@ namespace dnt = DotStr::Node::TypeVal;
   void CarpeDM::CarpeDMimpl::parseDownloadData(const vBuf& downloadData) {
     Graph& g = gDown;
     AllocTable& at = atDown;
-    std::stringstream stream;
 
     ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     //create AllocTable and Vertices
     //sLog << std::dec << "dl size " << downloadData.size() << std::endl;
     if(verbose) sLog << "Analysing downloaded graph binary " << std::dec << downloadData.size() << " bytes" << std::endl;
+
+    // The download buffer holds the nodes of all memories back to back. Get the index of each memory's first node, so memories can be decoded independently
+    const unsigned int memQty = at.getMemories().size();
+    std::vector<uint32_t> firstNode(memQty, 0);
     uint32_t nodeCnt = 0;
-    
-    //go through Memories
-    for(unsigned int i = 0; i < at.getMemories().size(); i++) {
-      //go through Bmp
+    for(unsigned int i = 0; i < memQty; i++) {
+      firstNode[i] = nodeCnt;
       for(unsigned int bitIdx = at.getMemories()[i].bmpSize / _MEM_BLOCK_SIZE; bitIdx < at.getMemories()[i].bmpBits; bitIdx++) {
-        if (at.getMemories()[i].getBmpBit(bitIdx)) {
-
-          uint32_t    localAdr  = nodeCnt * _MEM_BLOCK_SIZE; nodeCnt++;
-          uint32_t    adr       = at.getMemories()[i].bmpOffs + bitIdx * _MEM_BLOCK_SIZE;
-          //sLog << "THE adr : 0x" << std::hex << adr << std::endl;
-          uint32_t    hash      = writeBeBytesToLeNumber<uint32_t>((uint8_t*)&downloadData[localAdr + NODE_HASH]);
-          uint32_t    flags     = writeBeBytesToLeNumber<uint32_t>((uint8_t*)&downloadData[localAdr + NODE_FLAGS]); //FIXME what about future requests to hashmap if we improvised the name from hash? those will fail ...
-          uint32_t    type      = (flags >> NFLG_TYPE_POS) & NFLG_TYPE_MSK;
-          uint8_t     cpu       = i;
-
+        if (at.getMemories()[i].getBmpBit(bitIdx)) nodeCnt++;
+      }
+    }
+    if ((size_t)nodeCnt * _MEM_BLOCK_SIZE > downloadData.size()) throw std::runtime_error("Download data is shorter than the nodes marked in the bitmaps");
+
+    // Decode each memory's nodes on its own thread. Workers only read the download buffer, hashmap and grouptable and write to their own vector
+    std::vector<std::vector<DownloadedNode>> decoded(memQty);
+    std::vector<std::exception_ptr> failed(memQty);
+    auto decode = [&](unsigned int i) {
+      try {
+        std::stringstream stream;
+        uint32_t localIdx = firstNode[i];
+        //go through Bmp
+        for(unsigned int bitIdx = at.getMemories()[i].bmpSize / _MEM_BLOCK_SIZE; bitIdx < at.getMemories()[i].bmpBits; bitIdx++) {
+          if (!at.getMemories()[i].getBmpBit(bitIdx)) continue;
+
+          DownloadedNode n;
+          n.localAdr  = localIdx * _MEM_BLOCK_SIZE; localIdx++;
+          n.adr       = at.getMemories()[i].bmpOffs + bitIdx * _MEM_BLOCK_SIZE;
+          n.hash      = writeBeBytesToLeNumber<uint32_t>((uint8_t*)&downloadData[n.localAdr + NODE_HASH]);
+          n.flags     = writeBeBytesToLeNumber<uint32_t>((uint8_t*)&downloadData[n.localAdr + NODE_FLAGS]); //FIXME what about future requests to hashmap if we improvised the name from hash? those will fail ...
+          uint32_t type = (n.flags >> NFLG_TYPE_POS) & NFLG_TYPE_MSK;
+          uint8_t  cpu  = i;
 
-          //TODO Can't management and data be handled in parallel?... unsure
           // IMPORTANT: skip all mgmt nodes
           if (type == NODE_TYPE_MGMT) {continue; }
 
-
           stream.str(""); stream.clear();
-          stream << "0x" << std::setfill ('0') << std::setw(sizeof(uint32_t)*2) << std::hex << hash;
-          std::string name      = hm.contains(hash) ? hm.lookup(hash) : DotStr::Misc::sHashType + stream.str();
-          auto xPat  = gt.getTable().get<Groups::Node>().equal_range(name);
-          std::string pattern   = (xPat.first != xPat.second ? xPat.first->pattern : DotStr::Misc::sUndefined);
-          auto xBp  = gt.getTable().get<Groups::Node>().equal_range(name);
-          std::string beamproc  = (xBp.first != xBp.second ? xPat.first->beamproc : DotStr::Misc::sUndefined);
+          stream << "0x" << std::setfill ('0') << std::setw(sizeof(uint32_t)*2) << std::hex << n.hash;
+          n.name      = hm.contains(n.hash) ? hm.lookup(n.hash) : DotStr::Misc::sHashType + stream.str();
+          auto xPat  = gt.getTable().get<Groups::Node>().equal_range(n.name);
+          n.pattern   = (xPat.first != xPat.second ? xPat.first->pattern : DotStr::Misc::sUndefined);
+          auto xBp  = gt.getTable().get<Groups::Node>().equal_range(n.name);
+          n.beamproc  = (xBp.first != xBp.second ? xPat.first->beamproc : DotStr::Misc::sUndefined);
 
           //Vertex needs flags as a std::string. Convert to hex
           stream.str(""); stream.clear();
-          stream << "0x" << std::setfill ('0') << std::setw(sizeof(uint32_t)*2) << std::hex << flags;
-          std::string tmp(stream.str());
-
-          //Add Vertex
-          
-          
-
-          vertex_t v = boost::add_vertex(myVertex(name, pattern, beamproc, std::to_string(cpu), hash, nullptr, "", tmp), g);
-          //FIXME workaround for groupstable updates from download. not  nice ...
-          //sErr << std::endl << "DEBUG_After_Suspicious_Code" << std::endl;  
-          //BOOST_FOREACH( vertex_t v, vertices(g) ) { if(g[v].np != nullptr) g[v].np->show(); }
-
-          g[v].bpEntry  = std::to_string((bool)(flags & NFLG_BP_ENTRY_LM32_SMSK));
-          g[v].bpExit   = std::to_string((bool)(flags & NFLG_BP_EXIT_LM32_SMSK));
-          g[v].patEntry = std::to_string((bool)(flags & NFLG_PAT_ENTRY_LM32_SMSK));
-          g[v].patExit  = std::to_string((bool)(flags & NFLG_PAT_EXIT_LM32_SMSK));
-
-          //std::cout << "atdown cpu " << (int)cpu << " Adr: 0x" << std::hex << adr <<  " Hash 0x" << hash << std::endl;
-          //Add allocTable Entry
-          //vBuf test(downloadData.begin() + localAdr, downloadData.begin() + localAdr + _MEM_BLOCK_SIZE);
-          //vHexDump("TEST ****", test);
-
-
-          if (!(at.insert(cpu, adr, hash, v, false))) {
-            sLog << "Offending Node at: CPU " << (int)cpu << " 0x" << std::hex << adr << std::endl;
-            hexDump("Dump", (char*)&downloadData[localAdr], _MEM_BLOCK_SIZE );
-            throw std::runtime_error( std::string("Hash or address collision when adding node ") + name);
-          };
-
-          // Create node object for Vertex
-          auto src = downloadData.begin() + localAdr;
-          auto  it = at.lookupAdr(cpu, adr);
-          auto*  x = (AllocMeta*)&(*it);
-
-          std::copy(src, src + _MEM_BLOCK_SIZE, (uint8_t*)&(x->b[0]));
-
-      
+          stream << "0x" << std::setfill ('0') << std::setw(sizeof(uint32_t)*2) << std::hex << n.flags;
+          n.sFlags = stream.str();
 
+          // Create node object. The alloctable entry gets a copy of the same 32 bytes later on, so deserialise straight from the download buffer
+          uint8_t* b = (uint8_t*)&downloadData[n.localAdr];
           switch(type) {
-            case NODE_TYPE_TMSG         : g[v].np = (node_ptr) new  TimingMsg(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sTMsg;       g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_CNOOP        : g[v].np = (node_ptr) new       Noop(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sCmdNoop;    g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_CFLOW        : g[v].np = (node_ptr) new       Flow(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sCmdFlow;    g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_CSWITCH      : g[v].np = (node_ptr) new     Switch(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sSwitch;     g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_ORIGIN       : g[v].np = (node_ptr) new     Origin(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sOrigin;     g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_STARTTHREAD  : g[v].np = (node_ptr) new StartThread(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sStartThread; g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_CFLUSH       : g[v].np = (node_ptr) new      Flush(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sCmdFlush;   g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_CWAIT        : g[v].np = (node_ptr) new       Wait(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sCmdWait;    g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_BLOCK_FIXED  : g[v].np = (node_ptr) new BlockFixed(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sBlockFixed; g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_BLOCK_ALIGN  : g[v].np = (node_ptr) new BlockAlign(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sBlockAlign; g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_QUEUE        : g[v].np = (node_ptr) new   CmdQMeta(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sQInfo;      g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_ALTDST       : g[v].np = (node_ptr) new   DestList(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sDstList;    g[v].np->deserialise((uint8_t*)x->b); break;
-            case NODE_TYPE_QBUF         : g[v].np = (node_ptr) new CmdQBuffer(g[v].name, g[v].patName, g[v].bpName, x->hash, x->cpu, flags); g[v].type = dnt::sQBuf; break;
-            case NODE_TYPE_UNKNOWN      : sErr << "not yet implemented " << g[v].type << std::endl; break;
-            default                     : sErr << "Node type 0x" << std::hex << type << " not supported! " << std::endl;
+            case NODE_TYPE_TMSG         : n.np = (node_ptr) new  TimingMsg(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sTMsg;       n.np->deserialise(b); break;
+            case NODE_TYPE_CNOOP        : n.np = (node_ptr) new       Noop(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sCmdNoop;    n.np->deserialise(b); break;
+            case NODE_TYPE_CFLOW        : n.np = (node_ptr) new       Flow(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sCmdFlow;    n.np->deserialise(b); break;
+            case NODE_TYPE_CSWITCH      : n.np = (node_ptr) new     Switch(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sSwitch;     n.np->deserialise(b); break;
+            case NODE_TYPE_ORIGIN       : n.np = (node_ptr) new     Origin(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sOrigin;     n.np->deserialise(b); break;
+            case NODE_TYPE_STARTTHREAD  : n.np = (node_ptr) new StartThread(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sStartThread; n.np->deserialise(b); break;
+            case NODE_TYPE_CFLUSH       : n.np = (node_ptr) new      Flush(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sCmdFlush;   n.np->deserialise(b); break;
+            case NODE_TYPE_CWAIT        : n.np = (node_ptr) new       Wait(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sCmdWait;    n.np->deserialise(b); break;
+            case NODE_TYPE_BLOCK_FIXED  : n.np = (node_ptr) new BlockFixed(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sBlockFixed; n.np->deserialise(b); break;
+            case NODE_TYPE_BLOCK_ALIGN  : n.np = (node_ptr) new BlockAlign(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sBlockAlign; n.np->deserialise(b); break;
+            case NODE_TYPE_QUEUE        : n.np = (node_ptr) new   CmdQMeta(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sQInfo;      n.np->deserialise(b); break;
+            case NODE_TYPE_ALTDST       : n.np = (node_ptr) new   DestList(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sDstList;    n.np->deserialise(b); break;
+            case NODE_TYPE_QBUF         : n.np = (node_ptr) new CmdQBuffer(n.name, n.pattern, n.beamproc, n.hash, cpu, n.flags); n.type = dnt::sQBuf; break;
+            case NODE_TYPE_UNKNOWN      : n.error = "not yet implemented \n"; break;
+            default                     : stream.str(""); stream.clear(); stream << "Node type 0x" << std::hex << type << " not supported! \n"; n.error = stream.str();
           }
-          
-
-          
-        }
+          decoded[i].push_back(std::move(n));
         }
+      } catch (...) {
+        failed[i] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for(unsigned int i = 1; i < memQty; i++) workers.emplace_back(decode, i);
+    if (memQty > 0) decode(0);
+    for(auto& worker : workers) worker.join();
+    for(auto& e : failed) { if (e) std::rethrow_exception(e); }
+
+    // Merge in memory and bitmap order, so vertex indices and alloctable contents don't depend on thread timing
+    for(unsigned int i = 0; i < memQty; i++) {
+      uint8_t cpu = i;
+      for(auto& n : decoded[i]) {
+        //Add Vertex
+        vertex_t v = boost::add_vertex(myVertex(n.name, n.pattern, n.beamproc, std::to_string(cpu), n.hash, nullptr, "", n.sFlags), g);
+
+        g[v].bpEntry  = std::to_string((bool)(n.flags & NFLG_BP_ENTRY_LM32_SMSK));
+        g[v].bpExit   = std::to_string((bool)(n.flags & NFLG_BP_EXIT_LM32_SMSK));
+        g[v].patEntry = std::to_string((bool)(n.flags & NFLG_PAT_ENTRY_LM32_SMSK));
+        g[v].patExit  = std::to_string((bool)(n.flags & NFLG_PAT_EXIT_LM32_SMSK));
+
+        //Add allocTable Entry
+        if (!(at.insert(cpu, n.adr, n.hash, v, false))) {
+          sLog << "Offending Node at: CPU " << (int)cpu << " 0x" << std::hex << n.adr << std::endl;
+          hexDump("Dump", (char*)&downloadData[n.localAdr], _MEM_BLOCK_SIZE );
+          throw std::runtime_error( std::string("Hash or address collision when adding node ") + n.name);
+        };
+
+        auto src = downloadData.begin() + n.localAdr;
+        auto  it = at.lookupAdr(cpu, n.adr);
+        auto*  x = (AllocMeta*)&(*it);
+
+        std::copy(src, src + _MEM_BLOCK_SIZE, (uint8_t*)&(x->b[0]));
+
+        g[v].np   = n.np;
+        g[v].type = n.type;
+        if (!n.error.empty()) sErr << n.error << std::flush;
+      }
     }
-    
-    
 
 
     if(verbose) sLog << "Node creation done. Creating Edges" << std::endl;
@@ -333,6 +364,8 @@ namespace dnt = DotStr::Node::TypeVal;
     if(verbose) sLog << "returned." << std::endl;
 
     freshDownload = true;
+    lazyDownload  = false;
+    schedVersion++;
     if(optimisedS2R) updateCovenants();
 
     //gt.debug(sLog);
@@ -342,4 +375,59 @@ namespace dnt = DotStr::Node::TypeVal;
     return vDlD.size();
   }
 
+  // Reads bitmaps and management data only: the bitmaps, the flags word of all used nodes to locate the mgmt nodes, then the mgmt nodes themselves.
+  // The schedule graph is not built, node names are resolved on demand from the hash word at the node's address (see getNodeNameAtAdr).
+  // The first call which needs the graph runs a full download.
+  int CarpeDM::CarpeDMimpl::downloadLazy() {
+    AllocTable& at = atDown;
+    vEbrds erBmp = gatherDownloadBmpVector();
+    vEbrds erFlags, erMgmt;
+    std::vector<std::pair<uint8_t, uint32_t>> vNodes, vMgmt;
+
+    atDown.clear();
+    atDown.clearMemories();
+    gDown.clear();
+    if(verbose) sLog << "Downloading bitmaps and management data ...";
+    atDown.setBmps( ebd.readCycle(erBmp.va, erBmp.vcs) );
+
+    for(unsigned int i = 0; i < at.getMemories().size(); i++) {
+      for(unsigned int bitIdx = at.getMemories()[i].bmpSize / _MEM_BLOCK_SIZE; bitIdx < at.getMemories()[i].bmpBits; bitIdx++) {
+        if (at.getMemories()[i].getBmpBit(bitIdx)) {
+          uint32_t nodeAdr = at.getMemories()[i].bmpOffs + bitIdx * _MEM_BLOCK_SIZE;
+          vNodes.push_back(std::make_pair(i, nodeAdr));
+          erFlags.va.push_back(at.adrConv(AdrType::MGMT, AdrType::EXT, i, nodeAdr) + NODE_FLAGS);
+          erFlags.vcs.push_back(true);
+        }
+      }
+    }
+    vBuf vDlFlags = ebd.readCycle(erFlags.va, erFlags.vcs);
+
+    for(unsigned int n = 0; n < vNodes.size(); n++) {
+      uint32_t flags = writeBeBytesToLeNumber<uint32_t>((uint8_t*)&vDlFlags[n * _32b_SIZE_]);
+      if (((flags >> NFLG_TYPE_POS) & NFLG_TYPE_MSK) != NODE_TYPE_MGMT) continue;
+      uint8_t  cpu     = vNodes[n].first;
+      uint32_t nodeAdr = vNodes[n].second;
+      vMgmt.push_back(vNodes[n]);
+      for (uint32_t adr = at.adrConv(AdrType::MGMT, AdrType::EXT, cpu, nodeAdr); adr < at.adrConv(AdrType::MGMT, AdrType::EXT, cpu, nodeAdr + _MEM_BLOCK_SIZE); adr += _32b_SIZE_ ) {
+        erMgmt.va.push_back(adr);
+        erMgmt.vcs.push_back(adr == at.adrConv(AdrType::MGMT, AdrType::EXT, cpu, nodeAdr));
+      }
+    }
+    vBuf vDlMgmt = ebd.readCycle(erMgmt.va, erMgmt.vcs);
+    updateModTime();
+    if(verbose) sLog << "Done. " << std::dec << vMgmt.size() << " of " << vNodes.size() << " nodes are mgmt nodes" << std::endl;
+
+    readMgmtLLMeta();
+    for(unsigned int n = 0; n < vMgmt.size(); n++) {
+      if (!(at.insertMgmt(vMgmt[n].first, vMgmt[n].second, (uint8_t*)&vDlMgmt[n * _MEM_BLOCK_SIZE]))) {throw std::runtime_error( std::string("Address collision when adding mgmt node at "));};
+    }
+    recoverMgmtTables();
+
+    freshDownload = false;
+    lazyDownload  = true;
+    schedVersion++;
+
+    return vDlFlags.size() + vDlMgmt.size();
+  }
+
 
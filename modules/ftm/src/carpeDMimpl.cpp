@@ -11,6 +11,7 @@
 #include "carpeDMimpl.h"
 #include "common.h"
 #include "propwrite.h"
+#include "dotwriter.h"
 #include "graph.h"
 #include "minicommand.h"
 #include "dotstr.h"
@@ -45,7 +46,7 @@
 
 
   Graph& CarpeDM::CarpeDMimpl::getUpGraph()   {return gUp;}   //Returns the Upload Graph for CPU <cpuIdx>
-  Graph& CarpeDM::CarpeDMimpl::getDownGraph() {return gDown;} //Returns the Download Graph for CPU <cpuIdx>
+  Graph& CarpeDM::CarpeDMimpl::getDownGraph() {completeLazyDownload(); return gDown;} //Returns the Download Graph for CPU <cpuIdx>
 
 vBuf CarpeDM::CarpeDMimpl::compress(const vBuf& in) {return lzmaCompress(in);}
 vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in);}
@@ -217,6 +218,7 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
 
   uint8_t CarpeDM::CarpeDMimpl::getNodeCpu(const std::string& name, TransferDir dir) {
 
+    if (dir == TransferDir::DOWNLOAD) completeLazyDownload();
     AllocTable& at = (dir == TransferDir::UPLOAD ? atUp : atDown );
     uint32_t hash;
     hash = hm.lookup(name); //just pass it on
@@ -229,6 +231,7 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
     if (verbose) sLog << "Looking up Adr of " << name << std::endl;
     if(name == DotStr::Node::Special::sIdle) return LM32_NULL_PTR; //idle node is resolved as a null ptr without comment
 
+    if (dir == TransferDir::DOWNLOAD) completeLazyDownload();
     AllocTable& at = (dir == TransferDir::UPLOAD ? atUp : atDown );
     uint32_t hash;
 
@@ -248,6 +251,7 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
 
 //Returns if a hash / nodename is present on DM
   bool CarpeDM::CarpeDMimpl::isInHashDict(const uint32_t hash)  {
+    completeLazyDownload();
 
     if (atDown.isOk(atDown.lookupHash(hash))) return true;
     else return false;
@@ -255,6 +259,7 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
 
   bool CarpeDM::CarpeDMimpl::isInHashDict(const std::string& name) {
     if (!(hm.contains(name))) return false;
+    completeLazyDownload();
     return (atDown.isOk(atDown.lookupHash(hm.lookup(name))));
   }
 
@@ -284,8 +289,6 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
   void CarpeDM::CarpeDMimpl::writeUpDotFile(const std::string& fn, bool filterMeta)         { writeTextFile(fn, createDot(gUp, filterMeta)); }
 
   // Schedule Manipulation and Dispatch ///////////////////////////////////////////////////////////
-  //TODO assign a cpu to each node object. Currently taken from input .dot
-  int CarpeDM::CarpeDMimpl::assignNodesToCpus() {return 0;};
   //get all nodes from DM
   std::string CarpeDM::CarpeDMimpl::downloadDot(bool filterMeta) {download(); return createDot( gDown, filterMeta);};
   void CarpeDM::CarpeDMimpl::downloadDotFile(const std::string& fn, bool filterMeta) {download(); writeDownDotFile(fn, filterMeta);};
@@ -301,6 +304,9 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
   //removes all nodes in input file
   int CarpeDM::CarpeDMimpl::removeDot(const std::string& s, bool force) {Graph gTmp; return safeguardTransaction(&CarpeDMimpl::remove, std::ref(parseDot(s, gTmp)), force);};
   int CarpeDM::CarpeDMimpl::removeDotFile(const std::string& fn, bool force) {return removeDot(readTextFile(fn), force);};
+  //changes the DM to match the input file, uploads only the differences
+  int CarpeDM::CarpeDMimpl::syncDot(const std::string& s, bool force) {Graph gTmp; return safeguardTransaction(&CarpeDMimpl::sync, std::ref(parseDot(s, gTmp)), force);};
+  int CarpeDM::CarpeDMimpl::syncDotFile(const std::string& fn, bool force) {return syncDot(readTextFile(fn), force);};
   // Safe removal check
   //bool isSafe2RemoveDotFile(const std::string& fn) {Graph gTmp; return isSafeToRemove(parseDot(readTextFile(fn), gTmp));};
   //clears all nodes from DM
@@ -316,27 +322,9 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
 
    //write out dotstringfrom download graph
   std::string CarpeDM::CarpeDMimpl::createDot(Graph& g, bool filterMeta) {
-    std::ostringstream out;
-    typedef boost::property_map< Graph, node_ptr myVertex::* >::type NpMap;
-
-    boost::filtered_graph <Graph, boost::keep_all, non_meta<NpMap> > fg(g, boost::keep_all(), make_non_meta(boost::get(&myVertex::np, g)));
-    try {
-
-        if (filterMeta) {
-          boost::write_graphviz(out, fg, make_vertex_writer(boost::get(&myVertex::np, fg)),
-                      make_edge_writer(boost::get(&myEdge::type, fg)), sample_graph_writer{DotStr::Graph::sDefName},
-                      boost::get(&myVertex::name, fg));
-        }
-        else {
-
-          boost::write_graphviz(out, g, make_vertex_writer(boost::get(&myVertex::np, g)),
-                      make_edge_writer(boost::get(&myEdge::type, g)), sample_graph_writer{DotStr::Graph::sDefName},
-                      boost::get(&myVertex::name, g));
-        }
-      }
-      catch(...) {throw;}
-
-    return out.str();
+    std::string out;
+    writeDot(out, g, filterMeta);
+    return out;
   }
 
   //write out dotfile from download graph of a memunit
@@ -358,6 +346,15 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
             g[v].np->accept(VisitorValidation(g, v, at, force));
           }
     } catch (std::runtime_error const& err) { throw std::runtime_error("Validation of " + std::string(err.what()) ); }
+
+    if (timingCheck != TimingCheck::OFF) {
+      std::vector<TimingReport> vTr;
+      std::string report;
+      if (!timingAnalysis(g, vTr, report)) {
+        if (timingCheck == TimingCheck::ERROR && !force) throw std::runtime_error("Validation of timing: schedule is predicted to overload the DM\n" + report);
+        sErr << "Warning: Validation of timing: schedule is predicted to overload the DM" << std::endl << report << std::endl;
+      } else if (verbose) sLog << report << std::endl;
+    }
     return true;
   }
 
@@ -463,3 +460,4 @@ vBuf CarpeDM::CarpeDMimpl::decompress(const vBuf& in) {return lzmaDecompress(in)
   int CarpeDM::CarpeDMimpl::clearHealth(uint8_t cpuIdx)                                           { vEbwrs ew; clearHealth(ew, cpuIdx);                 return send(ew);}
   int CarpeDM::CarpeDMimpl::resetThrMsgCnt(uint8_t cpuIdx, uint8_t thrIdx)                        { vEbwrs ew; resetThrMsgCnt(ew, cpuIdx, thrIdx);      return send(ew);}
   int CarpeDM::CarpeDMimpl::blockAsyncClearQueues(const std::string& sBlock)                      { vEbwrs ew; blockAsyncClearQueues(ew, sBlock);       return send(ew);}
+  int CarpeDM::CarpeDMimpl::sendPreparedCommand(PreparedCommand& pc, bool vabs, uint64_t cmdTvalid) { vEbwrs ew; createPreparedCommand(ew, pc, vabs, cmdTvalid); return send(ew);}
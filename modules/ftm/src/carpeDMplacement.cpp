@@ -0,0 +1,355 @@
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <stdio.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <map>
+#include <inttypes.h>
+
+#include "common.h"
+#include "carpeDMimpl.h"
+#include "node.h"
+#include "block.h"
+#include "event.h"
+#include "dotstr.h"
+
+namespace dnt = DotStr::Node::TypeVal;
+namespace det = DotStr::Edge::TypeVal;
+
+namespace Placement {
+  const std::string exIntro = "assignNodesToCpus: ";
+
+  // weights of the placement cost function. Load dominates, memory pressure and cross CPU commands break ties
+  const double wLoad  = 1.0;
+  const double wMem   = 0.5;
+  const double wCross = 0.25;
+
+  /// Everything the placement engine needs to know about a set of patterns which must share a CPU
+  struct Cluster {
+    std::set<std::string> patterns;
+    vertex_set_t members;
+    int      pinnedCpu  = -1;    ///< CPU forced by a cpu attribute or a flow edge to a resident node, -1 if free
+    double   msgRate    = 0.0;   ///< estimated timing messages per second
+    double   nodeRate   = 0.0;   ///< estimated node visits per second, this is what the CPU has to process
+    uint32_t chunks     = 0;     ///< memory chunks needed including generated meta nodes
+    std::set<uint8_t> threads;   ///< thread indices claimed by origin/startthread nodes leading here
+    std::map<unsigned, unsigned> crossEdges; ///< command edges to other clusters (cluster index -> qty)
+    std::map<uint8_t, unsigned> residentEdges; ///< command edges to resident nodes (cpu -> qty)
+  };
+
+  /// Per pattern accumulators for message rate estimation
+  struct PatternLoad {
+    unsigned tmsgs  = 0;
+    unsigned nodes  = 0;
+    uint64_t period = 0;
+  };
+
+  // Flow edges are followed by the thread walking the schedule, so source and target must reside on the same CPU
+  bool isFlowEdge(const std::string& type) { return (type == det::sDefDst || type == det::sAltDst); }
+  // Command destinations must reside on the same CPU as the command's target block
+  bool isCmdDstEdge(const std::string& type) { return (type == det::sCmdFlowDst || type == det::sSwitchDst || type == det::sCmdFlushOvr); }
+  // Commands may cross CPUs, but pay for the peer access
+  bool isCmdEdge(const std::string& type) { return (type == det::sCmdTarget || type == det::sOriginDst); }
+
+  vertex_t findRoot(std::vector<vertex_t>& parent, vertex_t v) {
+    while (parent[v] != v) { parent[v] = parent[parent[v]]; v = parent[v]; }
+    return v;
+  }
+
+  void unite(std::vector<vertex_t>& parent, vertex_t a, vertex_t b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a != b) parent[std::max(a, b)] = std::min(a, b);
+  }
+
+  bool isDefined(const Graph& g, vertex_t v) { return g[v].type != DotStr::Misc::sUndefined; }
+
+  // Block period from the data object if the vertex has one (download), otherwise from the parsed dot property
+  uint64_t getPeriod(const Graph& g, vertex_t v) {
+    if (g[v].np != nullptr) {
+      if (g[v].np->isBlock()) return boost::dynamic_pointer_cast<Block>(g[v].np)->getTPeriod();
+      return 0;
+    }
+    if (g[v].tPeriod == DotStr::Misc::sUndefined64) return 0;
+    return s2u<uint64_t>(g[v].tPeriod);
+  }
+
+  // Thread claimed by an origin/startthread node, from the data object if the vertex has one (download), otherwise from the parsed dot property. -1 if none
+  int getThread(const Graph& g, vertex_t v) {
+    if (g[v].np != nullptr) {
+      if (g[v].type == dnt::sOrigin)      return boost::dynamic_pointer_cast<Origin>(g[v].np)->getThread();
+      if (g[v].type == dnt::sStartThread) return boost::dynamic_pointer_cast<StartThread>(g[v].np)->getThread();
+      return -1;
+    }
+    if (g[v].type != dnt::sOrigin && g[v].type != dnt::sStartThread) return -1;
+    if (g[v].thread == DotStr::Misc::sUndefined) return -1;
+    return s2u<uint8_t>(g[v].thread);
+  }
+
+  bool isBlockType(const std::string& type) { return (type == dnt::sBlock || type == dnt::sBlockFixed || type == dnt::sBlockAlign); }
+  bool isMetaType(const std::string& type)  { return (type == dnt::sQInfo || type == dnt::sQBuf || type == dnt::sDstList || type == dnt::sMeta); }
+
+  // Number of chunks a parsed node will occupy once generateBlockMeta has run
+  uint32_t getChunks(const Graph& g, vertex_t v) {
+    uint32_t ret = 1;
+    if (!isBlockType(g[v].type)) return ret;
+
+    bool hasAlt = false;
+    Graph::out_edge_iterator out_begin, out_end, out_cur;
+    boost::tie(out_begin, out_end) = out_edges(v, g);
+    for (out_cur = out_begin; out_cur != out_end; ++out_cur) { if (g[*out_cur].type == det::sAltDst) hasAlt = true; }
+
+    unsigned queues = 0;
+    try {
+      queues = (unsigned)s2u<bool>(g[v].qIl) + (unsigned)s2u<bool>(g[v].qHi) + (unsigned)s2u<bool>(g[v].qLo);
+    } catch (std::runtime_error const& err) {
+      throw std::runtime_error(exIntro + "Parser error when processing queue tags of node <" + g[v].name + ">. Cause: " + err.what());
+    }
+    ret += queues * 3;                  // queue buffer list and two buffers per priority
+    if (hasAlt || queues) ret += 1;     // destination list
+    return ret;
+  }
+
+  // Sum up timing messages, processed nodes and block periods per pattern. Rates follow as count / period.
+  void accumulateLoad(const Graph& g, vertex_t v, std::map<std::string, PatternLoad>& loads) {
+    if (isMetaType(g[v].type) || g[v].type == DotStr::Misc::sUndefined) return;
+    PatternLoad& pl = loads[g[v].patName];
+    pl.nodes++;
+    if (g[v].type == dnt::sTMsg) pl.tmsgs++;
+    if (isBlockType(g[v].type))  pl.period += getPeriod(g, v);
+  }
+
+  double rate(unsigned cnt, uint64_t period) { return (period ? (double)cnt * 1000000000.0 / (double)period : 0.0); }
+
+}
+
+using namespace Placement;
+
+/** Assign a CPU to every node in g which does not carry a cpu attribute.
+ * Nodes are placed pattern-wise. Patterns connected by flow edges (defdst/altdst) and commands with their
+ * destinations are fused into clusters which must share a CPU. A cluster is pinned if one of its members has a
+ * cpu attribute or a flow edge leads to a node already resident in at.
+ * Free clusters are placed greedily, busiest first, on the CPU minimising a weighted cost of predicted message
+ * load (estimated from block tPeriods and timing message counts), memory pressure (free chunks) and cross CPU
+ * command edges. Two clusters on one CPU may not claim the same thread via origin/startthread nodes, nor a thread
+ * claimed by a resident origin/startthread node.
+ * gResident and at describe what is already on the DM (use an empty graph and cleared table for overwrite).
+ * Returns the number of nodes which were assigned a CPU, the report contains the predicted per CPU load.
+ */
+int CarpeDM::CarpeDMimpl::assignNodesToCpus(Graph& g, Graph& gResident, AllocTable& at, std::string& report) {
+  std::stringstream ss;
+  const unsigned cpus = at.getMemories().size();
+  if (cpus == 0) throw std::runtime_error(exIntro + "No CPU memories known. Connect to a DM first");
+
+  // resident load per CPU
+  std::vector<std::map<std::string, PatternLoad>> residentLoads(cpus);
+  BOOST_FOREACH( vertex_t v, vertices(gResident) ) {
+    uint8_t cpu = s2u<uint8_t>(gResident[v].cpu);
+    if (cpu < cpus) accumulateLoad(gResident, v, residentLoads[cpu]);
+  }
+  std::vector<double> load(cpus, 0.0), msgs(cpus, 0.0), residentRate(cpus, 0.0);
+  std::vector<int64_t> freeChunks(cpus, 0);
+  std::vector<std::set<uint8_t>> threadsUsed(cpus);
+  for (unsigned c = 0; c < cpus; c++) {
+    for (auto& it : residentLoads[c]) { load[c] += rate(it.second.nodes, it.second.period); msgs[c] += rate(it.second.tmsgs, it.second.period); }
+    residentRate[c] = load[c];
+    freeChunks[c]   = at.getFreeChunkQty(c);
+  }
+  // threads claimed by resident origin/startthread nodes are taken on the CPU of their destination
+  BOOST_FOREACH( vertex_t v, vertices(gResident) ) {
+    int thr = getThread(gResident, v);
+    if (thr < 0) continue;
+    uint8_t cpu = s2u<uint8_t>(gResident[v].cpu);
+    Graph::out_edge_iterator out_begin, out_end, out_cur;
+    boost::tie(out_begin, out_end) = out_edges(v, gResident);
+    for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+      if (gResident[*out_cur].type == det::sOriginDst) cpu = s2u<uint8_t>(gResident[target(*out_cur, gResident)].cpu);
+    }
+    if (cpu < cpus) threadsUsed[cpu].insert(thr);
+  }
+
+  // fuse vertices into clusters: same pattern, flow edges and command target/destination pairs
+  std::vector<vertex_t> parent(num_vertices(g));
+  for (vertex_t v = 0; v < parent.size(); v++) parent[v] = v;
+  std::map<std::string, vertex_t> patternRep;
+
+  BOOST_FOREACH( vertex_t v, vertices(g) ) {
+    if (!isDefined(g, v)) continue;
+    if (g[v].patName != DotStr::Misc::sUndefined) {
+      auto itRep = patternRep.find(g[v].patName);
+      if (itRep == patternRep.end()) patternRep[g[v].patName] = v;
+      else unite(parent, itRep->second, v);
+    }
+    Graph::out_edge_iterator out_begin, out_end, out_cur;
+    boost::tie(out_begin, out_end) = out_edges(v, g);
+    vertex_t vTarget = null_vertex;
+    for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+      if (g[*out_cur].type == det::sCmdTarget) vTarget = target(*out_cur, g);
+    }
+    for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+      vertex_t w = target(*out_cur, g);
+      if (!isDefined(g, w)) continue;
+      if (isFlowEdge(g[*out_cur].type)) unite(parent, v, w);
+      if (isCmdDstEdge(g[*out_cur].type) && vTarget != null_vertex && isDefined(g, vTarget)) unite(parent, vTarget, w);
+    }
+  }
+
+  std::map<vertex_t, unsigned> clusterIdx;
+  std::vector<Cluster> clusters;
+  std::map<std::string, PatternLoad> newLoads;
+
+  BOOST_FOREACH( vertex_t v, vertices(g) ) {
+    if (!isDefined(g, v)) continue;
+    vertex_t r = findRoot(parent, v);
+    if (clusterIdx.find(r) == clusterIdx.end()) { clusterIdx[r] = clusters.size(); clusters.push_back(Cluster()); }
+    Cluster& cl = clusters[clusterIdx[r]];
+    cl.members.insert(v);
+    cl.patterns.insert(g[v].patName);
+    cl.chunks += getChunks(g, v);
+    accumulateLoad(g, v, newLoads);
+
+    if (g[v].cpu != DotStr::Misc::sUndefined) {
+      int cpu;
+      try { cpu = s2u<uint8_t>(g[v].cpu); } catch (std::runtime_error const& err) {
+        throw std::runtime_error(exIntro + "Parser error when processing cpu tag of node <" + g[v].name + ">. Cause: " + err.what());
+      }
+      if (cl.pinnedCpu >= 0 && cl.pinnedCpu != cpu) throw std::runtime_error(exIntro + "Node <" + g[v].name + "> is pinned to CPU " + std::to_string(cpu) + ", but its pattern cluster is already pinned to CPU " + std::to_string(cl.pinnedCpu));
+      cl.pinnedCpu = cpu;
+    }
+  }
+
+  // second pass over edges: resident neighbours, cross cluster commands and thread claims
+  BOOST_FOREACH( vertex_t v, vertices(g) ) {
+    if (!isDefined(g, v)) continue;
+    Cluster& cl = clusters[clusterIdx[findRoot(parent, v)]];
+    Graph::out_edge_iterator out_begin, out_end, out_cur;
+    boost::tie(out_begin, out_end) = out_edges(v, g);
+    for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+      vertex_t w = target(*out_cur, g);
+      const std::string& eType = g[*out_cur].type;
+
+      if ((g[v].type == dnt::sOrigin || g[v].type == dnt::sStartThread) && eType == det::sOriginDst && g[v].thread != DotStr::Misc::sUndefined) {
+        uint8_t thr = s2u<uint8_t>(g[v].thread);
+        if (thr >= _THR_QTY_) throw std::runtime_error(exIntro + "Node <" + g[v].name + "> claims thread " + std::to_string(thr) + ", but there are only " + std::to_string(_THR_QTY_) + " threads per CPU");
+        if (isDefined(g, w)) clusters[clusterIdx[findRoot(parent, w)]].threads.insert(thr);
+      }
+
+      if (!isDefined(g, w)) {
+        // implicit node, must already be on the DM
+        amI x = at.lookupHashNoEx(g[w].hash);
+        if (!at.isOk(x)) continue;
+        if (isFlowEdge(eType)) {
+          if (cl.pinnedCpu >= 0 && cl.pinnedCpu != x->cpu) throw std::runtime_error(exIntro + "Node <" + g[v].name + "> leads to resident node <" + g[w].name + "> on CPU " + std::to_string(x->cpu) + ", but its pattern cluster is pinned to CPU " + std::to_string(cl.pinnedCpu));
+          cl.pinnedCpu = x->cpu;
+        } else if (isCmdEdge(eType)) cl.residentEdges[x->cpu]++;
+      } else if (isCmdEdge(eType)) {
+        unsigned other = clusterIdx[findRoot(parent, w)];
+        if (other != clusterIdx[findRoot(parent, v)]) cl.crossEdges[other]++;
+      }
+    }
+  }
+
+  for (auto& cl : clusters) {
+    for (auto& p : cl.patterns) {
+      auto x = newLoads.find(p);
+      if (x == newLoads.end()) continue;
+      cl.nodeRate += rate(x->second.nodes, x->second.period);
+      cl.msgRate  += rate(x->second.tmsgs, x->second.period);
+    }
+  }
+
+  // pinned clusters first, they are not up for negotiation
+  std::vector<int> assignment(clusters.size(), -1);
+  for (unsigned i = 0; i < clusters.size(); i++) {
+    Cluster& cl = clusters[i];
+    if (cl.pinnedCpu < 0) continue;
+    if ((unsigned)cl.pinnedCpu >= cpus) throw std::runtime_error(exIntro + "Pattern cluster containing <" + *cl.patterns.begin() + "> is pinned to CPU " + std::to_string(cl.pinnedCpu) + ", but DM has only " + std::to_string(cpus) + " CPUs");
+    assignment[i] = cl.pinnedCpu;
+    load[cl.pinnedCpu] += cl.nodeRate;
+    msgs[cl.pinnedCpu] += cl.msgRate;
+    freeChunks[cl.pinnedCpu] -= cl.chunks;
+    threadsUsed[cl.pinnedCpu].insert(cl.threads.begin(), cl.threads.end());
+  }
+
+  // free clusters, busiest first (longest processing time first heuristic), then largest
+  std::vector<unsigned> order;
+  for (unsigned i = 0; i < clusters.size(); i++) if (assignment[i] < 0) order.push_back(i);
+  std::stable_sort(order.begin(), order.end(), [&clusters](unsigned a, unsigned b) {
+    if (clusters[a].nodeRate != clusters[b].nodeRate) return clusters[a].nodeRate > clusters[b].nodeRate;
+    return clusters[a].chunks > clusters[b].chunks;
+  });
+
+  double totalRate = 0.0;
+  for (unsigned c = 0; c < cpus; c++) totalRate += load[c];
+  for (auto i : order) totalRate += clusters[i].nodeRate;
+  if (totalRate <= 0.0) totalRate = 1.0;
+
+  for (auto i : order) {
+    Cluster& cl = clusters[i];
+    int best = -1;
+    double bestCost = 0.0;
+    for (unsigned c = 0; c < cpus; c++) {
+      if (freeChunks[c] < (int64_t)cl.chunks) continue;
+      bool threadClash = false;
+      for (auto thr : cl.threads) if (threadsUsed[c].count(thr)) threadClash = true;
+      if (threadClash) continue;
+
+      unsigned cross = 0, edges = 0;
+      for (auto& e : cl.crossEdges)    { edges += e.second; if (assignment[e.first] >= 0 && (unsigned)assignment[e.first] != c) cross += e.second; }
+      for (auto& e : cl.residentEdges) { edges += e.second; if (e.first != c) cross += e.second; }
+
+      double cost = wLoad  * (load[c] + cl.nodeRate) / totalRate
+                  + wMem   * (double)(at.getTotalChunkQty(c) - freeChunks[c] + cl.chunks) / (double)std::max(at.getTotalChunkQty(c), (uint32_t)1)
+                  + wCross * (double)cross / (double)std::max(edges, 1u);
+      if (best < 0 || cost < bestCost) { best = c; bestCost = cost; }
+    }
+    if (best < 0) throw std::runtime_error(exIntro + "No CPU has room for pattern cluster containing <" + *cl.patterns.begin() + "> (" + std::to_string(cl.chunks) + " chunks, " + std::to_string(cl.threads.size()) + " claimed threads)");
+    assignment[i] = best;
+    load[best] += cl.nodeRate;
+    msgs[best] += cl.msgRate;
+    freeChunks[best] -= cl.chunks;
+    threadsUsed[best].insert(cl.threads.begin(), cl.threads.end());
+  }
+
+  // write back
+  int assigned = 0;
+  for (unsigned i = 0; i < clusters.size(); i++) {
+    for (auto v : clusters[i].members) {
+      if (g[v].cpu == DotStr::Misc::sUndefined) { g[v].cpu = std::to_string(assignment[i]); assigned++; }
+    }
+  }
+
+  // report
+  ss << std::left << std::setfill(' ') << std::setw(40) << "Pattern Cluster" << std::right << std::setw(8) << "Cpu" << std::setw(8) << "Pinned"
+     << std::setw(10) << "Chunks" << std::setw(14) << "Msg/s" << std::setw(14) << "Nodes/s" << std::endl;
+  for (unsigned i = 0; i < clusters.size(); i++) {
+    Cluster& cl = clusters[i];
+    std::string sPat = *cl.patterns.begin() + (cl.patterns.size() > 1 ? " (+" + std::to_string(cl.patterns.size() - 1) + ")" : "");
+    ss << std::left << std::setw(40) << sPat << std::right << std::dec << std::setw(8) << assignment[i] << std::setw(8) << (cl.pinnedCpu >= 0 ? "yes" : "no")
+       << std::setw(10) << cl.chunks << std::setw(14) << std::fixed << std::setprecision(1) << cl.msgRate << std::setw(14) << cl.nodeRate << std::endl;
+  }
+  ss << std::endl << std::setw(4) << "Cpu" << std::setw(16) << "Resident Nodes/s" << std::setw(16) << "Predicted Nodes/s" << std::setw(14) << "Pred. Msg/s"
+     << std::setw(12) << "Free Chunks" << std::setw(10) << "Threads" << std::endl;
+  for (unsigned c = 0; c < cpus; c++) {
+    ss << std::setw(4) << c << std::setw(16) << residentRate[c] << std::setw(18) << load[c] << std::setw(14) << msgs[c]
+       << std::setw(12) << freeChunks[c] << std::setw(10) << threadsUsed[c].size() << std::endl;
+  }
+  report = ss.str();
+
+  return assigned;
+}
+
+/** Dry run of the placement engine on a .dot string. Nothing is uploaded, the report shows the predicted per CPU load.
+ */
+std::string CarpeDM::CarpeDMimpl::placementReportDot(const std::string& s) {
+  Graph gTmp;
+  std::string report;
+  download();
+  parseDot(s, gTmp);
+  int assigned = assignNodesToCpus(gTmp, gDown, atDown, report);
+  return report + "\n" + std::to_string(assigned) + " nodes assigned\n";
+}
+
+std::string CarpeDM::CarpeDMimpl::placementReportDotFile(const std::string& fn) { return placementReportDot(readTextFile(fn)); }
@@ -0,0 +1,251 @@
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <stdio.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <map>
+#include <inttypes.h>
+
+#include "common.h"
+#include "carpeDMimpl.h"
+#include "node.h"
+#include "block.h"
+#include "event.h"
+#include "dotstr.h"
+
+namespace dnt = DotStr::Node::TypeVal;
+namespace det = DotStr::Edge::TypeVal;
+
+namespace TimingAnalysis {
+  const std::string exIntro = "timingAnalysis: ";
+  const int thrUnknown = -1;
+
+  /// One cycle of the schedule graph along defdst edges, as a thread would walk it
+  struct ThreadCycle {
+    std::vector<vertex_t> nodes;  ///< cycle members in walk order, starting after a block
+    int      cpu        = -1;
+    int      thread     = thrUnknown;
+    uint64_t period     = 0;      ///< sum of all block periods in the cycle
+    std::vector<uint64_t> tNodes; ///< due time of every node relative to cycle start
+    std::vector<uint64_t> tMsgs;  ///< due time of every timing message relative to cycle start
+  };
+
+  bool isBlockType(const std::string& type) { return (type == dnt::sBlock || type == dnt::sBlockFixed || type == dnt::sBlockAlign); }
+  bool isMetaType(const std::string& type)  { return (type == dnt::sQInfo || type == dnt::sQBuf || type == dnt::sDstList || type == dnt::sMeta); }
+  bool isProcessed(const Graph& g, vertex_t v) { return !(isMetaType(g[v].type) || g[v].type == DotStr::Misc::sUndefined); }
+
+  // Time properties either come from the data object (allocated/downloaded graph) or from the parsed dot property
+  uint64_t getPeriod(const Graph& g, vertex_t v) {
+    if (g[v].np != nullptr) return boost::dynamic_pointer_cast<Block>(g[v].np)->getTPeriod();
+    if (g[v].tPeriod == DotStr::Misc::sUndefined64) return 0;
+    return s2u<uint64_t>(g[v].tPeriod);
+  }
+
+  uint64_t getOffs(const Graph& g, vertex_t v) {
+    if (g[v].np != nullptr) return boost::dynamic_pointer_cast<Event>(g[v].np)->getTOffs();
+    if (g[v].tOffs == DotStr::Misc::sUndefined64) return 0;
+    return s2u<uint64_t>(g[v].tOffs);
+  }
+
+  int getCpu(const Graph& g, vertex_t v) {
+    if (g[v].np != nullptr) return g[v].np->getCpu();
+    if (g[v].cpu == DotStr::Misc::sUndefined) return -1;
+    return s2u<uint8_t>(g[v].cpu);
+  }
+
+  int getThread(const Graph& g, vertex_t v) {
+    if (g[v].np != nullptr) {
+      if (g[v].type == dnt::sOrigin)      return boost::dynamic_pointer_cast<Origin>(g[v].np)->getThread();
+      if (g[v].type == dnt::sStartThread) return boost::dynamic_pointer_cast<StartThread>(g[v].np)->getThread();
+      return thrUnknown;
+    }
+    if (g[v].thread == DotStr::Misc::sUndefined) return thrUnknown;
+    return s2u<uint8_t>(g[v].thread);
+  }
+
+  vertex_t getDefDst(const Graph& g, vertex_t v) {
+    Graph::out_edge_iterator out_begin, out_end, out_cur;
+    boost::tie(out_begin, out_end) = out_edges(v, g);
+    for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+      if (g[*out_cur].type == det::sDefDst && isProcessed(g, target(*out_cur, g))) return target(*out_cur, g);
+    }
+    return null_vertex;
+  }
+
+  // Most due times falling into any window of length w on the circular timeline t (sorted, all < period)
+  uint32_t maxInWindow(const std::vector<uint64_t>& t, uint64_t period, uint64_t w) {
+    if (t.empty() || period == 0) return 0;
+    uint32_t full = (w / period) * t.size();
+    uint64_t rest = w % period;
+    if (rest == 0) return full; // the scan below needs a window of nonzero length, else j can stay behind i on equal due times
+    std::vector<uint64_t> tt(t);
+    for (auto x : t) tt.push_back(x + period);
+    uint32_t best = 0;
+    for (unsigned i = 0, j = 0; i < t.size(); i++) {
+      while (j < tt.size() && tt[j] < tt[i] + rest) j++;
+      best = std::max(best, (uint32_t)(j - i));
+    }
+    return full + best;
+  }
+
+  // Smallest distance between two consecutive due times on the circular timeline t (sorted, all < period)
+  uint64_t minSpacing(const std::vector<uint64_t>& t, uint64_t period) {
+    if (t.empty()) return uUndefined64;
+    uint64_t ret = period - t.back() + t.front();
+    for (unsigned i = 1; i < t.size(); i++) ret = std::min(ret, t[i] - t[i-1]);
+    return ret;
+  }
+
+}
+
+using namespace TimingAnalysis;
+
+/** Static timing analysis of schedule graph g, no upload necessary.
+ * Every cycle along defdst edges is walked once as a thread would, accumulating block periods (tPeriod) and event
+ * offsets (tOffs) into due times per cycle. Threads are identified by origin/startthread nodes leading into a cycle,
+ * their preptime is read from the DM if possible, else PREPTIME_DEFAULT is assumed.
+ * Per CPU, the average dispatch rate is the sum of all cycles, the peak rate and worst case backlog assume all threads
+ * aligned: the most nodes falling into one preptime window must be processed at nodeCost ns each before their deadline.
+ * Paths ending without a cycle are finite and do not contribute to sustained load.
+ * Returns true if no CPU is predicted to fall behind.
+ */
+bool CarpeDM::CarpeDMimpl::timingAnalysis(Graph& g, std::vector<TimingReport>& vTr, std::string& report) {
+  std::stringstream ss;
+  std::vector<ThreadCycle> cycles;
+  std::vector<int> colour(num_vertices(g), 0); // 0 unseen, 1 on current walk, 2 done
+  std::map<vertex_t, unsigned> cycleOf;
+
+  // find all cycles. each walk stops at the first vertex seen before, so every vertex is walked only once
+  BOOST_FOREACH( vertex_t v, vertices(g) ) {
+    if (colour[v] || !isProcessed(g, v)) continue;
+    std::vector<vertex_t> walk;
+    vertex_t w = v;
+    while (w != null_vertex && colour[w] == 0) { colour[w] = 1; walk.push_back(w); w = getDefDst(g, w); }
+    if (w != null_vertex && colour[w] == 1) {
+      ThreadCycle c;
+      auto itStart = std::find(walk.begin(), walk.end(), w);
+      c.nodes.assign(itStart, walk.end());
+      // rotate so the cycle starts right after a block. Block time base is then 0 for the first event
+      auto itBlock = std::find_if(c.nodes.begin(), c.nodes.end(), [&g](vertex_t x) { return isBlockType(g[x].type); });
+      if (itBlock != c.nodes.end()) std::rotate(c.nodes.begin(), itBlock + 1, c.nodes.end());
+      for (auto x : c.nodes) cycleOf[x] = cycles.size();
+      cycles.push_back(c);
+    }
+    for (auto x : walk) colour[x] = 2;
+  }
+
+  // threads: follow origin/startthread destinations until a cycle is hit
+  BOOST_FOREACH( vertex_t v, vertices(g) ) {
+    if (g[v].type != dnt::sOrigin && g[v].type != dnt::sStartThread) continue;
+    int thr = getThread(g, v);
+    if (thr == thrUnknown) continue;
+    Graph::out_edge_iterator out_begin, out_end, out_cur;
+    boost::tie(out_begin, out_end) = out_edges(v, g);
+    for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+      if (g[*out_cur].type != det::sOriginDst) continue;
+      vertex_t w = target(*out_cur, g);
+      std::set<vertex_t> seen;
+      while (w != null_vertex && isProcessed(g, w) && cycleOf.find(w) == cycleOf.end() && seen.insert(w).second) w = getDefDst(g, w);
+      if (w != null_vertex && cycleOf.find(w) != cycleOf.end()) cycles[cycleOf[w]].thread = thr;
+    }
+  }
+
+  // due times per cycle
+  for (auto& c : cycles) {
+    uint64_t tBase = 0;
+    c.cpu = getCpu(g, c.nodes[0]);
+    for (auto x : c.nodes) {
+      if (isBlockType(g[x].type)) { c.tNodes.push_back(tBase); tBase += getPeriod(g, x); }
+      else {
+        uint64_t t = tBase + getOffs(g, x);
+        c.tNodes.push_back(t);
+        if (g[x].type == dnt::sTMsg) c.tMsgs.push_back(t);
+      }
+    }
+    c.period = tBase;
+    if (c.period == 0) throw std::runtime_error(exIntro + "Cycle through node <" + g[c.nodes[0]].name + "> has no block period. A thread would loop without ever advancing time");
+    // offsets may exceed the block period, fold everything into one cycle
+    for (auto& t : c.tNodes) t %= c.period;
+    for (auto& t : c.tMsgs)  t %= c.period;
+    std::sort(c.tNodes.begin(), c.tNodes.end());
+    std::sort(c.tMsgs.begin(), c.tMsgs.end());
+  }
+
+  // per CPU
+  std::map<int, TimingReport> mTr;
+  ss << std::left << std::setfill(' ') << std::setw(32) << "Cycle" << std::right << std::setw(5) << "Cpu" << std::setw(5) << "Thr" << std::setw(6) << "Nodes"
+     << std::setw(16) << "Period/ns" << std::setw(12) << "Msg/s" << std::setw(16) << "MinSpacing/ns" << std::setw(10) << "Burst" << std::endl;
+  for (auto& c : cycles) {
+    uint64_t prepTime = PREPTIME_DEFAULT;
+    if (c.thread != thrUnknown && c.cpu >= 0) {
+      try { prepTime = getThrPrepTime(c.cpu, c.thread); } catch (...) { prepTime = PREPTIME_DEFAULT; }
+      if (prepTime == 0) prepTime = PREPTIME_DEFAULT;
+    }
+    uint32_t burst     = maxInWindow(c.tNodes, c.period, prepTime);
+    uint32_t burstMsgs = maxInWindow(c.tMsgs,  c.period, prepTime);
+    uint64_t spacing   = minSpacing(c.tMsgs, c.period);
+
+    if (mTr.find(c.cpu) == mTr.end()) {
+      TimingReport tr = {};
+      tr.cpu = c.cpu; tr.prepTime = prepTime; tr.minSpacing = uUndefined64;
+      mTr[c.cpu] = tr;
+    }
+    TimingReport& tr = mTr[c.cpu];
+    tr.cycles++;
+    tr.avgMsgRate  += (double)c.tMsgs.size()  * 1000000000.0 / (double)c.period;
+    tr.avgNodeRate += (double)c.tNodes.size() * 1000000000.0 / (double)c.period;
+    tr.peakMsgRate += (double)burstMsgs * 1000000000.0 / (double)prepTime;
+    tr.burstNodes  += burst;
+    tr.minSpacing   = std::min(tr.minSpacing, spacing);
+    tr.prepTime     = std::min(tr.prepTime, prepTime);
+
+    ss << std::left << std::setw(32) << g[c.nodes[0]].name << std::right << std::setw(5) << c.cpu << std::setw(5) << (c.thread == thrUnknown ? "-" : std::to_string(c.thread))
+       << std::setw(6) << c.nodes.size() << std::setw(16) << c.period << std::setw(12) << std::fixed << std::setprecision(1) << (double)c.tMsgs.size() * 1000000000.0 / (double)c.period
+       << std::setw(16) << (spacing == uUndefined64 ? "-" : std::to_string(spacing)) << std::setw(10) << burst << std::endl;
+  }
+
+  bool ok = true;
+  vTr.clear();
+  ss << std::endl << std::setw(4) << "Cpu" << std::setw(7) << "Cycles" << std::setw(12) << "Avg Msg/s" << std::setw(14) << "Peak Msg/s"
+     << std::setw(16) << "MinSpacing/ns" << std::setw(8) << "Load" << std::setw(8) << "Burst" << std::setw(10) << "Backlog" << std::endl;
+  for (auto& it : mTr) {
+    TimingReport& tr = it.second;
+    tr.nodeCost    = timingNodeCost;
+    tr.utilisation = tr.avgNodeRate * (double)timingNodeCost / 1000000000.0;
+    // nodes which cannot be processed within the tightest preptime window if all threads are aligned
+    uint64_t capacity = tr.prepTime / std::max(timingNodeCost, (uint64_t)1);
+    tr.backlog  = (tr.burstNodes > capacity) ? tr.burstNodes - capacity : 0;
+    tr.overload = (tr.utilisation >= 1.0) || (tr.backlog > 0);
+    ok &= !tr.overload;
+    vTr.push_back(tr);
+
+    ss << std::setw(4) << (tr.cpu < 0 ? "-" : std::to_string(tr.cpu)) << std::setw(7) << tr.cycles << std::setw(12) << tr.avgMsgRate << std::setw(14) << tr.peakMsgRate
+       << std::setw(16) << (tr.minSpacing == uUndefined64 ? "-" : std::to_string(tr.minSpacing)) << std::setw(7) << std::setprecision(0) << tr.utilisation * 100.0 << "%"
+       << std::setw(8) << tr.burstNodes << std::setw(10) << tr.backlog << std::setprecision(1) << (tr.overload ? "  OVERLOAD" : "") << std::endl;
+  }
+  ss << std::endl << "Assumed processing cost per node " << std::dec << timingNodeCost << " ns, " << cycles.size() << " cycles found" << std::endl;
+  report = ss.str();
+
+  return ok;
+}
+
+std::string CarpeDM::CarpeDMimpl::timingReportDot(const std::string& s) {
+  Graph gTmp;
+  std::vector<TimingReport> vTr;
+  std::string report;
+  parseDot(s, gTmp);
+  bool ok = timingAnalysis(gTmp, vTr, report);
+  return report + "Timing analysis: " + (ok ? "OK" : "OVERLOAD") + "\n";
+}
+
+std::string CarpeDM::CarpeDMimpl::timingReportDotFile(const std::string& fn) { return timingReportDot(readTextFile(fn)); }
+
+std::string CarpeDM::CarpeDMimpl::timingReportDown() {
+  std::vector<TimingReport> vTr;
+  std::string report;
+  download();
+  bool ok = timingAnalysis(gDown, vTr, report);
+  return report + "Timing analysis: " + (ok ? "OK" : "OVERLOAD") + "\n";
+}
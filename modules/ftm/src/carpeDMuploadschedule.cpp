@@ -31,7 +31,6 @@ using namespace DotStr::Misc;
   //TODO NC Traffic Verification
 
 
-  //TODO CPU Load Balancer
   vEbwrs CarpeDM::CarpeDMimpl::gatherUploadVector(std::set<uint8_t> moddedCpus, uint32_t modCnt, uint8_t opType) {
     //sLog << "Starting Upload address & data vectors" << std::endl;
     vEbwrs ew;
@@ -262,10 +261,56 @@ using namespace DotStr::Misc;
     for (auto eRm : vEdges2remove) boost::remove_edge(eRm, g);
   }
 
+  /** Create the data object for vertex v of graph g from its .dot properties.
+   * Hash and cpu are taken from the allocation, not from the vertex.
+   */
+  node_ptr CarpeDM::CarpeDMimpl::createNodeObject(Graph& g, vertex_t v, uint32_t hash, uint8_t cpu) {
+    uint32_t flags;
+    node_ptr np;
+    const std::string& cmp = g[v].type;
+
+    //add flags for beam process and pattern entry and exit points
+    try {
+    flags = ((s2u<bool>(g[v].bpEntry))  << NFLG_BP_ENTRY_LM32_POS)
+          | ((s2u<bool>(g[v].bpExit))   << NFLG_BP_EXIT_LM32_POS)
+          | ((s2u<bool>(g[v].patEntry)) << NFLG_PAT_ENTRY_LM32_POS)
+          | ((s2u<bool>(g[v].patExit))  << NFLG_PAT_EXIT_LM32_POS);
+
+    } catch (std::runtime_error const& err) {
+      throw std::runtime_error( "Parser error when processing pattern/BP entry/exit tags of node <" + g[v].name + ">. Cause: " + err.what());
+    }
+
+    try{
+          // TODO most of this shit should be in constructor
+           if (cmp == dnt::sTMsg)        {completeId(v, g); // create ID from SubId fields or vice versa
+                                          np = (node_ptr) new  TimingMsg(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tOffs), s2u<uint64_t>(g[v].id), s2u<uint64_t>(g[v].par), s2u<uint32_t>(g[v].tef), s2u<uint32_t>(g[v].res)); }
+      else if (cmp == dnt::sCmdNoop)     {np = (node_ptr) new       Noop(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tOffs), s2u<uint64_t>(g[v].tValid), s2u<uint8_t>(g[v].prio), s2u<uint32_t>(g[v].qty), s2u<bool>(g[v].vabs)); }
+      else if (cmp == dnt::sCmdFlow)     {np = (node_ptr) new       Flow(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tOffs), s2u<uint64_t>(g[v].tValid), s2u<uint8_t>(g[v].prio), s2u<uint32_t>(g[v].qty), s2u<bool>(g[v].vabs), s2u<bool>(g[v].perma)); }
+      else if (cmp == dnt::sSwitch)      {np = (node_ptr) new     Switch(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tOffs) ); }
+      else if (cmp == dnt::sOrigin)      {np = (node_ptr) new     Origin(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tOffs), s2u<uint8_t>(g[v].thread)); }
+      else if (cmp == dnt::sStartThread) {np = (node_ptr) new     StartThread(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tOffs), s2u<uint64_t>(g[v].startOffs), s2u<uint8_t>(g[v].thread)); }
+      else if (cmp == dnt::sCmdFlush)    {np = (node_ptr) new      Flush(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tOffs), s2u<uint64_t>(g[v].tValid), s2u<uint8_t>(g[v].prio),
+                                                                            s2u<bool>(g[v].qIl), s2u<bool>(g[v].qHi), s2u<bool>(g[v].qLo), s2u<bool>(g[v].vabs), s2u<bool>(g[v].perma), s2u<uint8_t>(g[v].frmIl), s2u<uint8_t>(g[v].toIl), s2u<uint8_t>(g[v].frmHi),
+                                                                            s2u<uint8_t>(g[v].toHi), s2u<uint8_t>(g[v].frmLo), s2u<uint8_t>(g[v].toLo) ); }
+      else if (cmp == dnt::sCmdWait)     {np = (node_ptr) new       Wait(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tOffs), s2u<uint64_t>(g[v].tValid), s2u<uint8_t>(g[v].prio), s2u<uint64_t>(g[v].tWait), s2u<bool>(g[v].vabs)); }
+      else if (cmp == dnt::sBlock)       {np = (node_ptr) new BlockFixed(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tPeriod) ); }
+      else if (cmp == dnt::sBlockFixed)  {np = (node_ptr) new BlockFixed(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tPeriod) ); }
+      else if (cmp == dnt::sBlockAlign)  {np = (node_ptr) new BlockAlign(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags, s2u<uint64_t>(g[v].tPeriod) ); }
+      else if (cmp == dnt::sQInfo)       {np = (node_ptr) new   CmdQMeta(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags);}
+      else if (cmp == dnt::sDstList)     {np = (node_ptr) new   DestList(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags);}
+      else if (cmp == dnt::sQBuf)        {np = (node_ptr) new CmdQBuffer(g[v].name, g[v].patName, g[v].bpName, hash, cpu, flags);}
+      else if (cmp == dnt::sMeta)        {throw std::runtime_error("Pure meta type not yet implemented");}
+      //FIXME try to get info from download
+      else                        {throw std::runtime_error("Node <" + g[v].name + ">'s type <" + cmp + "> is not supported!\nMost likely you forgot to set the type attribute or accidentally created the node by a typo in an edge definition.");}
+    } catch (std::runtime_error const& err) {
+      throw std::runtime_error( "Failed to create data object for node <" + g[v].name + "> of type <" + cmp + ">. Cause: " + err.what());
+    }
+    return np;
+  }
+
   void CarpeDM::CarpeDMimpl::prepareUpload() {
 
-    std::string cmp;
-    uint32_t hash, flags;
+    uint32_t hash;
     uint8_t cpu;
     int allocState;
 
@@ -283,16 +328,6 @@ using namespace DotStr::Misc;
         } catch (std::runtime_error const& err) {
           throw std::runtime_error( "Parser error when processing cpu tags of node <" + name + ">. Cause: " + err.what());
         }
-        //add flags for beam process and pattern entry and exit points
-        try {
-        flags = ((s2u<bool>(gUp[v].bpEntry))  << NFLG_BP_ENTRY_LM32_POS)
-              | ((s2u<bool>(gUp[v].bpExit))   << NFLG_BP_EXIT_LM32_POS)
-              | ((s2u<bool>(gUp[v].patEntry)) << NFLG_PAT_ENTRY_LM32_POS)
-              | ((s2u<bool>(gUp[v].patExit))  << NFLG_PAT_EXIT_LM32_POS);
-
-        } catch (std::runtime_error const& err) {
-          throw std::runtime_error( "Parser error when processing pattern/BP entry/exit tags of node <" + name + ">. Cause: " + err.what());
-        }
 
         amI it = atUp.lookupHashNoEx(hash); //if we already have a download entry, keep allocation, but update vertex index
         if (!atUp.isOk(it)) {
@@ -308,46 +343,19 @@ using namespace DotStr::Misc;
         //Ugly as hell. But otherwise the bloody iterator will only allow access to MY alloc buffers (not their pointers!) as const!
         auto* x = (AllocMeta*)&(*it);
 
-        try{
         // add timing node data objects to vertices
-        if(gUp[v].np == nullptr) {
-
-          cmp = gUp[v].type;
-
-              // TODO most of this shit should be in constructor
-               if (cmp == dnt::sTMsg)        {completeId(v, gUp); // create ID from SubId fields or vice versa
-                                              gUp[v].np = (node_ptr) new  TimingMsg(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tOffs), s2u<uint64_t>(gUp[v].id), s2u<uint64_t>(gUp[v].par), s2u<uint32_t>(gUp[v].tef), s2u<uint32_t>(gUp[v].res)); }
-          else if (cmp == dnt::sCmdNoop)     {gUp[v].np = (node_ptr) new       Noop(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tOffs), s2u<uint64_t>(gUp[v].tValid), s2u<uint8_t>(gUp[v].prio), s2u<uint32_t>(gUp[v].qty), s2u<bool>(gUp[v].vabs)); }
-          else if (cmp == dnt::sCmdFlow)     {gUp[v].np = (node_ptr) new       Flow(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tOffs), s2u<uint64_t>(gUp[v].tValid), s2u<uint8_t>(gUp[v].prio), s2u<uint32_t>(gUp[v].qty), s2u<bool>(gUp[v].vabs), s2u<bool>(gUp[v].perma)); }
-          else if (cmp == dnt::sSwitch)      {gUp[v].np = (node_ptr) new     Switch(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tOffs) ); }
-          else if (cmp == dnt::sOrigin)      {gUp[v].np = (node_ptr) new     Origin(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tOffs), s2u<uint8_t>(gUp[v].thread)); }
-          else if (cmp == dnt::sStartThread) {gUp[v].np = (node_ptr) new     StartThread(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tOffs), s2u<uint64_t>(gUp[v].startOffs), s2u<uint8_t>(gUp[v].thread)); }
-          else if (cmp == dnt::sCmdFlush)    {gUp[v].np = (node_ptr) new      Flush(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tOffs), s2u<uint64_t>(gUp[v].tValid), s2u<uint8_t>(gUp[v].prio),
-                                                                                s2u<bool>(gUp[v].qIl), s2u<bool>(gUp[v].qHi), s2u<bool>(gUp[v].qLo), s2u<bool>(gUp[v].vabs), s2u<bool>(gUp[v].perma), s2u<uint8_t>(gUp[v].frmIl), s2u<uint8_t>(gUp[v].toIl), s2u<uint8_t>(gUp[v].frmHi),
-                                                                                s2u<uint8_t>(gUp[v].toHi), s2u<uint8_t>(gUp[v].frmLo), s2u<uint8_t>(gUp[v].toLo) ); }
-          else if (cmp == dnt::sCmdWait)     {gUp[v].np = (node_ptr) new       Wait(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tOffs), s2u<uint64_t>(gUp[v].tValid), s2u<uint8_t>(gUp[v].prio), s2u<uint64_t>(gUp[v].tWait), s2u<bool>(gUp[v].vabs)); }
-          else if (cmp == dnt::sBlock)       {gUp[v].np = (node_ptr) new BlockFixed(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tPeriod) ); }
-          else if (cmp == dnt::sBlockFixed)  {gUp[v].np = (node_ptr) new BlockFixed(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tPeriod) ); }
-          else if (cmp == dnt::sBlockAlign)  {gUp[v].np = (node_ptr) new BlockAlign(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags, s2u<uint64_t>(gUp[v].tPeriod) ); }
-          else if (cmp == dnt::sQInfo)       {gUp[v].np = (node_ptr) new   CmdQMeta(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags);}
-          else if (cmp == dnt::sDstList)     {gUp[v].np = (node_ptr) new   DestList(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags);}
-          else if (cmp == dnt::sQBuf)        {gUp[v].np = (node_ptr) new CmdQBuffer(gUp[v].name, gUp[v].patName, gUp[v].bpName, x->hash, x->cpu, flags);}
-          else if (cmp == dnt::sMeta)        {throw std::runtime_error("Pure meta type not yet implemented"); return;}
-          //FIXME try to get info from download
-          else                        {throw std::runtime_error("Node <" + gUp[v].name + ">'s type <" + cmp + "> is not supported!\nMost likely you forgot to set the type attribute or accidentally created the node by a typo in an edge definition."); return;}
-        }
-        } catch (std::runtime_error const& err) {
-          throw std::runtime_error( "Failed to create data object for node <" + name + "> of type <" + cmp + ">. Cause: " + err.what());
-        }
+        if(gUp[v].np == nullptr) gUp[v].np = createNodeObject(gUp, v, x->hash, x->cpu);
     }
 
-    // Crawl vertices and serialise their data objects for upload
+    // Crawl staged vertices and serialise their data objects for upload. Only staged nodes are uploaded, all others were downloaded
+    // unchanged and their alloctable buffers still hold the DM's content. Their node objects are shared with gDown, leave them alone
     BOOST_FOREACH( vertex_t v, vertices(gUp) ) {
+      auto x = atUp.lookupVertex(v);
+      if (!x->staged) continue;
 
-      gUp[v].np->accept(VisitorUploadCrawler(gUp, v, atUp, sLog, sErr));
+      writableNode(gUp[v])->accept(VisitorUploadCrawler(gUp, v, atUp, sLog, sErr));
 
       //Check if all mandatory fields were properly initialised
-      auto x = atUp.lookupVertex(v);
       std::string haystack(x->b, x->b + _MEM_BLOCK_SIZE);
       std::size_t n = haystack.find(DotStr::Misc::needle);
 
@@ -429,6 +437,7 @@ using namespace DotStr::Misc;
     ebd.writeCycle(ew.va, ew.vb, ew.vcs);
     if(verbose) sLog << "Done." << std::endl;
     freshDownload = false;
+    schedVersion++;
     return ew.va.size();
 
   }
@@ -445,8 +454,9 @@ using namespace DotStr::Misc;
     atUp.cpyWithoutMgmt(atDown);
     // for some reason, copy_graph does not copy the name
     //boost::set_property(gTmp, boost::graph_name, boost::get_property(g, boost::graph_name));
+    // share the downloaded node objects, only the ones changed by the operation get cloned (writableNode)
     vertex_map_t vmap;
-    mycopy_graph<Graph>(gDown, gUp, vmap);
+    sharedcopy_graph(gDown, gUp, vmap);
   }
 
   void CarpeDM::CarpeDMimpl::addition(Graph& gTmp) {
@@ -648,6 +658,9 @@ using namespace DotStr::Misc;
     if ((boost::get_property(g, boost::graph_name)).find(DotStr::Graph::Special::sCmd) != std::string::npos) {throw std::runtime_error("Expected a schedule, but these appear to be commands (Tag '" + DotStr::Graph::Special::sCmd + "' found in graphname)"); return -1;}
     if(verbose) sLog << "Download binary as base for addition" << std::endl;
     baseUploadOnDownload();
+    std::string report;
+    assignNodesToCpus(g, gUp, atUp, report);
+    if(verbose) sLog << "CPU assignment" << std::endl << report << std::endl;
     if(verbose) sLog << "Add new subgraph" << std::endl;
     addition(g);
     //writeUpDotFile("upload.dot", false);
@@ -721,6 +734,176 @@ using namespace DotStr::Misc;
     return upload(OP_TYPE_SCH_KEEP, vQr);
   }
 
+  /** Bring the schedule on the DM in line with the schedule in g, touching only what differs.
+   * Nodes are matched by hash. Nodes not in g are removed, nodes not on the DM are added.
+   * Matched nodes with a different cpu or type are removed and added again. Matched nodes with
+   * different properties get a new data object, matched nodes with different outgoing edges are
+   * rewired. Only changed nodes are staged, so the upload carries just the delta.
+   */
+  int CarpeDM::CarpeDMimpl::sync(Graph& g, bool force) {
+    if ((boost::get_property(g, boost::graph_name)).find(DotStr::Graph::Special::sCmd) != std::string::npos) {throw std::runtime_error("Expected a schedule, but these appear to be commands (Tag '" + DotStr::Graph::Special::sCmd + "' found in graphname)"); return -1;}
+    // flags given by the .dot properties. All others are runtime state of the DM or derived from edges during upload
+    const uint32_t dotFlags  = NFLG_TYPE_SMSK | NFLG_BP_ENTRY_LM32_SMSK | NFLG_BP_EXIT_LM32_SMSK | NFLG_PAT_ENTRY_LM32_SMSK | NFLG_PAT_EXIT_LM32_SMSK;
+    // flags the upload crawler sets from edges (for blocks, the same bits hold the queue flags)
+    const uint32_t edgeFlags = NFLG_TMSG_DYN_ID_SMSK | NFLG_TMSG_DYN_PAR_SMSK | NFLG_TMSG_DYN_PAR0_SMSK | NFLG_TMSG_DYN_PAR1_SMSK | NFLG_TMSG_DYN_TEF_SMSK | NFLG_TMSG_DYN_RES_SMSK;
+
+    baseUploadOnDownload();
+
+    // nodes already on the DM stay on their cpu unless the target says otherwise
+    BOOST_FOREACH( vertex_t w, vertices(g) ) {
+      amI x = atUp.lookupHashNoEx(g[w].hash);
+      if (atUp.isOk(x) && g[w].cpu == sUndefined) g[w].cpu = std::to_string((int)x->cpu);
+    }
+    std::string report;
+    assignNodesToCpus(g, gUp, atUp, report);
+    if(verbose) sLog << "CPU assignment" << std::endl << report << std::endl;
+    generateBlockMeta(g);
+
+    //compare all nodes present on both sides
+    std::set<uint32_t> targetHashes, replaced, kept;
+    std::map<uint32_t, node_ptr> modified;
+    BOOST_FOREACH( vertex_t w, vertices(g) ) {
+      targetHashes.insert(g[w].hash);
+      amI x = atUp.lookupHashNoEx(g[w].hash);
+      if (!atUp.isOk(x) || g[w].type == sUndefined) continue;
+      vertex_t v = x->v;
+      uint8_t cpu;
+      try {
+        cpu = s2u<uint8_t>(g[w].cpu);
+      } catch (std::runtime_error const& err) {
+        throw std::runtime_error( "Parser error when processing cpu tags of node <" + g[w].name + ">. Cause: " + err.what());
+      }
+      node_ptr np = createNodeObject(g, w, x->hash, cpu);
+      if (cpu != x->cpu || ((np->getFlags() ^ gUp[v].np->getFlags()) & NFLG_TYPE_SMSK)) {
+        if (verbose) sLog << "Replacing " << g[w].name << std::endl;
+        replaced.insert(x->hash);
+        continue;
+      }
+      kept.insert(x->hash);
+      if (np->isMeta()) continue; // queues and destination lists follow their block
+
+      // take over what the .dot file does not describe, then compare the remaining properties
+      np->clrFlags(~dotFlags);
+      np->setFlags(gUp[v].np->getFlags() & ~dotFlags);
+      if (np->isBlock()) {
+        boost::dynamic_pointer_cast<Block>(np)->setRdIdxs(boost::dynamic_pointer_cast<Block>(gUp[v].np)->getRdIdxs());
+        boost::dynamic_pointer_cast<Block>(np)->setWrIdxs(boost::dynamic_pointer_cast<Block>(gUp[v].np)->getWrIdxs());
+      }
+      VertexText sTarget, sCurrent;
+      np->accept(VisitorVertexWriter(sTarget));
+      gUp[v].np->accept(VisitorVertexWriter(sCurrent));
+      if (sTarget.s != sCurrent.s) modified[x->hash] = np;
+    }
+
+    //remove nodes not in the target and nodes which changed cpu or type
+    Graph gTmpRemove;
+    BOOST_FOREACH( vertex_t v, vertices(gUp) ) {
+      if (!targetHashes.count(gUp[v].hash) || replaced.count(gUp[v].hash)) boost::add_vertex(myVertex(gUp[v]), gTmpRemove);
+    }
+    std::vector<QueueReport> vQr;
+    CovenantTable ctAdditions;
+    if (num_vertices(gTmpRemove) > 0) {
+      std::string safetyReport;
+      bool isSafe = isSafeToRemove(gTmpRemove, safetyReport, vQr, ctAdditions);
+      if (!(force | (isSafe))) {throw std::runtime_error("//Subgraph cannot safely be removed!\n\n" + safetyReport);}
+      if(verbose) sLog << "Remove " << num_vertices(gTmpRemove) << " nodes" << std::endl;
+      subtraction(gTmpRemove);
+    }
+
+    //add nodes not on the DM. Edges to nodes on the DM become implicit duplicates, addition merges them
+    Graph gTmpAdd;
+    vertex_map_t vertexMap;
+    std::vector<vertex_t> vNew;
+    BOOST_FOREACH( vertex_t w, vertices(g) ) {
+      if (g[w].type == sUndefined || atUp.isOk(atUp.lookupHashNoEx(g[w].hash))) continue;
+      vertexMap[w] = boost::add_vertex(myVertex(g[w]), gTmpAdd);
+      vNew.push_back(w);
+    }
+    Graph::out_edge_iterator out_begin, out_end, out_cur;
+    for (auto w : vNew) {
+      boost::tie(out_begin, out_end) = out_edges(w, g);
+      for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+        vertex_t wDst = target(*out_cur, g);
+        if (!vertexMap.count(wDst)) {
+          vertexMap[wDst] = boost::add_vertex(myVertex(g[wDst]), gTmpAdd);
+          gTmpAdd[vertexMap[wDst]].type = sUndefined;
+        }
+        boost::add_edge(vertexMap[w], vertexMap[wDst], myEdge(g[*out_cur].type), gTmpAdd);
+      }
+    }
+    if (!vNew.empty()) {
+      if(verbose) sLog << "Add " << vNew.size() << " nodes" << std::endl;
+      addition(gTmpAdd);
+    }
+
+    //update kept nodes in place: new data object on changed properties, rewire changed outgoing edges
+    bool inPlace = false;
+    BOOST_FOREACH( vertex_t w, vertices(g) ) {
+      if (!kept.count(g[w].hash)) continue;
+      vertex_t v = atUp.lookupHash(g[w].hash)->v;
+
+      auto itMod = modified.find(g[w].hash);
+      if (itMod != modified.end()) {
+        if(isCovenantPending(gUp[v].name)) {
+          sLog << "Node <" << gUp[v].name << "> has an active covenant. Skipping property update to avoid race condition." << std::endl;
+        } else {
+          if (verbose) sLog << "Updating " << g[w].name << std::endl;
+          gUp[v] = g[w];
+          gUp[v].np = itMod->second;
+          try {
+            gt.setBeamproc(gUp[v].name, gUp[v].bpName, (s2u<bool>(gUp[v].bpEntry)), (s2u<bool>(gUp[v].bpExit)));
+            gt.setPattern(gUp[v].name, gUp[v].patName, (s2u<bool>(gUp[v].patEntry)), (s2u<bool>(gUp[v].patExit)));
+          } catch (std::runtime_error const& err) {
+            throw std::runtime_error( "Parser error when processing entry/exit tags of node <" + gUp[v].name + ">. Cause: " + err.what());
+          }
+          atUp.setStaged(atUp.lookupVertex(v));
+          inPlace = true;
+        }
+      }
+
+      std::set<std::pair<std::string, uint32_t>> edgesTarget, edgesCurrent;
+      boost::tie(out_begin, out_end) = out_edges(w, g);
+      for (out_cur = out_begin; out_cur != out_end; ++out_cur) { edgesTarget.insert(std::make_pair(g[*out_cur].type, g[target(*out_cur, g)].hash)); }
+
+      std::vector<edge_t> vEdges2remove;
+      boost::tie(out_begin, out_end) = out_edges(v, gUp);
+      for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+        auto edge = std::make_pair(gUp[*out_cur].type, gUp[target(*out_cur, gUp)].hash);
+        edgesCurrent.insert(edge);
+        if (!edgesTarget.count(edge)) vEdges2remove.push_back(*out_cur);
+      }
+      bool rewired = !vEdges2remove.empty();
+      for (auto eRm : vEdges2remove) {
+        updateStaging(v, eRm);
+        boost::remove_edge(eRm, gUp);
+      }
+      for (auto& edge : edgesTarget) {
+        if (edgesCurrent.count(edge)) continue;
+        vertex_t vDst = atUp.lookupHash(edge.second, "Edge from node <" + g[w].name + "> leads to a node which is neither in the schedule nor on the DM")->v;
+        updateStaging(v, boost::add_edge(v, vDst, myEdge(edge.first), gUp).first);
+        rewired = true;
+      }
+      if (rewired) {
+        if (verbose) sLog << "Rewiring " << g[w].name << std::endl;
+        writableNode(gUp[v])->clrFlags(edgeFlags);
+        inPlace = true;
+      }
+    }
+
+    if (num_vertices(gTmpRemove) == 0 && vNew.empty() && !inPlace) {
+      if(verbose) sLog << "Schedule on DM already matches, nothing to upload" << std::endl;
+      return 0;
+    }
+    if (inPlace) {
+      prepareUpload();
+      atUp.syncBmpsToPools();
+    }
+    validate(gUp, atUp, force);
+    addCovenants(ctAdditions);
+    if(verbose) sLog << "Upload" << std::endl;
+    return upload(OP_TYPE_SCH_SYNC, vQr);
+  }
+
   int CarpeDM::CarpeDMimpl::clear_raw(bool force) {
     nullify(); // read out current time for upload mod time (seconds, but probably better to use same format as DM FW. Convert to ns)
     // check if there are any threads still running first
@@ -740,6 +923,9 @@ using namespace DotStr::Misc;
   int CarpeDM::CarpeDMimpl::overwrite(Graph& g, bool force) {
     if ((boost::get_property(g, boost::graph_name)).find(DotStr::Graph::Special::sCmd) != std::string::npos) {throw std::runtime_error("Expected a schedule, but these appear to be commands (Tag '" + DotStr::Graph::Special::sCmd + "' found in graphname)"); return -1;}
     nullify();
+    std::string report;
+    assignNodesToCpus(g, gUp, atUp, report);
+    if(verbose) sLog << "CPU assignment" << std::endl << report << std::endl;
     addition(g);
     //writeUpDotFile("upload.dot", false);
     validate(gUp, atUp, force);
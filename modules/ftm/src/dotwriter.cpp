@@ -0,0 +1,112 @@
+#include <unordered_map>
+#include <vector>
+#include "dotwriter.h"
+#include "node.h"
+#include "visitorvertexwriter.h"
+#include "dotstr.h"
+
+namespace ec  = DotStr::EyeCandy;
+namespace dep = DotStr::Edge::Prop;
+namespace det = DotStr::Edge::TypeVal;
+
+// Writes the same text as boost::write_graphviz did with the former property writers, but appends
+// everything to one string: no stream formatting, vertex IDs are escaped once and reused for the
+// edges, edge attributes are built once per edge type.
+namespace {
+
+  // true if name is an ID or a number in the dot language and needs no quotes, same rule as boost::escape_dot_string
+  bool isPlainId(const std::string& s) {
+    auto isAlpha = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); };
+    auto isDigit = [](char c) { return (c >= '0' && c <= '9'); };
+    auto allDigits = [&](size_t from) {
+      for (size_t i = from; i < s.size(); i++) { if (!isDigit(s[i])) return false; }
+      return true;
+    };
+    if (s.empty()) return false;
+    if (isAlpha(s[0]) || s[0] == '_') {
+      for (size_t i = 1; i < s.size(); i++) { if (!(isAlpha(s[i]) || isDigit(s[i]) || s[i] == '_')) return false; }
+      return true;
+    }
+    size_t i = (s[0] == '-') ? 1 : 0;
+    if (i < s.size() && s[i] == '.') return allDigits(i + 1);
+    size_t j = i;
+    while (j < s.size() && isDigit(s[j])) j++;
+    if (j == i) return false;
+    if (j == s.size()) return true;
+    return (s[j] == '.') && allDigits(j + 1);
+  }
+
+  void appendId(std::string& out, const std::string& name) {
+    if (isPlainId(name)) { out += name; return; }
+    out += '"';
+    for (char c : name) {
+      if (c == '"') out += '\\';
+      out += c;
+    }
+    out += '"';
+  }
+
+  const std::string& edgeLook(const std::string& type) {
+    if      (type == det::sBadDefDst)    return ec::Edge::sLookbad;
+    else if (type == det::sDefDst)       return ec::Edge::sLookDefDst;
+    else if (type == det::sAltDst)       return ec::Edge::sLookAltDst;
+    else if (type == det::sCmdTarget)    return ec::Edge::sLookTarget;
+    else if (type == det::sSwitchTarget) return ec::Edge::sLookTarget;
+    else if (type == det::sCmdFlowDst)   return ec::Edge::sLookArgument;
+    else if (type == det::sSwitchDst)    return ec::Edge::sLookArgument;
+    else if (type == det::sCmdFlushOvr)  return ec::Edge::sLookArgument;
+    else if (type == det::sDynId)        return ec::Edge::sLookArgument;
+    else if (type == det::sDynPar0)      return ec::Edge::sLookArgument;
+    else if (type == det::sDynPar1)      return ec::Edge::sLookArgument;
+    else if (type == det::sDynTef)       return ec::Edge::sLookArgument;
+    else if (type == det::sDynRes)       return ec::Edge::sLookArgument;
+    else if (type == det::sDynFlowDst)   return ec::Edge::sLookDebug0;
+    else if (type == det::sResFlowDst)   return ec::Edge::sLookDebug1;
+    else if (type == det::sDomFlowDst)   return ec::Edge::sLookDebug2;
+    else                                 return ec::Edge::sLookMeta;
+  }
+
+}
+
+void writeDot(std::string& out, const Graph& g, bool filterMeta) {
+  VertexText text;
+  text.s.swap(out);
+  text.s.reserve(text.s.size() + num_vertices(g) * 384 + num_edges(g) * 64);
+
+  text.s += "digraph G {\n";
+  text.s += "graph [root=\"";
+  text.s += DotStr::Graph::sDefName;
+  text.s += "\",";
+  text.s += ec::Graph::sLookVert;
+  text.s += "]\n";
+  text.s += "node [";
+  text.s += ec::Node::Base::sLookDef;
+  text.s += "]\n";
+
+  std::vector<bool> keep(num_vertices(g), true);
+  std::vector<std::string> ids(num_vertices(g));
+  BOOST_FOREACH( vertex_t v, vertices(g) ) {
+    if (filterMeta && g[v].np != nullptr && g[v].np->isMeta()) { keep[v] = false; continue; }
+    appendId(ids[v], g[v].name);
+    text.s += ids[v];
+    if (g[v].np != nullptr) g[v].np->accept(VisitorVertexWriter(text));
+    text.s += ";\n";
+  }
+
+  std::unordered_map<std::string, std::string> edgeAttributes;
+  BOOST_FOREACH( edge_t e, edges(g) ) {
+    vertex_t vSrc = source(e, g), vDst = target(e, g);
+    if (!(keep[vSrc] && keep[vDst])) continue;
+    text.s += ids[vSrc];
+    text.s += "->";
+    text.s += ids[vDst];
+    text.s += ' ';
+    auto it = edgeAttributes.find(g[e].type);
+    if (it == edgeAttributes.end()) {
+      it = edgeAttributes.emplace(g[e].type, "[" + dep::Base::sType + "=\"" + g[e].type + "\", " + edgeLook(g[e].type) + "];\n").first;
+    }
+    text.s += it->second;
+  }
+  text.s += "}\n";
+  out.swap(text.s);
+}
@@ -86,4 +86,25 @@ myVertex::myVertex(myVertex const &src) {
   this->cmdDestPat  = src.cmdDestPat;
   this->cmdDestThr  = src.cmdDestThr;
 
-}
\ No newline at end of file
+}
+
+Graph& sharedcopy_graph(const Graph& original, Graph& cpy, vertex_map_t& vmap) {
+  BOOST_FOREACH( vertex_t v, vertices(original) ) {
+    vertex_t i = boost::add_vertex(cpy);
+    cpy[i] = original[v]; // assignment does not clone the node object, unlike the copy constructor
+    vmap[v] = i;
+  }
+  BOOST_FOREACH( vertex_t v, vertices(original) ) {
+    Graph::out_edge_iterator out_begin, out_end, out_cur;
+    boost::tie(out_begin, out_end) = out_edges(v, original);
+    for (out_cur = out_begin; out_cur != out_end; ++out_cur) {
+      boost::add_edge(vmap[v], vmap[target(*out_cur, original)], original[*out_cur], cpy);
+    }
+  }
+  return cpy;
+}
+
+node_ptr& writableNode(myVertex& vertex) {
+  if (vertex.np != nullptr && !vertex.np.unique()) vertex.np = vertex.np->clone();
+  return vertex.np;
+}
@@ -16,27 +16,45 @@ namespace ssi = DotStr::Node::Prop::TMsg::SubId;
 
 using namespace DotStr::Misc;
 
+void VisitorVertexWriter::pushNumber(uint64_t v, bool hex, unsigned width) const {
+  static const char digits[] = "0123456789abcdef";
+  char buf[20];
+  char* p = buf + sizeof(buf);
+  const unsigned base = (hex ? 16 : 10);
+  do { *--p = digits[v % base]; v /= base; } while (v);
+  while ((unsigned)(buf + sizeof(buf) - p) < width) *--p = '0';
+  out.s.append(p, buf + sizeof(buf));
+  out.hexBase = hex;
+}
+
 void VisitorVertexWriter::pushPair(const std::string& p, uint64_t v, FormatNum format) const {
-  out << ", " << p << "=\"";
+  out.s += ", ";
+  out.s += p;
+  out.s += "=\"";
   switch (format) {
-    case FormatNum::HEX   : out << "0x" << std::hex << v; break;
-    case FormatNum::HEX16 : out << "0x" << std::hex  << std::setfill('0') << std::setw(4) << v; break;
-    case FormatNum::HEX32 : out << "0x" << std::hex  << std::setfill('0') << std::setw(8) << v; break;
-    case FormatNum::HEX64 : out << "0x" << std::hex  << std::setfill('0') << std::setw(16) << v; break;
-    case FormatNum::DEC   : out << std::dec << v; break;
-    case FormatNum::BIT   : out << std::dec << (v & 1); break;
-    case FormatNum::BOOL  : out << ((v & 1) ? sTrue : sFalse); break;
-    default               : out << std::dec << v;
+    case FormatNum::HEX   : out.s += "0x"; pushNumber(v, true); break;
+    case FormatNum::HEX16 : out.s += "0x"; pushNumber(v, true, 4); break;
+    case FormatNum::HEX32 : out.s += "0x"; pushNumber(v, true, 8); break;
+    case FormatNum::HEX64 : out.s += "0x"; pushNumber(v, true, 16); break;
+    case FormatNum::DEC   : pushNumber(v, false); break;
+    case FormatNum::BIT   : pushNumber(v & 1, false); break;
+    case FormatNum::BOOL  : out.s += ((v & 1) ? sTrue : sFalse); break;
+    default               : pushNumber(v, false);
   }
-  out << "\"";
+  out.s += '"';
 }
 
 void VisitorVertexWriter::pushPair(const std::string& p, const std::string& v) const {
-  out << ", " << p << "=\"" << v << "\"";
+  out.s += ", ";
+  out.s += p;
+  out.s += "=\"";
+  out.s += v;
+  out.s += '"';
 }
 
 void VisitorVertexWriter::pushSingle(const std::string& p) const  {
-  out << ", " << p;
+  out.s += ", ";
+  out.s += p;
 }
 
 void VisitorVertexWriter::pushMembershipInfo(const Node& el) const {
@@ -56,7 +74,10 @@ void VisitorVertexWriter::pushMembershipInfo(const Node& el) const {
 void VisitorVertexWriter::pushNodeInfo(const Node& el) const {
   pushStart();
   //can't use our helper for first property, as we cannot have a comma
-  out << dnp::Base::sCpu   << "=\"" <<  (int)el.getCpu() << "\"";
+  out.s += dnp::Base::sCpu;
+  out.s += "=\"";
+  pushNumber(el.getCpu(), out.hexBase);
+  out.s += '"';
   pushPair(dnp::Base::sFlags, el.getFlags(), FormatNum::HEX32);
 
 }
@@ -1,4 +1,5 @@
 import dm_testbench
+import re
 
 """Class collects unit tests for the command line of dm-cmd.
 First section: all commands which need a target name. Test case names: test_<command>_missing, test_<command>.
@@ -188,3 +189,36 @@ class TestDmCmdStop(dm_testbench.DmTestbench):
          expectedReturnCode=[0], linesCout=0, linesCerr=1)[1]
     self.assertTrue("Node 'EVT_PPS1' is not a block" in linesErr[0])
 
+"""Class collects unit tests for commands prepared once and sent repeatedly (dm-cmd option -r).
+The pattern of dm_cmd_prepared.dot is not started, so all commands stay pending in the queue of B_PREP.
+"""
+class TestDmCmdPrepared(dm_testbench.DmTestbench):
+
+  def queueContent(self):
+    """Return the verbose queue listing of B_PREP without the call time and the valid times, which differ between runs.
+    """
+    lines = self.startAndGetSubprocessStdout([self.binaryDmCmd, self.datamaster, '-v', 'queue', 'B_PREP'])
+    return [re.sub('Valid Time: 0x[0-9a-f]+ +[0-9]+', 'Valid Time:', line) for line in lines[1:]]
+
+  def sendAndComparePrepared(self, arguments, repetitions=3):
+    """Send the command <repetitions> times the normal way, then once more on a fresh schedule prepared once
+    with '-r <repetitions>'. Both ways must lead to the same queue content.
+    """
+    self.addSchedule('dm_cmd_prepared.dot')
+    for i in range(repetitions):
+      self.startAndCheckSubprocess([self.binaryDmCmd, self.datamaster] + arguments, linesCerr=0)
+    expected = self.queueContent()
+    self.assertEqual(len([line for line in expected if 'pending' in line]), repetitions, f'queue: {expected}')
+    self.initDatamaster()
+    self.addSchedule('dm_cmd_prepared.dot')
+    self.startAndCheckSubprocess([self.binaryDmCmd, self.datamaster, '-r', str(repetitions)] + arguments, linesCerr=0)
+    self.assertEqual(self.queueContent(), expected)
+
+  def test_prepared_flow(self):
+    self.sendAndComparePrepared(['flow', 'B_PREP', 'Evt_PREP_ALT'])
+
+  def test_prepared_noop(self):
+    self.sendAndComparePrepared(['noop', 'B_PREP'])
+
+  def test_prepared_relwait(self):
+    self.sendAndComparePrepared(['relwait', 'B_PREP', '20000000'])
@@ -6,7 +6,7 @@ class TestDmSched(dm_testbench.DmTestbench):
 
   def test_sched_usage(self):
     self.startAndGetSubprocessOutput([self.binaryDmSched, '-h'],
-         expectedReturnCode=[0], linesCout=0, linesCerr=25)
+         expectedReturnCode=[0], linesCout=0, linesCerr=31)
 
   def test_sched_default(self):
     linesOut = self.startAndGetSubprocessOutput([self.binaryDmSched, self.datamaster],
@@ -56,6 +56,68 @@ class TestDmSched(dm_testbench.DmTestbench):
     self.startAndGetSubprocessOutput([self.binaryDmSched, self.datamaster, 'rawvisited'],
          expectedReturnCode=[0], linesCout=0, linesCerr=0)
 
+  def test_sched_timing_duplicate_due(self):
+    """Event and block of the cycle are due at the same time, the preptime window (1 ms) equals the block period.
+    Both nodes fall into every window, so the burst must be 2.
+    """
+    linesOut = self.startAndGetSubprocessOutput([self.binaryDmSched, self.datamaster, 'timing', self.schedules_folder + 'timing-duplicate-due.dot'],
+         expectedReturnCode=[0], linesCerr=0)[0]
+    cycleLines = [line for line in linesOut if line.startswith('EVT_TIMING_DUP') or line.startswith('B_TIMING_DUP')]
+    self.assertEqual(len(cycleLines), 1)
+    self.assertEqual(cycleLines[0].split()[-1], '2')
+
+  def test_sched_place_resident_thread(self):
+    """A resident origin on CPU 0 claims thread 1. The new pattern claims thread 1 too and commands the resident block,
+    which makes CPU 0 the cheapest choice, but the thread is already taken there.
+    """
+    self.addSchedule('place-resident-origin.dot')
+    linesOut = self.startAndGetSubprocessOutput([self.binaryDmSched, self.datamaster, 'place', self.schedules_folder + 'place-new-origin.dot'],
+         expectedReturnCode=[0], linesCerr=0)[0]
+    clusterLines = [line for line in linesOut if line.startswith('PLACE_NEW')]
+    self.assertEqual(len(clusterLines), 1)
+    self.assertNotEqual(clusterLines[0].split()[1], '0')
+
+  def syncAndCompare(self, scheduleFile):
+    """Add sync-base.dot, sync the data master to <scheduleFile> and compare the downloaded status with <scheduleFile>.
+    Returns the verbose output of the sync.
+    """
+    status_file = 'sync-status.dot'
+    self.addSchedule('sync-base.dot')
+    linesOut = self.startAndGetSubprocessOutput([self.binaryDmSched, self.datamaster, 'sync', '-v', self.schedules_folder + scheduleFile],
+         expectedReturnCode=[0])[0]
+    self.startAndCheckSubprocess([self.binaryDmSched, self.datamaster, 'status', '-o', status_file])
+    self.startAndCheckSubprocess(['scheduleCompare', self.schedules_folder + scheduleFile, status_file])
+    self.deleteFile(status_file)
+    return linesOut
+
+  def test_sched_sync_unchanged(self):
+    linesOut = self.syncAndCompare('sync-base.dot')
+    self.assertIn('Schedule on DM already matches, nothing to upload', linesOut)
+    self.assertNotIn('Upload', linesOut)
+
+  def test_sched_sync_remove(self):
+    linesOut = self.syncAndCompare('sync-remove.dot')
+    self.assertIn('Remove 2 nodes', linesOut)
+    self.assertIn('Upload', linesOut)
+
+  def test_sched_sync_add(self):
+    linesOut = self.syncAndCompare('sync-add.dot')
+    self.assertIn('Add 2 nodes', linesOut)
+    self.assertIn('Upload', linesOut)
+
+  def test_sched_sync_modify(self):
+    """Changed properties are updated in place, the nodes are not replaced."""
+    linesOut = self.syncAndCompare('sync-modify.dot')
+    self.assertIn('Updating Evt_SYNC_A1', linesOut)
+    self.assertIn('Updating B_SYNC_A', linesOut)
+    self.assertEqual([line for line in linesOut if line.startswith('Replacing') or line.startswith('Remove') or line.startswith('Add')], [])
+
+  def test_sched_sync_rewire(self):
+    """Only the block with the changed outgoing edge is rewired."""
+    linesOut = self.syncAndCompare('sync-rewire.dot')
+    self.assertEqual([line for line in linesOut if line.startswith('Rewiring')], ['Rewiring B_SYNC_A'])
+    self.assertEqual([line for line in linesOut if line.startswith('Updating')], [])
+
   def test_sched_add_pps(self):
     self.startAndGetSubprocessOutput([self.binaryDmSched, self.datamaster, 'add', self.schedules_folder + 'pps.dot' ],
          expectedReturnCode=[0], linesCout=0, linesCerr=0)